@@ -2,6 +2,7 @@
 #include "src/Core/Application.h"
 #include "src/Core/Window.h"
 #include "src/Core/Time.h"
+#include "src/Core/JobSystem.h"
 #include "src/Core/AssetManager.h"
 #include "src/Core/LightManager.h"
 #include "src/Core/CustomMeshManager.h"
@@ -26,6 +27,7 @@
 
 #include "src/ECS/EntityManager.h"
 #include "src/ECS/Component.h"
+#include "src/ECS/SpatialIndex.h"
 
 #include "src/Audio/AudioManager.h"
 
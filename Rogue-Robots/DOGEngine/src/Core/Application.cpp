@@ -5,7 +5,9 @@
 #include "../Scripting//LuaMain.h"
 #include "AnimationManager.h"
 #include "AssetManager.h"
+#include "JobSystem.h"
 #include "../ECS/EntityManager.h"		// to remove
+#include "../ECS/SpatialIndex.h"
 #include "../Input/Mouse.h"
 #include "../Input/Keyboard.h"
 
@@ -63,12 +65,10 @@ namespace DOG
 
 			AssetManager::Get().Update();
 
-			for (auto& system : EntityManager::Get())
-			{
-				system->EarlyUpdate();
-			}
+			EntityManager::Get().RunSystems(SystemPhase::EarlyUpdate);
 
 			PhysicsEngine::UpdatePhysics((f32)Time::DeltaTime());
+			SpatialIndex::Invalidate();
 
 			AudioManager::AudioSystem();
 
@@ -84,29 +84,22 @@ namespace DOG
 				layer->OnImGuiRender();
 			}
 #endif
-			for (auto& system : EntityManager::Get())
-			{
-				system->Update();
-			}
+			EntityManager::Get().RunSystems(SystemPhase::Update);
 
 			m_frontRenderer->Update(Time::DeltaTime<TimeType::Seconds, f32>());
 			m_frontRenderer->BeginGPUFrame();
 			m_frontRenderer->Render(Time::DeltaTime<TimeType::Seconds, f32>());
 			m_frontRenderer->EndGPUFrame();
 
-			for (auto& system : EntityManager::Get())
-			{
-				system->LateUpdate();
-			}
-
-			EntityManager::Get().Collect<DirtyComponent>().Do([](entity, DirtyComponent& dirty) { dirty.dirtyBitSet &= 0; });	
+			EntityManager::Get().RunSystems(SystemPhase::LateUpdate);
 
 			// Remove collision components from entities before next frame's collisions
 			EntityManager::Get().Collect<HasEnteredCollisionComponent>().Do([](entity e, HasEnteredCollisionComponent& c)
 				{
 					if (c.entitiesCount > HasEnteredCollisionComponent::maxCount) std::cout << "HasCollidedComponent collided with more then" << HasEnteredCollisionComponent::maxCount << " other entities" << std::endl;
-					EntityManager::Get().RemoveComponent<HasEnteredCollisionComponent>(e);
+					EntityManager::Get().GetCommandBuffer().RemoveComponent<HasEnteredCollisionComponent>(e);
 				});
+			EntityManager::Get().PlaybackCommandBuffer();
 
 			//Deferred deletions happen here!!!
 			LuaMain::GetScriptManager()->RemoveScriptsFromDeferredEntities();
@@ -268,6 +261,7 @@ namespace DOG
 		SetAudioSettings(m_specification.audioSettings);
 		PhysicsEngine::Initialize();
 		LuaMain::Initialize();
+		JobSystem::Initialize();
 
 
 		ImGuiMenuLayer::RegisterDebugWindow("MiniProfiler", [](bool& open) { MiniProfiler::DrawResultWithImGui(open); }, true);
@@ -276,6 +270,7 @@ namespace DOG
 	void Application::OnShutDown() noexcept
 	{
 		ImGuiMenuLayer::UnRegisterDebugWindow("MiniProfiler");
+		JobSystem::Destroy();
 		AssetManager::Destroy();
 		AudioManager::Destroy();
 		
@@ -0,0 +1,135 @@
+#include "JobSystem.h"
+
+namespace DOG
+{
+	void JobSystem::Initialize(u32 workerCount)
+	{
+		assert(s_workers.empty());
+
+		if (workerCount == 0)
+		{
+			const u32 hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+		}
+
+		s_stop = false;
+		s_workers.reserve(workerCount);
+		for (u32 i = 0; i < workerCount; ++i)
+		{
+			s_workers.emplace_back(&JobSystem::WorkerLoop);
+		}
+	}
+
+	void JobSystem::Destroy()
+	{
+		{
+			std::scoped_lock lock(s_queueMutex);
+			s_stop = true;
+		}
+		s_queueCondition.notify_all();
+
+		for (auto& worker : s_workers)
+			worker.join();
+
+		s_workers.clear();
+		s_queue.clear();
+	}
+
+	void JobSystem::Execute(Job&& job, JobCounter* counter)
+	{
+		if (counter)
+			counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+		QueuedJob queuedJob{ std::move(job), counter };
+
+		// Without workers everything runs inline, this keeps callers valid before Initialize and after Destroy.
+		if (s_workers.empty())
+		{
+			RunJob(queuedJob);
+			return;
+		}
+
+		{
+			std::scoped_lock lock(s_queueMutex);
+			s_queue.emplace_back(std::move(queuedJob));
+		}
+		s_queueCondition.notify_one();
+	}
+
+	void JobSystem::Dispatch(u32 count, u32 groupSize, const RangeJob& job)
+	{
+		if (count == 0)
+			return;
+
+		groupSize = std::max(groupSize, 1u);
+		const u32 groupCount = (count + groupSize - 1) / groupSize;
+
+		if (groupCount == 1 || s_workers.empty())
+		{
+			job(0, count);
+			return;
+		}
+
+		JobCounter counter;
+		for (u32 group = 1; group < groupCount; ++group)
+		{
+			const u32 begin = group * groupSize;
+			const u32 end = std::min(begin + groupSize, count);
+			Execute([&job, begin, end]() { job(begin, end); }, &counter);
+		}
+
+		// The calling thread takes the first range itself instead of idling
+		job(0, std::min(groupSize, count));
+		Wait(counter);
+	}
+
+	void JobSystem::Wait(const JobCounter& counter)
+	{
+		while (counter.pending.load(std::memory_order_acquire) > 0)
+		{
+			if (!RunPendingJob())
+				std::this_thread::yield();
+		}
+	}
+
+	bool JobSystem::RunPendingJob()
+	{
+		QueuedJob queuedJob;
+		{
+			std::scoped_lock lock(s_queueMutex);
+			if (s_queue.empty())
+				return false;
+
+			queuedJob = std::move(s_queue.front());
+			s_queue.pop_front();
+		}
+		RunJob(queuedJob);
+		return true;
+	}
+
+	void JobSystem::WorkerLoop()
+	{
+		s_isWorkerThread = true;
+		while (true)
+		{
+			QueuedJob queuedJob;
+			{
+				std::unique_lock lock(s_queueMutex);
+				s_queueCondition.wait(lock, []() { return s_stop || !s_queue.empty(); });
+				if (s_stop && s_queue.empty())
+					return;
+
+				queuedJob = std::move(s_queue.front());
+				s_queue.pop_front();
+			}
+			RunJob(queuedJob);
+		}
+	}
+
+	void JobSystem::RunJob(QueuedJob& queuedJob)
+	{
+		queuedJob.job();
+		if (queuedJob.counter)
+			queuedJob.counter->pending.fetch_sub(1, std::memory_order_release);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+namespace DOG
+{
+	// Counts jobs that are still in flight. Pass one to JobSystem::Execute and hand it to JobSystem::Wait.
+	struct JobCounter
+	{
+		std::atomic<u32> pending{ 0 };
+	};
+
+	class JobSystem
+	{
+	public:
+		using Job = std::function<void()>;
+		using RangeJob = std::function<void(u32 begin, u32 end)>;
+
+		// workerCount == 0 picks hardware_concurrency - 1 (the main thread also executes jobs while waiting).
+		static void Initialize(u32 workerCount = 0);
+		static void Destroy();
+
+		static void Execute(Job&& job, JobCounter* counter = nullptr);
+
+		// Splits [0, count) into ranges of at most groupSize and runs them on the workers. Blocks until every range is done.
+		static void Dispatch(u32 count, u32 groupSize, const RangeJob& job);
+
+		// The calling thread helps out with queued jobs until the counter reaches zero.
+		static void Wait(const JobCounter& counter);
+
+		// Runs one queued job on the calling thread, returns false if the queue was empty.
+		static bool RunPendingJob();
+
+		[[nodiscard]] static u32 GetWorkerCount() noexcept { return static_cast<u32>(s_workers.size()); }
+		[[nodiscard]] static bool IsWorkerThread() noexcept { return s_isWorkerThread; }
+
+	private:
+		struct QueuedJob
+		{
+			Job job;
+			JobCounter* counter = nullptr;
+		};
+
+		static void WorkerLoop();
+		static void RunJob(QueuedJob& job);
+
+	private:
+		static inline std::vector<std::thread> s_workers;
+		static inline std::deque<QueuedJob> s_queue;
+		static inline std::mutex s_queueMutex;
+		static inline std::condition_variable s_queueCondition;
+		static inline bool s_stop = false;
+		static inline thread_local bool s_isWorkerThread = false;
+	};
+}
@@ -0,0 +1,341 @@
+#include "EntityManager.h"
+
+namespace DOG
+{
+	void ArchetypeChunk::Deleter::operator()(std::byte* data) const noexcept
+	{
+		::operator delete(data, std::align_val_t{ ARCHETYPE_COLUMN_ALIGNMENT });
+	}
+
+	std::byte* Archetype::ComponentAt(const ArchetypeChunk& chunk, const u32 bit, const u32 row) const noexcept
+	{
+		return chunk.data.get() + columnOffsets[bit] + (size_t)row * ArchetypeStorage::GetComponentInfo(bit).size;
+	}
+
+	ArchetypeStorage::ArchetypeStorage() noexcept
+	{
+		Reset();
+	}
+
+	ArchetypeStorage::~ArchetypeStorage() noexcept
+	{
+		DestroyAllComponents();
+	}
+
+	u32 ArchetypeStorage::RegisterComponent(const ArchetypeComponentInfo& info) noexcept
+	{
+		std::scoped_lock lock(s_registrationMutex);
+		ECS_ASSERT(s_componentInfos.size() < MAX_ARCHETYPE_COMPONENT_TYPES, "Too many archetype component types.");
+		ECS_ASSERT(info.alignment <= ARCHETYPE_COLUMN_ALIGNMENT, "Archetype components can not be aligned to more than a cache line.");
+
+		//Never reallocates, queries running on other threads read the infos without the lock
+		s_componentInfos.reserve(MAX_ARCHETYPE_COMPONENT_TYPES);
+		s_componentInfos.push_back(info);
+		return (u32)s_componentInfos.size() - 1u;
+	}
+
+	void ArchetypeStorage::DestroyEntity(const entity entityID) noexcept
+	{
+		if (EntityIndex(entityID) < m_locations.size() && m_locations[EntityIndex(entityID)].archetype != EMPTY_ARCHETYPE)
+		{
+			MoveEntity(entityID, EMPTY_ARCHETYPE);
+		}
+	}
+
+	void ArchetypeStorage::Reset() noexcept
+	{
+		DestroyAllComponents();
+
+		m_archetypes.clear();
+		m_archetypeLookup.clear();
+		m_queryCaches.clear();
+		m_locations.clear();
+		m_locations.resize(INITIAL_ENTITY_CAPACITY);
+
+		FindOrCreateArchetype(0u);
+	}
+
+	void ArchetypeStorage::WriteSnapshot(SnapshotWriter& writer) const noexcept
+	{
+		const size_t countOffset = writer.GetOffset();
+		writer.Write(0u);
+
+		u32 archetypeCount{ 0u };
+		for (const auto& archetype : m_archetypes)
+		{
+			if (archetype.entityCount == 0u)
+				continue;
+
+			u32 bitCount{ 0u };
+			for (u32 bit : archetype.componentBits)
+				bitCount += s_componentInfos[bit].snapshotMode != SnapshotMode::Retained;
+			if (bitCount == 0u)
+				continue;
+
+			//Only the snapshotted part of the signature is written, the reader matches the columns by type name
+			writer.Write(bitCount);
+			for (u32 bit : archetype.componentBits)
+			{
+				if (s_componentInfos[bit].snapshotMode != SnapshotMode::Retained)
+				{
+					writer.Write(s_componentInfos[bit].typeHash);
+					writer.Write(s_componentInfos[bit].snapshotMode);
+					writer.Write(s_componentInfos[bit].size);
+				}
+			}
+
+			writer.Write(archetype.entityCount);
+			for (const auto& chunk : archetype.chunks)
+				writer.Write(archetype.Entities(chunk), chunk.count * sizeof(entity));
+
+			for (u32 bit : archetype.componentBits)
+			{
+				if (s_componentInfos[bit].snapshotMode != SnapshotMode::Memcpy)
+					continue;
+				for (const auto& chunk : archetype.chunks)
+					writer.Write(archetype.ComponentAt(chunk, bit, 0u), (size_t)chunk.count * s_componentInfos[bit].size);
+			}
+			archetypeCount++;
+		}
+		writer.Patch(countOffset, archetypeCount);
+	}
+
+	void ArchetypeStorage::ReadSnapshot(SnapshotReader& reader) noexcept
+	{
+		//Drop the snapshotted components, retained ones stay where they are
+		u64 retainedMask{ 0u };
+		for (u32 bit{ 0u }; bit < s_componentInfos.size(); ++bit)
+		{
+			if (s_componentInfos[bit].snapshotMode == SnapshotMode::Retained)
+				retainedMask |= 1ull << bit;
+		}
+
+		std::vector<entity> entities;
+		for (u32 archetypeIndex{ 1u }; archetypeIndex < m_archetypes.size(); ++archetypeIndex)
+		{
+			const u64 signature = m_archetypes[archetypeIndex].signature;
+			if ((signature & retainedMask) == signature)
+				continue;
+
+			entities.clear();
+			for (const auto& chunk : m_archetypes[archetypeIndex].chunks)
+				entities.insert(entities.end(), m_archetypes[archetypeIndex].Entities(chunk), m_archetypes[archetypeIndex].Entities(chunk) + chunk.count);
+			const u32 target = FindOrCreateArchetype(signature & retainedMask);
+			for (const entity entityID : entities)
+				MoveEntity(entityID, target);
+		}
+
+		const u32 archetypeCount = reader.Read<u32>();
+		for (u32 i{ 0u }; i < archetypeCount; ++i)
+		{
+			struct Column { u32 bit; SnapshotMode mode; u32 size; };
+			std::vector<Column> columns(reader.Read<u32>());
+			u64 signature{ 0u };
+			for (auto& column : columns)
+			{
+				const u64 typeHash = reader.Read<u64>();
+				column.mode = reader.Read<SnapshotMode>();
+				column.size = reader.Read<u32>();
+
+				auto info = std::find_if(s_componentInfos.begin(), s_componentInfos.end(), [&](const ArchetypeComponentInfo& candidate) { return candidate.typeHash == typeHash; });
+				ECS_ASSERT(info != s_componentInfos.end(), "Snapshot contains an archetype component type this program has never used.");
+				ECS_ASSERT(info == s_componentInfos.end() || (info->snapshotMode == column.mode && info->size == column.size), "Archetype component changed layout since the snapshot was captured.");
+				const bool matches = info != s_componentInfos.end() && info->snapshotMode == column.mode && info->size == column.size;
+				column.bit = matches ? (u32)(info - s_componentInfos.begin()) : UINT32_MAX;
+				if (matches)
+					signature |= 1ull << column.bit;
+			}
+
+			entities.resize(reader.Read<u32>());
+			reader.Read(entities.data(), entities.size() * sizeof(entity));
+			for (const entity entityID : entities)
+			{
+				ValidateLocation(entityID);
+				const u32 current = m_locations[EntityIndex(entityID)].archetype;
+				if ((m_archetypes[current].signature | signature) != m_archetypes[current].signature)
+					MoveEntity(entityID, FindOrCreateArchetype(m_archetypes[current].signature | signature));
+			}
+
+			//The components were dropped above, so the moved in rows are raw storage that is overwritten byte for byte
+			for (const auto& column : columns)
+			{
+				if (column.mode != SnapshotMode::Memcpy)
+					continue;
+				if (column.bit == UINT32_MAX)
+				{
+					reader.Skip(entities.size() * column.size);
+					continue;
+				}
+				for (const entity entityID : entities)
+				{
+					const ArchetypeLocation& location = m_locations[EntityIndex(entityID)];
+					const Archetype& archetype = m_archetypes[location.archetype];
+					reader.Read(archetype.ComponentAt(archetype.chunks[location.chunk], column.bit, location.row), column.size);
+				}
+			}
+		}
+	}
+
+	const ArchetypeQueryCache& ArchetypeStorage::GetQueryCache(const u64 signature) noexcept
+	{
+		auto& cache = m_queryCaches[signature];
+		for (u32 i{ cache.archetypesSeen }; i < m_archetypes.size(); ++i)
+		{
+			if ((m_archetypes[i].signature & signature) == signature)
+				cache.archetypes.push_back(i);
+		}
+		cache.archetypesSeen = (u32)m_archetypes.size();
+		return cache;
+	}
+
+	u32 ArchetypeStorage::FindOrCreateArchetype(const u64 signature) noexcept
+	{
+		if (auto it = m_archetypeLookup.find(signature); it != m_archetypeLookup.end())
+			return it->second;
+
+		Archetype archetype;
+		archetype.signature = signature;
+		archetype.columnOffsets.fill(UINT32_MAX);
+		archetype.addEdges.fill(NULL_ARCHETYPE_EDGE);
+		archetype.removeEdges.fill(NULL_ARCHETYPE_EDGE);
+
+		u32 bytesPerEntity = sizeof(entity);
+		for (u32 bit{ 0u }; bit < MAX_ARCHETYPE_COMPONENT_TYPES; ++bit)
+		{
+			if (signature & (1ull << bit))
+			{
+				archetype.componentBits.push_back(bit);
+				bytesPerEntity += s_componentInfos[bit].size;
+			}
+		}
+
+		//Every column is padded up to a cache line, shrink the capacity until the padding fits as well
+		const auto alignUp = [](u32 value) { return (value + ARCHETYPE_COLUMN_ALIGNMENT - 1u) / ARCHETYPE_COLUMN_ALIGNMENT * ARCHETYPE_COLUMN_ALIGNMENT; };
+		const auto layoutSize = [&](u32 capacity)
+		{
+			u32 offset = alignUp(capacity * (u32)sizeof(entity));
+			for (u32 bit : archetype.componentBits)
+			{
+				archetype.columnOffsets[bit] = offset;
+				offset = alignUp(offset + capacity * s_componentInfos[bit].size);
+			}
+			return offset;
+		};
+
+		archetype.capacity = std::max(ARCHETYPE_CHUNK_SIZE / bytesPerEntity, 1u);
+		while (archetype.capacity > 1u && layoutSize(archetype.capacity) > ARCHETYPE_CHUNK_SIZE)
+			archetype.capacity--;
+		ECS_ASSERT(layoutSize(archetype.capacity) <= ARCHETYPE_CHUNK_SIZE, "Archetype does not fit in a chunk.");
+
+		m_archetypes.emplace_back(std::move(archetype));
+		m_archetypeLookup[signature] = (u32)m_archetypes.size() - 1u;
+		return (u32)m_archetypes.size() - 1u;
+	}
+
+	u32 ArchetypeStorage::AddEdge(const u32 archetypeIndex, const u32 bit) noexcept
+	{
+		if (m_archetypes[archetypeIndex].addEdges[bit] == NULL_ARCHETYPE_EDGE)
+		{
+			const u32 target = FindOrCreateArchetype(m_archetypes[archetypeIndex].signature | (1ull << bit));
+			m_archetypes[archetypeIndex].addEdges[bit] = target;
+			m_archetypes[target].removeEdges[bit] = archetypeIndex;
+		}
+		return m_archetypes[archetypeIndex].addEdges[bit];
+	}
+
+	u32 ArchetypeStorage::RemoveEdge(const u32 archetypeIndex, const u32 bit) noexcept
+	{
+		if (m_archetypes[archetypeIndex].removeEdges[bit] == NULL_ARCHETYPE_EDGE)
+		{
+			const u32 target = FindOrCreateArchetype(m_archetypes[archetypeIndex].signature & ~(1ull << bit));
+			m_archetypes[archetypeIndex].removeEdges[bit] = target;
+			m_archetypes[target].addEdges[bit] = archetypeIndex;
+		}
+		return m_archetypes[archetypeIndex].removeEdges[bit];
+	}
+
+	void ArchetypeStorage::MoveEntity(const entity entityID, const u32 targetArchetype) noexcept
+	{
+		const ArchetypeLocation source = m_locations[EntityIndex(entityID)];
+		const ArchetypeLocation destination = targetArchetype != EMPTY_ARCHETYPE ? AllocateRow(targetArchetype, entityID) : ArchetypeLocation{};
+
+		if (source.archetype != EMPTY_ARCHETYPE)
+		{
+			const Archetype& from = m_archetypes[source.archetype];
+			const Archetype& to = m_archetypes[targetArchetype];
+			for (u32 bit : from.componentBits)
+			{
+				std::byte* component = from.ComponentAt(from.chunks[source.chunk], bit, source.row);
+				if (to.signature & (1ull << bit))
+					s_componentInfos[bit].relocate(to.ComponentAt(to.chunks[destination.chunk], bit, destination.row), component);
+				else
+					s_componentInfos[bit].destroy(component);
+			}
+			RemoveRow(source);
+		}
+		m_locations[EntityIndex(entityID)] = destination;
+	}
+
+	ArchetypeLocation ArchetypeStorage::AllocateRow(const u32 archetypeIndex, const entity entityID) noexcept
+	{
+		Archetype& archetype = m_archetypes[archetypeIndex];
+		if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+		{
+			auto& chunk = archetype.chunks.emplace_back();
+			chunk.data.reset(static_cast<std::byte*>(::operator new(ARCHETYPE_CHUNK_SIZE, std::align_val_t{ ARCHETYPE_COLUMN_ALIGNMENT })));
+		}
+
+		auto& chunk = archetype.chunks.back();
+		const u32 row = chunk.count++;
+		archetype.Entities(chunk)[row] = entityID;
+		archetype.entityCount++;
+		return { archetypeIndex, (u32)archetype.chunks.size() - 1u, row };
+	}
+
+	void ArchetypeStorage::RemoveRow(const ArchetypeLocation& location) noexcept
+	{
+		Archetype& archetype = m_archetypes[location.archetype];
+		auto& lastChunk = archetype.chunks.back();
+		const u32 lastRow = lastChunk.count - 1u;
+
+		//The components of the removed row have already been moved out or destroyed, fill the hole with the last row
+		if (location.chunk != archetype.chunks.size() - 1u || location.row != lastRow)
+		{
+			auto& chunk = archetype.chunks[location.chunk];
+			const entity moved = archetype.Entities(lastChunk)[lastRow];
+			for (u32 bit : archetype.componentBits)
+				s_componentInfos[bit].relocate(archetype.ComponentAt(chunk, bit, location.row), archetype.ComponentAt(lastChunk, bit, lastRow));
+
+			archetype.Entities(chunk)[location.row] = moved;
+			m_locations[EntityIndex(moved)] = location;
+		}
+
+		lastChunk.count--;
+		archetype.entityCount--;
+		if (lastChunk.count == 0u)
+			archetype.chunks.pop_back();
+	}
+
+	void ArchetypeStorage::DestroyAllComponents() noexcept
+	{
+		for (auto& archetype : m_archetypes)
+		{
+			for (auto& chunk : archetype.chunks)
+			{
+				for (u32 bit : archetype.componentBits)
+				{
+					for (u32 row{ 0u }; row < chunk.count; ++row)
+						s_componentInfos[bit].destroy(archetype.ComponentAt(chunk, bit, row));
+				}
+			}
+		}
+	}
+
+	void ArchetypeStorage::ValidateLocation(const entity entityID) noexcept
+	{
+		if (EntityIndex(entityID) >= m_locations.size())
+		{
+			m_locations.resize((size_t)EntityIndex(entityID) * 2u + 1u);
+		}
+	}
+}
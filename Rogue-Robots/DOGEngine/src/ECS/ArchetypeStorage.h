@@ -0,0 +1,135 @@
+#pragma once
+#include "EntityTypedef.h"
+#include "WorldSnapshot.h"
+
+namespace DOG
+{
+	// Opt-in storage for components that are mostly queried together (transforms, renderers, lights), see DOG_ARCHETYPE_STORAGE.
+	// Entities with the same set of archetype components share SoA chunks, so EntityManager::Query is a linear scan.
+	// Tag-like components and components that are mostly probed with HasComponent should stay in the default SparseSet storage.
+	template<typename ComponentType>
+	struct UsesArchetypeStorage : std::false_type {};
+
+	template<typename ComponentType>
+	inline constexpr bool IsArchetypeComponent = UsesArchetypeStorage<ComponentType>::value;
+
+	constexpr const u32 ARCHETYPE_CHUNK_SIZE = 16u * 1024u;
+	constexpr const u32 ARCHETYPE_COLUMN_ALIGNMENT = 64u;
+	constexpr const u32 MAX_ARCHETYPE_COMPONENT_TYPES = 64u;
+	constexpr const u32 EMPTY_ARCHETYPE = 0u;
+	constexpr const u32 NULL_ARCHETYPE_EDGE = UINT32_MAX;
+
+	struct ArchetypeComponentInfo
+	{
+		u32 size = 0u;
+		u32 alignment = 0u;
+		void (*relocate)(void* destination, void* source) = nullptr; //Move constructs into destination and destroys source
+		void (*destroy)(void* component) = nullptr;
+		u64 typeHash = 0u; //Hash of the component type name, identifies the column in snapshots
+		SnapshotMode snapshotMode = SnapshotMode::Retained; //Memcpy, Tag or Retained, archetype columns have no custom serializers
+	};
+
+	struct ArchetypeChunk
+	{
+		struct Deleter { void operator()(std::byte* data) const noexcept; };
+
+		//Entity column followed by one column per component, every column starts on a cache line
+		std::unique_ptr<std::byte, Deleter> data;
+		u32 count = 0u;
+	};
+
+	struct Archetype
+	{
+		[[nodiscard]] entity* Entities(const ArchetypeChunk& chunk) const noexcept { return reinterpret_cast<entity*>(chunk.data.get()); }
+		[[nodiscard]] std::byte* ComponentAt(const ArchetypeChunk& chunk, const u32 bit, const u32 row) const noexcept;
+
+		template<typename ComponentType>
+		[[nodiscard]] ComponentType* Column(const ArchetypeChunk& chunk) const noexcept;
+
+		u64 signature = 0u;
+		u32 capacity = 0u;
+		u32 entityCount = 0u;
+		std::vector<u32> componentBits;
+		std::array<u32, MAX_ARCHETYPE_COMPONENT_TYPES> columnOffsets;
+		std::array<u32, MAX_ARCHETYPE_COMPONENT_TYPES> addEdges;
+		std::array<u32, MAX_ARCHETYPE_COMPONENT_TYPES> removeEdges;
+		//Rows are always removed by moving the last row into the hole, so only the last chunk can be partially filled
+		std::vector<ArchetypeChunk> chunks;
+	};
+
+	struct ArchetypeLocation
+	{
+		u32 archetype = EMPTY_ARCHETYPE;
+		u32 chunk = 0u;
+		u32 row = 0u;
+	};
+
+	// Archetypes are never removed, so a cached match list only has to look at archetypes created since it was last refreshed.
+	struct ArchetypeQueryCache
+	{
+		std::vector<u32> archetypes;
+		u32 archetypesSeen = 0u;
+	};
+
+	class ArchetypeStorage
+	{
+	public:
+		ArchetypeStorage() noexcept;
+		~ArchetypeStorage() noexcept;
+		DELETE_COPY_MOVE_CONSTRUCTOR(ArchetypeStorage);
+
+		template<typename ComponentType>
+		[[nodiscard]] static u32 ComponentBit() noexcept;
+
+		template<typename ComponentType, typename ...Args>
+		ComponentType& Add(const entity entityID, Args&& ...args) noexcept;
+
+		template<typename ComponentType>
+		void Remove(const entity entityID) noexcept;
+
+		template<typename ComponentType>
+		[[nodiscard]] bool Has(const entity entityID) const noexcept;
+
+		template<typename ComponentType>
+		[[nodiscard]] ComponentType& Get(const entity entityID) const noexcept;
+
+		void DestroyEntity(const entity entityID) noexcept;
+		void Reset() noexcept;
+
+		// Snapshot part of EntityManager::CaptureSnapshot/RestoreSnapshot. Restoring expects entities that did not survive to be
+		// destroyed already, it drops the snapshotted components of every remaining entity and moves the captured rows back in.
+		// Retained components stay on their entities.
+		void WriteSnapshot(SnapshotWriter& writer) const noexcept;
+		void ReadSnapshot(SnapshotReader& reader) noexcept;
+
+		[[nodiscard]] const ArchetypeQueryCache& GetQueryCache(const u64 signature) noexcept;
+		[[nodiscard]] const Archetype& GetArchetype(const u32 archetypeIndex) const noexcept { return m_archetypes[archetypeIndex]; }
+		[[nodiscard]] static const ArchetypeComponentInfo& GetComponentInfo(const u32 bit) noexcept { return s_componentInfos[bit]; }
+
+	private:
+		static u32 RegisterComponent(const ArchetypeComponentInfo& info) noexcept;
+
+		u32 FindOrCreateArchetype(const u64 signature) noexcept;
+		u32 AddEdge(const u32 archetypeIndex, const u32 bit) noexcept;
+		u32 RemoveEdge(const u32 archetypeIndex, const u32 bit) noexcept;
+
+		//Moves the components the target archetype shares with the current one and destroys the rest
+		void MoveEntity(const entity entityID, const u32 targetArchetype) noexcept;
+		ArchetypeLocation AllocateRow(const u32 archetypeIndex, const entity entityID) noexcept;
+		void RemoveRow(const ArchetypeLocation& location) noexcept;
+		void DestroyAllComponents() noexcept;
+		void ValidateLocation(const entity entityID) noexcept;
+
+	private:
+		static inline std::vector<ArchetypeComponentInfo> s_componentInfos;
+		static inline std::mutex s_registrationMutex;
+
+		std::vector<Archetype> m_archetypes;
+		std::unordered_map<u64, u32> m_archetypeLookup;
+		std::unordered_map<u64, ArchetypeQueryCache> m_queryCaches;
+		std::vector<ArchetypeLocation> m_locations;
+	};
+}
+
+// Moves a component type into archetype storage. Use at global scope in the header that declares the component.
+#define DOG_ARCHETYPE_STORAGE(ComponentType) template<> struct DOG::UsesArchetypeStorage<ComponentType> : std::true_type {};
@@ -244,22 +244,6 @@ namespace DOG
 		i32 loops{ 1 };
 	};
 
-	struct DirtyComponent
-	{
-		static constexpr u8 positionChanged = 0;
-		static constexpr u8 rotationChanged = 1;
-		DirtyComponent& SetDirty(u8 index)
-		{
-			dirtyBitSet[index] = true;
-			return *this;
-		}
-		bool IsDirty(u8 index)
-		{
-			return dirtyBitSet[index];
-		}
-		std::bitset<2> dirtyBitSet;
-	};
-
 	//Is set on entities which are going to be destroyed at the end of the frame!
 	struct DeferredDeletionComponent
 	{
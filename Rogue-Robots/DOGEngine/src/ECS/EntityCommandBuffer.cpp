@@ -0,0 +1,171 @@
+#include "EntityManager.h"
+
+namespace DOG
+{
+	void* EntityCommandBuffer::Lane::Allocate(const u32 size, const u32 alignment) noexcept
+	{
+		ECS_ASSERT(size <= COMMAND_BUFFER_BLOCK_SIZE, "Component is too large to be recorded.");
+
+		u32 offset = (blockOffset + alignment - 1u) / alignment * alignment;
+		if (blocks.empty() || offset + size > COMMAND_BUFFER_BLOCK_SIZE)
+		{
+			if (!blocks.empty())
+				currentBlock++;
+			if (currentBlock == blocks.size())
+				blocks.emplace_back(new std::byte[COMMAND_BUFFER_BLOCK_SIZE]);
+			offset = 0u;
+		}
+
+		blockOffset = offset + size;
+		return blocks[currentBlock].get() + offset;
+	}
+
+	void EntityCommandBuffer::Lane::Clear() noexcept
+	{
+		//Keeps the blocks and vector capacity around for the next frame
+		componentCommands.clear();
+		destroyCommands.clear();
+		currentBlock = 0u;
+		blockOffset = 0u;
+	}
+
+	EntityCommandBuffer::EntityCommandBuffer() noexcept
+		: m_id{ s_nextBufferID.fetch_add(1u, std::memory_order_relaxed) }
+	{}
+
+	EntityCommandBuffer::~EntityCommandBuffer() noexcept
+	{
+		Clear();
+	}
+
+	entity EntityCommandBuffer::CreateEntity() noexcept
+	{
+		ECS_ASSERT(!m_playingBack, "Commands can not be recorded during playback.");
+		const u32 index = m_createCount.fetch_add(1u, std::memory_order_relaxed);
+		ECS_ASSERT(index < COMMAND_BUFFER_PLACEHOLDER_BIT, "Too many entities created in one command buffer.");
+		return COMMAND_BUFFER_PLACEHOLDER_BIT | index;
+	}
+
+	void EntityCommandBuffer::DestroyEntity(const entity entityID) noexcept
+	{
+		ECS_ASSERT(!m_playingBack, "Commands can not be recorded during playback.");
+		GetLane().destroyCommands.push_back(entityID);
+	}
+
+	void EntityCommandBuffer::Playback(EntityManager& manager) noexcept
+	{
+		ECS_ASSERT(!EntityManager::IsInParallelIteration(), "Command buffers can not be played back inside ParallelDo.");
+		ECS_ASSERT(!m_playingBack, "Command buffer is already being played back.");
+
+		std::scoped_lock lock(m_lanesMutex);
+		m_playingBack = true;
+
+		const u32 createCount = m_createCount.exchange(0u, std::memory_order_relaxed);
+		m_createdEntities.clear();
+		for (u32 i{ 0u }; i < createCount; ++i)
+			m_createdEntities.push_back(manager.CreateEntity());
+
+		//Lanes are merged in the order they were first used. The sort is stable, so one thread's commands on a pool
+		//keep their recorded order, and all commands on a pool end up next to each other in entity order.
+		m_sortedCommands.clear();
+		for (auto& lane : m_lanes)
+			m_sortedCommands.insert(m_sortedCommands.end(), lane->componentCommands.begin(), lane->componentCommands.end());
+
+		std::stable_sort(m_sortedCommands.begin(), m_sortedCommands.end(), [](const ComponentCommand& a, const ComponentCommand& b)
+			{
+				if (a.pool != b.pool)
+					return std::less<>{}(a.pool, b.pool);
+				return a.entityID < b.entityID;
+			});
+
+		for (auto& command : m_sortedCommands)
+		{
+			const entity entityID = Resolve(command.entityID);
+			if (manager.Exists(entityID))
+				command.apply(manager, entityID, command.payload);
+			if (command.destroy)
+				command.destroy(command.payload);
+		}
+
+		for (auto& lane : m_lanes)
+		{
+			for (entity destroyed : lane->destroyCommands)
+			{
+				const entity entityID = Resolve(destroyed);
+				if (manager.Exists(entityID))
+					manager.DestroyEntity(entityID);
+			}
+			lane->Clear();
+		}
+
+		m_sortedCommands.clear();
+		m_createdEntities.clear();
+		m_playingBack = false;
+	}
+
+	void EntityCommandBuffer::Clear() noexcept
+	{
+		std::scoped_lock lock(m_lanesMutex);
+		for (auto& lane : m_lanes)
+		{
+			for (auto& command : lane->componentCommands)
+			{
+				if (command.destroy)
+					command.destroy(command.payload);
+			}
+			lane->Clear();
+		}
+		m_createCount.store(0u, std::memory_order_relaxed);
+	}
+
+	bool EntityCommandBuffer::IsEmpty() noexcept
+	{
+		std::scoped_lock lock(m_lanesMutex);
+		if (m_createCount.load(std::memory_order_relaxed) != 0u)
+			return false;
+
+		for (auto& lane : m_lanes)
+		{
+			if (!lane->componentCommands.empty() || !lane->destroyCommands.empty())
+				return false;
+		}
+		return true;
+	}
+
+	EntityCommandBuffer::Lane& EntityCommandBuffer::GetLane() noexcept
+	{
+		//Buffer ids are never reused, so a stale cache entry from a destroyed buffer can not match
+		struct CachedLane
+		{
+			u64 bufferID = 0u;
+			Lane* lane = nullptr;
+		};
+		static thread_local CachedLane s_cachedLane;
+
+		if (s_cachedLane.bufferID == m_id)
+			return *s_cachedLane.lane;
+
+		std::scoped_lock lock(m_lanesMutex);
+		const auto thisThread = std::this_thread::get_id();
+		auto it = std::find_if(m_lanes.begin(), m_lanes.end(), [thisThread](const auto& lane) { return lane->owner == thisThread; });
+		if (it == m_lanes.end())
+		{
+			m_lanes.emplace_back(std::make_unique<Lane>());
+			m_lanes.back()->owner = thisThread;
+			it = m_lanes.end() - 1;
+		}
+
+		s_cachedLane = { m_id, it->get() };
+		return *s_cachedLane.lane;
+	}
+
+	entity EntityCommandBuffer::Resolve(const entity entityID) const noexcept
+	{
+		if (!IsPlaceholder(entityID))
+			return entityID;
+
+		const u32 index = entityID & ~COMMAND_BUFFER_PLACEHOLDER_BIT;
+		ECS_ASSERT(index < m_createdEntities.size(), "Placeholder entity does not belong to this playback.");
+		return m_createdEntities[index];
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "EntityTypedef.h"
+#include <StaticTypeInfo/type_index.h>
+
+namespace DOG
+{
+	class EntityManager;
+
+	constexpr const entity COMMAND_BUFFER_PLACEHOLDER_BIT = 0x8000'0000u;
+	static_assert((COMMAND_BUFFER_PLACEHOLDER_BIT & MakeEntity(ENTITY_INDEX_MASK, ENTITY_GENERATION_MASK)) == 0u, "Placeholders can not overlap entity handles.");
+	constexpr const u32 COMMAND_BUFFER_BLOCK_SIZE = 16u * 1024u;
+
+	// Records structural changes (creating/destroying entities, adding/removing components) and applies them later in one batch.
+	// Recording is allowed from any thread, every thread gets its own lane so recording never takes a lock after the first command.
+	// Playback happens on one thread at a sync point: creates first, then component commands grouped by pool, then destroys.
+	// Commands on one pool keep the order they were recorded in per thread, commands on entities that no longer exist are skipped.
+	class EntityCommandBuffer
+	{
+	public:
+		EntityCommandBuffer() noexcept;
+		~EntityCommandBuffer() noexcept;
+		DELETE_COPY_MOVE_CONSTRUCTOR(EntityCommandBuffer);
+
+		// The returned entity is a placeholder, it can only be passed back to this buffer until the next playback.
+		[[nodiscard]] entity CreateEntity() noexcept;
+		void DestroyEntity(const entity entityID) noexcept;
+
+		// Behaves like AddOrReplaceComponent at playback.
+		template<typename ComponentType, typename ...Args>
+		void AddComponent(const entity entityID, Args&& ...args) noexcept;
+
+		// Behaves like RemoveComponentIfExists at playback.
+		template<typename ComponentType>
+		void RemoveComponent(const entity entityID) noexcept;
+
+		void Playback(EntityManager& manager) noexcept;
+		void Clear() noexcept;
+		[[nodiscard]] bool IsEmpty() noexcept;
+
+		[[nodiscard]] static constexpr bool IsPlaceholder(const entity entityID) noexcept { return (entityID & COMMAND_BUFFER_PLACEHOLDER_BIT) != 0u; }
+
+	private:
+		struct ComponentCommand
+		{
+			static_type_info::TypeIndex pool = nullptr;
+			entity entityID = NULL_ENTITY;
+			void* payload = nullptr; //The component to add, nullptr for removals
+			void (*apply)(EntityManager& manager, const entity entityID, void* payload) = nullptr;
+			void (*destroy)(void* payload) = nullptr;
+		};
+
+		struct Lane
+		{
+			[[nodiscard]] void* Allocate(const u32 size, const u32 alignment) noexcept;
+			void Clear() noexcept;
+
+			std::thread::id owner;
+			std::vector<ComponentCommand> componentCommands;
+			std::vector<entity> destroyCommands;
+			//Payloads live in fixed blocks so the pointers stay valid while more commands are recorded
+			std::vector<std::unique_ptr<std::byte[]>> blocks;
+			u32 currentBlock = 0u;
+			u32 blockOffset = 0u;
+		};
+
+		[[nodiscard]] Lane& GetLane() noexcept;
+		[[nodiscard]] entity Resolve(const entity entityID) const noexcept;
+
+		template<typename ComponentType>
+		static void ApplyAdd(EntityManager& manager, const entity entityID, void* payload) noexcept;
+		template<typename ComponentType>
+		static void ApplyRemove(EntityManager& manager, const entity entityID, void* payload) noexcept;
+		template<typename ComponentType>
+		static void DestroyPayload(void* payload) noexcept;
+
+	private:
+		static inline std::atomic<u64> s_nextBufferID{ 1u };
+
+		u64 m_id;
+		std::atomic<u32> m_createCount{ 0u };
+		std::mutex m_lanesMutex;
+		//Lanes are never removed before the buffer dies, so a thread can keep using its lane pointer across playbacks
+		std::vector<std::unique_ptr<Lane>> m_lanes;
+		std::vector<entity> m_createdEntities;
+		std::vector<ComponentCommand> m_sortedCommands;
+		bool m_playingBack{ false };
+	};
+}
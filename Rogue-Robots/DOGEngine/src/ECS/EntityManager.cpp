@@ -4,6 +4,26 @@ namespace DOG
 	EntityManager EntityManager::s_instance;
 
 	constexpr const u32 INITIAL_SYSTEM_CAPACITY = 250u;
+	constexpr const u32 SNAPSHOT_MAGIC = 0x534E5344u; //"DSNS"
+	constexpr const u32 SNAPSHOT_VERSION = 2u;
+
+	struct SnapshotHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 entityCapacity;
+		u32 generationCount;
+		u32 freeCount;
+		u32 poolCount;
+	};
+
+	struct SnapshotPoolHeader
+	{
+		u64 typeHash;
+		SnapshotMode mode;
+		u32 count;
+		u64 payloadSize; //Bytes after this header, so pools unknown to the reader can be skipped
+	};
 	
 	EntityManager::EntityManager() noexcept
 	{
@@ -12,30 +32,47 @@ namespace DOG
 
 	entity EntityManager::CreateEntity() noexcept
 	{
+		ECS_ASSERT(!IsInParallelIteration(), "Entities can not be created inside ParallelDo, use Defer.");
 		VerifyEntityCapacity();
 		
 		u32 indexToInsert = m_freeList.front();
-		m_entities[indexToInsert] = indexToInsert;
 		m_freeList.pop();
 
-		ECS_DEBUG_OP([&](){m_aliveEntities.push_back(indexToInsert); });
+		//NULL_ENTITY is a valid index/generation pair as well, it must never be handed out
+		entity handle = MakeEntity(indexToInsert, m_generations[indexToInsert]);
+		if (handle == NULL_ENTITY)
+		{
+			m_generations[indexToInsert] = (m_generations[indexToInsert] + 1u) & ENTITY_GENERATION_MASK;
+			handle = MakeEntity(indexToInsert, m_generations[indexToInsert]);
+		}
+		m_entities[indexToInsert] = handle;
+
+		ECS_DEBUG_OP([&](){m_aliveEntities.push_back(handle); });
 
-		return m_entities[indexToInsert];
+		return handle;
 	}
 
 	void EntityManager::DestroyEntity(const entity entityID) noexcept
 	{
 		ECS_ASSERT(Exists(entityID), "Entity is invalid.");
+		ECS_ASSERT(!IsInParallelIteration(), "Entities can not be destroyed inside ParallelDo, use DeferredEntityDestruction.");
 
-		for (auto& [componentPoolIndex, componentPool] : m_components)
+		//Only the pools the entity is in are visited
+		const u32 index = EntityIndex(entityID);
+		u64* mask = &m_componentMasks[(size_t)index * m_componentMaskWords];
+		for (u32 word{ 0u }; word < m_componentMaskWords; ++word)
 		{
-			if (HasComponentInternal(componentPoolIndex, entityID))
+			while (mask[word])
 			{
-				DestroyComponentInternal(componentPoolIndex, entityID);
+				const u32 bit = (u32)std::countr_zero(mask[word]);
+				mask[word] &= mask[word] - 1u;
+				DestroyComponentInternal(*m_poolsByID[word * 64u + bit], entityID);
 			}
 		}
-		m_entities[entityID] = NULL_ENTITY;
-		m_freeList.push(entityID);
+		m_archetypes.DestroyEntity(entityID);
+		m_entities[index] = NULL_ENTITY;
+		m_generations[index] = (m_generations[index] + 1u) & ENTITY_GENERATION_MASK;
+		m_freeList.push(index);
 		
 		ECS_DEBUG_OP([&](){
 			for (u32 i{ 0u }; i < m_aliveEntities.size(); ++i)
@@ -51,6 +88,13 @@ namespace DOG
 
 	void EntityManager::DeferredEntityDestruction(const entity entityID) noexcept
 	{
+		//The deletion flag is a component itself, so inside ParallelDo it has to be deferred as well
+		if (IsInParallelIteration())
+		{
+			Defer([this, entityID]() { DeferredEntityDestruction(entityID); });
+			return;
+		}
+
 		//Add flag for deletion at the end of the frame
 		if (Exists(entityID) && !HasComponent<DeferredDeletionComponent>(entityID))
 			AddComponent<DeferredDeletionComponent>(entityID);
@@ -65,6 +109,14 @@ namespace DOG
 			});
 	}
 
+	void EntityManager::Defer(std::function<void()>&& operation) noexcept
+	{
+		if (s_deferredOperations)
+			s_deferredOperations->emplace_back(std::move(operation));
+		else
+			operation();
+	}
+
 	const std::vector<entity>& EntityManager::GetAllEntities() const noexcept
 	{
 		return m_entities;
@@ -72,13 +124,24 @@ namespace DOG
 
 	void EntityManager::Reset() noexcept
 	{
+		m_commandBuffer.Clear();
+
 		std::queue<entity> temp;
 		std::swap(m_freeList, temp);
 
+		//Generations survive the reset, handles from before it stay stale
+		for (auto& generation : m_generations)
+			generation = (generation + 1u) & ENTITY_GENERATION_MASK;
+
 		m_entities.clear();
 		m_components.clear();
+		m_poolsByID.clear();
+		m_componentMaskWords = 1u;
 		m_bundles.clear();
+		m_cachedQueries.clear();
+		m_archetypes.Reset();
 		m_systems.clear();
+		m_systemScheduler.Invalidate();
 		ECS_DEBUG_OP([&](){ m_aliveEntities.clear(); });
 
 		Initialize();
@@ -86,12 +149,14 @@ namespace DOG
 
 	bool EntityManager::Exists(const entity entityID) const noexcept
 	{
-		return ((entityID < m_entities.size()) && (m_entities[entityID] == entityID));
+		return (entityID != NULL_ENTITY) && (EntityIndex(entityID) < m_entities.size()) && (m_entities[EntityIndex(entityID)] == entityID);
 	}
 
 	void EntityManager::Initialize() noexcept
 	{
 		m_entities.resize(INITIAL_ENTITY_CAPACITY, NULL_ENTITY);
+		m_generations.resize(std::max<size_t>(m_generations.size(), INITIAL_ENTITY_CAPACITY), 0u);
+		m_componentMasks.assign(INITIAL_ENTITY_CAPACITY * m_componentMaskWords, 0u);
 
 		for (u32 entityId{ 0u }; entityId < INITIAL_ENTITY_CAPACITY; entityId++)
 			m_freeList.push(entityId);
@@ -106,32 +171,273 @@ namespace DOG
 		if (m_freeList.empty())
 		{
 			size_t size = m_entities.size();
+			ECS_ASSERT(size * 2 <= MAX_ENTITIES, "Out of entity indices.");
 			m_entities.resize(m_entities.size() * 2, NULL_ENTITY);
-			for (size_t entityId{ size }; entityId < m_entities.capacity(); entityId++)
+			m_generations.resize(std::max(m_generations.size(), m_entities.size()), 0u);
+			m_componentMasks.resize(m_entities.size() * m_componentMaskWords, 0u);
+			for (size_t entityId{ size }; entityId < m_entities.size(); entityId++)
 				m_freeList.push((entity)entityId);
 		}
 	}
 
-	[[nodiscard]] bool EntityManager::HasComponentInternal(const sti::TypeIndex componentPoolIndex, const entity entityID) const noexcept
+	void EntityManager::DestroyComponentInternal(SparseSetBase& pool, const entity entityID) noexcept
 	{
-		return m_components.contains(componentPoolIndex) && entityID < m_components.at(componentPoolIndex)->sparseArray.size()
-			&& (m_components.at(componentPoolIndex)->sparseArray[entityID] < m_components.at(componentPoolIndex)->denseArray.size())
-			&& (m_components.at(componentPoolIndex)->sparseArray[entityID] != NULL_ENTITY);
+		if (pool.bundle != nullptr)
+		{
+			m_bundles[pool.bundle]->UpdateOnRemove(entityID);
+		}
+
+		pool.Remove(entityID);
+
+		if (!pool.queries.empty())
+			RefreshCachedQueries(pool, entityID);
+	}
+
+	void EntityManager::AddPool(const sti::TypeIndex componentID, ComponentPool&& pool) noexcept
+	{
+		pool->poolID = (u32)m_poolsByID.size();
+		m_poolsByID.push_back(pool.get());
+		m_components[componentID] = std::move(pool);
+		if (m_poolsByID.size() > m_componentMaskWords * 64u)
+			GrowComponentMasks();
+	}
+
+	void EntityManager::GrowComponentMasks() noexcept
+	{
+		const u32 newWords = m_componentMaskWords * 2u;
+		std::vector<u64> masks(m_entities.size() * newWords, 0u);
+		for (size_t index{ 0u }; index < m_entities.size(); ++index)
+			std::copy_n(&m_componentMasks[index * m_componentMaskWords], m_componentMaskWords, &masks[index * newWords]);
+
+		m_componentMasks = std::move(masks);
+		m_componentMaskWords = newWords;
+	}
+
+	void EntityManager::RegisterCachedQuery(CachedQueryBase& query) noexcept
+	{
+		for (auto* pool : query.m_includePools)
+			pool->queries.push_back(&query);
+		for (auto* pool : query.m_excludePools)
+			pool->queries.push_back(&query);
+
+		PopulateCachedQuery(query);
+	}
+
+	void EntityManager::PopulateCachedQuery(CachedQueryBase& query) noexcept
+	{
+		for (const entity entityID : query.m_entities)
+			query.m_positions[EntityIndex(entityID)] = NULL_ENTITY;
+		query.m_entities.clear();
+
+		//Every match is in the smallest include pool
+		const auto smallest = std::min_element(query.m_includePools.begin(), query.m_includePools.end(),
+			[](const SparseSetBase* a, const SparseSetBase* b) { return a->denseArray.size() < b->denseArray.size(); });
+		for (const entity entityID : (*smallest)->denseArray)
+			query.Refresh(entityID, &m_componentMasks[(size_t)EntityIndex(entityID) * m_componentMaskWords]);
+	}
+
+	void EntityManager::RefreshCachedQueries(const SparseSetBase& pool, const entity entityID) noexcept
+	{
+		const u64* mask = &m_componentMasks[(size_t)EntityIndex(entityID) * m_componentMaskWords];
+		for (auto* query : pool.queries)
+			query->Refresh(entityID, mask);
+	}
+
+	void CachedQueryBase::Refresh(const entity entityID, const u64* mask) noexcept
+	{
+		const auto owns = [mask](const SparseSetBase* pool) { return (mask[pool->poolID / 64u] >> (pool->poolID % 64u)) & 1u; };
+		const bool matches = std::all_of(m_includePools.begin(), m_includePools.end(), owns)
+			&& std::none_of(m_excludePools.begin(), m_excludePools.end(), owns);
+
+		const u32 index = EntityIndex(entityID);
+		if (index >= m_positions.size())
+		{
+			if (!matches)
+				return;
+			m_positions.resize(std::max<size_t>(index + 1u, m_positions.size() * 2u), NULL_ENTITY);
+		}
+
+		const bool listed = m_positions[index] != NULL_ENTITY;
+		if (matches && !listed)
+		{
+			m_positions[index] = (entity)m_entities.size();
+			m_entities.push_back(entityID);
+		}
+		else if (!matches && listed)
+		{
+			const entity last = m_entities.back();
+			m_entities[m_positions[index]] = last;
+			m_positions[EntityIndex(last)] = m_positions[index];
+			m_entities.pop_back();
+			m_positions[index] = NULL_ENTITY;
+		}
+	}
+
+	void EntityManager::CaptureSnapshot(WorldSnapshot& snapshot) noexcept
+	{
+		ECS_ASSERT(!IsInParallelIteration(), "Snapshots can not be captured inside ParallelDo.");
+		snapshot.Clear();
+		SnapshotWriter writer(snapshot);
+
+		const SnapshotHeader header{ SNAPSHOT_MAGIC, SNAPSHOT_VERSION, (u32)m_entities.size(), (u32)m_generations.size(), (u32)m_freeList.size(), (u32)m_poolsByID.size() };
+		writer.Write(header);
+		writer.Write(m_entities.data(), m_entities.size() * sizeof(entity));
+		writer.Write(m_generations.data(), m_generations.size() * sizeof(u8));
+
+		//Rotating the queue once writes it in order without copying it
+		for (u32 i{ 0u }; i < header.freeCount; ++i)
+		{
+			const entity index = m_freeList.front();
+			m_freeList.pop();
+			writer.Write(index);
+			m_freeList.push(index);
+		}
+
+		for (const auto* pool : m_poolsByID)
+		{
+			SnapshotPoolHeader poolHeader{ pool->typeHash, pool->GetSnapshotMode(), (u32)pool->denseArray.size(), 0u };
+			if (poolHeader.mode == SnapshotMode::Retained)
+				poolHeader.count = 0u;
+
+			const size_t headerOffset = writer.GetOffset();
+			writer.Write(poolHeader);
+			if (poolHeader.mode == SnapshotMode::Retained)
+				continue;
+
+			writer.Write(pool->denseArray.data(), pool->denseArray.size() * sizeof(entity));
+			pool->WriteSnapshot(writer);
+			poolHeader.payloadSize = writer.GetOffset() - headerOffset - sizeof(SnapshotPoolHeader);
+			writer.Patch(headerOffset, poolHeader);
+		}
+
+		m_archetypes.WriteSnapshot(writer);
 	}
 
-	void EntityManager::DestroyComponentInternal(const sti::TypeIndex componentPoolIndex, const entity entityID) noexcept
+	void EntityManager::RestoreSnapshot(const WorldSnapshot& snapshot) noexcept
 	{
-		if (m_components.at(componentPoolIndex)->bundle != nullptr)
+		ECS_ASSERT(!IsInParallelIteration(), "Snapshots can not be restored inside ParallelDo.");
+		SnapshotReader reader(snapshot);
+		const auto header = reader.Read<SnapshotHeader>();
+		ECS_ASSERT(header.magic == SNAPSHOT_MAGIC && header.version == SNAPSHOT_VERSION, "Snapshot is not compatible with this build.");
+
+		m_commandBuffer.Clear();
+
+		//Entities
+		std::swap(m_entities, m_previousEntities);
+		m_entities.resize(header.entityCapacity);
+		reader.Read(m_entities.data(), m_entities.size() * sizeof(entity));
+		m_generations.resize(std::max<size_t>(header.generationCount, m_entities.size()), 0u);
+		reader.Read(m_generations.data(), header.generationCount * sizeof(u8));
+
+		std::queue<entity> freeList;
+		std::swap(m_freeList, freeList);
+		for (u32 i{ 0u }; i < header.freeCount; ++i)
+			m_freeList.push(reader.Read<entity>());
+
+		//Entities that did not survive the restore lose their archetype components, the captured ones are read after the pools
+		for (const entity entityID : m_previousEntities)
 		{
-			m_bundles[m_components.at(componentPoolIndex)->bundle]->UpdateOnRemove(entityID);
+			if (entityID != NULL_ENTITY && !Exists(entityID))
+				m_archetypes.DestroyEntity(entityID);
 		}
 
-		const auto last = m_components.at(componentPoolIndex)->denseArray.back();
-		std::swap(m_components.at(componentPoolIndex)->denseArray.back(), m_components.at(componentPoolIndex)->denseArray[m_components.at(componentPoolIndex)->sparseArray[entityID]]);
-		m_components.at(componentPoolIndex)->DestroyInternal(entityID);
-		std::swap(m_components.at(componentPoolIndex)->sparseArray[last], m_components.at(componentPoolIndex)->sparseArray[entityID]);
-		m_components.at(componentPoolIndex)->denseArray.pop_back();
-		m_components.at(componentPoolIndex)->sparseArray[entityID] = NULL_ENTITY;
+		//Pools
+		std::vector<u8> restored(m_poolsByID.size(), 0u);
+		for (u32 i{ 0u }; i < header.poolCount; ++i)
+		{
+			const auto poolHeader = reader.Read<SnapshotPoolHeader>();
+			if (poolHeader.mode == SnapshotMode::Retained)
+				continue;
+
+			auto pool = std::find_if(m_poolsByID.begin(), m_poolsByID.end(), [&](const SparseSetBase* candidate) { return candidate->typeHash == poolHeader.typeHash; });
+			if (pool == m_poolsByID.end())
+			{
+				const auto factory = s_poolFactories.find(poolHeader.typeHash);
+				ECS_ASSERT(factory != s_poolFactories.end(), "Snapshot contains a component type this program has never used.");
+				if (factory == s_poolFactories.end())
+				{
+					reader.Skip(poolHeader.payloadSize);
+					continue;
+				}
+
+				AddPool(factory->second.componentID, factory->second.create());
+				restored.push_back(0u);
+				pool = m_poolsByID.end() - 1;
+			}
+
+			SparseSetBase& set = **pool;
+			ECS_ASSERT(set.GetSnapshotMode() == poolHeader.mode, "Component changed how it is serialized since the snapshot was captured.");
+			if (set.GetSnapshotMode() != poolHeader.mode)
+			{
+				reader.Skip(poolHeader.payloadSize);
+				continue;
+			}
+
+			for (const entity entityID : set.denseArray)
+				set.sparseArray[EntityIndex(entityID)] = NULL_ENTITY;
+			if (set.sparseArray.size() < m_entities.size())
+				set.Reserve((u32)m_entities.size());
+
+			set.denseArray.resize(poolHeader.count);
+			reader.Read(set.denseArray.data(), set.denseArray.size() * sizeof(entity));
+			set.ReadSnapshot(reader, poolHeader.count);
+			for (u32 denseIndex{ 0u }; denseIndex < poolHeader.count; ++denseIndex)
+			{
+				set.sparseArray[EntityIndex(set.denseArray[denseIndex])] = denseIndex;
+				set.StampAdded(set.denseArray[denseIndex], m_changeTick);
+			}
+			restored[set.poolID] = 1u;
+		}
+
+		m_archetypes.ReadSnapshot(reader);
+
+		//Pools that were empty when the snapshot was taken are cleared, retained pools only lose components of entities that are gone
+		for (auto* pool : m_poolsByID)
+		{
+			if (restored[pool->poolID])
+				continue;
+
+			if (pool->GetSnapshotMode() == SnapshotMode::Retained)
+			{
+				for (size_t i{ pool->denseArray.size() }; i > 0u; --i)
+				{
+					if (!Exists(pool->denseArray[i - 1u]))
+						pool->Remove(pool->denseArray[i - 1u]);
+				}
+			}
+			else
+			{
+				for (const entity entityID : pool->denseArray)
+					pool->sparseArray[EntityIndex(entityID)] = NULL_ENTITY;
+				pool->denseArray.clear();
+				pool->ClearComponents();
+			}
+		}
+
+		//Everything derived from the pools is rebuilt
+		m_componentMasks.assign(m_entities.size() * m_componentMaskWords, 0u);
+		for (const auto* pool : m_poolsByID)
+		{
+			for (const entity entityID : pool->denseArray)
+				m_componentMasks[(size_t)EntityIndex(entityID) * m_componentMaskWords + pool->poolID / 64u] |= 1ull << (pool->poolID % 64u);
+		}
+
+		for (auto& [id, bundle] : m_bundles)
+		{
+			if (bundle)
+				bundle->Regroup();
+		}
+
+		for (auto& [id, query] : m_cachedQueries)
+			PopulateCachedQuery(*query);
+
+		ECS_DEBUG_OP([&]() {
+			m_aliveEntities.clear();
+			for (const entity entityID : m_entities)
+			{
+				if (entityID != NULL_ENTITY)
+					m_aliveEntities.push_back(entityID);
+			}});
 	}
 
 	void EntityManager::RegisterSystem(std::unique_ptr<ISystem>&& pSystem) noexcept
@@ -139,5 +445,15 @@ namespace DOG
 		ECS_DEBUG_OP([&]() { for (auto& system : m_systems) ECS_ASSERT(typeid(*system) != typeid(*pSystem), "System already exists."); })
 		pSystem->Create();
 		m_systems.emplace_back(std::move(pSystem));
+		m_systemScheduler.Invalidate();
+	}
+
+	void EntityManager::RunSystems(const SystemPhase phase) noexcept
+	{
+		if (!m_systemScheduler.IsBuilt())
+		{
+			m_systemScheduler.Build(m_systems);
+		}
+		m_systemScheduler.Run(phase);
 	}
 }
\ No newline at end of file
@@ -1,9 +1,15 @@
 #pragma once
 #include "Component.h"
 #include "System.h"
+#include "SystemScheduler.h"
+#include "ArchetypeStorage.h"
+#include "EntityCommandBuffer.h"
+#include "WorldSnapshot.h"
+#include "../Core/JobSystem.h"
 #include <StaticTypeInfo/type_id.h>
 #include <StaticTypeInfo/type_index.h>
 #include <StaticTypeInfo/type_name.h>
+#include <StaticTypeInfo/hash.h>
 #define set(ID) (static_cast<SparseSet<ComponentType>*>(m_components.at(ID).get()))
 
 #if defined RELWITHDEBUGINFO
@@ -50,6 +56,37 @@ namespace DOG
 	template<typename... ComponentType>
 	class BundleImpl;
 
+	template<typename... ComponentType>
+	class ArchetypeQuery;
+
+	class CachedQueryBase;
+	template<typename IncludeList, typename ExcludeList, typename OptionalList>
+	class CachedQueryImpl;
+
+	// Component lists for EntityManager::CachedQuery. Entities need every Include and no Exclude component,
+	// Optional components are handed to the function as pointers that are nullptr when the entity lacks them.
+	// Changed/Added skip entities unless one of the listed components was changed/added since the query's previous Do.
+	template<typename... ComponentType>
+	struct Include {};
+
+	template<typename... ComponentType>
+	struct Exclude {};
+
+	template<typename... ComponentType>
+	struct Optional {};
+
+	template<typename... ComponentType>
+	struct Changed {};
+
+	template<typename... ComponentType>
+	struct Added {};
+
+	template<typename Query, typename... QueryList>
+	struct MergeQueryLists { using Type = Query; };
+
+	template<typename... QueryList>
+	using CachedQueryType = typename MergeQueryLists<CachedQueryImpl<Include<>, Exclude<>, Optional<>>, QueryList...>::Type;
+
 	typedef std::unique_ptr<SparseSetBase> ComponentPool;
 
 	//##################### SPARSE SET #####################
@@ -59,19 +96,77 @@ namespace DOG
 		SparseSetBase() noexcept = default;
 		virtual ~SparseSetBase() noexcept = default;
 		virtual void DestroyInternal(const entity entityID) noexcept = 0;
+
+		// Type erased access for world snapshots, components are written and read in dense order
+		[[nodiscard]] virtual SnapshotMode GetSnapshotMode() const noexcept = 0;
+		virtual void WriteSnapshot(SnapshotWriter& writer) const noexcept = 0;
+		virtual void ReadSnapshot(SnapshotReader& reader, const u32 count) noexcept = 0;
+		virtual void ClearComponents() noexcept = 0;
+
 		void Reserve(const uint32_t newCapacity) noexcept
 		{
 			sparseArray.resize(newCapacity, NULL_ENTITY);
+			addedTicks.resize(newCapacity, 0u);
+			changedTicks.resize(newCapacity, 0u);
 		}
 
 #if defined _DEBUG | defined RELWITHDEBUGINFO
 		virtual std::pair<std::vector<entity>&, std::string_view> ReportUsage() noexcept = 0;
 #endif
+		//The dense entry holds the whole handle, so a stale handle to a recycled slot is not contained
+		[[nodiscard]] bool Contains(const entity entityID) const noexcept
+		{
+			return EntityIndex(entityID) < sparseArray.size()
+				&& sparseArray[EntityIndex(entityID)] < denseArray.size()
+				&& denseArray[sparseArray[EntityIndex(entityID)]] == entityID;
+		}
+
+		void StampAdded(const entity entityID, const u32 tick) noexcept
+		{
+			addedTicks[EntityIndex(entityID)] = tick;
+			changedTicks[EntityIndex(entityID)] = tick;
+		}
+
+		//Swap and pop, bundles and cached queries are left to the caller
+		void Remove(const entity entityID) noexcept
+		{
+			const auto last = denseArray.back();
+			std::swap(denseArray.back(), denseArray[sparseArray[EntityIndex(entityID)]]);
+			DestroyInternal(entityID);
+			std::swap(sparseArray[EntityIndex(last)], sparseArray[EntityIndex(entityID)]);
+			denseArray.pop_back();
+			sparseArray[EntityIndex(entityID)] = NULL_ENTITY;
+		}
+
 		std::vector<entity> sparseArray;
 		std::vector<entity> denseArray;
+		//Change ticks per entity slot (not per dense index, so removals and bundle swaps never have to move them)
+		std::vector<u32> addedTicks;
+		std::vector<u32> changedTicks;
 		sti::TypeIndex bundle = nullptr;
+		u32 poolID = 0u; //Bit in the per-entity component masks
+		u64 typeHash = 0u; //Hash of the component type name, identifies the pool in snapshots
+		std::vector<CachedQueryBase*> queries; //Cached queries that include or exclude this pool
 	};
 
+	// Stands in for the component vector of empty (tag) components. There is nothing to store, so every
+	// entity in the pool shares one instance and adding, removing or swapping a tag never touches memory.
+	template<typename ComponentType>
+	struct TagStorage
+	{
+		void emplace_back(ComponentType&&) noexcept {}
+		void pop_back() noexcept {}
+		void reserve(const size_t) noexcept {}
+		void clear() noexcept {}
+		[[nodiscard]] ComponentType& back() noexcept { return s_instance; }
+		[[nodiscard]] ComponentType& operator[](const size_t) noexcept { return s_instance; }
+
+		static inline ComponentType s_instance{};
+	};
+
+	template<typename ComponentType>
+	using ComponentStorage = std::conditional_t<std::is_empty_v<ComponentType>, TagStorage<ComponentType>, std::vector<ComponentType>>;
+
 	template<typename ComponentType>
 	struct SparseSet : public SparseSetBase
 	{
@@ -86,7 +181,14 @@ namespace DOG
 			return { denseArray, finalString };
 		}
 #endif
-		std::vector<ComponentType> components;
+		[[nodiscard]] ComponentType& Get(const entity entityID) noexcept { return components[sparseArray[EntityIndex(entityID)]]; }
+
+		[[nodiscard]] virtual SnapshotMode GetSnapshotMode() const noexcept override final { return ComponentSnapshotMode<ComponentType>(); }
+		virtual void WriteSnapshot(SnapshotWriter& writer) const noexcept override final;
+		virtual void ReadSnapshot(SnapshotReader& reader, const u32 count) noexcept override final;
+		virtual void ClearComponents() noexcept override final { components.clear(); }
+
+		ComponentStorage<ComponentType> components;
 	private:
 		virtual void DestroyInternal(const entity entityID) noexcept override final;
 	};
@@ -94,10 +196,44 @@ namespace DOG
 	template<typename ComponentType>
 	void SparseSet<ComponentType>::DestroyInternal(const entity entityID) noexcept
 	{
-		std::swap(components.back(), components[sparseArray[entityID]]);
+		std::swap(components.back(), components[sparseArray[EntityIndex(entityID)]]);
 		components.pop_back();
 	}
 
+	template<typename ComponentType>
+	void SparseSet<ComponentType>::WriteSnapshot(SnapshotWriter& writer) const noexcept
+	{
+		constexpr SnapshotMode mode = ComponentSnapshotMode<ComponentType>();
+		if constexpr (mode == SnapshotMode::Memcpy)
+		{
+			writer.Write(components.data(), components.size() * sizeof(ComponentType));
+		}
+		else if constexpr (mode == SnapshotMode::Custom)
+		{
+			for (const auto& component : components)
+				SnapshotSerializer<ComponentType>::Write(writer, component);
+		}
+	}
+
+	template<typename ComponentType>
+	void SparseSet<ComponentType>::ReadSnapshot(SnapshotReader& reader, const u32 count) noexcept
+	{
+		constexpr SnapshotMode mode = ComponentSnapshotMode<ComponentType>();
+		if constexpr (mode == SnapshotMode::Memcpy)
+		{
+			//Reuses the capacity the pool already has
+			components.resize(count);
+			reader.Read(components.data(), (size_t)count * sizeof(ComponentType));
+		}
+		else if constexpr (mode == SnapshotMode::Custom)
+		{
+			components.clear();
+			components.reserve(count);
+			for (u32 i{ 0u }; i < count; ++i)
+				components.emplace_back(SnapshotSerializer<ComponentType>::Read(reader));
+		}
+	}
+
 	//##################### ENTITY MANAGER #####################
 
 	class EntityManager
@@ -109,9 +245,33 @@ namespace DOG
 		void DestroyEntity(const entity entityID) noexcept;
 		void DeferredEntityDestruction(const entity entityID) noexcept;
 		void DestroyDeferredEntities() noexcept;
+
+		// Structural changes (adding/removing components, creating/destroying entities) are not allowed inside ParallelDo.
+		// Deferred operations run on the thread that called ParallelDo once every chunk is done, in chunk order.
+		// Outside of ParallelDo they run immediately.
+		void Defer(std::function<void()>&& operation) noexcept;
+
+		template<typename ComponentType, typename ...Args>
+		void DeferredAddOrReplaceComponent(const entity entityID, Args&& ...args) noexcept;
+
+		template<typename ComponentType>
+		void DeferredRemoveComponentIfExists(const entity entityID) noexcept;
+
+		[[nodiscard]] static bool IsInParallelIteration() noexcept { return s_deferredOperations != nullptr; }
+
+		// Shared buffer for structural changes that can wait until the next sync point. RunSystems plays it back around every phase
+		// and after every system that runs alone on the main thread, so later systems still see the changes in the same frame.
+		[[nodiscard]] EntityCommandBuffer& GetCommandBuffer() noexcept { return m_commandBuffer; }
+		void PlaybackCommandBuffer() noexcept { m_commandBuffer.Playback(*this); }
+
+		// Splits [0, count) into chunks of a multiple of alignment (one cache line of dense entities by default) and runs them on the JobSystem.
+		// func(begin, end) is called once per chunk.
+		template<typename ChunkFunction>
+		void ParallelForChunks(const u32 count, ChunkFunction&& func, const u32 alignment = PARALLEL_CHUNK_ALIGNMENT, const u32 minChunkSize = MIN_PARALLEL_CHUNK_SIZE) noexcept;
+
 		[[nodiscard]] const std::vector<entity>& GetAllEntities() const noexcept;
 		//[[nodiscard]] u32 GetNrOfEntities() const noexcept { return MAX_ENTITIES - (u32)m_freeList.size(); }
-		[[nodiscard]] u32 GetNrOfEntities() const noexcept { return (u32)m_entities.capacity() - (u32)m_freeList.size(); }
+		[[nodiscard]] u32 GetNrOfEntities() const noexcept { return (u32)m_entities.size() - (u32)m_freeList.size(); }
 		void Reset() noexcept;
 		[[nodiscard]] bool Exists(const entity entityID) const noexcept;
 		[[nodiscard]] const std::unordered_map<sti::TypeIndex, ComponentPool>& GetAllComponentPools() const noexcept { return m_components; }
@@ -134,9 +294,23 @@ namespace DOG
 		template<typename ComponentType>
 		[[nodiscard]] ComponentType& GetComponent(const entity entityID) const noexcept;
 
+		// Stale handles are allowed here and in HasComponent, they never see the component of the entity that reused their slot.
 		template<typename ComponentType>
 		[[nodiscard]] std::optional<std::reference_wrapper<ComponentType>> TryGetComponent(const entity entityID) const noexcept;
 
+		// Change tracking for SparseSet components. Adding or replacing a component stamps it with the current change tick,
+		// writes through references are invisible to the ECS and have to be reported with MarkChanged.
+		template<typename ComponentType>
+		void MarkChanged(const entity entityID) noexcept;
+
+		template<typename ComponentType>
+		[[nodiscard]] bool WasChanged(const entity entityID, const u32 sinceTick) const noexcept;
+
+		template<typename ComponentType>
+		[[nodiscard]] bool WasAdded(const entity entityID, const u32 sinceTick) const noexcept;
+
+		[[nodiscard]] u32 GetChangeTick() const noexcept { return m_changeTick; }
+
 		template<typename... ComponentType>
 		[[nodiscard]] Collection<ComponentType...> Collect() noexcept;
 
@@ -152,7 +326,31 @@ namespace DOG
 		template<typename... ComponentType>
 		[[nodiscard]] BundleImpl<ComponentType...>& Bundle() noexcept;
 
+		// Linear scan over the archetypes holding every listed component, all of them have to use archetype storage.
+		template<typename... ComponentType>
+		[[nodiscard]] ArchetypeQuery<ComponentType...> Query() noexcept;
+
+		// Persistent query over SparseSet components, e.g. CachedQuery<Include<A, B>, Exclude<C>, Optional<D>>().
+		// The matching entities are kept in a list that is only touched when a component in Include/Exclude is added or removed.
+		// Changed<...>/Added<...> filter that list against the change ticks while iterating.
+		// Created on first use and owned by the EntityManager until Reset, create it outside of ParallelDo and parallel systems.
+		template<typename... QueryList>
+		[[nodiscard]] CachedQueryType<QueryList...>& CachedQuery() noexcept;
+
+		// Copies every entity and every SparseSet pool into one contiguous buffer. Trivially copyable components are copied
+		// byte for byte, other components need a SnapshotSerializer or they are left out (see SnapshotMode::Retained).
+		// Archetype components are captured when they are trivially copyable. Systems and the command buffer are not part of the snapshot.
+		void CaptureSnapshot(WorldSnapshot& snapshot) noexcept;
+
+		// Puts the entities and pools back the way they were captured, entity handles included, so handles stored inside
+		// components stay valid. Pending command buffer operations are dropped and every restored component counts as added
+		// at the current change tick. Pool memory is reused, so restoring into the same world repeatedly barely allocates.
+		void RestoreSnapshot(const WorldSnapshot& snapshot) noexcept;
+
 		void RegisterSystem(std::unique_ptr<ISystem>&& pSystem) noexcept;
+		void RunSystems(const SystemPhase phase) noexcept;
+		void SetParallelSystemExecution(const bool enabled) noexcept { m_systemScheduler.SetParallel(enabled); }
+		[[nodiscard]] bool IsParallelSystemExecutionEnabled() const noexcept { return m_systemScheduler.IsParallel(); }
 
 		[[nodiscard]] constexpr const std::vector<std::unique_ptr<ISystem>>::const_iterator begin() const { return m_systems.begin(); }
 		[[nodiscard]] constexpr const std::vector<std::unique_ptr<ISystem>>::const_iterator end() const { return m_systems.end(); }
@@ -167,8 +365,7 @@ namespace DOG
 
 		void Initialize() noexcept;
 
-		[[nodiscard]] bool HasComponentInternal(const sti::TypeIndex componentPoolIndex, const entity entityID) const noexcept;
-		void DestroyComponentInternal(const sti::TypeIndex componentPoolIndex, const entity entityID) noexcept;
+		void DestroyComponentInternal(SparseSetBase& pool, const entity entityID) noexcept;
 
 		void VerifyEntityCapacity() noexcept;
 
@@ -180,6 +377,20 @@ namespace DOG
 
 		template<typename ComponentType> 
 		void AddSparseSet() noexcept;
+
+		template<typename ComponentType>
+		[[nodiscard]] static ComponentPool CreateSparseSet() noexcept;
+		void AddPool(const sti::TypeIndex componentID, ComponentPool&& pool) noexcept;
+
+		void SetComponentBit(const u32 poolID, const entity entityID, const bool owned) noexcept;
+		void GrowComponentMasks() noexcept;
+
+		void RegisterCachedQuery(CachedQueryBase& query) noexcept;
+		void PopulateCachedQuery(CachedQueryBase& query) noexcept;
+		void RefreshCachedQueries(const SparseSetBase& pool, const entity entityID) noexcept;
+
+		template<typename Function>
+		void DeferStructuralChanges(Function&& func) noexcept;
 	public:
 		template<typename ComponentType>
 		SparseSet<ComponentType>* ExpandAsTupleArguments() noexcept;
@@ -188,27 +399,139 @@ namespace DOG
 		friend class Collection;
 		template<typename... ComponentType>
 		friend class BundleImpl;
+		template<typename... ComponentType>
+		friend class ArchetypeQuery;
+		template<typename IncludeList, typename ExcludeList, typename OptionalList>
+		friend class CachedQueryImpl;
 		friend class ISystem;
 
 		static EntityManager s_instance;
 		std::vector<entity> m_entities;
+		std::vector<u8> m_generations;
 		std::queue<entity> m_freeList;
 		std::unordered_map<sti::TypeIndex ,ComponentPool> m_components;
+		//One bit per SparseSet pool for every entity slot, so destroying an entity only visits the pools it is in
+		std::vector<SparseSetBase*> m_poolsByID;
+		std::vector<u64> m_componentMasks;
+		u32 m_componentMaskWords{ 1u };
 		std::unordered_map<sti::TypeIndex, std::unique_ptr<BundleBase>> m_bundles;
+		std::unordered_map<sti::TypeIndex, std::unique_ptr<CachedQueryBase>> m_cachedQueries;
+		ArchetypeStorage m_archetypes;
 		std::vector<std::unique_ptr<ISystem>> m_systems;
+		SystemScheduler m_systemScheduler;
+		EntityCommandBuffer m_commandBuffer;
+		u32 m_changeTick{ 1u };
+		std::vector<entity> m_previousEntities; //Scratch for RestoreSnapshot
+
+		//Every component type that has had a pool, so a snapshot can recreate pools that do not exist (anymore)
+		struct PoolFactory
+		{
+			sti::TypeIndex componentID;
+			ComponentPool(*create)() noexcept;
+		};
+		static inline std::unordered_map<u64, PoolFactory> s_poolFactories;
+		static inline thread_local std::vector<std::function<void()>>* s_deferredOperations = nullptr;
 	
 		ECS_DEBUG_EXPR(std::vector<entity> m_aliveEntities;);
 	};
 
+	template<typename ComponentType, typename ...Args>
+	void EntityManager::DeferredAddOrReplaceComponent(const entity entityID, Args&& ...args) noexcept
+	{
+		Defer([this, entityID, component = ComponentType(std::forward<Args>(args)...)]() mutable
+			{
+				if (Exists(entityID))
+					AddOrReplaceComponent<ComponentType>(entityID, std::move(component));
+			});
+	}
+
+	template<typename ComponentType>
+	void EntityManager::DeferredRemoveComponentIfExists(const entity entityID) noexcept
+	{
+		Defer([this, entityID]()
+			{
+				if (Exists(entityID))
+					RemoveComponentIfExists<ComponentType>(entityID);
+			});
+	}
+
+	template<typename ChunkFunction>
+	void EntityManager::ParallelForChunks(const u32 count, ChunkFunction&& func, const u32 alignment, const u32 minChunkSize) noexcept
+	{
+		if (count == 0u)
+			return;
+
+		// Roughly four chunks per thread for load balancing, never smaller than minChunkSize
+		const u32 threadCount = JobSystem::GetWorkerCount() + 1u;
+		u32 chunkSize = count / (threadCount * 4u);
+		chunkSize = (chunkSize + alignment - 1u) / alignment * alignment;
+		chunkSize = std::max(chunkSize, minChunkSize);
+
+		std::vector<std::vector<std::function<void()>>> deferredPerChunk((count + chunkSize - 1u) / chunkSize);
+		JobSystem::Dispatch(count, chunkSize, [&](u32 begin, u32 end)
+			{
+				auto* outerOperations = s_deferredOperations;
+				s_deferredOperations = &deferredPerChunk[begin / chunkSize];
+				func(begin, end);
+				s_deferredOperations = outerOperations;
+			});
+
+		// A nested ParallelDo hands its operations on to the enclosing chunk instead of running them on a worker
+		for (auto& operations : deferredPerChunk)
+		{
+			for (auto& operation : operations)
+				Defer(std::move(operation));
+		}
+	}
+
 	template<typename ComponentType>
 	SparseSet<ComponentType>* EntityManager::ExpandAsTupleArguments() noexcept
 	{
+		static_assert(!IsArchetypeComponent<ComponentType>, "Archetype components have no SparseSet, use Query.");
 		static constexpr auto componentID = sti::getTypeIndex<ComponentType>();
 		ValidateComponentPool<ComponentType>();
 		
 		return static_cast<SparseSet<ComponentType>*>(m_components.at(componentID).get());
 	}
 
+	template<typename Function>
+	void EntityManager::DeferStructuralChanges(Function&& func) noexcept
+	{
+		std::vector<std::function<void()>> operations;
+		auto* outerOperations = s_deferredOperations;
+		s_deferredOperations = &operations;
+		func();
+		s_deferredOperations = outerOperations;
+
+		for (auto& operation : operations)
+			Defer(std::move(operation));
+	}
+
+	template<typename... ComponentType>
+	ArchetypeQuery<ComponentType...> EntityManager::Query() noexcept
+	{
+		static_assert((IsArchetypeComponent<ComponentType> && ...), "Query only works on archetype components, use Collect.");
+		static const u64 signature = ((1ull << ArchetypeStorage::ComponentBit<ComponentType>()) | ...);
+		return ArchetypeQuery<ComponentType...>(this, &m_archetypes.GetQueryCache(signature));
+	}
+
+	template<typename... QueryList>
+	CachedQueryType<QueryList...>& EntityManager::CachedQuery() noexcept
+	{
+		using QueryType = CachedQueryType<QueryList...>;
+		//Queries that only differ in their Changed/Added filters share a type, so the key is the full list
+		static constexpr auto queryID = sti::getTypeIndex<std::tuple<QueryList...>>();
+
+		auto& query = m_cachedQueries[queryID];
+		if (query == nullptr)
+		{
+			ECS_ASSERT(!IsInParallelIteration(), "Cached queries can not be created inside ParallelDo.");
+			query = std::unique_ptr<CachedQueryBase>(new QueryType(this, QueryList{}...));
+			RegisterCachedQuery(*query);
+		}
+		return *static_cast<QueryType*>(query.get());
+	}
+
 	template<typename... ComponentType>
 	BundleImpl<ComponentType...>& EntityManager::Bundle() noexcept
 	{
@@ -234,24 +557,34 @@ namespace DOG
 
 		ECS_ASSERT(Exists(entityID), "Entity is invalid");
 		ECS_ASSERT(!HasComponent<ComponentType>(entityID), "Entity already has component!");
+		ECS_ASSERT(!IsInParallelIteration(), "Components can not be added while iterating in parallel or over a Query, use Defer.");
 
-		ValidateComponentPool<ComponentType>();
-		ValidateSparseArray<ComponentType>(entityID);
+		if constexpr (IsArchetypeComponent<ComponentType>)
+		{
+			return m_archetypes.Add<ComponentType>(entityID, std::forward<Args>(args)...);
+		}
+		else
+		{
+			ValidateComponentPool<ComponentType>();
+			ValidateSparseArray<ComponentType>(entityID);
 
-		const size_t position = set(ComponentID)->denseArray.size();
-		set(ComponentID)->denseArray.emplace_back(entityID);
-		set(ComponentID)->components.emplace_back(ComponentType(std::forward<Args>(args)...));
-		set(ComponentID)->sparseArray[entityID] = static_cast<entity>(position);
+			const size_t position = set(ComponentID)->denseArray.size();
+			set(ComponentID)->denseArray.emplace_back(entityID);
+			set(ComponentID)->components.emplace_back(ComponentType(std::forward<Args>(args)...));
+			set(ComponentID)->sparseArray[EntityIndex(entityID)] = static_cast<entity>(position);
+			set(ComponentID)->StampAdded(entityID, m_changeTick);
+			SetComponentBit(set(ComponentID)->poolID, entityID, true);
 
-		if (set(ComponentID)->bundle != nullptr)
-		{
-			auto componentIdx = m_bundles[set(ComponentID)->bundle]->UpdateOnAdd(entityID);
-			if (componentIdx)
+			if (set(ComponentID)->bundle != nullptr)
 			{
-				return set(ComponentID)->components[*componentIdx];
+				auto componentIdx = m_bundles[set(ComponentID)->bundle]->UpdateOnAdd(entityID);
+				if (componentIdx)
+				{
+					return set(ComponentID)->components[*componentIdx];
+				}
 			}
+			return set(ComponentID)->components.back();
 		}
-		return set(ComponentID)->components.back();
 	}
 
 	template<typename ComponentType, typename ...Args>
@@ -260,28 +593,39 @@ namespace DOG
 		static constexpr auto ComponentID = sti::getTypeIndex<ComponentType>();
 
 		ECS_ASSERT(Exists(entityID), "Entity is invalid");
-		if (HasComponent<ComponentType>(entityID))
+		if constexpr (IsArchetypeComponent<ComponentType>)
 		{
-			return set(ComponentID)->components[set(ComponentID)->sparseArray[entityID]];
+			if (!m_archetypes.Has<ComponentType>(entityID))
+				return AddComponent<ComponentType>(entityID, std::forward<Args>(args)...);
+			return m_archetypes.Get<ComponentType>(entityID);
 		}
+		else
+		{
+			if (HasComponent<ComponentType>(entityID))
+			{
+				return set(ComponentID)->components[set(ComponentID)->sparseArray[EntityIndex(entityID)]];
+			}
 
-		ValidateComponentPool<ComponentType>();
-		ValidateSparseArray<ComponentType>(entityID);
+			ValidateComponentPool<ComponentType>();
+			ValidateSparseArray<ComponentType>(entityID);
 
-		const size_t position = set(ComponentID)->denseArray.size();
-		set(ComponentID)->denseArray.emplace_back(entityID);
-		set(ComponentID)->components.emplace_back(ComponentType(std::forward<Args>(args)...));
-		set(ComponentID)->sparseArray[entityID] = static_cast<entity>(position);
+			const size_t position = set(ComponentID)->denseArray.size();
+			set(ComponentID)->denseArray.emplace_back(entityID);
+			set(ComponentID)->components.emplace_back(ComponentType(std::forward<Args>(args)...));
+			set(ComponentID)->sparseArray[EntityIndex(entityID)] = static_cast<entity>(position);
+			set(ComponentID)->StampAdded(entityID, m_changeTick);
+			SetComponentBit(set(ComponentID)->poolID, entityID, true);
 
-		if (set(ComponentID)->bundle != nullptr)
-		{
-			auto componentIdx = m_bundles[set(ComponentID)->bundle]->UpdateOnAdd(entityID);
-			if (componentIdx)
+			if (set(ComponentID)->bundle != nullptr)
 			{
-				return set(ComponentID)->components[*componentIdx];
+				auto componentIdx = m_bundles[set(ComponentID)->bundle]->UpdateOnAdd(entityID);
+				if (componentIdx)
+				{
+					return set(ComponentID)->components[*componentIdx];
+				}
 			}
+			return set(ComponentID)->components.back();
 		}
-		return set(ComponentID)->components.back();
 	}
 
 	template<typename ComponentType, typename ...Args>
@@ -290,29 +634,41 @@ namespace DOG
 		static constexpr auto ComponentID = sti::getTypeIndex<ComponentType>();
 
 		ECS_ASSERT(Exists(entityID), "Entity is invalid");
-		if (HasComponent<ComponentType>(entityID))
+		if constexpr (IsArchetypeComponent<ComponentType>)
 		{
-			set(ComponentID)->components[set(ComponentID)->sparseArray[entityID]] = ComponentType(std::forward<Args>(args)...);
-			return set(ComponentID)->components[set(ComponentID)->sparseArray[entityID]];
+			if (!m_archetypes.Has<ComponentType>(entityID))
+				return AddComponent<ComponentType>(entityID, std::forward<Args>(args)...);
+			return m_archetypes.Get<ComponentType>(entityID) = ComponentType(std::forward<Args>(args)...);
 		}
+		else
+		{
+			if (HasComponent<ComponentType>(entityID))
+			{
+				set(ComponentID)->components[set(ComponentID)->sparseArray[EntityIndex(entityID)]] = ComponentType(std::forward<Args>(args)...);
+				set(ComponentID)->changedTicks[EntityIndex(entityID)] = m_changeTick;
+				return set(ComponentID)->components[set(ComponentID)->sparseArray[EntityIndex(entityID)]];
+			}
 
-		ValidateComponentPool<ComponentType>();
-		ValidateSparseArray<ComponentType>(entityID);
+			ValidateComponentPool<ComponentType>();
+			ValidateSparseArray<ComponentType>(entityID);
 
-		const size_t position = set(ComponentID)->denseArray.size();
-		set(ComponentID)->denseArray.emplace_back(entityID);
-		set(ComponentID)->components.emplace_back(ComponentType(std::forward<Args>(args)...));
-		set(ComponentID)->sparseArray[entityID] = static_cast<entity>(position);
+			const size_t position = set(ComponentID)->denseArray.size();
+			set(ComponentID)->denseArray.emplace_back(entityID);
+			set(ComponentID)->components.emplace_back(ComponentType(std::forward<Args>(args)...));
+			set(ComponentID)->sparseArray[EntityIndex(entityID)] = static_cast<entity>(position);
+			set(ComponentID)->StampAdded(entityID, m_changeTick);
+			SetComponentBit(set(ComponentID)->poolID, entityID, true);
 
-		if (set(ComponentID)->bundle != nullptr)
-		{
-			auto componentIdx = m_bundles[set(ComponentID)->bundle]->UpdateOnAdd(entityID);
-			if (componentIdx)
+			if (set(ComponentID)->bundle != nullptr)
 			{
-				return set(ComponentID)->components[*componentIdx];
+				auto componentIdx = m_bundles[set(ComponentID)->bundle]->UpdateOnAdd(entityID);
+				if (componentIdx)
+				{
+					return set(ComponentID)->components[*componentIdx];
+				}
 			}
+			return set(ComponentID)->components.back();
 		}
-		return set(ComponentID)->components.back();
 	}
 
 	template<typename ComponentType>
@@ -322,19 +678,28 @@ namespace DOG
 
 		ECS_ASSERT(Exists(entityID), "Entity is invalid");
 		ECS_ASSERT(HasComponent<ComponentType>(entityID), "Entity does not have that component.");
+		ECS_ASSERT(!IsInParallelIteration(), "Components can not be removed while iterating in parallel or over a Query, use Defer.");
 
-		if (set(componentID)->bundle != nullptr)
+		if constexpr (IsArchetypeComponent<ComponentType>)
 		{
-			m_bundles[set(componentID)->bundle]->UpdateOnRemove(entityID);
+			m_archetypes.Remove<ComponentType>(entityID);
 		}
+		else
+		{
+			if (set(componentID)->bundle != nullptr)
+			{
+				m_bundles[set(componentID)->bundle]->UpdateOnRemove(entityID);
+			}
 
-		const auto last = set(componentID)->denseArray.back();
-		std::swap(set(componentID)->denseArray.back(), set(componentID)->denseArray[set(componentID)->sparseArray[entityID]]);
-		std::swap(set(componentID)->components.back(), set(componentID)->components[set(componentID)->sparseArray[entityID]]);
-		std::swap(set(componentID)->sparseArray[last], set(componentID)->sparseArray[entityID]);
-		set(componentID)->denseArray.pop_back();
-		set(componentID)->components.pop_back();
-		set(componentID)->sparseArray[entityID] = NULL_ENTITY;
+			const auto last = set(componentID)->denseArray.back();
+			std::swap(set(componentID)->denseArray.back(), set(componentID)->denseArray[set(componentID)->sparseArray[EntityIndex(entityID)]]);
+			std::swap(set(componentID)->components.back(), set(componentID)->components[set(componentID)->sparseArray[EntityIndex(entityID)]]);
+			std::swap(set(componentID)->sparseArray[EntityIndex(last)], set(componentID)->sparseArray[EntityIndex(entityID)]);
+			set(componentID)->denseArray.pop_back();
+			set(componentID)->components.pop_back();
+			set(componentID)->sparseArray[EntityIndex(entityID)] = NULL_ENTITY;
+			SetComponentBit(set(componentID)->poolID, entityID, false);
+		}
 	}
 
 	template<typename ComponentType>
@@ -344,20 +709,29 @@ namespace DOG
 
 		ECS_ASSERT(Exists(entityID), "Entity is invalid");
 
-		if (HasComponent<ComponentType>(entityID))
+		if constexpr (IsArchetypeComponent<ComponentType>)
 		{
-			if (set(componentID)->bundle != nullptr)
+			if (m_archetypes.Has<ComponentType>(entityID))
+				RemoveComponent<ComponentType>(entityID);
+		}
+		else
+		{
+			if (HasComponent<ComponentType>(entityID))
 			{
-				m_bundles[set(componentID)->bundle]->UpdateOnRemove(entityID);
+				if (set(componentID)->bundle != nullptr)
+				{
+					m_bundles[set(componentID)->bundle]->UpdateOnRemove(entityID);
+				}
+
+				const auto last = set(componentID)->denseArray.back();
+				std::swap(set(componentID)->denseArray.back(), set(componentID)->denseArray[set(componentID)->sparseArray[EntityIndex(entityID)]]);
+				std::swap(set(componentID)->components.back(), set(componentID)->components[set(componentID)->sparseArray[EntityIndex(entityID)]]);
+				std::swap(set(componentID)->sparseArray[EntityIndex(last)], set(componentID)->sparseArray[EntityIndex(entityID)]);
+				set(componentID)->denseArray.pop_back();
+				set(componentID)->components.pop_back();
+				set(componentID)->sparseArray[EntityIndex(entityID)] = NULL_ENTITY;
+				SetComponentBit(set(componentID)->poolID, entityID, false);
 			}
-
-			const auto last = set(componentID)->denseArray.back();
-			std::swap(set(componentID)->denseArray.back(), set(componentID)->denseArray[set(componentID)->sparseArray[entityID]]);
-			std::swap(set(componentID)->components.back(), set(componentID)->components[set(componentID)->sparseArray[entityID]]);
-			std::swap(set(componentID)->sparseArray[last], set(componentID)->sparseArray[entityID]);
-			set(componentID)->denseArray.pop_back();
-			set(componentID)->components.pop_back();
-			set(componentID)->sparseArray[entityID] = NULL_ENTITY;
 		}
 	}
 
@@ -368,18 +742,18 @@ namespace DOG
 		ECS_ASSERT(Exists(entityID), "Entity is invalid");
 		ECS_ASSERT(HasComponent<ComponentType>(entityID), "Entity does not have that component.");
 
-		return set(componentID)->components[set(componentID)->sparseArray[entityID]];
+		if constexpr (IsArchetypeComponent<ComponentType>)
+			return m_archetypes.Get<ComponentType>(entityID);
+		else
+			return set(componentID)->components[set(componentID)->sparseArray[EntityIndex(entityID)]];
 	}
 
 	template<typename ComponentType>
 	[[nodiscard]] std::optional<std::reference_wrapper<ComponentType>> EntityManager::TryGetComponent(const entity entityID) const noexcept
 	{
-		static auto constexpr componentID = sti::getTypeIndex<ComponentType>();
-		ECS_ASSERT(Exists(entityID), "Entity is invalid");
-
 		if (HasComponent<ComponentType>(entityID))
 		{
-			return set(componentID)->components[set(componentID)->sparseArray[entityID]];
+			return GetComponent<ComponentType>(entityID);
 		}
 		else
 		{
@@ -387,6 +761,34 @@ namespace DOG
 		}
 	}
 
+	template<typename ComponentType>
+	void EntityManager::MarkChanged(const entity entityID) noexcept
+	{
+		static_assert(!IsArchetypeComponent<ComponentType>, "Change tracking only covers SparseSet components.");
+		static auto constexpr componentID = sti::getTypeIndex<ComponentType>();
+		ECS_ASSERT(HasComponent<ComponentType>(entityID), "Entity does not have that component.");
+
+		set(componentID)->changedTicks[EntityIndex(entityID)] = m_changeTick;
+	}
+
+	template<typename ComponentType>
+	bool EntityManager::WasChanged(const entity entityID, const u32 sinceTick) const noexcept
+	{
+		static_assert(!IsArchetypeComponent<ComponentType>, "Change tracking only covers SparseSet components.");
+		static auto constexpr componentID = sti::getTypeIndex<ComponentType>();
+
+		return HasComponent<ComponentType>(entityID) && set(componentID)->changedTicks[EntityIndex(entityID)] > sinceTick;
+	}
+
+	template<typename ComponentType>
+	bool EntityManager::WasAdded(const entity entityID, const u32 sinceTick) const noexcept
+	{
+		static_assert(!IsArchetypeComponent<ComponentType>, "Change tracking only covers SparseSet components.");
+		static auto constexpr componentID = sti::getTypeIndex<ComponentType>();
+
+		return HasComponent<ComponentType>(entityID) && set(componentID)->addedTicks[EntityIndex(entityID)] > sinceTick;
+	}
+
 	template<typename... ComponentType>
 	Collection<ComponentType...> EntityManager::Collect() noexcept
 	{
@@ -397,14 +799,14 @@ namespace DOG
 	bool EntityManager::HasComponent(const entity entityID) const noexcept
 	{
 		static auto constexpr componentID = sti::getTypeIndex<ComponentType>();
-		ECS_ASSERT(Exists(entityID), "Entity is invalid");
-		return 
-			(
-			m_components.contains(componentID)
-			&& entityID < set(componentID)->sparseArray.size())
-			&& (set(componentID)->sparseArray[entityID] < set(componentID)->denseArray.size())
-			&& (set(componentID)->sparseArray[entityID] != NULL_ENTITY
-			);
+		//No Exists assert, a stale handle (destroyed, or its slot recycled) simply has no components
+		if constexpr (IsArchetypeComponent<ComponentType>)
+			return m_archetypes.Has<ComponentType>(entityID);
+		else
+		{
+			const auto pool = m_components.find(componentID);
+			return pool != m_components.end() && pool->second->Contains(entityID);
+		}
 	}
 
 	template<typename... ComponentType>
@@ -437,9 +839,9 @@ namespace DOG
 	void EntityManager::ValidateSparseArray(const entity entityID) noexcept
 	{
 		static constexpr auto ComponentID = sti::getTypeIndex<ComponentType>();
-		if (entityID >= set(ComponentID)->sparseArray.size())
+		if (EntityIndex(entityID) >= set(ComponentID)->sparseArray.size())
 		{
-			set(ComponentID)->Reserve(entityID * 2);
+			set(ComponentID)->Reserve(EntityIndex(entityID) * 2);
 		}
 	}
 
@@ -447,11 +849,174 @@ namespace DOG
 	void EntityManager::AddSparseSet() noexcept
 	{
 		static constexpr auto ComponentID = sti::getTypeIndex<ComponentType>();
-		m_components[ComponentID] = std::move(std::make_unique<SparseSet<ComponentType>>());
+		auto pool = CreateSparseSet<ComponentType>();
+		s_poolFactories.try_emplace(pool->typeHash, PoolFactory{ ComponentID, &CreateSparseSet<ComponentType> });
+		AddPool(ComponentID, std::move(pool));
+	}
 
-		set(ComponentID)->sparseArray.resize(INITIAL_ENTITY_CAPACITY, NULL_ENTITY);
-		set(ComponentID)->denseArray.reserve(INITIAL_ENTITY_CAPACITY);
-		set(ComponentID)->components.reserve(INITIAL_COMPONENT_CAPACITY);
+	template<typename ComponentType>
+	ComponentPool EntityManager::CreateSparseSet() noexcept
+	{
+		auto pool = std::make_unique<SparseSet<ComponentType>>();
+		pool->Reserve(INITIAL_ENTITY_CAPACITY);
+		pool->denseArray.reserve(INITIAL_ENTITY_CAPACITY);
+		pool->components.reserve(INITIAL_COMPONENT_CAPACITY);
+		pool->typeHash = sti::hash_64_fnv1a_const(sti::getTypeName<ComponentType>());
+		return pool;
+	}
+
+	inline void EntityManager::SetComponentBit(const u32 poolID, const entity entityID, const bool owned) noexcept
+	{
+		u64& word = m_componentMasks[(size_t)EntityIndex(entityID) * m_componentMaskWords + poolID / 64u];
+		if (owned)
+			word |= 1ull << (poolID % 64u);
+		else
+			word &= ~(1ull << (poolID % 64u));
+
+		if (!m_poolsByID[poolID]->queries.empty())
+			RefreshCachedQueries(*m_poolsByID[poolID], entityID);
+	}
+
+	//##################### SYSTEM ACCESS #####################
+
+	template<typename... AccessList>
+	void SystemAccess::Declare() noexcept
+	{
+		exclusive = false;
+		(DeclareList(AccessList{}), ...);
+	}
+
+	template<typename... ComponentType>
+	void SystemAccess::DeclareList(Reads<ComponentType...>) noexcept
+	{
+		(reads.push_back(sti::getTypeIndex<ComponentType>()), ...);
+		(PrepareStorage<ComponentType>(), ...);
+	}
+
+	template<typename... ComponentType>
+	void SystemAccess::DeclareList(Writes<ComponentType...>) noexcept
+	{
+		(writes.push_back(sti::getTypeIndex<ComponentType>()), ...);
+		(PrepareStorage<ComponentType>(), ...);
+	}
+
+	template<typename ComponentType>
+	void SystemAccess::PrepareStorage() noexcept
+	{
+		// Pools are created up front, systems running in parallel must never insert into the pool map
+		if constexpr (IsArchetypeComponent<ComponentType>)
+			(void)ArchetypeStorage::ComponentBit<ComponentType>();
+		else
+			EntityManager::Get().ExpandAsTupleArguments<ComponentType>();
+	}
+
+	//##################### COMMAND BUFFER #####################
+
+	template<typename ComponentType, typename ...Args>
+	void EntityCommandBuffer::AddComponent(const entity entityID, Args&& ...args) noexcept
+	{
+		static_assert(alignof(ComponentType) <= alignof(std::max_align_t), "Over-aligned components can not be recorded.");
+		ECS_ASSERT(!m_playingBack, "Commands can not be recorded during playback.");
+
+		Lane& lane = GetLane();
+		void* payload = lane.Allocate((u32)sizeof(ComponentType), (u32)alignof(ComponentType));
+		new (payload) ComponentType(std::forward<Args>(args)...);
+
+		void (*destroy)(void*) = nullptr;
+		if constexpr (!std::is_trivially_destructible_v<ComponentType>)
+			destroy = &DestroyPayload<ComponentType>;
+
+		lane.componentCommands.push_back({ sti::getTypeIndex<ComponentType>(), entityID, payload, &ApplyAdd<ComponentType>, destroy });
+	}
+
+	template<typename ComponentType>
+	void EntityCommandBuffer::RemoveComponent(const entity entityID) noexcept
+	{
+		ECS_ASSERT(!m_playingBack, "Commands can not be recorded during playback.");
+		GetLane().componentCommands.push_back({ sti::getTypeIndex<ComponentType>(), entityID, nullptr, &ApplyRemove<ComponentType>, nullptr });
+	}
+
+	template<typename ComponentType>
+	void EntityCommandBuffer::ApplyAdd(EntityManager& manager, const entity entityID, void* payload) noexcept
+	{
+		manager.AddOrReplaceComponent<ComponentType>(entityID, std::move(*static_cast<ComponentType*>(payload)));
+	}
+
+	template<typename ComponentType>
+	void EntityCommandBuffer::ApplyRemove(EntityManager& manager, const entity entityID, void*) noexcept
+	{
+		manager.RemoveComponentIfExists<ComponentType>(entityID);
+	}
+
+	template<typename ComponentType>
+	void EntityCommandBuffer::DestroyPayload(void* payload) noexcept
+	{
+		static_cast<ComponentType*>(payload)->~ComponentType();
+	}
+
+	//##################### ARCHETYPE STORAGE #####################
+
+	template<typename ComponentType>
+	ComponentType* Archetype::Column(const ArchetypeChunk& chunk) const noexcept
+	{
+		return reinterpret_cast<ComponentType*>(chunk.data.get() + columnOffsets[ArchetypeStorage::ComponentBit<ComponentType>()]);
+	}
+
+	template<typename ComponentType>
+	u32 ArchetypeStorage::ComponentBit() noexcept
+	{
+		static const u32 bit = RegisterComponent({
+			(u32)sizeof(ComponentType),
+			(u32)alignof(ComponentType),
+			[](void* destination, void* source)
+			{
+				new (destination) ComponentType(std::move(*static_cast<ComponentType*>(source)));
+				static_cast<ComponentType*>(source)->~ComponentType();
+			},
+			[](void* component) { static_cast<ComponentType*>(component)->~ComponentType(); },
+			sti::hash_64_fnv1a_const(sti::getTypeName<ComponentType>()),
+			ComponentSnapshotMode<ComponentType>() == SnapshotMode::Custom ? SnapshotMode::Retained : ComponentSnapshotMode<ComponentType>()
+			});
+		return bit;
+	}
+
+	template<typename ComponentType, typename ...Args>
+	ComponentType& ArchetypeStorage::Add(const entity entityID, Args&& ...args) noexcept
+	{
+		const u32 bit = ComponentBit<ComponentType>();
+		ValidateLocation(entityID);
+
+		MoveEntity(entityID, AddEdge(m_locations[EntityIndex(entityID)].archetype, bit));
+
+		const ArchetypeLocation& location = m_locations[EntityIndex(entityID)];
+		const Archetype& archetype = m_archetypes[location.archetype];
+		return *new (archetype.ComponentAt(archetype.chunks[location.chunk], bit, location.row)) ComponentType(std::forward<Args>(args)...);
+	}
+
+	template<typename ComponentType>
+	void ArchetypeStorage::Remove(const entity entityID) noexcept
+	{
+		MoveEntity(entityID, RemoveEdge(m_locations[EntityIndex(entityID)].archetype, ComponentBit<ComponentType>()));
+	}
+
+	template<typename ComponentType>
+	bool ArchetypeStorage::Has(const entity entityID) const noexcept
+	{
+		if (EntityIndex(entityID) >= m_locations.size())
+			return false;
+
+		//The row holds the whole handle, so a stale handle to a recycled slot does not have the component
+		const ArchetypeLocation& location = m_locations[EntityIndex(entityID)];
+		const Archetype& archetype = m_archetypes[location.archetype];
+		return (archetype.signature & (1ull << ComponentBit<ComponentType>())) && archetype.Entities(archetype.chunks[location.chunk])[location.row] == entityID;
+	}
+
+	template<typename ComponentType>
+	ComponentType& ArchetypeStorage::Get(const entity entityID) const noexcept
+	{
+		const ArchetypeLocation& location = m_locations[EntityIndex(entityID)];
+		const Archetype& archetype = m_archetypes[location.archetype];
+		return *reinterpret_cast<ComponentType*>(archetype.ComponentAt(archetype.chunks[location.chunk], ComponentBit<ComponentType>(), location.row));
 	}
 
 	//##################### COLLECTIONS #####################
@@ -466,6 +1031,11 @@ namespace DOG
 		void Do(std::invocable<ComponentType&...> auto&& func) const noexcept;
 		void Do(std::invocable<entity, ComponentType&...> auto&& func) const noexcept;
 
+		// Runs func over chunks of the collection on the JobSystem, iteration order is unspecified.
+		// func may only touch the components it is given (plus read-only data); structural changes must go through EntityManager::Defer.
+		void ParallelDo(std::invocable<ComponentType&...> auto&& func) const noexcept;
+		void ParallelDo(std::invocable<entity, ComponentType&...> auto&& func) const noexcept;
+
 	private:
 		DELETE_COPY_MOVE_CONSTRUCTOR(Collection);
 		friend class EntityManager;
@@ -491,10 +1061,12 @@ namespace DOG
 
 		for (int i{ (int)ePointer->size() - 1 }; i >= 0; --i)
 		{
-			if (m_mgr->HasAllOf<ComponentType...>((*ePointer)[i]))
-			{
-				func(m_mgr->GetComponent<ComponentType>((*ePointer)[i])...);
-			}
+			const entity e = (*ePointer)[i];
+			std::apply([&](auto... pool)
+				{
+					if ((pool->Contains(e) && ...))
+						func(pool->Get(e)...);
+				}, m_pools);
 		}
 	}
 
@@ -509,13 +1081,44 @@ namespace DOG
 
 		for (int i{ (int)ePointer->size() - 1 }; i >= 0; --i)
 		{
-			if (m_mgr->HasAllOf<ComponentType...>((*ePointer)[i]))
-			{
-				func((*ePointer)[i], m_mgr->GetComponent<ComponentType>((*ePointer)[i])...);
-			}
+			const entity e = (*ePointer)[i];
+			std::apply([&](auto... pool)
+				{
+					if ((pool->Contains(e) && ...))
+						func(e, pool->Get(e)...);
+				}, m_pools);
 		}
 	}
 
+	template<typename... ComponentType>
+	void Collection<ComponentType...>::ParallelDo(std::invocable<ComponentType&...> auto&& func) const noexcept
+	{
+		ParallelDo([&func](entity, ComponentType&... components) { func(components...); });
+	}
+
+	template<typename... ComponentType>
+	void Collection<ComponentType...>::ParallelDo(std::invocable<entity, ComponentType&...> auto&& func) const noexcept
+	{
+		std::vector<entity>* ePointer = &(get<0>(m_pools)->denseArray);
+		std::apply([&ePointer](const auto&... pool)
+			{
+				((ePointer = (pool->denseArray.size() < ePointer->size()) ? &pool->denseArray : ePointer), ...);
+			}, m_pools);
+
+		m_mgr->ParallelForChunks((u32)ePointer->size(), [&](u32 begin, u32 end)
+			{
+				for (u32 i{ begin }; i < end; ++i)
+				{
+					const entity e = (*ePointer)[i];
+					std::apply([&](auto... pool)
+						{
+							if ((pool->Contains(e) && ...))
+								func(e, pool->Get(e)...);
+						}, m_pools);
+				}
+			});
+	}
+
 	//##################### BUNDLES #####################
 
 	class BundleBase
@@ -526,6 +1129,8 @@ namespace DOG
 
 		virtual [[nodiscard]] std::optional<u32> UpdateOnAdd(const entity entityID) noexcept = 0;
 		virtual void UpdateOnRemove(const entity entityID) noexcept = 0;
+		//Moves every entity with all of the components to the front of the pools again, used after a snapshot restore
+		virtual void Regroup() noexcept = 0;
 		friend ISystem;
 	};
 
@@ -539,12 +1144,17 @@ namespace DOG
 		void Do(std::invocable<ComponentType&...> auto&& func) const noexcept;
 		void Do(std::invocable<entity, ComponentType&...> auto&& func) const noexcept;
 
+		// See Collection::ParallelDo
+		void ParallelDo(std::invocable<ComponentType&...> auto&& func) const noexcept;
+		void ParallelDo(std::invocable<entity, ComponentType&...> auto&& func) const noexcept;
+
 		[[nodiscard]] constexpr const std::vector<entity>* GetEntityVectorPointer() const noexcept { return ePointer; }
 		[[nodiscard]] constexpr const int* GetBundleStartPointer() const noexcept { return &m_bundleStart; }
 	private:
 		DELETE_COPY_MOVE_CONSTRUCTOR(BundleImpl);
 		[[nodiscard]] std::optional<u32> UpdateOnAdd(const entity entityID) noexcept override final;
 		virtual void UpdateOnRemove(const entity entityID) noexcept override final;
+		virtual void Regroup() noexcept override final;
 	private:
 		friend EntityManager;
 		friend ISystem;
@@ -559,7 +1169,13 @@ namespace DOG
 		: m_mgr{ mgr }, m_pools{ std::move(pools) }, m_bundleStart{ -1 }, ePointer{ nullptr }
 	{
 		ECS_DEBUG_EXPR(std::apply([](const auto... pool) {(ECS_ASSERT(pool, "Component type does not exist."), ...); }, m_pools);)
-		
+		Regroup();
+	}
+
+	template<typename... ComponentType>
+	void BundleImpl<ComponentType...>::Regroup() noexcept
+	{
+		m_bundleStart = -1;
 		ePointer = &(get<0>(m_pools)->denseArray);
 		std::apply([&](const auto... pool)
 			{
@@ -570,7 +1186,7 @@ namespace DOG
 		{
 			std::swap(pool->denseArray[index], pool->denseArray[bundleStart + 1]);
 			std::swap(pool->components[index], pool->components[bundleStart + 1]);
-			std::swap(pool->sparseArray[pool->denseArray[index]], pool->sparseArray[pool->denseArray[bundleStart + 1]]);
+			std::swap(pool->sparseArray[EntityIndex(pool->denseArray[index])], pool->sparseArray[EntityIndex(pool->denseArray[bundleStart + 1])]);
 		};
 
 		for (u32 i{ 0u }; i < ePointer->size(); ++i)
@@ -579,7 +1195,7 @@ namespace DOG
 			{
 				std::apply([&](const auto... pool)
 					{
-						(myLambda(pool, pool->sparseArray[(*ePointer)[i]], m_bundleStart), ...);
+						(myLambda(pool, pool->sparseArray[EntityIndex((*ePointer)[i])], m_bundleStart), ...);
 					}, m_pools);
 
 				m_bundleStart++;
@@ -592,7 +1208,8 @@ namespace DOG
 	{
 		for (int i{ m_bundleStart }; i >= 0; --i)
 		{
-			func(m_mgr->GetComponent<ComponentType>((*ePointer)[i])...);
+			const entity e = (*ePointer)[i];
+			std::apply([&](auto... pool) { func(pool->Get(e)...); }, m_pools);
 		}
 	}
 
@@ -601,10 +1218,30 @@ namespace DOG
 	{
 		for (int i{ m_bundleStart }; i >= 0; --i)
 		{
-			func((*ePointer)[i], m_mgr->GetComponent<ComponentType>((*ePointer)[i])...);
+			const entity e = (*ePointer)[i];
+			std::apply([&](auto... pool) { func(e, pool->Get(e)...); }, m_pools);
 		}
 	}
 
+	template<typename... ComponentType>
+	void BundleImpl<ComponentType...>::ParallelDo(std::invocable<ComponentType&...> auto&& func) const noexcept
+	{
+		ParallelDo([&func](entity, ComponentType&... components) { func(components...); });
+	}
+
+	template<typename... ComponentType>
+	void BundleImpl<ComponentType...>::ParallelDo(std::invocable<entity, ComponentType&...> auto&& func) const noexcept
+	{
+		m_mgr->ParallelForChunks((u32)(m_bundleStart + 1), [&](u32 begin, u32 end)
+			{
+				for (u32 i{ begin }; i < end; ++i)
+				{
+					const entity e = (*ePointer)[i];
+					std::apply([&](auto... pool) { func(e, pool->Get(e)...); }, m_pools);
+				}
+			});
+	}
+
 	template<typename... ComponentType>
 	std::optional<u32> BundleImpl<ComponentType...>::UpdateOnAdd(const entity entityID) noexcept
 	{
@@ -612,14 +1249,14 @@ namespace DOG
 		{
 			std::swap(pool->denseArray[index], pool->denseArray[bundleStart + 1]);
 			std::swap(pool->components[index], pool->components[bundleStart + 1]);
-			std::swap(pool->sparseArray[pool->denseArray[index]], pool->sparseArray[pool->denseArray[bundleStart + 1]]);
+			std::swap(pool->sparseArray[EntityIndex(pool->denseArray[index])], pool->sparseArray[EntityIndex(pool->denseArray[bundleStart + 1])]);
 		};
 
 		if (m_mgr->HasAllOf<ComponentType...>(entityID))
 		{
 			std::apply([&](const auto... pool)
 				{
-					(SwapLambda(pool, pool->sparseArray[entityID], m_bundleStart), ...);
+					(SwapLambda(pool, pool->sparseArray[EntityIndex(entityID)], m_bundleStart), ...);
 				}, m_pools);
 
 			m_bundleStart++;
@@ -635,19 +1272,248 @@ namespace DOG
 		{
 			std::swap(pool->denseArray[index], pool->denseArray[bundleStart]);
 			std::swap(pool->components[index], pool->components[bundleStart]);
-			std::swap(pool->sparseArray[pool->denseArray[index]], pool->sparseArray[pool->denseArray[bundleStart]]);
+			std::swap(pool->sparseArray[EntityIndex(pool->denseArray[index])], pool->sparseArray[EntityIndex(pool->denseArray[bundleStart])]);
 		};
 
 		if (m_mgr->HasAllOf<ComponentType...>(entityID))
 		{
 			std::apply([&](const auto... pool)
 				{
-					(SwapLambda(pool, pool->sparseArray[entityID], m_bundleStart), ...);
+					(SwapLambda(pool, pool->sparseArray[EntityIndex(entityID)], m_bundleStart), ...);
 				}, m_pools);
 
 			m_bundleStart--;
 		}
 	}
+
+	//##################### CACHED QUERIES #####################
+
+	template<typename... IncludeType, typename... ExcludeType, typename... OptionalType, typename... ComponentType, typename... Rest>
+	struct MergeQueryLists<CachedQueryImpl<Include<IncludeType...>, Exclude<ExcludeType...>, Optional<OptionalType...>>, Include<ComponentType...>, Rest...>
+		: MergeQueryLists<CachedQueryImpl<Include<IncludeType..., ComponentType...>, Exclude<ExcludeType...>, Optional<OptionalType...>>, Rest...> {};
+
+	template<typename... IncludeType, typename... ExcludeType, typename... OptionalType, typename... ComponentType, typename... Rest>
+	struct MergeQueryLists<CachedQueryImpl<Include<IncludeType...>, Exclude<ExcludeType...>, Optional<OptionalType...>>, Exclude<ComponentType...>, Rest...>
+		: MergeQueryLists<CachedQueryImpl<Include<IncludeType...>, Exclude<ExcludeType..., ComponentType...>, Optional<OptionalType...>>, Rest...> {};
+
+	template<typename... IncludeType, typename... ExcludeType, typename... OptionalType, typename... ComponentType, typename... Rest>
+	struct MergeQueryLists<CachedQueryImpl<Include<IncludeType...>, Exclude<ExcludeType...>, Optional<OptionalType...>>, Optional<ComponentType...>, Rest...>
+		: MergeQueryLists<CachedQueryImpl<Include<IncludeType...>, Exclude<ExcludeType...>, Optional<OptionalType..., ComponentType...>>, Rest...> {};
+
+	//Filters do not change which components are handed out, the query picks them up in its constructor
+	template<typename Query, typename... ComponentType, typename... Rest>
+	struct MergeQueryLists<Query, Changed<ComponentType...>, Rest...> : MergeQueryLists<Query, Rest...> {};
+
+	template<typename Query, typename... ComponentType, typename... Rest>
+	struct MergeQueryLists<Query, Added<ComponentType...>, Rest...> : MergeQueryLists<Query, Rest...> {};
+
+	class CachedQueryBase
+	{
+	public:
+		CachedQueryBase() noexcept = default;
+		virtual ~CachedQueryBase() noexcept = default;
+
+		[[nodiscard]] const std::vector<entity>& GetEntities() const noexcept { return m_entities; }
+		[[nodiscard]] u32 Count() const noexcept { return (u32)m_entities.size(); }
+
+	protected:
+		[[nodiscard]] bool PassesChangeFilters(const entity entityID, const u32 sinceTick) const noexcept
+		{
+			const auto changed = [&](const SparseSetBase* pool) { return pool->Contains(entityID) && pool->changedTicks[EntityIndex(entityID)] > sinceTick; };
+			const auto added = [&](const SparseSetBase* pool) { return pool->Contains(entityID) && pool->addedTicks[EntityIndex(entityID)] > sinceTick; };
+			return (m_changedPools.empty() || std::any_of(m_changedPools.begin(), m_changedPools.end(), changed))
+				&& (m_addedPools.empty() || std::any_of(m_addedPools.begin(), m_addedPools.end(), added));
+		}
+
+		std::vector<SparseSetBase*> m_includePools;
+		std::vector<SparseSetBase*> m_excludePools;
+		std::vector<SparseSetBase*> m_changedPools;
+		std::vector<SparseSetBase*> m_addedPools;
+		std::vector<entity> m_entities;
+		u32 m_lastRunTick{ 0u };
+
+	private:
+		DELETE_COPY_MOVE_CONSTRUCTOR(CachedQueryBase);
+		friend class EntityManager;
+		void Refresh(const entity entityID, const u64* mask) noexcept;
+
+		std::vector<entity> m_positions; //Index into m_entities per entity slot, NULL_ENTITY if the entity does not match
+	};
+
+	template<typename... IncludeType, typename... ExcludeType, typename... OptionalType>
+	class CachedQueryImpl<Include<IncludeType...>, Exclude<ExcludeType...>, Optional<OptionalType...>> : public CachedQueryBase
+	{
+		static_assert(sizeof...(IncludeType) > 0, "A cached query needs at least one Include component.");
+	public:
+		template<typename... QueryList>
+		explicit CachedQueryImpl(EntityManager* mgr, QueryList...) noexcept
+			: m_mgr{ mgr }, m_includeSets{ mgr->ExpandAsTupleArguments<IncludeType>()... }, m_optionalSets{ mgr->ExpandAsTupleArguments<OptionalType>()... }
+		{
+			std::apply([&](auto... pool) { (m_includePools.push_back(pool), ...); }, m_includeSets);
+			(m_excludePools.push_back(mgr->ExpandAsTupleArguments<ExcludeType>()), ...);
+			(AddFilter(QueryList{}), ...);
+		}
+		virtual ~CachedQueryImpl() noexcept override final = default;
+
+		void Do(std::invocable<IncludeType&..., OptionalType*...> auto&& func) noexcept
+		{
+			Do([&func](entity, IncludeType&... components, OptionalType*... optionals) { func(components..., optionals...); });
+		}
+
+		// Iterates back to front like Collection::Do, so removing components from the current entity is fine
+		void Do(std::invocable<entity, IncludeType&..., OptionalType*...> auto&& func) noexcept
+		{
+			const u32 sinceTick = BeginRun();
+			for (u32 i{ Count() }; i-- > 0u;)
+			{
+				if (i < Count())
+					Invoke(m_entities[i], sinceTick, func);
+			}
+			EndRun();
+		}
+
+		// See Collection::ParallelDo
+		void ParallelDo(std::invocable<IncludeType&..., OptionalType*...> auto&& func) noexcept
+		{
+			ParallelDo([&func](entity, IncludeType&... components, OptionalType*... optionals) { func(components..., optionals...); });
+		}
+
+		void ParallelDo(std::invocable<entity, IncludeType&..., OptionalType*...> auto&& func) noexcept
+		{
+			const u32 sinceTick = BeginRun();
+			m_mgr->ParallelForChunks(Count(), [&](u32 begin, u32 end)
+				{
+					for (u32 i{ begin }; i < end; ++i)
+						Invoke(m_entities[i], sinceTick, func);
+				});
+			EndRun();
+		}
+
+	private:
+		template<typename... ComponentType>
+		void AddFilter(Changed<ComponentType...>) noexcept { (m_changedPools.push_back(m_mgr->ExpandAsTupleArguments<ComponentType>()), ...); }
+		template<typename... ComponentType>
+		void AddFilter(Added<ComponentType...>) noexcept { (m_addedPools.push_back(m_mgr->ExpandAsTupleArguments<ComponentType>()), ...); }
+		void AddFilter(auto) noexcept {}
+
+		// Writes made while the query runs are stamped with the run's own tick, so the next run does not see its own changes
+		[[nodiscard]] u32 BeginRun() noexcept
+		{
+			const u32 sinceTick = m_lastRunTick;
+			m_lastRunTick = ++m_mgr->m_changeTick;
+			return sinceTick;
+		}
+		void EndRun() noexcept { ++m_mgr->m_changeTick; }
+
+		void Invoke(const entity entityID, const u32 sinceTick, auto&& func) const noexcept
+		{
+			if (!PassesChangeFilters(entityID, sinceTick))
+				return;
+
+			std::apply([&](auto... include)
+				{
+					std::apply([&](auto... optional)
+						{
+							func(entityID, include->Get(entityID)..., (optional->Contains(entityID) ? &optional->Get(entityID) : nullptr)...);
+						}, m_optionalSets);
+				}, m_includeSets);
+		}
+
+		EntityManager* m_mgr;
+		std::tuple<SparseSet<IncludeType>*...> m_includeSets;
+		std::tuple<SparseSet<OptionalType>*...> m_optionalSets;
+	};
+
+	//##################### ARCHETYPE QUERIES #####################
+
+	template<typename... ComponentType>
+	class ArchetypeQuery
+	{
+	public:
+		explicit ArchetypeQuery(EntityManager* mgr, const ArchetypeQueryCache* cache) noexcept : m_mgr{ mgr }, m_cache{ cache } {}
+		~ArchetypeQuery() noexcept = default;
+
+		// Structural changes are deferred until the iteration is done, like inside Collection::ParallelDo.
+		void Do(std::invocable<ComponentType&...> auto&& func) const noexcept;
+		void Do(std::invocable<entity, ComponentType&...> auto&& func) const noexcept;
+
+		// Hands out whole chunks to the JobSystem, see Collection::ParallelDo.
+		void ParallelDo(std::invocable<ComponentType&...> auto&& func) const noexcept;
+		void ParallelDo(std::invocable<entity, ComponentType&...> auto&& func) const noexcept;
+
+		[[nodiscard]] u32 Count() const noexcept;
+
+	private:
+		DELETE_COPY_MOVE_CONSTRUCTOR(ArchetypeQuery);
+		static void DoChunk(const Archetype& archetype, const ArchetypeChunk& chunk, auto&& func) noexcept;
+
+		EntityManager* m_mgr;
+		const ArchetypeQueryCache* m_cache;
+	};
+
+	template<typename... ComponentType>
+	void ArchetypeQuery<ComponentType...>::DoChunk(const Archetype& archetype, const ArchetypeChunk& chunk, auto&& func) noexcept
+	{
+		const entity* entities = archetype.Entities(chunk);
+		const std::tuple<ComponentType*...> columns{ archetype.Column<ComponentType>(chunk)... };
+		for (u32 row{ 0u }; row < chunk.count; ++row)
+		{
+			func(entities[row], std::get<ComponentType*>(columns)[row]...);
+		}
+	}
+
+	template<typename... ComponentType>
+	void ArchetypeQuery<ComponentType...>::Do(std::invocable<ComponentType&...> auto&& func) const noexcept
+	{
+		Do([&func](entity, ComponentType&... components) { func(components...); });
+	}
+
+	template<typename... ComponentType>
+	void ArchetypeQuery<ComponentType...>::Do(std::invocable<entity, ComponentType&...> auto&& func) const noexcept
+	{
+		m_mgr->DeferStructuralChanges([&]()
+			{
+				for (u32 archetypeIndex : m_cache->archetypes)
+				{
+					const Archetype& archetype = m_mgr->m_archetypes.GetArchetype(archetypeIndex);
+					for (const auto& chunk : archetype.chunks)
+						DoChunk(archetype, chunk, func);
+				}
+			});
+	}
+
+	template<typename... ComponentType>
+	void ArchetypeQuery<ComponentType...>::ParallelDo(std::invocable<ComponentType&...> auto&& func) const noexcept
+	{
+		ParallelDo([&func](entity, ComponentType&... components) { func(components...); });
+	}
+
+	template<typename... ComponentType>
+	void ArchetypeQuery<ComponentType...>::ParallelDo(std::invocable<entity, ComponentType&...> auto&& func) const noexcept
+	{
+		std::vector<std::pair<const Archetype*, const ArchetypeChunk*>> chunks;
+		for (u32 archetypeIndex : m_cache->archetypes)
+		{
+			const Archetype& archetype = m_mgr->m_archetypes.GetArchetype(archetypeIndex);
+			for (const auto& chunk : archetype.chunks)
+				chunks.emplace_back(&archetype, &chunk);
+		}
+
+		m_mgr->ParallelForChunks((u32)chunks.size(), [&](u32 begin, u32 end)
+			{
+				for (u32 i{ begin }; i < end; ++i)
+					DoChunk(*chunks[i].first, *chunks[i].second, func);
+			}, 1u, 1u);
+	}
+
+	template<typename... ComponentType>
+	u32 ArchetypeQuery<ComponentType...>::Count() const noexcept
+	{
+		u32 count = 0u;
+		for (u32 archetypeIndex : m_cache->archetypes)
+			count += m_mgr->m_archetypes.GetArchetype(archetypeIndex).entityCount;
+		return count;
+	}
 }
 
 //##################### SYSTEMS #####################
@@ -732,6 +1598,16 @@ public:																															\
 	CriticalSystemHelper<__VA_ARGS__> m_systemHelper;
 #endif
 
+	/*SYSTEM_ACCESS*/
+
+#ifndef SYSTEM_ACCESS
+#define SYSTEM_ACCESS(...)																									\
+	void DeclareAccess(DOG::SystemAccess& access) const noexcept override final											\
+	{																														\
+		access.Declare<__VA_ARGS__>();																						\
+	}
+#endif
+
 	/*ON_CREATE*/
 
 #ifndef ON_CREATE
@@ -854,6 +1730,30 @@ public:																															\
 	}
 #endif
 
+#ifndef ON_EARLY_UPDATE_ID_PARALLEL
+#define ON_EARLY_UPDATE_ID_PARALLEL(...)																				\
+	void EarlyUpdate() noexcept override final																		\
+	{																												\
+		EarlyUpdateImpl<__VA_ARGS__>();																				\
+	}																												\
+																														\
+	template<typename... ComponentType>																				\
+	void EarlyUpdateImpl()																							\
+	{																												\
+		auto ePointer = m_systemHelper.GetMinimumEntityVector();														\
+		m_systemHelper.m_mgr.ParallelForChunks((u32)ePointer->size(), [&](u32 begin, u32 end)						\
+			{																										\
+				for (u32 i{ begin }; i < end; ++i)																	\
+				{																									\
+					if (m_systemHelper.m_mgr.HasAllOf<ComponentType...>((*ePointer)[i]))								\
+					{																								\
+						OnEarlyUpdate((*ePointer)[i], m_systemHelper.m_mgr.GetComponent<ComponentType>((*ePointer)[i]) ...);	\
+					}																								\
+				}																									\
+			});																										\
+	}
+#endif
+
 #ifndef ON_EARLY_UPDATE_CRITICAL
 #define ON_EARLY_UPDATE_CRITICAL(...)																						\
 	void EarlyUpdate() noexcept override final																				\
@@ -932,6 +1832,30 @@ public:																															\
 	}
 #endif
 
+#ifndef ON_UPDATE_ID_PARALLEL
+#define ON_UPDATE_ID_PARALLEL(...)																					\
+	void Update() noexcept override final																			\
+	{																												\
+		UpdateImpl<__VA_ARGS__>();																					\
+	}																												\
+																														\
+	template<typename... ComponentType>																				\
+	void UpdateImpl()																								\
+	{																												\
+		auto ePointer = m_systemHelper.GetMinimumEntityVector();														\
+		m_systemHelper.m_mgr.ParallelForChunks((u32)ePointer->size(), [&](u32 begin, u32 end)						\
+			{																										\
+				for (u32 i{ begin }; i < end; ++i)																	\
+				{																									\
+					if (m_systemHelper.m_mgr.HasAllOf<ComponentType...>((*ePointer)[i]))								\
+					{																								\
+						OnUpdate((*ePointer)[i], m_systemHelper.m_mgr.GetComponent<ComponentType>((*ePointer)[i]) ...);	\
+					}																								\
+				}																									\
+			});																										\
+	}
+#endif
+
 #ifndef ON_UPDATE_CRITICAL
 #define ON_UPDATE_CRITICAL(...)																								\
 	void Update() noexcept override final																					\
@@ -1010,6 +1934,30 @@ public:																															\
 	}
 #endif
 
+#ifndef ON_LATE_UPDATE_ID_PARALLEL
+#define ON_LATE_UPDATE_ID_PARALLEL(...)																				\
+	void LateUpdate() noexcept override final																		\
+	{																												\
+		LateUpdateImpl<__VA_ARGS__>();																				\
+	}																												\
+																														\
+	template<typename... ComponentType>																				\
+	void LateUpdateImpl()																							\
+	{																												\
+		auto ePointer = m_systemHelper.GetMinimumEntityVector();														\
+		m_systemHelper.m_mgr.ParallelForChunks((u32)ePointer->size(), [&](u32 begin, u32 end)						\
+			{																										\
+				for (u32 i{ begin }; i < end; ++i)																	\
+				{																									\
+					if (m_systemHelper.m_mgr.HasAllOf<ComponentType...>((*ePointer)[i]))								\
+					{																								\
+						OnLateUpdate((*ePointer)[i], m_systemHelper.m_mgr.GetComponent<ComponentType>((*ePointer)[i]) ...);	\
+					}																								\
+				}																									\
+			});																										\
+	}
+#endif
+
 #ifndef ON_LATE_UPDATE_CRITICAL
 #define ON_LATE_UPDATE_CRITICAL(...)																						\
 	void LateUpdate() noexcept override final																				\
@@ -2,8 +2,23 @@
 
 namespace DOG
 {
+	typedef u32 entity;
+
 	constexpr const u32 INITIAL_ENTITY_CAPACITY = 2u; //500
 	constexpr const u32 INITIAL_COMPONENT_CAPACITY = 2u;
 	constexpr const u32 NULL_ENTITY = 100'000'000u;
-	typedef u32 entity;
-}
\ No newline at end of file
+	constexpr const u32 PARALLEL_CHUNK_ALIGNMENT = 64u / sizeof(u32); //One cache line of dense entities
+	constexpr const u32 MIN_PARALLEL_CHUNK_SIZE = 4u * PARALLEL_CHUNK_ALIGNMENT;
+
+	//An entity is a handle: the low bits are the slot index, the bits above count how many times the slot has been reused.
+	//A handle to a destroyed entity never matches the slot again (until the generation wraps), so Exists catches stale handles.
+	//The top bit is left free for EntityCommandBuffer placeholders.
+	constexpr const u32 ENTITY_INDEX_BITS = 24u;
+	constexpr const u32 ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1u;
+	constexpr const u32 ENTITY_GENERATION_MASK = 0x7Fu;
+	constexpr const u32 MAX_ENTITIES = 1u << ENTITY_INDEX_BITS;
+
+	[[nodiscard]] constexpr u32 EntityIndex(const entity entityID) noexcept { return entityID & ENTITY_INDEX_MASK; }
+	[[nodiscard]] constexpr u32 EntityGeneration(const entity entityID) noexcept { return (entityID >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK; }
+	[[nodiscard]] constexpr entity MakeEntity(const u32 index, const u32 generation) noexcept { return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | index; }
+}
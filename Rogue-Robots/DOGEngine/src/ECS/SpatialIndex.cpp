@@ -0,0 +1,59 @@
+#include "SpatialIndex.h"
+
+namespace DOG
+{
+	void SpatialIndex::Invalidate(f32 cellSize) noexcept
+	{
+		ECS_ASSERT(cellSize > 0.0f, "Cell size has to be positive.");
+		//Looked up every frame, the EntityManager drops its cached queries on Reset
+		s_tracked = &EntityManager::Get().CachedQuery<Include<TransformComponent>, Exclude<ModularBlockComponent>>();
+		s_cellSize = cellSize;
+		s_dirty.store(true, std::memory_order_release);
+	}
+
+	void SpatialIndex::Rebuild() noexcept
+	{
+		std::scoped_lock lock(s_rebuildMutex);
+		if (!s_dirty.load(std::memory_order_relaxed))
+			return;
+		s_inverseCellSize = 1.0f / s_cellSize;
+
+		//Read through the entity list of the cached query, running it would bump the change tick and is not thread safe
+		EntityManager& em = EntityManager::Get();
+		s_unsorted.clear();
+		for (const entity e : s_tracked->GetEntities())
+		{
+			const Vector3 position = em.GetComponent<TransformComponent>(e).GetPosition();
+			s_unsorted.push_back({ position, e, CellCoordinate(position.x), CellCoordinate(position.y), CellCoordinate(position.z) });
+		}
+
+		// At least twice as many buckets as entities keeps the chains short
+		u32 bucketCount = 64u;
+		while (bucketCount < 2u * s_unsorted.size())
+			bucketCount <<= 1u;
+		s_bucketMask = bucketCount - 1u;
+
+		// Counting sort by bucket, the offsets end up as the start of every bucket
+		s_bucketOffsets.assign(bucketCount + 1u, 0u);
+		s_entryBuckets.resize(s_unsorted.size());
+		for (u32 i = 0; i < s_unsorted.size(); ++i)
+		{
+			const Entry& entry = s_unsorted[i];
+			s_entryBuckets[i] = Bucket(entry.x, entry.y, entry.z);
+			++s_bucketOffsets[s_entryBuckets[i] + 1u];
+		}
+		for (u32 bucket = 0; bucket < bucketCount; ++bucket)
+			s_bucketOffsets[bucket + 1u] += s_bucketOffsets[bucket];
+
+		s_entries.resize(s_unsorted.size());
+		for (u32 i = 0; i < s_unsorted.size(); ++i)
+			s_entries[s_bucketOffsets[s_entryBuckets[i]]++] = s_unsorted[i];
+
+		// Filling moved every offset to the end of its bucket, which is the start of the next one
+		for (u32 bucket = bucketCount; bucket > 0u; --bucket)
+			s_bucketOffsets[bucket] = s_bucketOffsets[bucket - 1u];
+		s_bucketOffsets[0] = 0u;
+
+		s_dirty.store(false, std::memory_order_release);
+	}
+}
@@ -0,0 +1,237 @@
+#pragma once
+#include "EntityManager.h"
+
+namespace DOG
+{
+	// Uniform hash grid over the position of every entity with a TransformComponent, static level blocks
+	// (ModularBlockComponent) left out. The Application invalidates it once per frame right after the physics step and
+	// the first query after that rebuilds it, so frames without queries cost nothing and queries see the positions of that
+	// step (EarlyUpdate systems see the ones of the previous frame). Entities are bucketed by cell with a counting sort,
+	// a query only visits the cells its volume overlaps and then filters by the component types it is given, e.g.
+	//		SpatialIndex::QueryRadius<RigidbodyComponent>(center, radius, out);
+	// Queries can run from parallel systems, the rebuild is guarded by a lock. Since it reads every TransformComponent,
+	// a parallel system that queries has to declare Reads<TransformComponent>. Entities created after the rebuild are not
+	// found until the next one.
+	class SpatialIndex
+	{
+		using Vector3 = DirectX::SimpleMath::Vector3;
+	public:
+		static constexpr f32 DEFAULT_CELL_SIZE = 4.0f;
+
+		// Main thread only, marks the positions as outdated
+		static void Invalidate(f32 cellSize = DEFAULT_CELL_SIZE) noexcept;
+
+		// Appends every entity within radius of center (inclusive) that has all of ComponentType
+		template<typename... ComponentType>
+		static void QueryRadius(const Vector3& center, f32 radius, std::vector<entity>& out) noexcept;
+
+		// Appends every entity inside the box [low, high]
+		template<typename... ComponentType>
+		static void QueryAABB(const Vector3& low, const Vector3& high, std::vector<entity>& out) noexcept;
+
+		// Appends every entity within range of apex whose direction from apex is at most acos(cosHalfAngle) off direction (normalized)
+		template<typename... ComponentType>
+		static void QueryCone(const Vector3& apex, const Vector3& direction, f32 range, f32 cosHalfAngle, std::vector<entity>& out) noexcept;
+
+		// Writes the (at most) k closest entities within maxRadius into out, closest first
+		template<typename... ComponentType>
+		static void QueryNearest(const Vector3& center, u32 k, f32 maxRadius, std::vector<entity>& out) noexcept;
+
+		// The closest entity within maxRadius that accepted returns true for, NULL_ENTITY if there is none. accepted is called
+		// in order of distance and at most once per entity, so it can be expensive (a raycast).
+		template<typename... ComponentType, typename Predicate>
+		static entity FindNearest(const Vector3& center, f32 maxRadius, Predicate&& accepted) noexcept;
+
+		[[nodiscard]] static u32 GetEntityCount() noexcept { return static_cast<u32>(s_entries.size()); }
+
+	private:
+		struct Entry
+		{
+			Vector3 position;
+			entity id;
+			i32 x, y, z;
+		};
+
+		static void EnsureBuilt() noexcept
+		{
+			if (s_dirty.load(std::memory_order_acquire))
+				Rebuild();
+		}
+		static void Rebuild() noexcept;
+
+		// Calls visit(entry) once for every entry in a cell that overlaps [low, high]
+		template<typename Visitor>
+		static void ForEachInBox(const Vector3& low, const Vector3& high, Visitor&& visit) noexcept;
+
+		// The component filter looks up pools, queries run it after their (cheaper) distance test
+		template<typename... ComponentType>
+		static bool Matches(entity id) noexcept
+		{
+			EntityManager& em = EntityManager::Get();
+			return em.Exists(id) && em.HasAllOf<ComponentType...>(id);
+		}
+
+		static i32 CellCoordinate(f32 value) noexcept { return static_cast<i32>(std::floor(value * s_inverseCellSize)); }
+		static u32 Bucket(i32 x, i32 y, i32 z) noexcept
+		{
+			// Teschner et al. spatial hash
+			return ((static_cast<u32>(x) * 73856093u) ^ (static_cast<u32>(y) * 19349663u) ^ (static_cast<u32>(z) * 83492791u)) & s_bucketMask;
+		}
+
+	private:
+		static inline std::vector<Entry> s_entries;			// Sorted by bucket
+		static inline std::vector<u32> s_bucketOffsets;		// Bucket count + 1 entries, CSR into s_entries
+		static inline std::vector<u32> s_entryBuckets;		// Scratch for the counting sort
+		static inline std::vector<Entry> s_unsorted;
+		static inline u32 s_bucketMask = 0;
+		static inline f32 s_inverseCellSize = 1.0f / DEFAULT_CELL_SIZE;
+		static inline thread_local std::vector<std::pair<f32, entity>> s_nearest;
+
+		static inline const CachedQueryBase* s_tracked = nullptr;	// TransformComponent without ModularBlockComponent
+		static inline f32 s_cellSize = DEFAULT_CELL_SIZE;
+		static inline std::atomic<bool> s_dirty{ false };
+		static inline std::mutex s_rebuildMutex;
+	};
+
+	template<typename Visitor>
+	void SpatialIndex::ForEachInBox(const Vector3& low, const Vector3& high, Visitor&& visit) noexcept
+	{
+		EnsureBuilt();
+		if (s_entries.empty())
+			return;
+
+		const i32 lowX = CellCoordinate(low.x), lowY = CellCoordinate(low.y), lowZ = CellCoordinate(low.z);
+		const i32 highX = CellCoordinate(high.x), highY = CellCoordinate(high.y), highZ = CellCoordinate(high.z);
+		const u64 cellCount = u64(highX - lowX + 1) * u64(highY - lowY + 1) * u64(highZ - lowZ + 1);
+
+		// A box covering more cells than there are buckets is cheaper to answer by going over everything
+		if (cellCount > s_bucketMask + 1u)
+		{
+			for (const Entry& entry : s_entries)
+			{
+				if (entry.x >= lowX && entry.x <= highX && entry.y >= lowY && entry.y <= highY && entry.z >= lowZ && entry.z <= highZ)
+					visit(entry);
+			}
+			return;
+		}
+
+		for (i32 z = lowZ; z <= highZ; ++z)
+			for (i32 y = lowY; y <= highY; ++y)
+				for (i32 x = lowX; x <= highX; ++x)
+				{
+					const u32 bucket = Bucket(x, y, z);
+					for (u32 i = s_bucketOffsets[bucket]; i < s_bucketOffsets[bucket + 1]; ++i)
+					{
+						// Other cells share the bucket, only the entries of this one are visited here
+						const Entry& entry = s_entries[i];
+						if (entry.x == x && entry.y == y && entry.z == z)
+							visit(entry);
+					}
+				}
+	}
+
+	template<typename... ComponentType>
+	void SpatialIndex::QueryRadius(const Vector3& center, f32 radius, std::vector<entity>& out) noexcept
+	{
+		const Vector3 extent{ radius, radius, radius };
+		const f32 radiusSquared = radius * radius;
+		ForEachInBox(center - extent, center + extent, [&](const Entry& entry)
+			{
+				if (Vector3::DistanceSquared(entry.position, center) <= radiusSquared && Matches<ComponentType...>(entry.id))
+					out.push_back(entry.id);
+			});
+	}
+
+	template<typename... ComponentType>
+	void SpatialIndex::QueryAABB(const Vector3& low, const Vector3& high, std::vector<entity>& out) noexcept
+	{
+		ForEachInBox(low, high, [&](const Entry& entry)
+			{
+				const Vector3& p = entry.position;
+				if (p.x >= low.x && p.x <= high.x && p.y >= low.y && p.y <= high.y && p.z >= low.z && p.z <= high.z && Matches<ComponentType...>(entry.id))
+					out.push_back(entry.id);
+			});
+	}
+
+	template<typename... ComponentType>
+	void SpatialIndex::QueryCone(const Vector3& apex, const Vector3& direction, f32 range, f32 cosHalfAngle, std::vector<entity>& out) noexcept
+	{
+		const Vector3 extent{ range, range, range };
+		const f32 rangeSquared = range * range;
+		ForEachInBox(apex - extent, apex + extent, [&](const Entry& entry)
+			{
+				const Vector3 toEntry = entry.position - apex;
+				const f32 distanceSquared = toEntry.LengthSquared();
+				if (distanceSquared > rangeSquared)
+					return;
+				// The apex itself counts as inside
+				if ((distanceSquared == 0.0f || toEntry.Dot(direction) >= cosHalfAngle * std::sqrt(distanceSquared)) && Matches<ComponentType...>(entry.id))
+					out.push_back(entry.id);
+			});
+	}
+
+	template<typename... ComponentType>
+	void SpatialIndex::QueryNearest(const Vector3& center, u32 k, f32 maxRadius, std::vector<entity>& out) noexcept
+	{
+		out.clear();
+		if (k == 0u)
+			return;
+
+		EnsureBuilt();
+		// Grow the searched sphere until it holds k entities, the k closest of those are the k closest overall
+		auto& candidates = s_nearest;
+		for (f32 radius = std::min(1.0f / s_inverseCellSize, maxRadius);; radius = std::min(radius * 2.0f, maxRadius))
+		{
+			candidates.clear();
+			const Vector3 extent{ radius, radius, radius };
+			const f32 radiusSquared = radius * radius;
+			ForEachInBox(center - extent, center + extent, [&](const Entry& entry)
+				{
+					const f32 distanceSquared = Vector3::DistanceSquared(entry.position, center);
+					if (distanceSquared <= radiusSquared && Matches<ComponentType...>(entry.id))
+						candidates.emplace_back(distanceSquared, entry.id);
+				});
+
+			if (candidates.size() >= k || radius >= maxRadius)
+				break;
+		}
+
+		const u32 count = std::min(k, static_cast<u32>(candidates.size()));
+		std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+		for (u32 i = 0; i < count; ++i)
+			out.push_back(candidates[i].second);
+	}
+
+	template<typename... ComponentType, typename Predicate>
+	entity SpatialIndex::FindNearest(const Vector3& center, f32 maxRadius, Predicate&& accepted) noexcept
+	{
+		EnsureBuilt();
+		// Every shell only tests the entities that were outside the previous one, closest first. The first accepted
+		// entity of a shell is the closest accepted one overall since everything not yet tested lies further out.
+		auto& candidates = s_nearest;
+		f32 innerSquared = -1.0f;
+		for (f32 radius = std::min(1.0f / s_inverseCellSize, maxRadius);; radius = std::min(radius * 2.0f, maxRadius))
+		{
+			candidates.clear();
+			const Vector3 extent{ radius, radius, radius };
+			const f32 radiusSquared = radius * radius;
+			ForEachInBox(center - extent, center + extent, [&](const Entry& entry)
+				{
+					const f32 distanceSquared = Vector3::DistanceSquared(entry.position, center);
+					if (distanceSquared > innerSquared && distanceSquared <= radiusSquared && Matches<ComponentType...>(entry.id))
+						candidates.emplace_back(distanceSquared, entry.id);
+				});
+
+			std::sort(candidates.begin(), candidates.end());
+			for (const auto& [distanceSquared, id] : candidates)
+			{
+				if (accepted(id))
+					return id;
+			}
+
+			if (radius >= maxRadius)
+				return NULL_ENTITY;
+			innerSquared = radiusSquared;
+		}
+	}
+}
@@ -2,6 +2,9 @@
 namespace DOG
 {
 	enum class SystemType : u8 { Standard , Critical };
+	enum class SystemPhase : u8 { EarlyUpdate, Update, LateUpdate };
+
+	struct SystemAccess;
 
 	class ISystem
 	{
@@ -12,6 +15,8 @@ namespace DOG
 		virtual void EarlyUpdate() noexcept {}
 		virtual void Update() noexcept {}
 		virtual void LateUpdate() noexcept {}
+		// Systems that do not declare their component access (see SYSTEM_ACCESS) run alone, on the main thread.
+		virtual void DeclareAccess(SystemAccess&) const noexcept {}
 #if defined _DEBUG | defined RELWITHDEBUGINFO
 		[[nodiscard]] virtual std::string_view GetName() const = 0;
 		[[nodiscard]] virtual SystemType GetType() const noexcept = 0;
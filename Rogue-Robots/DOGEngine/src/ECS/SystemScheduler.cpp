@@ -0,0 +1,154 @@
+#include "EntityManager.h"
+#include "../Core/JobSystem.h"
+
+namespace DOG
+{
+	bool SystemAccess::ConflictsWith(const SystemAccess& other) const noexcept
+	{
+		if (exclusive || other.exclusive)
+			return true;
+
+		const auto intersects = [](const std::vector<static_type_info::TypeIndex>& a, const std::vector<static_type_info::TypeIndex>& b)
+		{
+			for (auto id : a)
+			{
+				if (std::find(b.begin(), b.end(), id) != b.end())
+					return true;
+			}
+			return false;
+		};
+
+		return intersects(writes, other.reads) || intersects(writes, other.writes) || intersects(reads, other.writes);
+	}
+
+	void SystemScheduler::Build(const std::vector<std::unique_ptr<ISystem>>& systems) noexcept
+	{
+		m_nodes.clear();
+		m_nodes.resize(systems.size());
+
+		for (u32 i{ 0u }; i < m_nodes.size(); ++i)
+		{
+			m_nodes[i].system = systems[i].get();
+			m_nodes[i].system->DeclareAccess(m_nodes[i].access);
+		}
+
+		// Every conflicting earlier system becomes a dependency. An exclusive system already depends on everything
+		// registered before it, so the backwards scan can stop as soon as one has been added.
+		for (u32 i{ 0u }; i < m_nodes.size(); ++i)
+		{
+			for (i32 j{ (i32)i - 1 }; j >= 0; --j)
+			{
+				if (!m_nodes[i].access.ConflictsWith(m_nodes[j].access))
+					continue;
+
+				m_nodes[j].successors.push_back(i);
+				m_nodes[i].dependencyCount++;
+
+				if (m_nodes[j].access.exclusive)
+					break;
+			}
+		}
+
+		m_remainingDependencies = std::make_unique<std::atomic<u32>[]>(m_nodes.size());
+		m_mainThreadQueue.reserve(m_nodes.size());
+		m_built = true;
+	}
+
+	void SystemScheduler::Run(SystemPhase phase) noexcept
+	{
+		ECS_ASSERT(m_built, "SystemScheduler has to be built before it runs.");
+
+		// Changes recorded between phases (layers, physics, rendering) are visible to every system of this phase
+		EntityManager::Get().PlaybackCommandBuffer();
+
+		if (!m_parallel || JobSystem::GetWorkerCount() == 0u)
+		{
+			for (auto& node : m_nodes)
+			{
+				Invoke(node.system, phase);
+				if (node.access.exclusive)
+					EntityManager::Get().PlaybackCommandBuffer();
+			}
+			EntityManager::Get().PlaybackCommandBuffer();
+			return;
+		}
+
+		m_phase = phase;
+		m_completedNodes.store(0u, std::memory_order_relaxed);
+		for (u32 i{ 0u }; i < m_nodes.size(); ++i)
+			m_remainingDependencies[i].store(m_nodes[i].dependencyCount, std::memory_order_relaxed);
+
+		for (u32 i{ 0u }; i < m_nodes.size(); ++i)
+		{
+			if (m_nodes[i].dependencyCount == 0u)
+				Schedule(i);
+		}
+
+		// The main thread runs exclusive systems as they become ready and helps the workers in between.
+		while (m_completedNodes.load(std::memory_order_acquire) < m_nodes.size())
+		{
+			if (auto nodeIndex = PopMainThreadNode())
+				RunNode(*nodeIndex);
+			else if (!JobSystem::RunPendingJob())
+				std::this_thread::yield();
+		}
+		EntityManager::Get().PlaybackCommandBuffer();
+	}
+
+	void SystemScheduler::Schedule(u32 nodeIndex) noexcept
+	{
+		if (m_nodes[nodeIndex].access.exclusive)
+		{
+			std::scoped_lock lock(m_mainThreadMutex);
+			m_mainThreadQueue.push_back(nodeIndex);
+		}
+		else
+		{
+			JobSystem::Execute([this, nodeIndex]() { RunNode(nodeIndex); });
+		}
+	}
+
+	void SystemScheduler::RunNode(u32 nodeIndex) noexcept
+	{
+		Invoke(m_nodes[nodeIndex].system, m_phase);
+
+		// Nothing else runs next to an exclusive system, so its recorded changes can be applied before its successors start
+		if (m_nodes[nodeIndex].access.exclusive)
+			EntityManager::Get().PlaybackCommandBuffer();
+
+		for (u32 successor : m_nodes[nodeIndex].successors)
+		{
+			if (m_remainingDependencies[successor].fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+				Schedule(successor);
+		}
+		m_completedNodes.fetch_add(1u, std::memory_order_release);
+	}
+
+	std::optional<u32> SystemScheduler::PopMainThreadNode() noexcept
+	{
+		std::scoped_lock lock(m_mainThreadMutex);
+		if (m_mainThreadQueue.empty())
+			return std::nullopt;
+
+		// Exclusive systems conflict with everything, so at most one of them can be ready at a time.
+		u32 nodeIndex = m_mainThreadQueue.back();
+		m_mainThreadQueue.pop_back();
+		return nodeIndex;
+	}
+
+	void SystemScheduler::Invoke(ISystem* system, SystemPhase phase) noexcept
+	{
+		switch (phase)
+		{
+		case SystemPhase::EarlyUpdate:
+			system->EarlyUpdate();
+			break;
+		case SystemPhase::Update:
+			system->Update();
+			break;
+		case SystemPhase::LateUpdate:
+			system->LateUpdate();
+			break;
+		}
+	}
+}
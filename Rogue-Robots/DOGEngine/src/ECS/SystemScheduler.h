@@ -0,0 +1,83 @@
+#pragma once
+#include "System.h"
+#include <StaticTypeInfo/type_index.h>
+
+namespace DOG
+{
+	template<typename... ComponentType>
+	struct Reads {};
+
+	template<typename... ComponentType>
+	struct Writes {};
+
+	// Component types a system touches during its updates, declared with SYSTEM_ACCESS(DOG::Reads<...>, DOG::Writes<...>).
+	// A system with a declaration may run on a worker thread at the same time as other non-conflicting systems,
+	// so it must not add/remove components, create/destroy entities or touch component types it did not declare.
+	// Structural changes from such a system are recorded into EntityManager::GetCommandBuffer instead.
+	struct SystemAccess
+	{
+		std::vector<static_type_info::TypeIndex> reads;
+		std::vector<static_type_info::TypeIndex> writes;
+		bool exclusive = true;
+
+		template<typename... AccessList>
+		void Declare() noexcept;
+
+		[[nodiscard]] bool ConflictsWith(const SystemAccess& other) const noexcept;
+
+	private:
+		template<typename... ComponentType>
+		void DeclareList(Reads<ComponentType...>) noexcept;
+		template<typename... ComponentType>
+		void DeclareList(Writes<ComponentType...>) noexcept;
+		template<typename ComponentType>
+		static void PrepareStorage() noexcept;
+	};
+
+	// Runs the registered systems of one phase as a dependency graph. Two systems conflict if either one is exclusive
+	// or one of them writes a component type the other reads or writes; conflicting systems keep their registration order.
+	// Non-conflicting systems are handed to the JobSystem, exclusive systems always run on the calling (main) thread.
+	// The EntityManager command buffer is played back before the phase, after every exclusive system and once the whole phase is done.
+	class SystemScheduler
+	{
+	public:
+		SystemScheduler() noexcept = default;
+		~SystemScheduler() noexcept = default;
+
+		void Build(const std::vector<std::unique_ptr<ISystem>>& systems) noexcept;
+		void Run(SystemPhase phase) noexcept;
+		void Invalidate() noexcept { m_built = false; }
+
+		void SetParallel(bool parallel) noexcept { m_parallel = parallel; }
+		[[nodiscard]] bool IsParallel() const noexcept { return m_parallel; }
+		[[nodiscard]] bool IsBuilt() const noexcept { return m_built; }
+
+	private:
+		DELETE_COPY_MOVE_CONSTRUCTOR(SystemScheduler);
+
+		struct Node
+		{
+			ISystem* system = nullptr;
+			SystemAccess access;
+			std::vector<u32> successors;
+			u32 dependencyCount = 0u;
+		};
+
+		void Schedule(u32 nodeIndex) noexcept;
+		void RunNode(u32 nodeIndex) noexcept;
+		[[nodiscard]] std::optional<u32> PopMainThreadNode() noexcept;
+		static void Invoke(ISystem* system, SystemPhase phase) noexcept;
+
+	private:
+		std::vector<Node> m_nodes;
+		std::unique_ptr<std::atomic<u32>[]> m_remainingDependencies;
+		std::atomic<u32> m_completedNodes{ 0u };
+
+		std::mutex m_mainThreadMutex;
+		std::vector<u32> m_mainThreadQueue;
+
+		SystemPhase m_phase{ SystemPhase::EarlyUpdate };
+		bool m_built{ false };
+		bool m_parallel{ true };
+	};
+}
@@ -0,0 +1,19 @@
+#include "EntityManager.h"
+
+namespace DOG
+{
+	void SnapshotReader::Read(void* data, const size_t size) noexcept
+	{
+		ECS_ASSERT(m_offset + size <= m_size, "Snapshot is truncated.");
+		if (size == 0u)
+			return;
+		std::memcpy(data, m_data + m_offset, size);
+		m_offset += size;
+	}
+
+	void SnapshotReader::Skip(const size_t size) noexcept
+	{
+		ECS_ASSERT(m_offset + size <= m_size, "Snapshot is truncated.");
+		m_offset += size;
+	}
+}
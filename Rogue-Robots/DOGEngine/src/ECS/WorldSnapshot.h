@@ -0,0 +1,141 @@
+#pragma once
+#include "EntityTypedef.h"
+
+namespace DOG
+{
+	// Contiguous copy of the EntityManager state, see EntityManager::CaptureSnapshot. The buffer keeps its capacity between
+	// captures so a rollback loop does not allocate once it has warmed up. The bytes can be written to disk or sent over the
+	// network, but they are only meaningful to a build with the same component types (pools are matched by type name).
+	class WorldSnapshot
+	{
+	public:
+		WorldSnapshot() noexcept = default;
+
+		[[nodiscard]] const std::byte* GetData() const noexcept { return m_data.data(); }
+		[[nodiscard]] size_t GetSize() const noexcept { return m_data.size(); }
+		[[nodiscard]] bool IsEmpty() const noexcept { return m_data.empty(); }
+
+		void Assign(const void* data, const size_t size) noexcept
+		{
+			m_data.resize(size);
+			std::memcpy(m_data.data(), data, size);
+		}
+		void Clear() noexcept { m_data.clear(); }
+
+	private:
+		friend class SnapshotWriter;
+		std::vector<std::byte> m_data;
+	};
+
+	class SnapshotWriter
+	{
+	public:
+		explicit SnapshotWriter(WorldSnapshot& snapshot) noexcept : m_data{ snapshot.m_data } {}
+
+		void Write(const void* data, const size_t size) noexcept
+		{
+			if (size == 0u)
+				return;
+			const size_t offset = m_data.size();
+			m_data.resize(offset + size);
+			std::memcpy(m_data.data() + offset, data, size);
+		}
+
+		template<typename T>
+		void Write(const T& value) noexcept
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written directly.");
+			Write(&value, sizeof(T));
+		}
+
+		void Write(const std::string& value) noexcept
+		{
+			Write((u32)value.size());
+			Write(value.data(), value.size());
+		}
+
+		[[nodiscard]] size_t GetOffset() const noexcept { return m_data.size(); }
+
+		// Writes a value at an offset that has already been written, used to fill in sizes afterwards
+		template<typename T>
+		void Patch(const size_t offset, const T& value) noexcept
+		{
+			std::memcpy(m_data.data() + offset, &value, sizeof(T));
+		}
+
+	private:
+		std::vector<std::byte>& m_data;
+	};
+
+	class SnapshotReader
+	{
+	public:
+		explicit SnapshotReader(const WorldSnapshot& snapshot) noexcept : m_data{ snapshot.GetData() }, m_size{ snapshot.GetSize() } {}
+
+		void Read(void* data, const size_t size) noexcept;
+
+		template<typename T>
+		[[nodiscard]] T Read() noexcept
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read directly.");
+			T value;
+			Read(&value, sizeof(T));
+			return value;
+		}
+
+		[[nodiscard]] std::string ReadString() noexcept
+		{
+			std::string value(Read<u32>(), '\0');
+			Read(value.data(), value.size());
+			return value;
+		}
+
+		void Skip(const size_t size) noexcept;
+
+		[[nodiscard]] size_t GetOffset() const noexcept { return m_offset; }
+
+	private:
+		const std::byte* m_data;
+		size_t m_size;
+		size_t m_offset = 0u;
+	};
+
+	// Opt-in serializer for components that can not be copied byte for byte (owning pointers, strings, containers...), e.g.
+	// template<> struct SnapshotSerializer<NameComponent>
+	// {
+	//	static void Write(SnapshotWriter& writer, const NameComponent& component) noexcept { writer.Write(component.name); }
+	//	static NameComponent Read(SnapshotReader& reader) noexcept { return NameComponent(reader.ReadString()); }
+	// };
+	template<typename ComponentType>
+	struct SnapshotSerializer {};
+
+	template<typename ComponentType>
+	concept HasSnapshotSerializer = requires(SnapshotWriter& writer, SnapshotReader& reader, const ComponentType& component)
+	{
+		SnapshotSerializer<ComponentType>::Write(writer, component);
+		{ SnapshotSerializer<ComponentType>::Read(reader) } -> std::convertible_to<ComponentType>;
+	};
+
+	// How a pool is stored in a snapshot. Components that are neither copyable byte for byte nor have a SnapshotSerializer
+	// are Retained: they are not in the snapshot, restoring keeps them on entities that are alive in the snapshot.
+	enum class SnapshotMode : u32
+	{
+		Retained = 0u,
+		Tag,
+		Memcpy,
+		Custom,
+	};
+
+	template<typename ComponentType>
+	constexpr SnapshotMode ComponentSnapshotMode() noexcept
+	{
+		if constexpr (HasSnapshotSerializer<ComponentType>)
+			return SnapshotMode::Custom;
+		else if constexpr (std::is_empty_v<ComponentType>)
+			return SnapshotMode::Tag;
+		else if constexpr (std::is_trivially_copyable_v<ComponentType> && std::is_default_constructible_v<ComponentType>)
+			return SnapshotMode::Memcpy;
+		else
+			return SnapshotMode::Retained;
+	}
+}
@@ -68,15 +68,15 @@ namespace DOG::gfx
 
 	void FrontRenderer::UpdateLights()
 	{
-		// Update lights
-		EntityManager::Get().Collect<DirtyComponent, PointLightComponent>().Do([](entity, DirtyComponent& dirty, PointLightComponent& light)
+		// Update lights, only the ones whose transform was marked as changed since the last frame are visited
+		EntityManager::Get().CachedQuery<Include<PointLightComponent>, Changed<TransformComponent>>().Do([](PointLightComponent& light)
 			{
-				light.dirty |= dirty.IsDirty(DirtyComponent::positionChanged);
+				light.dirty = true;
 			});
 
-		EntityManager::Get().Collect<DirtyComponent, SpotLightComponent>().Do([](entity, DirtyComponent& dirty, SpotLightComponent& light)
+		EntityManager::Get().CachedQuery<Include<SpotLightComponent>, Changed<TransformComponent>>().Do([](SpotLightComponent& light)
 			{
-				light.dirty |= dirty.IsDirty(DirtyComponent::positionChanged) || dirty.IsDirty(DirtyComponent::rotationChanged);
+				light.dirty = true;
 			});
 
 		EntityManager::Get().Collect<TransformComponent, SpotLightComponent>().Do([&](entity, TransformComponent& tr, SpotLightComponent& light)
@@ -114,10 +114,12 @@ namespace DOG::gfx
 	{
 		auto& mgr = EntityManager::Get();
 
-		mgr.Collect<TransformComponent, SubmeshRenderer>().Do([&](entity e, TransformComponent& tr, SubmeshRenderer& sr)
+		// Cached queries hand over the optional components directly instead of probing the pools per entity
+		mgr.CachedQuery<Include<TransformComponent, SubmeshRenderer>, Optional<ShadowReceiverComponent, OutlineComponent, ThisPlayerWeapon, DontDraw>>().Do(
+			[&](TransformComponent& tr, SubmeshRenderer& sr, ShadowReceiverComponent* shadowReceiver, OutlineComponent* outline, ThisPlayerWeapon* playerWeapon, DontDraw* dontDraw)
 			{
 				// We are assuming that this is a totally normal submesh with no weird branches (i.e on ModularBlock or whatever)
-				if (mgr.HasComponent<ShadowReceiverComponent>(e))
+				if (shadowReceiver)
 				{
 					m_singleSidedShadowed.push_back({ sr.mesh, 0, tr });
 				}
@@ -126,19 +128,21 @@ namespace DOG::gfx
 				m_renderer->SubmitMesh(sr.mesh, 0, sr.material, tr);
 
 				// Outline submission
-				if (mgr.HasComponent<OutlineComponent>(e) && !mgr.HasComponent<ThisPlayerWeapon>(e))
+				if (outline && !playerWeapon)
 				{
-					if (!mgr.HasComponent<DontDraw>(e))
+					if (!dontDraw)
 					{
-						const auto& oc = mgr.GetComponent<OutlineComponent>(e);
-						m_renderer->SubmitOutlinedMesh(sr.mesh, 0, oc.color, tr, false, 0);
+						m_renderer->SubmitOutlinedMesh(sr.mesh, 0, outline->color, tr, false, 0);
 					}
 				}
 			});
 
 
 		// We need to bucket in a better way..
-		mgr.Bundle<TransformComponent, ModelComponent>().Do([&](entity e, TransformComponent& transformC, ModelComponent& modelC)
+		mgr.CachedQuery<Include<TransformComponent, ModelComponent>,
+			Optional<OutlineComponent, ThisPlayerWeapon, DontDraw, RigDataComponent, ShadowReceiverComponent, ModularBlockComponent, MeshColliderComponent>>().Do(
+			[&](TransformComponent& transformC, ModelComponent& modelC, OutlineComponent* outline, ThisPlayerWeapon* playerWeapon, DontDraw* dontDraw,
+				RigDataComponent* rigData, ShadowReceiverComponent* shadowReceiver, ModularBlockComponent* modularBlock, MeshColliderComponent* meshCollider)
 			{
 				ModelAsset* model = AssetManager::Get().GetAsset<ModelAsset>(modelC);
 
@@ -148,19 +152,19 @@ namespace DOG::gfx
 				if (model && model->gfxModel)
 				{
 					// Outline submission
-					if (mgr.HasComponent<OutlineComponent>(e) && !mgr.HasComponent<ThisPlayerWeapon>(e))
+					if (outline && !playerWeapon)
 					{
-						if (!mgr.HasComponent<DontDraw>(e))
+						if (!dontDraw)
 						{
 							u32 jointOffset{ 0 };
 							bool animated{ false };
-							if (mgr.HasComponent<RigDataComponent>(e))
+							if (rigData)
 							{
-								jointOffset = mgr.GetComponent<RigDataComponent>(e).offset;
+								jointOffset = rigData->offset;
 								animated = true;
 							}
 
-							const auto& oc = mgr.GetComponent<OutlineComponent>(e);
+							const auto& oc = *outline;
 							if (oc.onlyOutline)
 								skipNormalRendering = true;
 
@@ -200,14 +204,14 @@ namespace DOG::gfx
 				if (model && model->gfxModel)
 				{
 					// Shadow submission:
-					if (mgr.HasComponent<ShadowReceiverComponent>(e))
+					if (shadowReceiver)
 					{
 						for (u32 i = 0; i < model->gfxModel->mesh.numSubmeshes; ++i)
 						{
-							if (mgr.HasComponent<ModularBlockComponent>(e))
+							if (modularBlock)
 								m_doubleSidedShadowed.push_back({ model->gfxModel->mesh.mesh, i, transformC, false });
-							else if (EntityManager::Get().HasComponent<RigDataComponent>(e))
-								m_doubleSidedShadowed.push_back({ model->gfxModel->mesh.mesh, i, transformC, false, true, EntityManager::Get().GetComponent<RigDataComponent>(e).offset });
+							else if (rigData)
+								m_doubleSidedShadowed.push_back({ model->gfxModel->mesh.mesh, i, transformC, false, true, rigData->offset });
 							else
 								m_singleSidedShadowed.push_back({ model->gfxModel->mesh.mesh, i, transformC });
 						}
@@ -218,12 +222,11 @@ namespace DOG::gfx
 						return;
 
 
-					if (mgr.HasComponent<ModularBlockComponent>(e))
+					if (modularBlock)
 					{
-						if (mgr.HasComponent<MeshColliderComponent>(e) &&
-							mgr.GetComponent<MeshColliderComponent>(e).drawMeshColliderOverride)
+						if (meshCollider && meshCollider->drawMeshColliderOverride)
 						{
-							u32 meshColliderModelID = mgr.GetComponent<MeshColliderComponent>(e).meshColliderModelID;
+							u32 meshColliderModelID = meshCollider->meshColliderModelID;
 							ModelAsset* meshColliderModel = AssetManager::Get().GetAsset<ModelAsset>(meshColliderModelID);
 							if (meshColliderModel && meshColliderModel->gfxModel)
 							{
@@ -237,30 +240,29 @@ namespace DOG::gfx
 								m_renderer->SubmitMeshNoFaceCulling(model->gfxModel->mesh.mesh, i, model->gfxModel->mats[i], transformC);
 						}
 					}
-					else if (mgr.HasComponent<RigDataComponent>(e))
+					else if (rigData)
 					{
-						auto offset = mgr.GetComponent<RigDataComponent>(e).offset;
-						if (!mgr.HasComponent<DontDraw>(e) || !mgr.GetComponent<DontDraw>(e).dontDraw)
+						auto offset = rigData->offset;
+						if (!dontDraw || !dontDraw->dontDraw)
 							for (u32 i = 0; i < model->gfxModel->mesh.numSubmeshes; ++i)
 								m_renderer->SubmitAnimatedMesh(model->gfxModel->mesh.mesh, i, model->gfxModel->mats[i], transformC, offset);
 					}
 					else
 					{
-						if (mgr.HasComponent<MeshColliderComponent>(e) &&
-							mgr.GetComponent<MeshColliderComponent>(e).drawMeshColliderOverride)
+						if (meshCollider && meshCollider->drawMeshColliderOverride)
 						{
 							for (u32 i = 0; i < model->gfxModel->mesh.numSubmeshes; ++i)
 								m_renderer->SubmitMeshWireframe(model->gfxModel->mesh.mesh, i, model->gfxModel->mats[i], transformC);
 						}
 						// Special case for weapon draws
-						else if (mgr.HasComponent<ThisPlayerWeapon>(e) && (!mgr.HasComponent<DontDraw>(e) || !mgr.GetComponent<DontDraw>(e).dontDraw))
+						else if (playerWeapon && (!dontDraw || !dontDraw->dontDraw))
 						{
 							for (u32 i = 0; i < model->gfxModel->mesh.numSubmeshes; ++i)
 								m_renderer->SubmitMesh(model->gfxModel->mesh.mesh, i, model->gfxModel->mats[i], transformC, true);
 						}
 						else
 						{
-							if (!mgr.HasComponent<DontDraw>(e) || !mgr.GetComponent<DontDraw>(e).dontDraw)
+							if (!dontDraw || !dontDraw->dontDraw)
 								for (u32 i = 0; i < model->gfxModel->mesh.numSubmeshes; ++i)
 									m_renderer->SubmitMesh(model->gfxModel->mesh.mesh, i, model->gfxModel->mats[i], transformC);
 						}
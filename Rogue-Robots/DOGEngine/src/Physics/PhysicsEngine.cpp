@@ -110,8 +110,9 @@ namespace DOG
 		PhysicsRigidbody::UpdateRigidbodies();
 
 		//Is possible that this is removed later 
+		//Every collider owns its own bullet object, so the syncs before and after the step can run in parallel
 		{
-			EntityManager::Get().Collect<TransformComponent, BoxColliderComponent>().Do([&](TransformComponent& transform, BoxColliderComponent& collider)
+			EntityManager::Get().Collect<TransformComponent, BoxColliderComponent>().ParallelDo([&](TransformComponent& transform, BoxColliderComponent& collider)
 				{
 					//Get rigidbody
 					auto* rigidBody = s_physicsEngine.GetRigidbodyColliderData(collider.rigidbodyHandle);
@@ -125,7 +126,7 @@ namespace DOG
 					}
 				});
 
-			EntityManager::Get().Collect<TransformComponent, SphereColliderComponent>().Do([&](TransformComponent& transform, SphereColliderComponent& collider)
+			EntityManager::Get().Collect<TransformComponent, SphereColliderComponent>().ParallelDo([&](TransformComponent& transform, SphereColliderComponent& collider)
 				{
 					//Get rigidbody
 					auto* rigidBody = s_physicsEngine.GetRigidbodyColliderData(collider.rigidbodyHandle);
@@ -139,7 +140,7 @@ namespace DOG
 					}
 				});
 
-			EntityManager::Get().Collect<TransformComponent, CapsuleColliderComponent>().Do([&](TransformComponent& transform, CapsuleColliderComponent& collider)
+			EntityManager::Get().Collect<TransformComponent, CapsuleColliderComponent>().ParallelDo([&](TransformComponent& transform, CapsuleColliderComponent& collider)
 				{
 					//Get rigidbody
 					auto* rigidBody = s_physicsEngine.GetRigidbodyColliderData(collider.rigidbodyHandle);
@@ -189,7 +190,7 @@ namespace DOG
 				});
 
 			//Ghost objects have no physics done to them but we want to update the boxtriggers position in the physics world
-			EntityManager::Get().Collect<TransformComponent, BoxTriggerComponent>().Do([&](TransformComponent& transform, BoxTriggerComponent& trigger)
+			EntityManager::Get().Collect<TransformComponent, BoxTriggerComponent>().ParallelDo([&](TransformComponent& transform, BoxTriggerComponent& trigger)
 				{
 					//Get ghostObject
 					auto* ghostObjectData = s_physicsEngine.GetGhostObjectData(trigger.ghostObjectHandle);
@@ -202,7 +203,7 @@ namespace DOG
 				});
 
 			//Ghost objects have no physics done to them but we want to update the spheretriggers position in the physics world
-			EntityManager::Get().Collect<TransformComponent, SphereTriggerComponent>().Do([&](TransformComponent& transform, SphereTriggerComponent& trigger)
+			EntityManager::Get().Collect<TransformComponent, SphereTriggerComponent>().ParallelDo([&](TransformComponent& transform, SphereTriggerComponent& trigger)
 				{
 					//Get ghostObject
 					auto* ghostObjectData = s_physicsEngine.GetGhostObjectData(trigger.ghostObjectHandle);
@@ -217,45 +218,57 @@ namespace DOG
 
 		s_physicsEngine.GetDynamicsWorld()->stepSimulation(deltaTime, 10, INTERNAL_TIME_STEP);
 
-		EntityManager::Get().Collect<TransformComponent, BoxColliderComponent>().Do([&](TransformComponent& transform, BoxColliderComponent& collider)
+		EntityManager::Get().Collect<TransformComponent, BoxColliderComponent>().ParallelDo([&](entity e, TransformComponent& transform, BoxColliderComponent& collider)
 			{
 				//Get rigidbody
 				auto* rigidBody = s_physicsEngine.GetRigidbodyColliderData(collider.rigidbodyHandle);
 				if (rigidBody->dynamic && rigidBody->rigidBody && rigidBody->rigidBody->getMotionState())
 				{
+					const auto previous = transform.worldMatrix;
 					btTransform trans;
 					rigidBody->rigidBody->getMotionState()->getWorldTransform(trans);
 					trans.getOpenGLMatrix((float*)(&transform.worldMatrix));
 					//The scale is set to 1 by bullet physics, so we set it back to the original scale
 					transform.SetScale(rigidBody->rigidbodyScale);
+					//Sleeping bodies come back unchanged, only moved ones show up in Changed<TransformComponent> queries
+					if (transform.worldMatrix != previous)
+						EntityManager::Get().MarkChanged<TransformComponent>(e);
 				}
 			});
 		
-		EntityManager::Get().Collect<TransformComponent, SphereColliderComponent>().Do([&](TransformComponent& transform, SphereColliderComponent& collider)
+		EntityManager::Get().Collect<TransformComponent, SphereColliderComponent>().ParallelDo([&](entity e, TransformComponent& transform, SphereColliderComponent& collider)
 			{
 				//Get rigidbody
 				auto* rigidBody = s_physicsEngine.GetRigidbodyColliderData(collider.rigidbodyHandle);
 				if (rigidBody->dynamic && rigidBody->rigidBody && rigidBody->rigidBody->getMotionState())
 				{
+					const auto previous = transform.worldMatrix;
 					btTransform trans;
 					rigidBody->rigidBody->getMotionState()->getWorldTransform(trans);
 					trans.getOpenGLMatrix((float*)(&transform.worldMatrix));
 					//The scale is set to 1 by bullet physics, so we set it back to the original scale
 					transform.SetScale(rigidBody->rigidbodyScale);
+					//Sleeping bodies come back unchanged, only moved ones show up in Changed<TransformComponent> queries
+					if (transform.worldMatrix != previous)
+						EntityManager::Get().MarkChanged<TransformComponent>(e);
 				}
 			});
 
-		EntityManager::Get().Collect<TransformComponent, CapsuleColliderComponent>().Do([&](TransformComponent& transform, CapsuleColliderComponent& collider)
+		EntityManager::Get().Collect<TransformComponent, CapsuleColliderComponent>().ParallelDo([&](entity e, TransformComponent& transform, CapsuleColliderComponent& collider)
 			{
 				//Get rigidbody
 				auto* rigidBody = s_physicsEngine.GetRigidbodyColliderData(collider.rigidbodyHandle);
 				if (rigidBody->dynamic && rigidBody->rigidBody && rigidBody->rigidBody->getMotionState())
 				{
+					const auto previous = transform.worldMatrix;
 					btTransform trans;
 					rigidBody->rigidBody->getMotionState()->getWorldTransform(trans);
 					trans.getOpenGLMatrix((float*)(&transform.worldMatrix));
 					//The scale is set to 1 by bullet physics, so we set it back to the original scale
 					transform.SetScale(rigidBody->rigidbodyScale);
+					//Sleeping bodies come back unchanged, only moved ones show up in Changed<TransformComponent> queries
+					if (transform.worldMatrix != previous)
+						EntityManager::Get().MarkChanged<TransformComponent>(e);
 
 					//Check if the capsule has an rigidbodycomponent and if it should have controll over the transform
 					if (EntityManager::Get().HasComponent<RigidbodyComponent>(rigidBody->rigidbodyEntity))
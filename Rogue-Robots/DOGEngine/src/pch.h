@@ -49,6 +49,7 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <semaphore>
 #include <atomic>
 #include <future>
@@ -63,6 +64,7 @@
 #include <optional>
 #include <DirectXMath.h>
 #include <bitset>
+#include <bit>
 #include <barrier>
 #include <timeapi.h>
 #include <cstdio>
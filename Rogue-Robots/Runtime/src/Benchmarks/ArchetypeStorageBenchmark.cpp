@@ -0,0 +1,225 @@
+#include "ArchetypeStorageBenchmark.h"
+
+using namespace DOG;
+using Matrix = DirectX::SimpleMath::Matrix;
+using Vector3 = DirectX::SimpleMath::Vector3;
+
+// Stand-ins for the components FrontRenderer::Update iterates over, one set per storage backend.
+template<bool Archetype> struct BenchmarkTransform { Matrix worldMatrix; };
+template<bool Archetype> struct BenchmarkModel { u32 modelID = 0u; bool animated = false; };
+template<bool Archetype> struct BenchmarkSubmesh { u32 mesh = 0u; u32 material = 0u; bool dirty = false; };
+template<bool Archetype> struct BenchmarkPointLight { u32 handle = 0u; Vector3 color; f32 strength = 1.f; f32 radius = 5.f; bool dirty = false; };
+template<bool Archetype> struct BenchmarkSpotLight { u32 handle = 0u; Vector3 color; Vector3 direction; f32 cutoffAngle = 30.f; bool dirty = false; };
+template<bool Archetype> struct BenchmarkCamera { Matrix viewMatrix; Matrix projMatrix; };
+template<bool Archetype> struct BenchmarkDirty { std::bitset<2> dirtyBitSet; };
+
+DOG_ARCHETYPE_STORAGE(BenchmarkTransform<true>)
+DOG_ARCHETYPE_STORAGE(BenchmarkModel<true>)
+DOG_ARCHETYPE_STORAGE(BenchmarkSubmesh<true>)
+DOG_ARCHETYPE_STORAGE(BenchmarkPointLight<true>)
+DOG_ARCHETYPE_STORAGE(BenchmarkSpotLight<true>)
+DOG_ARCHETYPE_STORAGE(BenchmarkCamera<true>)
+DOG_ARCHETYPE_STORAGE(BenchmarkDirty<true>)
+
+// Tag-like components FrontRenderer probes with HasComponent, these stay in SparseSets for both runs.
+struct BenchmarkShadowReceiver {};
+struct BenchmarkOutline { Vector3 color; };
+struct BenchmarkDontDraw { bool dontDraw = true; };
+struct BenchmarkRigData { u32 offset = 0u; };
+
+struct BenchmarkDrawCall
+{
+	u32 mesh;
+	u32 jointOffset;
+	Matrix world;
+};
+
+template<bool Archetype, typename... ComponentType>
+static void ForEach(auto&& func)
+{
+	if constexpr (Archetype)
+		EntityManager::Get().Query<ComponentType...>().Do(func);
+	else
+		EntityManager::Get().Collect<ComponentType...>().Do(func);
+}
+
+template<bool Archetype>
+static std::vector<entity> CreateScene(u32 modelCount)
+{
+	using Transform = BenchmarkTransform<Archetype>;
+	auto& em = EntityManager::Get();
+
+	std::mt19937 gen(1337u);
+	std::uniform_real_distribution<f32> position(-100.f, 100.f);
+	std::uniform_int_distribution<u32> percent(0u, 99u);
+
+	std::vector<entity> entities;
+	const auto createWithTransform = [&]()
+	{
+		entity e = em.CreateEntity();
+		em.AddComponent<Transform>(e).worldMatrix = Matrix::CreateTranslation(position(gen), position(gen), position(gen));
+		entities.push_back(e);
+		return e;
+	};
+
+	for (u32 i = 0; i < modelCount; ++i)
+	{
+		entity e = createWithTransform();
+		em.AddComponent<BenchmarkModel<Archetype>>(e, i % 64u, percent(gen) < 20u);
+		if (percent(gen) < 60u) em.AddComponent<BenchmarkShadowReceiver>(e);
+		if (percent(gen) < 5u) em.AddComponent<BenchmarkOutline>(e);
+		if (percent(gen) < 20u) em.AddComponent<BenchmarkRigData>(e, i);
+		if (percent(gen) < 2u) em.AddComponent<BenchmarkDontDraw>(e);
+	}
+
+	for (u32 i = 0; i < modelCount / 8u; ++i)
+	{
+		entity e = createWithTransform();
+		em.AddComponent<BenchmarkSubmesh<Archetype>>(e, i, i % 16u, false);
+		if (percent(gen) < 50u) em.AddComponent<BenchmarkShadowReceiver>(e);
+	}
+
+	for (u32 i = 0; i < modelCount / 20u; ++i)
+	{
+		entity e = createWithTransform();
+		em.AddComponent<BenchmarkPointLight<Archetype>>(e).handle = i;
+		em.AddComponent<BenchmarkDirty<Archetype>>(e).dirtyBitSet[0] = percent(gen) < 30u;
+	}
+
+	for (u32 i = 0; i < 16u; ++i)
+	{
+		entity e = createWithTransform();
+		em.AddComponent<BenchmarkSpotLight<Archetype>>(e).handle = i;
+		em.AddComponent<BenchmarkCamera<Archetype>>(e);
+		em.AddComponent<BenchmarkDirty<Archetype>>(e).dirtyBitSet[1] = true;
+	}
+
+	// Props that only have a transform, they make the transform pool larger than every query result
+	for (u32 i = 0; i < modelCount / 2u; ++i)
+		createWithTransform();
+
+	return entities;
+}
+
+// Mirrors FrontRenderer::UpdateLights, GatherDrawCalls and the shadow caster loop in Update
+template<bool Archetype>
+static u64 RunFrontRendererQueries(std::vector<BenchmarkDrawCall>& drawCalls, std::vector<BenchmarkDrawCall>& shadowed)
+{
+	using Transform = BenchmarkTransform<Archetype>;
+	using Model = BenchmarkModel<Archetype>;
+	using Submesh = BenchmarkSubmesh<Archetype>;
+	using PointLight = BenchmarkPointLight<Archetype>;
+	using SpotLight = BenchmarkSpotLight<Archetype>;
+	using Camera = BenchmarkCamera<Archetype>;
+	using Dirty = BenchmarkDirty<Archetype>;
+	auto& em = EntityManager::Get();
+
+	u64 checksum = 0u;
+	drawCalls.clear();
+	shadowed.clear();
+
+	ForEach<Archetype, Dirty, PointLight>([](Dirty& dirty, PointLight& light) { light.dirty |= dirty.dirtyBitSet[0]; });
+	ForEach<Archetype, Dirty, SpotLight>([](Dirty& dirty, SpotLight& light) { light.dirty |= dirty.dirtyBitSet[0] || dirty.dirtyBitSet[1]; });
+	ForEach<Archetype, Transform, SpotLight>([&](Transform& tr, SpotLight& light)
+		{
+			if (light.dirty)
+				checksum += (u64)(tr.worldMatrix.Translation().LengthSquared()) + light.handle;
+		});
+	ForEach<Archetype, Transform, PointLight>([&](Transform& tr, PointLight& light)
+		{
+			if (light.dirty)
+				checksum += (u64)(tr.worldMatrix.Translation().LengthSquared()) + light.handle;
+		});
+
+	ForEach<Archetype, Transform, Submesh>([&](entity e, Transform& tr, Submesh& sr)
+		{
+			if (em.HasComponent<BenchmarkShadowReceiver>(e))
+				shadowed.push_back({ sr.mesh, 0u, tr.worldMatrix });
+			drawCalls.push_back({ sr.mesh, 0u, tr.worldMatrix });
+			if (em.HasComponent<BenchmarkOutline>(e) && !em.HasComponent<BenchmarkDontDraw>(e))
+				checksum += sr.mesh;
+		});
+
+	const auto gatherModel = [&](entity e, Transform& tr, Model& model)
+	{
+		u32 jointOffset = 0u;
+		if (em.HasComponent<BenchmarkRigData>(e))
+			jointOffset = em.GetComponent<BenchmarkRigData>(e).offset;
+		if (em.HasComponent<BenchmarkOutline>(e) && !em.HasComponent<BenchmarkDontDraw>(e))
+			checksum += model.modelID;
+		if (em.HasComponent<BenchmarkShadowReceiver>(e))
+			shadowed.push_back({ model.modelID, jointOffset, tr.worldMatrix });
+		if (!em.HasComponent<BenchmarkDontDraw>(e) || !em.GetComponent<BenchmarkDontDraw>(e).dontDraw)
+			drawCalls.push_back({ model.modelID, jointOffset, tr.worldMatrix });
+	};
+	// FrontRenderer gathers models through a bundle
+	if constexpr (Archetype)
+		em.Query<Transform, Model>().Do(gatherModel);
+	else
+		em.Bundle<Transform, Model>().Do(gatherModel);
+
+	ForEach<Archetype, SpotLight, Camera, Transform>([&](SpotLight& light, Camera& camera, Transform& tr)
+		{
+			camera.viewMatrix = tr.worldMatrix.Invert();
+			checksum += light.handle;
+		});
+
+	return checksum + drawCalls.size() + shadowed.size();
+}
+
+template<bool Archetype>
+static std::pair<f64, f64> MeasureBackend(u32 modelCount, u32 warmupFrames, u32 measuredFrames, u64& checksum)
+{
+	std::vector<BenchmarkDrawCall> drawCalls;
+	std::vector<BenchmarkDrawCall> shadowed;
+	drawCalls.reserve(modelCount * 2u);
+	shadowed.reserve(modelCount * 2u);
+
+	Timer timer;
+	timer.Start();
+	std::vector<entity> entities = CreateScene<Archetype>(modelCount);
+	const f64 buildMs = timer.Stop() / static_cast<f64>(TimeType::Milliseconds);
+
+	for (u32 frame = 0; frame < warmupFrames; ++frame)
+		RunFrontRendererQueries<Archetype>(drawCalls, shadowed);
+
+	checksum = 0u;
+	timer.Start();
+	for (u32 frame = 0; frame < measuredFrames; ++frame)
+		checksum += RunFrontRendererQueries<Archetype>(drawCalls, shadowed);
+	const f64 frameMs = timer.Stop() / static_cast<f64>(TimeType::Milliseconds) / measuredFrames;
+
+	for (entity e : entities)
+		EntityManager::Get().DestroyEntity(e);
+
+	return { buildMs, frameMs };
+}
+
+std::string RunArchetypeStorageBenchmark()
+{
+	constexpr u32 modelCounts[] = { 1000u, 5000u, 20000u, 50000u };
+	constexpr u32 warmupFrames = 5u;
+	constexpr u32 measuredFrames = 60u;
+
+	std::stringstream report;
+	report << "FrontRenderer query mix, SparseSet vs archetype storage (" << measuredFrames << " frames, tags stay in SparseSets)\n";
+	report << std::setw(8) << "models" << std::setw(14) << "sparse ms" << std::setw(14) << "archetype ms" << std::setw(10) << "speedup"
+		<< std::setw(16) << "sparse build" << std::setw(16) << "archetype build" << "\n";
+
+	for (u32 modelCount : modelCounts)
+	{
+		u64 sparseChecksum = 0u, archetypeChecksum = 0u;
+		const auto [sparseBuildMs, sparseMs] = MeasureBackend<false>(modelCount, warmupFrames, measuredFrames, sparseChecksum);
+		const auto [archetypeBuildMs, archetypeMs] = MeasureBackend<true>(modelCount, warmupFrames, measuredFrames, archetypeChecksum);
+
+		report << std::setw(8) << modelCount << std::fixed << std::setprecision(3)
+			<< std::setw(14) << sparseMs << std::setw(14) << archetypeMs
+			<< std::setprecision(2) << std::setw(9) << sparseMs / archetypeMs << "x"
+			<< std::setprecision(1) << std::setw(14) << sparseBuildMs << "ms" << std::setw(14) << archetypeBuildMs << "ms";
+		if (sparseChecksum != archetypeChecksum)
+			report << "  (checksum mismatch!)";
+		report << "\n";
+	}
+
+	return report.str();
+}
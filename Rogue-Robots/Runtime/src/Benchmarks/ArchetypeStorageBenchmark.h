@@ -0,0 +1,6 @@
+#pragma once
+#include <DOGEngine.h>
+
+// The FrontRenderer::Update query mix (light sync, submesh and model gathering, shadow casters) on synthetic scenes,
+// once with every component in SparseSets and once with the queried components in archetype storage.
+std::string RunArchetypeStorageBenchmark();
@@ -0,0 +1,52 @@
+#include "BenchmarkMenu.h"
+
+static std::vector<Benchmark> s_benchmarks;
+static std::string s_lastReport;
+
+// One row per report line, the Logger writes them to Benchmarks.csv on exit
+static void LogReport(const std::string& name, const std::string& report)
+{
+	DOG::Log& log = DOG::Logger::Get()["Benchmarks"];
+	std::istringstream lines(report);
+	for (std::string line; std::getline(lines, line);)
+	{
+		log["benchmark"].Add(name);
+		log["report"].Add("\"" + line + "\"");
+	}
+}
+
+void RegisterBenchmark(const std::string& name, std::function<std::string()> run)
+{
+	s_benchmarks.push_back({ name, std::move(run) });
+}
+
+void BenchmarkMenu(bool& open)
+{
+	if (ImGui::BeginMenu("View"))
+	{
+		if (ImGui::MenuItem("Benchmarks"))
+		{
+			open = true;
+		}
+		ImGui::EndMenu(); // "View"
+	}
+
+	if (open)
+	{
+		ImGui::SetNextWindowSize(ImVec2(620, 480), ImGuiCond_FirstUseEver);
+		if (ImGui::Begin("Benchmarks", &open))
+		{
+			for (auto& benchmark : s_benchmarks)
+			{
+				if (ImGui::Button(benchmark.name.c_str()))
+				{
+					s_lastReport = benchmark.run();
+					LogReport(benchmark.name, s_lastReport);
+				}
+			}
+			ImGui::Separator();
+			ImGui::TextUnformatted(s_lastReport.c_str());
+		}
+		ImGui::End(); // "Benchmarks"
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <DOGEngine.h>
+
+// Headless benchmarks run on synthetic data next to whatever is loaded, log their report through DOG::Logger
+// and are listed under View -> Benchmarks in the ImGui menu.
+struct Benchmark
+{
+	std::string name;
+	std::function<std::string()> run;
+};
+
+void RegisterBenchmark(const std::string& name, std::function<std::string()> run);
+void BenchmarkMenu(bool& open);
@@ -0,0 +1,217 @@
+#include "ECSChecks.h"
+
+using namespace DOG;
+
+// Synthetic components, only ever touched by these checks.
+struct CheckSparseComponent { u32 value = 0u; };
+struct CheckArchetypeComponent { u32 value = 0u; };
+
+DOG_ARCHETYPE_STORAGE(CheckArchetypeComponent)
+
+static void Check(std::stringstream& report, u32& failed, const char* name, bool passed)
+{
+	report << (passed ? "  passed  " : "  FAILED  ") << name << "\n";
+	if (!passed)
+		failed++;
+}
+
+// Destroys an entity, creates entities until its index is handed out again and makes sure the old handle does not see
+// the components of the entity that now owns the slot.
+static void CheckStaleHandles(std::stringstream& report, u32& failed)
+{
+	auto& em = EntityManager::Get();
+
+	const entity stale = em.CreateEntity();
+	em.AddComponent<CheckSparseComponent>(stale, 1u);
+	em.AddComponent<CheckArchetypeComponent>(stale, 1u);
+	em.DestroyEntity(stale);
+
+	// The free list is FIFO, so the slot comes back after the ones freed before it
+	std::vector<entity> created;
+	entity recycled = NULL_ENTITY;
+	while (created.size() < MAX_ENTITIES)
+	{
+		created.push_back(em.CreateEntity());
+		if (EntityIndex(created.back()) == EntityIndex(stale))
+		{
+			recycled = created.back();
+			break;
+		}
+	}
+
+	Check(report, failed, "index is recycled with a new generation", recycled != NULL_ENTITY && recycled != stale);
+	if (recycled != NULL_ENTITY)
+	{
+		em.AddComponent<CheckSparseComponent>(recycled, 2u);
+		em.AddComponent<CheckArchetypeComponent>(recycled, 2u);
+
+		Check(report, failed, "stale handle does not exist", !em.Exists(stale));
+		Check(report, failed, "stale handle, SparseSet HasComponent", !em.HasComponent<CheckSparseComponent>(stale));
+		Check(report, failed, "stale handle, SparseSet TryGetComponent", !em.TryGetComponent<CheckSparseComponent>(stale));
+		Check(report, failed, "stale handle, archetype HasComponent", !em.HasComponent<CheckArchetypeComponent>(stale));
+		Check(report, failed, "stale handle, archetype TryGetComponent", !em.TryGetComponent<CheckArchetypeComponent>(stale));
+		Check(report, failed, "new handle still has its components",
+			em.GetComponent<CheckSparseComponent>(recycled).value == 2u && em.GetComponent<CheckArchetypeComponent>(recycled).value == 2u);
+	}
+
+	for (entity e : created)
+		em.DestroyEntity(e);
+}
+
+// Captures a snapshot, mutates, destroys and creates entities, restores and compares with what was captured. The snapshot
+// covers the whole world, everything else is put back as it was when the check started.
+static void CheckSnapshotRoundTrip(std::stringstream& report, u32& failed)
+{
+	auto& em = EntityManager::Get();
+
+	const entity both = em.CreateEntity();
+	em.AddComponent<CheckSparseComponent>(both, 1u);
+	em.AddComponent<CheckArchetypeComponent>(both, 10u);
+	const entity sparseOnly = em.CreateEntity();
+	em.AddComponent<CheckSparseComponent>(sparseOnly, 2u);
+	const entity archetypeOnly = em.CreateEntity();
+	em.AddComponent<CheckArchetypeComponent>(archetypeOnly, 30u);
+
+	WorldSnapshot snapshot;
+	em.CaptureSnapshot(snapshot);
+
+	em.GetComponent<CheckSparseComponent>(both).value = 100u;
+	em.GetComponent<CheckArchetypeComponent>(both).value = 1000u;
+	em.AddComponent<CheckArchetypeComponent>(sparseOnly, 20u);
+	em.DestroyEntity(archetypeOnly);
+	const entity created = em.CreateEntity();
+	em.AddComponent<CheckSparseComponent>(created, 4u);
+	em.AddComponent<CheckArchetypeComponent>(created, 40u);
+
+	em.RestoreSnapshot(snapshot);
+
+	Check(report, failed, "captured handles exist again, generations included", em.Exists(both) && em.Exists(sparseOnly) && em.Exists(archetypeOnly));
+	Check(report, failed, "entity created after the capture is gone", !em.Exists(created) && !em.HasComponent<CheckArchetypeComponent>(created));
+	Check(report, failed, "SparseSet values restored",
+		em.GetComponent<CheckSparseComponent>(both).value == 1u && em.GetComponent<CheckSparseComponent>(sparseOnly).value == 2u
+		&& !em.HasComponent<CheckSparseComponent>(archetypeOnly));
+	Check(report, failed, "archetype values restored",
+		em.GetComponent<CheckArchetypeComponent>(both).value == 10u && em.GetComponent<CheckArchetypeComponent>(archetypeOnly).value == 30u);
+	Check(report, failed, "archetype component added after the capture is removed", !em.HasComponent<CheckArchetypeComponent>(sparseOnly));
+
+	u32 archetypeCount = 0u;
+	em.Query<CheckArchetypeComponent>().Do([&](CheckArchetypeComponent&) { archetypeCount++; });
+	Check(report, failed, "archetype query sees only the captured rows", archetypeCount == 2u);
+
+	// The slot of the destroyed entity is handed out with a newer generation than the restored handle
+	em.DestroyEntity(archetypeOnly);
+	std::vector<entity> recycled;
+	while (recycled.size() < MAX_ENTITIES)
+	{
+		recycled.push_back(em.CreateEntity());
+		if (EntityIndex(recycled.back()) == EntityIndex(archetypeOnly))
+			break;
+	}
+	Check(report, failed, "restored generation keeps counting", recycled.back() != archetypeOnly && EntityIndex(recycled.back()) == EntityIndex(archetypeOnly));
+
+	for (entity e : recycled)
+		em.DestroyEntity(e);
+	em.DestroyEntity(both);
+	em.DestroyEntity(sparseOnly);
+}
+
+// Scatters tagged, untagged and static block entities and compares the spatial index queries with a linear scan over
+// the same entities.
+static void CheckSpatialIndex(std::stringstream& report, u32& failed)
+{
+	using Vector3 = DirectX::SimpleMath::Vector3;
+	auto& em = EntityManager::Get();
+
+	std::mt19937 rng(1234u);
+	std::uniform_real_distribution<f32> coordinate(-60.0f, 60.0f);
+	std::uniform_real_distribution<f32> radius(0.5f, 25.0f);
+
+	std::vector<entity> tagged, created;
+	for (u32 i = 0; i < 4000u; ++i)
+	{
+		const entity e = em.CreateEntity();
+		em.AddComponent<TransformComponent>(e, Vector3(coordinate(rng), coordinate(rng) * 0.1f, coordinate(rng)));
+		if (i % 3u == 0u)
+		{
+			em.AddComponent<CheckSparseComponent>(e, i);
+			tagged.push_back(e);
+		}
+		else if (i % 3u == 1u)
+		{
+			em.AddComponent<ModularBlockComponent>(e);
+		}
+		created.push_back(e);
+	}
+	SpatialIndex::Invalidate();
+
+	const auto positionOf = [&](entity e) { return em.GetComponent<TransformComponent>(e).GetPosition(); };
+	const auto acceptOdd = [&](entity e) { return em.GetComponent<CheckSparseComponent>(e).value % 2u == 1u; };
+
+	bool radiusMatches = true, nearestMatches = true;
+	std::vector<entity> found, expected;
+	for (u32 query = 0; query < 200u; ++query)
+	{
+		const Vector3 center(coordinate(rng), coordinate(rng) * 0.1f, coordinate(rng));
+		const f32 r = query % 50u == 0u ? 500.0f : radius(rng);
+
+		found.clear();
+		expected.clear();
+		SpatialIndex::QueryRadius<CheckSparseComponent>(center, r, found);
+		for (entity e : tagged)
+		{
+			if (Vector3::DistanceSquared(positionOf(e), center) <= r * r)
+				expected.push_back(e);
+		}
+		std::sort(found.begin(), found.end());
+		std::sort(expected.begin(), expected.end());
+		radiusMatches &= found == expected;
+
+		entity closest = NULL_ENTITY;
+		f32 closestDistance = std::numeric_limits<f32>::max();
+		for (entity e : tagged)
+		{
+			const f32 distance = Vector3::DistanceSquared(positionOf(e), center);
+			if (acceptOdd(e) && distance <= r * r && distance < closestDistance)
+			{
+				closest = e;
+				closestDistance = distance;
+			}
+		}
+		nearestMatches &= SpatialIndex::FindNearest<CheckSparseComponent>(center, r, acceptOdd) == closest;
+	}
+	Check(report, failed, "QueryRadius matches a linear scan", radiusMatches);
+	Check(report, failed, "FindNearest matches a linear scan", nearestMatches);
+
+	found.clear();
+	SpatialIndex::QueryRadius<ModularBlockComponent>(Vector3(0.0f, 0.0f, 0.0f), 500.0f, found);
+	Check(report, failed, "static level blocks are not indexed", found.empty());
+
+	const entity moved = tagged.front();
+	em.GetComponent<TransformComponent>(moved).SetPosition(Vector3(1000.0f, 0.0f, 1000.0f));
+	SpatialIndex::Invalidate();
+	found.clear();
+	SpatialIndex::QueryRadius<CheckSparseComponent>(Vector3(1000.0f, 0.0f, 1000.0f), 1.0f, found);
+	Check(report, failed, "first query after Invalidate sees the new positions", found.size() == 1u && found.front() == moved);
+
+	for (entity e : created)
+		em.DestroyEntity(e);
+	SpatialIndex::Invalidate();
+}
+
+std::string RunECSChecks()
+{
+	std::stringstream report;
+	u32 failed = 0u;
+
+	report << "Stale entity handles\n";
+	CheckStaleHandles(report, failed);
+
+	report << "World snapshots\n";
+	CheckSnapshotRoundTrip(report, failed);
+
+	report << "Spatial index\n";
+	CheckSpatialIndex(report, failed);
+
+	report << (failed == 0u ? "All checks passed\n" : std::to_string(failed) + " check(s) FAILED\n");
+	return report.str();
+}
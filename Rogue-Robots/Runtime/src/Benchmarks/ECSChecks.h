@@ -0,0 +1,6 @@
+#pragma once
+#include <DOGEngine.h>
+
+// Headless correctness checks for the ECS, run from the benchmark menu since there is no test runner. Every check
+// works on its own synthetic components and entities and removes them again, the report lists passed/FAILED per check.
+std::string RunECSChecks();
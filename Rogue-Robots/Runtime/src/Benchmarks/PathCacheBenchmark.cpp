@@ -0,0 +1,290 @@
+#include "PathCacheBenchmark.h"
+#include "../Pathfinder/Pathfinder.h"
+#include "../Game/PCG/PcgLevelLoader.h"
+
+using namespace DOG;
+using Vector3 = DirectX::SimpleMath::Vector3;
+
+struct NavGrid
+{
+	u32 size = 0u;
+	std::vector<entity> all;
+};
+
+// One floor of size x size blocks. A random spanning tree keeps every block reachable,
+// half of the remaining walls are opened on top of it so there are loops to choose between.
+static NavGrid CreateNavGrid(u32 size)
+{
+	constexpr float dim = pcgBlock::DIMENSION;
+	EntityManager& em = EntityManager::Get();
+	std::mt19937 gen(1337u);
+
+	NavGrid grid;
+	grid.size = size;
+
+	entity navSceneID = em.CreateEntity();
+	NavSceneComponent& navScene = em.AddComponent<NavSceneComponent>(navSceneID);
+	grid.all.push_back(navSceneID);
+
+	for (size_t z = 0; z < size; ++z)
+	{
+		for (size_t x = 0; x < size; ++x)
+		{
+			entity mesh = em.CreateEntity();
+			em.AddComponent<NavMeshComponent>(mesh);
+			em.AddComponent<BoundingBoxComponent>(mesh, Vector3((x + .5f) * dim, .5f * dim, (z + .5f) * dim), Vector3(.5f * dim));
+			navScene.AddIdAt(x, 0, z, mesh);
+			grid.all.push_back(mesh);
+		}
+	}
+
+	const auto connect = [&](entity me, entity other)
+	{
+		entity id = em.CreateEntity();
+		em.AddComponent<PortalComponent>(id, me, other);
+		em.GetComponent<NavMeshComponent>(me).portals.push_back(id);
+		em.GetComponent<NavMeshComponent>(other).portals.push_back(id);
+		grid.all.push_back(id);
+	};
+
+	std::vector<u8> visited(size * size, 0u);
+	std::vector<u8> opened(size * size * 2u, 0u); // east and south wall per block
+	std::vector<u32> stack = { 0u };
+	visited[0] = 1u;
+	while (!stack.empty())
+	{
+		const u32 cell = stack.back();
+		const u32 x = cell % size, z = cell / size;
+		std::array<u32, 4> candidates;
+		u32 count = 0u;
+		if (x > 0u && !visited[cell - 1u]) candidates[count++] = cell - 1u;
+		if (x + 1u < size && !visited[cell + 1u]) candidates[count++] = cell + 1u;
+		if (z > 0u && !visited[cell - size]) candidates[count++] = cell - size;
+		if (z + 1u < size && !visited[cell + size]) candidates[count++] = cell + size;
+		if (count == 0u)
+		{
+			stack.pop_back();
+			continue;
+		}
+
+		const u32 next = candidates[std::uniform_int_distribution<u32>(0u, count - 1u)(gen)];
+		const u32 low = std::min(cell, next), high = std::max(cell, next);
+		opened[low * 2u + (high - low == 1u ? 0u : 1u)] = 1u;
+		visited[next] = 1u;
+		stack.push_back(next);
+	}
+
+	std::bernoulli_distribution openWall(0.5);
+	for (u32 cell = 0; cell < size * size; ++cell)
+	{
+		const size_t x = cell % size, y = 0, z = cell / size;
+		if (x + 1u < size && (opened[cell * 2u] || openWall(gen)))
+			connect(navScene.At(x, y, z), navScene.At(x + 1u, y, z));
+		if (z + 1u < size && (opened[cell * 2u + 1u] || openWall(gen)))
+			connect(navScene.At(x, y, z), navScene.At(x, y, z + 1u));
+	}
+	return grid;
+}
+
+// Players run in slow loops over the whole floor, so their NavMesh changes every few frames
+static Vector3 PlayerPosition(const NavGrid& grid, u32 player, u32 frame)
+{
+	const float extent = grid.size * pcgBlock::DIMENSION;
+	const float t = frame * 0.01f + player * 1.7f;
+	return Vector3(extent * (.5f + .45f * std::sin(t)), .5f * pcgBlock::DIMENSION, extent * (.5f + .45f * std::sin(1.3f * t + player)));
+}
+
+static void Step(Vector3& position, const std::vector<Vector3>& path)
+{
+	constexpr float speed = .4f;
+	if (path.empty())
+		return;
+	Vector3 dir = path[0] - position;
+	dir.y = 0.f;
+	dir.Normalize();
+	position += dir * speed;
+}
+
+std::string RunPathCacheBenchmark()
+{
+	constexpr std::pair<u32, u32> sizes[] = { { 16u, 128u }, { 32u, 512u }, { 32u, 1024u }, { 48u, 2048u } };
+	constexpr u32 playerCount = 4u;
+	constexpr u32 warmupFrames = 5u;
+	constexpr u32 measuredFrames = 60u;
+
+	std::stringstream report;
+	report << "Path cache, A* per agent per frame vs. corridor following with cached paths vs. one flow field per player ("
+		<< playerCount << " players, " << Pathfinder::PathCacheCapacity() << " cached paths, " << measuredFrames << " frames)\n";
+	report << std::setw(8) << "blocks" << std::setw(8) << "agents" << std::setw(14) << "A* ms" << std::setw(14) << "cached ms"
+		<< std::setw(10) << "speedup" << std::setw(16) << "searches/frame" << std::setw(12) << "hit rate" << std::setw(18) << "evictions/frame"
+		<< std::setw(12) << "flow ms" << std::setw(10) << "speedup" << std::setw(14) << "fields/frame" << "\n";
+
+	Pathfinder& pf = Pathfinder::Get();
+	for (auto [gridSize, agentCount] : sizes)
+	{
+		NavGrid grid = CreateNavGrid(gridSize);
+		pf.InvalidatePaths();
+
+		std::mt19937 gen(42u);
+		std::uniform_real_distribution<f32> coordinate(.1f, gridSize * pcgBlock::DIMENSION - .1f);
+		std::vector<Vector3> spawns(agentCount);
+		for (auto& spawn : spawns)
+			spawn = Vector3(coordinate(gen), .5f * pcgBlock::DIMENSION, coordinate(gen));
+
+		std::vector<Vector3> agents;
+		std::vector<PathfinderWalkComponent> walkers;
+		std::array<Vector3, playerCount> players;
+		std::array<entity, playerCount> playerEntities;
+		for (auto& player : playerEntities)
+		{
+			player = EntityManager::Get().CreateEntity();
+			grid.all.push_back(player);
+		}
+		Timer timer;
+
+		const auto measure = [&](auto&& update)
+		{
+			agents = spawns;
+			for (u32 frame = 0; frame < warmupFrames + measuredFrames; ++frame)
+			{
+				if (frame == warmupFrames)
+					timer.Start();
+				for (u32 p = 0; p < playerCount; ++p)
+					players[p] = PlayerPosition(grid, p, frame);
+				update();
+			}
+			return timer.Stop() / static_cast<f64>(TimeType::Milliseconds) / measuredFrames;
+		};
+
+		const f64 astarMs = measure([&]()
+			{
+				for (u32 i = 0; i < agentCount; ++i)
+					Step(agents[i], pf.Checkpoints(agents[i], players[i % playerCount]));
+			});
+
+		walkers.assign(agentCount, PathfinderWalkComponent{});
+		const u32 hitsBefore = pf.CacheHits(), missesBefore = pf.CacheMisses(), evictionsBefore = pf.CacheEvictions();
+		const f64 cachedMs = measure([&]()
+			{
+				for (u32 i = 0; i < agentCount; ++i)
+				{
+					walkers[i].goal = players[i % playerCount];
+					pf.Checkpoints(agents[i], walkers[i]);
+					Step(agents[i], walkers[i].path);
+				}
+			});
+		const u32 hits = pf.CacheHits() - hitsBefore, misses = pf.CacheMisses() - missesBefore, evictions = pf.CacheEvictions() - evictionsBefore;
+
+		walkers.assign(agentCount, PathfinderWalkComponent{});
+		for (u32 i = 0; i < agentCount; ++i)
+			walkers[i].flowTarget = playerEntities[i % playerCount];
+		const u32 buildsBefore = pf.FlowFieldBuilds();
+		const f64 flowMs = measure([&]()
+			{
+				for (u32 i = 0; i < agentCount; ++i)
+				{
+					walkers[i].goal = players[i % playerCount];
+					pf.Checkpoints(agents[i], walkers[i]);
+					Step(agents[i], walkers[i].path);
+				}
+			});
+		const u32 builds = pf.FlowFieldBuilds() - buildsBefore;
+
+		report << std::setw(8) << gridSize * gridSize << std::setw(8) << agentCount
+			<< std::fixed << std::setprecision(3) << std::setw(14) << astarMs << std::setw(14) << cachedMs
+			<< std::setprecision(2) << std::setw(9) << astarMs / cachedMs << "x"
+			<< std::setw(16) << static_cast<f64>(misses) / (warmupFrames + measuredFrames)
+			<< std::setw(11) << 100.0 * hits / std::max(1u, hits + misses) << "%"
+			<< std::setw(18) << static_cast<f64>(evictions) / (warmupFrames + measuredFrames)
+			<< std::setprecision(3) << std::setw(12) << flowMs << std::setprecision(2) << std::setw(9) << astarMs / flowMs << "x"
+			<< std::setw(14) << static_cast<f64>(builds) / (warmupFrames + measuredFrames) << "\n";
+
+		for (entity e : grid.all)
+			EntityManager::Get().DestroyEntity(e);
+		pf.InvalidatePaths();
+	}
+
+	return report.str();
+}
+
+std::string RunHierarchicalPathBenchmark()
+{
+	constexpr u32 sizes[] = { 32u, 64u, 128u, 192u };
+	constexpr u32 clusterBlocks = 8u;
+	constexpr u32 queryCount = 500u;
+
+	std::stringstream report;
+	report << "Hierarchical paths, flat A* vs. cluster level search (" << clusterBlocks << "x" << clusterBlocks << " block clusters, "
+		<< queryCount << " random queries)\n";
+	report << std::setw(8) << "blocks" << std::setw(10) << "portals" << std::setw(10) << "clusters" << std::setw(12) << "build ms"
+		<< std::setw(14) << "flat us/path" << std::setw(14) << "HPA* us/path" << std::setw(10) << "speedup" << std::setw(12) << "longer by" << std::setw(10) << "failed" << "\n";
+
+	for (u32 gridSize : sizes)
+	{
+		NavGrid grid = CreateNavGrid(gridSize);
+		EntityManager& em = EntityManager::Get();
+		NavSceneComponent& navScene = em.GetComponent<NavSceneComponent>(grid.all[0]);
+
+		Timer timer;
+		timer.Start();
+		NavGraph graph;
+		graph.Build(clusterBlocks * pcgBlock::DIMENSION);
+		const f64 buildMs = timer.Stop() / static_cast<f64>(TimeType::Milliseconds);
+
+		std::mt19937 gen(7u);
+		std::uniform_real_distribution<f32> coordinate(.1f, gridSize * pcgBlock::DIMENSION - .1f);
+		struct Query { entity startMesh, goalMesh; Vector3 start, goal; };
+		std::vector<Query> queries(queryCount);
+		for (auto& query : queries)
+		{
+			query.start = Vector3(coordinate(gen), .5f * pcgBlock::DIMENSION, coordinate(gen));
+			query.goal = Vector3(coordinate(gen), .5f * pcgBlock::DIMENSION, coordinate(gen));
+			query.startMesh = navScene.At(query.start);
+			query.goalMesh = navScene.At(query.goal);
+		}
+
+		const auto pathLength = [&](const Query& query, const std::vector<entity>& portals)
+		{
+			float length = 0.f;
+			Vector3 at = query.start;
+			for (entity portal : portals)
+			{
+				length += Vector3::Distance(at, em.GetComponent<PortalComponent>(portal).portal);
+				at = em.GetComponent<PortalComponent>(portal).portal;
+			}
+			return length + Vector3::Distance(at, query.goal);
+		};
+
+		std::vector<std::vector<entity>> flatPaths(queryCount), clusterPaths(queryCount);
+		timer.Start();
+		for (u32 i = 0; i < queryCount; ++i)
+			graph.FindPathFlat(queries[i].startMesh, queries[i].start, queries[i].goalMesh, queries[i].goal, flatPaths[i]);
+		const f64 flatUs = timer.Stop() / static_cast<f64>(TimeType::Microseconds) / queryCount;
+
+		timer.Start();
+		for (u32 i = 0; i < queryCount; ++i)
+			graph.FindPath(queries[i].startMesh, queries[i].start, queries[i].goalMesh, queries[i].goal, clusterPaths[i]);
+		const f64 clusterUs = timer.Stop() / static_cast<f64>(TimeType::Microseconds) / queryCount;
+
+		// Every block is reachable, so an empty path between two NavMeshes means the search failed
+		f64 flatLength = 0.0, clusterLength = 0.0;
+		u32 failed = 0u;
+		for (u32 i = 0; i < queryCount; ++i)
+		{
+			if (clusterPaths[i].empty() && !flatPaths[i].empty())
+				failed++;
+			flatLength += pathLength(queries[i], flatPaths[i]);
+			clusterLength += pathLength(queries[i], clusterPaths[i]);
+		}
+
+		report << std::setw(8) << gridSize * gridSize << std::setw(10) << graph.NodeCount() << std::setw(10) << graph.ClusterCount()
+			<< std::fixed << std::setprecision(2) << std::setw(12) << buildMs << std::setw(14) << flatUs << std::setw(14) << clusterUs
+			<< std::setw(9) << flatUs / clusterUs << "x" << std::setw(11) << 100.0 * (clusterLength / flatLength - 1.0) << "%"
+			<< std::setw(10) << failed << "\n";
+
+		for (entity e : grid.all)
+			em.DestroyEntity(e);
+	}
+
+	return report.str();
+}
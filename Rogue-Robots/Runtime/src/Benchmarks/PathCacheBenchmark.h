@@ -0,0 +1,10 @@
+#pragma once
+#include <DOGEngine.h>
+
+// Swarms of agents chasing players through a synthetic nav grid, one A* per agent per frame (the old
+// PathfinderWalkSystem behaviour) vs. corridor following with the (start NavMesh, goal NavMesh) path cache, whose hit rate
+// and evictions are reported.
+std::string RunPathCacheBenchmark();
+
+// Long random queries on growing nav grids, A* on the flat portal graph vs. the clustered (HPA*) search of NavGraph
+std::string RunHierarchicalPathBenchmark();
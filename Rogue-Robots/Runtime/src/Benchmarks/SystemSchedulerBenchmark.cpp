@@ -0,0 +1,191 @@
+#include "SystemSchedulerBenchmark.h"
+
+using namespace DOG;
+using Vector3 = DirectX::SimpleMath::Vector3;
+
+// Synthetic agent data, only ever touched by this benchmark.
+struct BenchmarkPositionComponent { Vector3 position; };
+struct BenchmarkVelocityComponent { Vector3 velocity; };
+struct BenchmarkTargetComponent { Vector3 target; };
+struct BenchmarkSensorComponent { f32 distanceToTarget = 0.f; bool inRange = false; };
+struct BenchmarkHealthComponent { f32 hp = 100.f; f32 regen = 1.f; };
+struct BenchmarkCooldownComponent { f32 timer = 0.f; u32 triggered = 0u; };
+struct BenchmarkAnimationComponent { f32 blend = 0.f; f32 phase = 0.f; };
+
+// Stands in for the per-agent math a real system does (path following, LOS tests, animation blending).
+static f32 SimulateAgentWork(f32 seed)
+{
+	f32 acc = seed;
+	for (u32 i = 0; i < 48; ++i)
+		acc = std::sinf(acc) * 0.5f + std::cosf(acc * 1.3f) * 0.5f;
+	return acc;
+}
+
+class BenchmarkSteeringSystem : public ISystem
+{
+public:
+	SYSTEM_CLASS(BenchmarkPositionComponent, BenchmarkTargetComponent, BenchmarkVelocityComponent);
+	SYSTEM_ACCESS(Reads<BenchmarkPositionComponent, BenchmarkTargetComponent>, Writes<BenchmarkVelocityComponent>);
+	ON_EARLY_UPDATE(BenchmarkPositionComponent, BenchmarkTargetComponent, BenchmarkVelocityComponent);
+	void OnEarlyUpdate(BenchmarkPositionComponent& p, BenchmarkTargetComponent& t, BenchmarkVelocityComponent& v)
+	{
+		Vector3 toTarget = t.target - p.position;
+		toTarget.Normalize();
+		v.velocity = toTarget * (1.f + SimulateAgentWork(p.position.x));
+	}
+};
+
+class BenchmarkSensorSystem : public ISystem
+{
+public:
+	SYSTEM_CLASS(BenchmarkPositionComponent, BenchmarkTargetComponent, BenchmarkSensorComponent);
+	SYSTEM_ACCESS(Reads<BenchmarkPositionComponent, BenchmarkTargetComponent>, Writes<BenchmarkSensorComponent>);
+	ON_EARLY_UPDATE(BenchmarkPositionComponent, BenchmarkTargetComponent, BenchmarkSensorComponent);
+	void OnEarlyUpdate(BenchmarkPositionComponent& p, BenchmarkTargetComponent& t, BenchmarkSensorComponent& s)
+	{
+		s.distanceToTarget = Vector3::Distance(p.position, t.target) + SimulateAgentWork(p.position.z) * 0.001f;
+		s.inRange = s.distanceToTarget < 10.f;
+	}
+};
+
+class BenchmarkHealthSystem : public ISystem
+{
+public:
+	SYSTEM_CLASS(BenchmarkHealthComponent);
+	SYSTEM_ACCESS(Writes<BenchmarkHealthComponent>);
+	ON_UPDATE(BenchmarkHealthComponent);
+	void OnUpdate(BenchmarkHealthComponent& h)
+	{
+		h.hp = std::min(100.f, h.hp + h.regen * SimulateAgentWork(h.hp) * 0.01f);
+	}
+};
+
+class BenchmarkCooldownSystem : public ISystem
+{
+public:
+	SYSTEM_CLASS(BenchmarkSensorComponent, BenchmarkCooldownComponent);
+	SYSTEM_ACCESS(Reads<BenchmarkSensorComponent>, Writes<BenchmarkCooldownComponent>);
+	ON_UPDATE(BenchmarkSensorComponent, BenchmarkCooldownComponent);
+	void OnUpdate(BenchmarkSensorComponent& s, BenchmarkCooldownComponent& c)
+	{
+		c.timer -= 0.016f + SimulateAgentWork(c.timer) * 0.0001f;
+		if (s.inRange && c.timer <= 0.f)
+		{
+			c.timer = 1.f;
+			c.triggered++;
+		}
+	}
+};
+
+class BenchmarkAnimationSystem : public ISystem
+{
+public:
+	SYSTEM_CLASS(BenchmarkVelocityComponent, BenchmarkAnimationComponent);
+	SYSTEM_ACCESS(Reads<BenchmarkVelocityComponent>, Writes<BenchmarkAnimationComponent>);
+	ON_UPDATE(BenchmarkVelocityComponent, BenchmarkAnimationComponent);
+	void OnUpdate(BenchmarkVelocityComponent& v, BenchmarkAnimationComponent& a)
+	{
+		a.blend = std::clamp(v.velocity.Length() * 0.5f, 0.f, 1.f);
+		a.phase += a.blend * SimulateAgentWork(a.phase) * 0.016f;
+	}
+};
+
+class BenchmarkMovementSystem : public ISystem
+{
+public:
+	SYSTEM_CLASS(BenchmarkVelocityComponent, BenchmarkPositionComponent);
+	SYSTEM_ACCESS(Reads<BenchmarkVelocityComponent>, Writes<BenchmarkPositionComponent>);
+	ON_LATE_UPDATE(BenchmarkVelocityComponent, BenchmarkPositionComponent);
+	void OnLateUpdate(BenchmarkVelocityComponent& v, BenchmarkPositionComponent& p)
+	{
+		p.position += v.velocity * (0.016f + SimulateAgentWork(p.position.y) * 0.0001f);
+	}
+};
+
+// Undeclared on purpose: behaves like most game systems today and runs alone on the main thread.
+class BenchmarkBookkeepingSystem : public ISystem
+{
+public:
+	SYSTEM_CLASS(BenchmarkCooldownComponent);
+	ON_LATE_UPDATE(BenchmarkCooldownComponent);
+	void OnLateUpdate(BenchmarkCooldownComponent& c)
+	{
+		m_totalTriggers += c.triggered;
+	}
+	u64 m_totalTriggers = 0u;
+};
+
+std::string RunSystemSchedulerBenchmark()
+{
+	constexpr u32 agentCounts[] = { 250u, 500u, 1000u, 2000u, 4000u, 8000u };
+	constexpr u32 warmupFrames = 10u;
+	constexpr u32 measuredFrames = 120u;
+
+	auto& em = EntityManager::Get();
+
+	std::vector<std::unique_ptr<ISystem>> systems;
+	systems.emplace_back(std::make_unique<BenchmarkSteeringSystem>());
+	systems.emplace_back(std::make_unique<BenchmarkSensorSystem>());
+	systems.emplace_back(std::make_unique<BenchmarkHealthSystem>());
+	systems.emplace_back(std::make_unique<BenchmarkCooldownSystem>());
+	systems.emplace_back(std::make_unique<BenchmarkAnimationSystem>());
+	systems.emplace_back(std::make_unique<BenchmarkMovementSystem>());
+	systems.emplace_back(std::make_unique<BenchmarkBookkeepingSystem>());
+
+	SystemScheduler scheduler;
+	scheduler.Build(systems);
+
+	auto runFrames = [&scheduler](u32 frames) -> f64
+	{
+		Timer timer;
+		timer.Start();
+		for (u32 frame = 0; frame < frames; ++frame)
+		{
+			scheduler.Run(SystemPhase::EarlyUpdate);
+			scheduler.Run(SystemPhase::Update);
+			scheduler.Run(SystemPhase::LateUpdate);
+		}
+		return timer.Stop() / static_cast<f64>(TimeType::Milliseconds) / frames;
+	};
+
+	std::stringstream report;
+	report << "SystemScheduler benchmark (" << JobSystem::GetWorkerCount() << " workers, " << systems.size() << " systems, " << measuredFrames << " frames)\n";
+	report << std::setw(8) << "agents" << std::setw(14) << "serial ms" << std::setw(14) << "parallel ms" << std::setw(10) << "speedup" << "\n";
+
+	std::mt19937 gen(1337u);
+	std::uniform_real_distribution<f32> dist(-50.f, 50.f);
+	for (u32 agentCount : agentCounts)
+	{
+		std::vector<entity> agents;
+		agents.reserve(agentCount);
+		for (u32 i = 0; i < agentCount; ++i)
+		{
+			entity agent = em.CreateEntity();
+			em.AddComponent<BenchmarkPositionComponent>(agent).position = Vector3(dist(gen), 0.f, dist(gen));
+			em.AddComponent<BenchmarkVelocityComponent>(agent);
+			em.AddComponent<BenchmarkTargetComponent>(agent).target = Vector3(dist(gen), 0.f, dist(gen));
+			em.AddComponent<BenchmarkSensorComponent>(agent);
+			em.AddComponent<BenchmarkHealthComponent>(agent);
+			em.AddComponent<BenchmarkCooldownComponent>(agent);
+			em.AddComponent<BenchmarkAnimationComponent>(agent);
+			agents.push_back(agent);
+		}
+
+		scheduler.SetParallel(false);
+		runFrames(warmupFrames);
+		const f64 serialMs = runFrames(measuredFrames);
+
+		scheduler.SetParallel(true);
+		runFrames(warmupFrames);
+		const f64 parallelMs = runFrames(measuredFrames);
+
+		report << std::setw(8) << agentCount << std::fixed << std::setprecision(3)
+			<< std::setw(14) << serialMs << std::setw(14) << parallelMs
+			<< std::setprecision(2) << std::setw(9) << serialMs / parallelMs << "x\n";
+
+		for (entity agent : agents)
+			em.DestroyEntity(agent);
+	}
+
+	return report.str();
+}
@@ -0,0 +1,5 @@
+#pragma once
+#include <DOGEngine.h>
+
+// Frame time of a synthetic agent workload (seven systems over 250 - 8000 agents), serial vs. the parallel SystemScheduler.
+std::string RunSystemSchedulerBenchmark();
@@ -0,0 +1,169 @@
+#include "TransformHierarchyBenchmark.h"
+#include "../Game/TransformHierarchySystem.h"
+
+using namespace DOG;
+using Matrix = DirectX::SimpleMath::Matrix;
+using Vector3 = DirectX::SimpleMath::Vector3;
+
+// The resolve ScuffedSceneGraphSystem used to do: every child walks up its parents with component lookups,
+// the per-entity flag keeps shared ancestors from being resolved twice in one frame.
+static void LegacyResolveParent(entity parent, std::vector<u8>& updated)
+{
+	auto& em = EntityManager::Get();
+	if (auto parentAsChild = em.TryGetComponent<ChildComponent>(parent); parentAsChild && !updated[EntityIndex(parent)])
+	{
+		entity grandParent = parentAsChild->get().parent;
+		if (em.Exists(grandParent))
+		{
+			LegacyResolveParent(grandParent, updated);
+			em.GetComponent<TransformComponent>(parent).worldMatrix = parentAsChild->get().localTransform.worldMatrix * em.GetComponent<TransformComponent>(grandParent).worldMatrix;
+			updated[EntityIndex(parent)] = true;
+		}
+	}
+}
+
+static void LegacyUpdate(std::vector<u8>& updated)
+{
+	auto& em = EntityManager::Get();
+	updated.assign(em.GetAllEntities().size(), 0u);
+	em.Collect<ChildComponent, TransformComponent>().Do([&](entity e, ChildComponent& child, TransformComponent& world)
+		{
+			if (em.Exists(child.parent) && !em.HasComponent<DeferredDeletionComponent>(child.parent) && !updated[EntityIndex(e)])
+			{
+				LegacyResolveParent(child.parent, updated);
+				world.worldMatrix = child.localTransform.worldMatrix * em.GetComponent<TransformComponent>(child.parent).worldMatrix;
+				updated[EntityIndex(e)] = true;
+			}
+		});
+}
+
+struct BenchmarkScene
+{
+	std::vector<entity> players;
+	std::vector<entity> checked; //Leaves whose world matrices are compared between the two runs
+	std::vector<entity> all;
+};
+
+static BenchmarkScene CreateScene(u32 playerCount, u32 emitterCount)
+{
+	auto& em = EntityManager::Get();
+	std::mt19937 gen(1337u);
+	std::uniform_real_distribution<f32> position(-100.f, 100.f);
+
+	BenchmarkScene scene;
+	const auto createChild = [&](entity parent, const Vector3& offset)
+	{
+		entity e = em.CreateEntity();
+		em.AddComponent<TransformComponent>(e);
+		auto& child = em.AddComponent<ChildComponent>(e);
+		child.parent = parent;
+		child.localTransform.SetPosition(offset).SetRotation({ 0.f, 0.1f, 0.f });
+		scene.all.push_back(e);
+		return e;
+	};
+
+	for (u32 i = 0; i < playerCount; ++i)
+	{
+		entity player = em.CreateEntity();
+		em.AddComponent<TransformComponent>(player, Vector3(position(gen), 0.f, position(gen)));
+		scene.players.push_back(player);
+		scene.all.push_back(player);
+
+		entity weapon = createChild(player, { 0.3f, 1.2f, 0.5f });
+		entity barrel = createChild(weapon, { 0.f, 0.f, 0.4f });
+		entity muzzle = createChild(barrel, { 0.f, 0.05f, 0.3f });
+		scene.checked.push_back(createChild(muzzle, { 0.f, 0.f, 0.1f })); //Muzzle light
+		scene.checked.push_back(createChild(player, { 0.f, 1.7f, 0.f })); //Audio source on the head
+	}
+
+	// Emitters hang off static props, a few props carry most of them
+	std::vector<entity> props;
+	for (u32 i = 0; i < std::max(1u, emitterCount / 64u); ++i)
+	{
+		entity prop = em.CreateEntity();
+		em.AddComponent<TransformComponent>(prop, Vector3(position(gen), 0.f, position(gen)));
+		props.push_back(prop);
+		scene.all.push_back(prop);
+	}
+	for (u32 i = 0; i < emitterCount; ++i)
+	{
+		entity emitter = createChild(props[i % props.size()], { position(gen) * 0.01f, 1.f, position(gen) * 0.01f });
+		if (i % 16u == 0u)
+			scene.checked.push_back(emitter);
+	}
+	return scene;
+}
+
+static void MovePlayers(const BenchmarkScene& scene, u32 frame)
+{
+	auto& em = EntityManager::Get();
+	for (u32 i = 0; i < scene.players.size(); ++i)
+	{
+		auto& tr = em.GetComponent<TransformComponent>(scene.players[i]);
+		tr.SetPosition(Vector3((f32)i, 0.f, 0.01f * frame)).SetRotation({ 0.f, 0.02f * frame, 0.f });
+	}
+}
+
+static f64 Checksum(const BenchmarkScene& scene)
+{
+	f64 sum = 0.0;
+	for (entity e : scene.checked)
+	{
+		const Vector3 p = EntityManager::Get().GetComponent<TransformComponent>(e).GetPosition();
+		sum += p.x + p.y + p.z;
+	}
+	return sum;
+}
+
+std::string RunTransformHierarchyBenchmark()
+{
+	constexpr std::pair<u32, u32> sceneSizes[] = { { 4u, 1000u }, { 16u, 4000u }, { 64u, 10000u }, { 256u, 20000u } };
+	constexpr u32 warmupFrames = 5u;
+	constexpr u32 measuredFrames = 60u;
+
+	std::stringstream report;
+	report << "Transform hierarchy, recursive resolve vs depth-sorted propagation (" << measuredFrames << " frames, players move every frame)\n";
+	report << std::setw(8) << "players" << std::setw(10) << "emitters" << std::setw(12) << "nodes"
+		<< std::setw(14) << "recursive ms" << std::setw(16) << "hierarchy ms" << std::setw(10) << "speedup" << std::setw(14) << "recomputed" << "\n";
+
+	for (auto [playerCount, emitterCount] : sceneSizes)
+	{
+		BenchmarkScene scene = CreateScene(playerCount, emitterCount);
+		std::vector<u8> updated;
+		TransformHierarchy hierarchy;
+		Timer timer;
+
+		const auto measure = [&](auto&& update)
+		{
+			for (u32 frame = 0; frame < warmupFrames; ++frame)
+			{
+				MovePlayers(scene, frame);
+				update();
+			}
+			timer.Start();
+			for (u32 frame = warmupFrames; frame < warmupFrames + measuredFrames; ++frame)
+			{
+				MovePlayers(scene, frame);
+				update();
+			}
+			return timer.Stop() / static_cast<f64>(TimeType::Milliseconds) / measuredFrames;
+		};
+
+		const f64 legacyMs = measure([&]() { LegacyUpdate(updated); });
+		const f64 legacyChecksum = Checksum(scene);
+		const f64 hierarchyMs = measure([&]() { hierarchy.Update(); });
+		const f64 hierarchyChecksum = Checksum(scene);
+
+		report << std::setw(8) << playerCount << std::setw(10) << emitterCount << std::setw(12) << hierarchy.GetNodeCount()
+			<< std::fixed << std::setprecision(3) << std::setw(14) << legacyMs << std::setw(16) << hierarchyMs
+			<< std::setprecision(2) << std::setw(9) << legacyMs / hierarchyMs << "x" << std::setw(14) << hierarchy.GetRecomputedCount();
+		if (std::abs(legacyChecksum - hierarchyChecksum) > 1e-2 * std::max(1.0, std::abs(legacyChecksum)))
+			report << "  (checksum mismatch!)";
+		report << "\n";
+
+		for (entity e : scene.all)
+			EntityManager::Get().DestroyEntity(e);
+	}
+
+	return report.str();
+}
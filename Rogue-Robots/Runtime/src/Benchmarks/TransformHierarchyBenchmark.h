@@ -0,0 +1,6 @@
+#pragma once
+#include <DOGEngine.h>
+
+// ChildComponent propagation on synthetic scenes (player -> weapon -> attachment -> light chains plus particle emitters
+// parented to props), the old recursive per-entity resolve vs. the depth-sorted TransformHierarchy.
+std::string RunTransformHierarchyBenchmark();
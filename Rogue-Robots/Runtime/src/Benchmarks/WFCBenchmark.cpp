@@ -0,0 +1,671 @@
+#include "WFCBenchmark.h"
+#include "../Game/PCG/PQ.h"
+
+using namespace DOG;
+
+struct TileSet
+{
+	std::unordered_map<unsigned int, Block> blocks;
+	u32 tileCount = 0u;
+	WFCRules rules;
+	std::vector<u64> roomTiles;
+	std::vector<u64> edgeTiles; //Per direction
+};
+
+// The block format WFC::ReadInput reads: "name count" followed by one comma separated line per direction
+static bool LoadTileSet(const std::string& path, TileSet& set)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+		return false;
+
+	std::unordered_map<std::string, u32> ids;
+	std::vector<std::string> names;
+	const auto idOf = [&](const std::string& name)
+	{
+		auto [it, inserted] = ids.try_emplace(name, static_cast<u32>(names.size()));
+		if (inserted)
+			names.push_back(name);
+		return it->second;
+	};
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const u32 id = idOf(line.substr(0, line.find(' ')));
+		Block& block = set.blocks[id];
+		block.frequency = 1.0f;
+		for (u32 dir = 0; dir < 6u; ++dir)
+		{
+			std::getline(file, line);
+			for (size_t start = 0, end; (end = line.find(',', start)) != std::string::npos; start = end + 1)
+				block.dirPossibilities[dir].push_back(idOf(line.substr(start, end - start)));
+		}
+		std::getline(file, line);
+	}
+
+	set.tileCount = static_cast<u32>(names.size());
+	set.rules.Build(set.blocks, set.tileCount);
+	const u32 words = set.rules.GetWordCount();
+	set.roomTiles.assign(words, 0u);
+	set.edgeTiles.assign(6u * words, 0u);
+
+	// Same masks as WFC::ReadInput, no doors or spawns inside and only blocks that can face Edge or Void at the boundary
+	const u32 edge = ids.contains("Edge") ? ids["Edge"] : set.tileCount;
+	const u32 empty = ids.contains("Void") ? ids["Void"] : set.tileCount;
+	for (auto& [tile, block] : set.blocks)
+	{
+		const bool door = names[tile].find("Door") != std::string::npos;
+		if (!door && names[tile].find("Spawn") == std::string::npos)
+			set.roomTiles[tile >> 6u] |= 1ull << (tile & 63u);
+		for (u32 dir = 0; dir < 6u; ++dir)
+		{
+			const auto& allowed = block.dirPossibilities[dir];
+			if (door || std::count(allowed.begin(), allowed.end(), edge) || std::count(allowed.begin(), allowed.end(), empty))
+				set.edgeTiles[dir * words + (tile >> 6u)] |= 1ull << (tile & 63u);
+		}
+	}
+	return true;
+}
+
+// Random symmetric rules where every pair of tiles fits with the given probability, no boundary constraints
+static void CreateTileSet(u32 tileCount, f32 density, TileSet& set)
+{
+	std::mt19937 gen(1337u);
+	std::bernoulli_distribution fits(density);
+	for (u32 tile = 0; tile < tileCount; ++tile)
+		set.blocks[tile].frequency = 1.0f;
+	for (u32 dir = 0; dir < 6u; dir += 2u)
+	{
+		for (u32 a = 0; a < tileCount; ++a)
+		{
+			for (u32 b = 0; b < tileCount; ++b)
+			{
+				if (fits(gen))
+				{
+					set.blocks[a].dirPossibilities[dir].push_back(b);
+					set.blocks[b].dirPossibilities[dir ^ 1u].push_back(a);
+				}
+			}
+		}
+	}
+
+	set.tileCount = tileCount;
+	set.rules.Build(set.blocks, tileCount);
+	const u32 words = set.rules.GetWordCount();
+	set.roomTiles.assign(words, 0u);
+	for (u32 tile = 0; tile < tileCount; ++tile)
+		set.roomTiles[tile >> 6u] |= 1ull << (tile & 63u);
+	set.edgeTiles.clear();
+	for (u32 dir = 0; dir < 6u; ++dir)
+		set.edgeTiles.insert(set.edgeTiles.end(), set.roomTiles.begin(), set.roomTiles.end());
+}
+
+struct RoomSize
+{
+	u32 width, height, depth;
+	u32 Cells() const { return width * height * depth; }
+};
+
+static i32 NeighborCell(const RoomSize& size, u32 cell, u32 dir)
+{
+	const u32 layer = size.width * size.height;
+	const u32 remainder = cell % layer;
+	switch (dir)
+	{
+	case 0: return cell >= layer ? static_cast<i32>(cell - layer) : -1;
+	case 1: return cell < layer * (size.depth - 1u) ? static_cast<i32>(cell + layer) : -1;
+	case 2: return cell % size.width != 0u ? static_cast<i32>(cell - 1u) : -1;
+	case 3: return cell % size.width != size.width - 1u ? static_cast<i32>(cell + 1u) : -1;
+	case 4: return remainder >= size.width ? static_cast<i32>(cell - size.width) : -1;
+	default: return remainder < size.width * (size.height - 1u) ? static_cast<i32>(cell + size.width) : -1;
+	}
+}
+
+// The directions the room boundary closes a cell off in, the same cases WFC::IntroduceConstraints checks
+template<typename Function>
+static void ForEachBoundary(const RoomSize& size, u32 cell, Function&& function)
+{
+	for (u32 dir = 0; dir < 6u; ++dir)
+	{
+		if (NeighborCell(size, cell, dir ^ 1u) < 0)
+			function(dir);
+	}
+}
+
+// The domains WFC used to keep: a sorted vector of ids per cell, revised tile by tile with the
+// neighbor's dirPossibilities (what CheckForPropogation did) and a queue of cells to propagate from.
+struct LegacyRoom
+{
+	std::vector<std::vector<u32>> domains;
+	std::queue<u32> queue;
+};
+
+static bool LegacyRevise(const TileSet& set, LegacyRoom& room, u32 current, u32 neighbor, u32 dir)
+{
+	std::vector<u32>& domain = room.domains[neighbor];
+	const std::vector<u32>& currentDomain = room.domains[current];
+	bool removed = false;
+	for (u32 i = 0; i < domain.size(); ++i)
+	{
+		const auto& allowed = set.blocks.at(domain[i]).dirPossibilities[dir];
+		bool matched = false;
+		for (u32 possibility : currentDomain)
+		{
+			if (std::count(allowed.begin(), allowed.end(), possibility))
+			{
+				matched = true;
+				break;
+			}
+		}
+		if (!matched)
+		{
+			if (domain.size() == 1u)
+				return false;
+			domain.erase(domain.begin() + i);
+			--i;
+			removed = true;
+		}
+	}
+	if (removed)
+		room.queue.push(neighbor);
+	return true;
+}
+
+static bool LegacyPropagate(const TileSet& set, const RoomSize& size, LegacyRoom& room)
+{
+	while (!room.queue.empty())
+	{
+		const u32 cell = room.queue.front();
+		room.queue.pop();
+		for (u32 dir = 0; dir < 6u; ++dir)
+		{
+			const i32 neighbor = NeighborCell(size, cell, dir);
+			if (neighbor >= 0 && !LegacyRevise(set, room, cell, static_cast<u32>(neighbor), dir))
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool LegacyRestrict(const TileSet& set, const RoomSize& size, LegacyRoom& room, u32 cell, const u64* mask)
+{
+	std::vector<u32>& domain = room.domains[cell];
+	const size_t before = domain.size();
+	std::erase_if(domain, [mask](u32 tile) { return !((mask[tile >> 6u] >> (tile & 63u)) & 1u); });
+	if (domain.empty())
+		return false;
+	if (domain.size() != before)
+		room.queue.push(cell);
+	return LegacyPropagate(set, size, room);
+}
+
+// Both solvers observe the same way: the first cell with the fewest tiles left, a uniformly chosen tile of it.
+// With identical propagation they make identical choices and end up with identical rooms.
+static bool SolveLegacy(const TileSet& set, const RoomSize& size, u32 seed, std::vector<u32>& out)
+{
+	std::mt19937 gen(seed);
+	LegacyRoom room;
+	std::vector<u32> allTiles;
+	for (u32 tile = 0; tile < set.tileCount; ++tile)
+	{
+		if ((set.roomTiles[tile >> 6u] >> (tile & 63u)) & 1u)
+			allTiles.push_back(tile);
+	}
+	room.domains.assign(size.Cells(), allTiles);
+
+	const u32 words = set.rules.GetWordCount();
+	for (u32 cell = 0; cell < size.Cells(); ++cell)
+	{
+		bool failed = false;
+		ForEachBoundary(size, cell, [&](u32 dir) { failed = failed || !LegacyRestrict(set, size, room, cell, &set.edgeTiles[dir * words]); });
+		if (failed)
+			return false;
+	}
+
+	std::vector<u64> only(words);
+	while (true)
+	{
+		u32 chosen = size.Cells();
+		size_t fewest = std::numeric_limits<size_t>::max();
+		for (u32 cell = 0; cell < size.Cells(); ++cell)
+		{
+			if (room.domains[cell].size() > 1u && room.domains[cell].size() < fewest)
+			{
+				fewest = room.domains[cell].size();
+				chosen = cell;
+			}
+		}
+		if (chosen == size.Cells())
+			break;
+
+		const u32 tile = room.domains[chosen][std::uniform_int_distribution<size_t>(0u, fewest - 1u)(gen)];
+		std::fill(only.begin(), only.end(), 0u);
+		only[tile >> 6u] = 1ull << (tile & 63u);
+		if (!LegacyRestrict(set, size, room, chosen, only.data()))
+			return false;
+	}
+
+	out.resize(size.Cells());
+	for (u32 cell = 0; cell < size.Cells(); ++cell)
+		out[cell] = room.domains[cell][0];
+	return true;
+}
+
+static bool Solve(const TileSet& set, const RoomSize& size, u32 seed, WFCSolver::Propagation propagation, WFCSolver& solver, std::vector<u32>& out)
+{
+	std::mt19937 gen(seed);
+	solver.Reset(set.rules, size.width, size.height, size.depth, set.roomTiles.data(), propagation);
+
+	const u32 words = set.rules.GetWordCount();
+	for (u32 cell = 0; cell < size.Cells(); ++cell)
+	{
+		bool failed = false;
+		ForEachBoundary(size, cell, [&](u32 dir) { failed = failed || !solver.Restrict(cell, &set.edgeTiles[dir * words], false); });
+		if (failed)
+			return false;
+	}
+	if (!solver.Propagate())
+		return false;
+
+	while (true)
+	{
+		u32 chosen = size.Cells();
+		u32 fewest = std::numeric_limits<u32>::max();
+		for (u32 cell = 0; cell < size.Cells(); ++cell)
+		{
+			const u32 count = solver.Count(cell);
+			if (count > 1u && count < fewest)
+			{
+				fewest = count;
+				chosen = cell;
+			}
+		}
+		if (chosen == size.Cells())
+			break;
+
+		u32 skip = static_cast<u32>(std::uniform_int_distribution<size_t>(0u, fewest - 1u)(gen));
+		u32 tile = 0u;
+		solver.ForEachTile(chosen, [&](u32 candidate)
+			{
+				if (skip-- == 0u)
+					tile = candidate;
+			});
+		if (!solver.Collapse(chosen, tile))
+			return false;
+		solver.ClearChanged();
+	}
+
+	out.resize(size.Cells());
+	for (u32 cell = 0; cell < size.Cells(); ++cell)
+		out[cell] = solver.FirstTile(cell);
+	return true;
+}
+
+struct SolveResult
+{
+	f64 roomsPerSecond = 0.0;
+	u32 succeeded = 0u;
+	std::vector<std::vector<u32>> rooms; //Empty for failed rooms
+};
+
+template<typename SolveRoom>
+static SolveResult Measure(u32 roomCount, SolveRoom&& solveRoom)
+{
+	SolveResult result;
+	result.rooms.resize(roomCount);
+	Timer timer;
+	timer.Start();
+	for (u32 i = 0; i < roomCount; ++i)
+	{
+		if (solveRoom(i, result.rooms[i]))
+			++result.succeeded;
+		else
+			result.rooms[i].clear();
+	}
+	result.roomsPerSecond = roomCount / (timer.Stop() / static_cast<f64>(TimeType::Seconds));
+	return result;
+}
+
+// The sorted list PriorityQueue used to be: a shared_ptr node per cell inserted in order of entropy, Rearrange
+// walks to the cell and reinserts it, the entropy is recomputed over the whole domain and Pop picks randomly among
+// the equal entropies at the front.
+class LegacyQueue
+{
+	struct Node
+	{
+		u32 cell = 0u;
+		f32 entropy = 0.0f;
+		std::shared_ptr<Node> next;
+	};
+
+public:
+	LegacyQueue(const WFCSolver& solver, const WFCRules& rules)
+	{
+		for (u32 cell = 0; cell < solver.GetCellCount(); ++cell)
+		{
+			auto node = std::make_shared<Node>();
+			node->cell = cell;
+			node->entropy = Entropy(cell, solver, rules);
+			Insert(node);
+		}
+	}
+
+	~LegacyQueue()
+	{
+		while (m_first)
+		{
+			std::shared_ptr<Node> next = std::move(m_first->next);
+			m_first = std::move(next);
+		}
+	}
+
+	i32 Pop(std::default_random_engine& gen)
+	{
+		if (!m_first)
+			return -1;
+		u32 count = 1u;
+		for (Node* node = m_first->next.get(); node && node->entropy == m_first->entropy; node = node->next.get())
+			++count;
+
+		std::shared_ptr<Node> previous;
+		std::shared_ptr<Node> current = m_first;
+		for (u32 skip = std::uniform_int_distribution<u32>(0u, count - 1u)(gen); skip > 0u; --skip)
+		{
+			previous = current;
+			current = current->next;
+		}
+		(previous ? previous->next : m_first) = current->next;
+		return static_cast<i32>(current->cell);
+	}
+
+	void Rearrange(u32 cell, const WFCSolver& solver, const WFCRules& rules)
+	{
+		std::shared_ptr<Node> previous;
+		std::shared_ptr<Node> current = m_first;
+		while (current && current->cell != cell)
+		{
+			previous = current;
+			current = current->next;
+		}
+		if (!current)
+			return;
+		(previous ? previous->next : m_first) = current->next;
+		current->next = nullptr;
+		current->entropy = Entropy(cell, solver, rules);
+		Insert(current);
+	}
+
+private:
+	static f32 Entropy(u32 cell, const WFCSolver& solver, const WFCRules& rules)
+	{
+		f32 sumWeights = 0.0f;
+		f32 sumWeightLogWeights = 0.0f;
+		solver.ForEachTile(cell, [&](u32 tile)
+			{
+				const f32 weight = rules.GetWeight(tile) * 100.0f;
+				sumWeights += weight;
+				sumWeightLogWeights += weight * std::log(weight);
+			});
+		return std::log(sumWeights) - sumWeightLogWeights / sumWeights;
+	}
+
+	void Insert(const std::shared_ptr<Node>& node)
+	{
+		std::shared_ptr<Node> previous;
+		std::shared_ptr<Node> current = m_first;
+		while (current && current->entropy < node->entropy)
+		{
+			previous = current;
+			current = current->next;
+		}
+		node->next = current;
+		(previous ? previous->next : m_first) = node;
+	}
+
+	std::shared_ptr<Node> m_first;
+};
+
+// The generation loop of WFC::GenerateRoom on top of the boundary constrained domains, cells are taken from the
+// queue in order of entropy and collapsed to a random tile
+template<typename Queue>
+static bool SolveWithQueue(const TileSet& set, const RoomSize& size, u32 seed, WFCSolver& solver, Queue&& queue)
+{
+	std::default_random_engine gen(seed);
+	for (i32 cell = queue.Pop(gen); cell != -1; cell = queue.Pop(gen))
+	{
+		const u32 count = solver.Count(cell);
+		if (count < 2u)
+			continue;
+
+		u32 skip = std::uniform_int_distribution<u32>(0u, count - 1u)(gen);
+		u32 tile = 0u;
+		solver.ForEachTile(cell, [&](u32 candidate)
+			{
+				if (skip-- == 0u)
+					tile = candidate;
+			});
+		if (!solver.Collapse(cell, tile))
+			return false;
+		for (u32 changed : solver.GetChanged())
+			queue.Rearrange(changed, solver, set.rules);
+		solver.ClearChanged();
+	}
+	return true;
+}
+
+// The generation loop of WFC::GenerateRoom with backtracking, a contradiction takes back the latest decisions until
+// the room is consistent again. Fails when more than maxBacktracks decisions had to be taken back.
+static bool SolveWithBacktracking(u32 seed, u32 maxBacktracks, WFCSolver& solver, PriorityQueue& queue)
+{
+	std::default_random_engine gen(seed);
+	solver.Restart();
+	queue.Reset(solver, seed);
+	u32 backtracks = 0u;
+	for (i32 cell = queue.Pop(); cell != -1; cell = queue.Pop())
+	{
+		const u32 count = solver.Count(cell);
+		if (count == 0u)
+			return false;
+		if (count == 1u)
+			continue;
+
+		u32 skip = std::uniform_int_distribution<u32>(0u, count - 1u)(gen);
+		u32 tile = 0u;
+		solver.ForEachTile(cell, [&](u32 candidate)
+			{
+				if (skip-- == 0u)
+					tile = candidate;
+			});
+		bool consistent = solver.Decide(cell, tile);
+		const bool backtracked = !consistent;
+		while (!consistent && solver.GetDecisionCount() != 0u && backtracks < maxBacktracks)
+		{
+			consistent = solver.Backtrack();
+			++backtracks;
+		}
+		if (!consistent)
+		{
+			solver.ClearChanged();
+			return false;
+		}
+		for (u32 changed : solver.GetChanged())
+		{
+			if (backtracked)
+				queue.Push(changed, solver);
+			else
+				queue.Rearrange(changed, solver);
+		}
+		solver.ClearChanged();
+	}
+	return true;
+}
+
+// Boundary constrained domains for a room, saved so every solve starts from them
+static bool Constrain(const TileSet& set, const RoomSize& size, WFCSolver& solver)
+{
+	solver.Reset(set.rules, size.width, size.height, size.depth, set.roomTiles.data());
+	const u32 words = set.rules.GetWordCount();
+	for (u32 cell = 0; cell < size.Cells(); ++cell)
+		ForEachBoundary(size, cell, [&](u32 dir) { solver.Restrict(cell, &set.edgeTiles[dir * words], false); });
+	if (!solver.Propagate())
+		return false;
+	solver.ClearChanged();
+	solver.SaveStart();
+	return true;
+}
+
+std::string RunWFCBenchmark()
+{
+	constexpr RoomSize roomSizes[] = { { 8u, 5u, 8u }, { 13u, 5u, 13u }, { 20u, 7u, 20u } };
+	constexpr u32 roomCounts[] = { 40u, 20u, 5u };
+
+	std::stringstream report;
+	TileSet level;
+	if (!LoadTileSet("Assets/Levels/largerTest1Output_Floors.txt", level))
+		return "Wave function collapse, could not read Assets/Levels/largerTest1Output_Floors.txt\n";
+
+	const auto header = [&](const std::string& title)
+	{
+		report << title << "\n";
+		report << std::setw(16) << "room" << std::setw(8) << "rooms" << std::setw(10) << "success"
+			<< std::setw(14) << "legacy /s" << std::setw(14) << "bitset /s" << std::setw(14) << "counts /s" << std::setw(10) << "speedup" << "\n";
+	};
+	const auto row = [&](const std::string& name, u32 roomCount, const SolveResult* legacy, const SolveResult& bitset, const SolveResult& counts)
+	{
+		report << std::setw(16) << name << std::setw(8) << roomCount << std::setw(9) << 100u * bitset.succeeded / roomCount << "%"
+			<< std::fixed << std::setprecision(1) << std::setw(14);
+		if (legacy)
+			report << legacy->roomsPerSecond;
+		else
+			report << "-";
+		report << std::setw(14) << bitset.roomsPerSecond << std::setw(14) << counts.roomsPerSecond << std::setprecision(2) << std::setw(9);
+		if (legacy)
+			report << std::max(bitset.roomsPerSecond, counts.roomsPerSecond) / legacy->roomsPerSecond << "x";
+		else
+			report << "-" << " ";
+		if (bitset.rooms != counts.rooms || (legacy && legacy->rooms != bitset.rooms))
+			report << "  (rooms differ!)";
+		report << "\n";
+	};
+
+	const auto sizeName = [](const RoomSize& size)
+	{
+		return std::to_string(size.width) + "x" + std::to_string(size.height) + "x" + std::to_string(size.depth);
+	};
+
+	WFCSolver solver;
+	header("Wave function collapse, vector domains vs. bitset domains (" + std::to_string(level.tileCount) + " blocks from the level input, boundary constraints)");
+	for (u32 i = 0; i < std::size(roomSizes); ++i)
+	{
+		const RoomSize& size = roomSizes[i];
+		const SolveResult legacy = Measure(roomCounts[i], [&](u32 seed, std::vector<u32>& out) { return SolveLegacy(level, size, seed, out); });
+		const SolveResult bitset = Measure(roomCounts[i], [&](u32 seed, std::vector<u32>& out) { return Solve(level, size, seed, WFCSolver::Propagation::Bitset, solver, out); });
+		const SolveResult counts = Measure(roomCounts[i], [&](u32 seed, std::vector<u32>& out) { return Solve(level, size, seed, WFCSolver::Propagation::SupportCount, solver, out); });
+		row(sizeName(size), roomCounts[i], &legacy, bitset, counts);
+	}
+
+	// How the two propagations scale with larger synthetic tile sets, the vector domains are too slow to run at these sizes
+	constexpr u32 syntheticTileCounts[] = { 128u, 256u, 512u, 1024u };
+	constexpr RoomSize syntheticSize = { 8u, 4u, 8u };
+	header("\nSynthetic rules, every pair of blocks fits with probability 0.5 (blocks / room)");
+	for (u32 tileCount : syntheticTileCounts)
+	{
+		TileSet synthetic;
+		CreateTileSet(tileCount, 0.5f, synthetic);
+		const SolveResult bitset = Measure(10u, [&](u32 seed, std::vector<u32>& out) { return Solve(synthetic, syntheticSize, seed, WFCSolver::Propagation::Bitset, solver, out); });
+		const SolveResult counts = Measure(10u, [&](u32 seed, std::vector<u32>& out) { return Solve(synthetic, syntheticSize, seed, WFCSolver::Propagation::SupportCount, solver, out); });
+		row(std::to_string(tileCount) + " / " + sizeName(syntheticSize), 10u, nullptr, bitset, counts);
+	}
+
+	// Only the queue differs here, both runs collapse every cell of the bitset solver. The synthetic rules are used
+	// since most rooms of the level input fail part way through, which would make the runs do different amounts of work.
+	constexpr RoomSize queueSizes[] = { { 13u, 5u, 13u }, { 20u, 7u, 20u }, { 30u, 7u, 30u } };
+	constexpr u32 queueRoomCount = 5u;
+	TileSet queueSet;
+	CreateTileSet(128u, 0.5f, queueSet);
+	report << "\nEntropy queue, sorted list vs. indexed heap (128 synthetic blocks, " << queueRoomCount << " rooms each)\n";
+	report << std::setw(16) << "room" << std::setw(10) << "success" << std::setw(12) << "list ms" << std::setw(12) << "heap ms" << std::setw(10) << "speedup" << "\n";
+	for (const RoomSize& size : queueSizes)
+	{
+		if (!Constrain(queueSet, size, solver))
+			continue;
+
+		PriorityQueue heap;
+		u32 listSucceeded = 0u, heapSucceeded = 0u;
+		Timer timer;
+		timer.Start();
+		for (u32 seed = 0; seed < queueRoomCount; ++seed)
+		{
+			solver.Restart();
+			listSucceeded += SolveWithQueue(queueSet, size, seed, solver, LegacyQueue(solver, queueSet.rules));
+		}
+		const f64 listMs = timer.Stop() / static_cast<f64>(TimeType::Milliseconds) / queueRoomCount;
+
+		// Adapts PriorityQueue to the calls SolveWithQueue makes, the heap breaks ties with its own keys
+		struct HeapQueue
+		{
+			PriorityQueue& heap;
+			i32 Pop(std::default_random_engine&) { return heap.Pop(); }
+			void Rearrange(u32 cell, const WFCSolver& solver, const WFCRules&) { heap.Rearrange(cell, solver); }
+		};
+		timer.Start();
+		for (u32 seed = 0; seed < queueRoomCount; ++seed)
+		{
+			solver.Restart();
+			heap.Reset(solver, seed);
+			heapSucceeded += SolveWithQueue(queueSet, size, seed, solver, HeapQueue{ heap });
+		}
+		const f64 heapMs = timer.Stop() / static_cast<f64>(TimeType::Milliseconds) / queueRoomCount;
+
+		report << std::setw(16) << sizeName(size) << std::setw(4) << listSucceeded << " / " << heapSucceeded
+			<< std::fixed << std::setprecision(2) << std::setw(12) << listMs << std::setw(12) << heapMs << std::setw(9) << listMs / heapMs << "x\n";
+	}
+
+	// A room is attempted with new seeds until it succeeds, at most as many times as WFC::t_GenerateRoom tries.
+	// A budget of 0 is the old generation, every contradiction starts the room over.
+	constexpr u32 backtrackBudgets[] = { 0u, 16u, 64u, 256u };
+	constexpr u32 backtrackRoomCounts[] = { 100u, 40u, 10u };
+	constexpr u32 maxAttempts = 100u;
+	report << "\nBacktracking, whole room retries vs. taking back decisions (level input, ms per room until it succeeds)\n";
+	report << std::setw(16) << "room" << std::setw(10) << "budget" << std::setw(10) << "success" << std::setw(10) << "attempts"
+		<< std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+	PriorityQueue queue;
+	for (u32 i = 0; i < std::size(roomSizes); ++i)
+	{
+		const RoomSize& size = roomSizes[i];
+		if (!Constrain(level, size, solver))
+			continue;
+
+		for (u32 budget : backtrackBudgets)
+		{
+			const u32 roomCount = backtrackRoomCounts[i];
+			std::vector<f64> roomMs;
+			u32 succeeded = 0u, attempts = 0u;
+			for (u32 room = 0; room < roomCount; ++room)
+			{
+				Timer timer;
+				timer.Start();
+				for (u32 attempt = 0; attempt < maxAttempts; ++attempt)
+				{
+					++attempts;
+					if (SolveWithBacktracking(room * maxAttempts + attempt, budget, solver, queue))
+					{
+						++succeeded;
+						break;
+					}
+				}
+				roomMs.push_back(timer.Stop() / static_cast<f64>(TimeType::Milliseconds));
+			}
+
+			std::sort(roomMs.begin(), roomMs.end());
+			const auto percentile = [&](f64 p) { return roomMs[std::min(roomMs.size() - 1u, static_cast<size_t>(p * roomMs.size()))]; };
+			report << std::setw(16) << sizeName(size) << std::setw(10) << budget << std::setw(9) << 100u * succeeded / roomCount << "%"
+				<< std::fixed << std::setprecision(2) << std::setw(10) << static_cast<f64>(attempts) / roomCount
+				<< std::setw(10) << std::accumulate(roomMs.begin(), roomMs.end(), 0.0) / roomCount
+				<< std::setw(10) << percentile(0.5) << std::setw(10) << percentile(0.99) << std::setw(10) << roomMs.back() << "\n";
+		}
+	}
+
+	return report.str();
+}
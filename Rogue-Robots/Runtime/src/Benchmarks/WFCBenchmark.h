@@ -0,0 +1,7 @@
+#pragma once
+#include <DOGEngine.h>
+
+// Wave function collapse rooms from the level input with the boundary constraints, the old vector domains with
+// tile by tile propagation vs. the bitset domains of WFCSolver (OR of support masks and AC-4 support counts),
+// then the sorted list entropy queue vs. the indexed heap, and retrying whole rooms vs. backtracking on contradictions.
+std::string RunWFCBenchmark();
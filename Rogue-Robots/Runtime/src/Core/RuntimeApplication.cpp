@@ -1,5 +1,12 @@
 #include "RuntimeApplication.h"
 #include <EntryPoint.h>
+#include "../Benchmarks/BenchmarkMenu.h"
+#include "../Benchmarks/SystemSchedulerBenchmark.h"
+#include "../Benchmarks/ArchetypeStorageBenchmark.h"
+#include "../Benchmarks/TransformHierarchyBenchmark.h"
+#include "../Benchmarks/PathCacheBenchmark.h"
+#include "../Benchmarks/WFCBenchmark.h"
+#include "../Benchmarks/ECSChecks.h"
 using namespace DOG;
 void SaveRuntimeSettings(const ApplicationSpecification& spec, const GameSettings& gameSettings, const std::string& path) noexcept;
 std::string GetWorkingDirectory();
@@ -25,6 +32,15 @@ void RuntimeApplication::OnStartUp() noexcept
 	//PushLayer(&m_PathfinderDebugLayer);
 	ImGuiMenuLayer::RegisterDebugWindow("GraphicsSetting", [this](bool& open) { SettingDebugMenu(open); }, false, std::make_pair(Key::LCtrl, Key::V));
 
+	RegisterBenchmark("System scheduler", RunSystemSchedulerBenchmark);
+	RegisterBenchmark("Archetype storage", RunArchetypeStorageBenchmark);
+	RegisterBenchmark("Transform hierarchy", RunTransformHierarchyBenchmark);
+	RegisterBenchmark("Path cache", RunPathCacheBenchmark);
+	RegisterBenchmark("Hierarchical paths", RunHierarchicalPathBenchmark);
+	RegisterBenchmark("Wave function collapse", RunWFCBenchmark);
+	RegisterBenchmark("ECS checks", RunECSChecks);
+	ImGuiMenuLayer::RegisterDebugWindow("Benchmarks", [](bool& open) { BenchmarkMenu(open); });
+
 
 	SettingsMenu::Initialize(
 		[this](auto settings) {
@@ -60,6 +76,7 @@ void RuntimeApplication::OnShutDown() noexcept
 {
 	//SaveRuntimeSettings();
 	ImGuiMenuLayer::UnRegisterDebugWindow("GraphicsSetting");
+	ImGuiMenuLayer::UnRegisterDebugWindow("Benchmarks");
 	SaveRuntimeSettings(GetApplicationSpecification(), m_gameLayer.GetGameSettings(), "Settings.lua");
 }
 
@@ -10,14 +10,25 @@ using namespace DirectX::SimpleMath;
 *			Early Update Systems
 ***************************************************/
 
-void AgentBehaviorTreeSystem::OnEarlyUpdate(entity agent, AgentIdComponent&, BehaviorTreeComponent& btc)
+void AgentBehaviorTreeSystem::EarlyUpdate() noexcept
 {
-	ASSERT(btc.currentRunningNode, "Current running node is nullptr!");
+	BehaviorTree::BeginFrame();
+	EntityManager::Get().Collect<AgentIdComponent, BehaviorTreeComponent>().Do([](entity agent, AgentIdComponent&, BehaviorTreeComponent& btc)
+		{
+			BehaviorTree::Process(agent, btc);
+		});
+}
 
-	btc.currentRunningNode->Process(agent);
+AgentDistanceToPlayersSystem::AgentDistanceToPlayersSystem()
+{
+	//Runs in parallel, so every pool the loop reads from has to exist before the first update
+	EntityManager::Get().ExpandAsTupleArguments<PlayerAliveComponent>();
+	EntityManager::Get().ExpandAsTupleArguments<ThisPlayer>();
+	EntityManager::Get().ExpandAsTupleArguments<NetworkPlayerComponent>();
+	EntityManager::Get().ExpandAsTupleArguments<PointLightComponent>();
 }
 
-void AgentDistanceToPlayersSystem::OnEarlyUpdate(entity agent, BTDistanceToPlayerComponent&, AgentTargetMetricsComponent& atmc,
+void AgentDistanceToPlayersSystem::OnEarlyUpdate(entity agent, AgentTargetMetricsComponent& atmc,
 	AgentIdComponent& aidc, TransformComponent& tc, BehaviorTreeComponent& btc)
 {
 	//System checks the (non-squared) distance to every living player.
@@ -49,75 +60,96 @@ void AgentDistanceToPlayersSystem::OnEarlyUpdate(entity agent, BTDistanceToPlaye
 			atLeastOneWithinAudioRange = atLeastOneWithinAudioRange || (atmc.playerData.back().distanceFromAgent <= AUDIO_RANGE);
 		});
 
-	//Only one per group is played
-	EntityManager::Get().Collect<AgentOnStandbyAudioComponent, AgentIdComponent>().Do([&](AgentOnStandbyAudioComponent, AgentIdComponent agentId)
+	//The on standby audio and the behavior tree step are structural changes, they run after every agent has been measured.
+	//Agents are still handled one at a time in there, so "only one per group" sees the audio started by earlier agents this frame.
+	u16 currentLeaf = btc.currentRunningNode;
+	u32 agentId = aidc.id;
+	EntityManager::Get().Defer([agent, agentId, currentLeaf, atLeastOneWithinAudioRange, atLeastOneWithinRange]() mutable
 		{
-			AgentManager& am = AgentManager::Get();
-			u32 myGroup = am.GroupID(agentId.id);
-			u32 agentGroup = am.GroupID(aidc.id);
-
-			if (agentId.id == aidc.id)
-				return;
+			//Only one per group is played
+			if (atLeastOneWithinAudioRange)
+			{
+				EntityManager::Get().Collect<AgentOnStandbyAudioComponent, AgentIdComponent>().Do([&](AgentOnStandbyAudioComponent, AgentIdComponent otherAgentId)
+					{
+						AgentManager& am = AgentManager::Get();
+						u32 myGroup = am.GroupID(otherAgentId.id);
+						u32 agentGroup = am.GroupID(agentId);
 
-			atLeastOneWithinAudioRange = (myGroup != agentGroup) && atLeastOneWithinAudioRange;
-		});
+						if (otherAgentId.id == agentId)
+							return;
 
-	//Add audiocomponent if wihtin range or else remove it
-	entity e = agent;
-	if (atLeastOneWithinAudioRange)
-	{
-		if (!EntityManager::Get().HasComponent<AgentAggroComponent>(e))
-		{
-			if (!EntityManager::Get().HasComponent<AgentOnStandbyAudioComponent>(e))
-			{
-				auto& agentOnStandbyComponent = EntityManager::Get().AddComponent<AgentOnStandbyAudioComponent>(e);
-				agentOnStandbyComponent.agentOnStandbyAudioEntity = EntityManager::Get().CreateEntity();
-
-				entity audioEntity = agentOnStandbyComponent.agentOnStandbyAudioEntity;
-				EntityManager::Get().AddComponent<TransformComponent>(audioEntity);
-				EntityManager::Get().AddComponent<ChildComponent>(audioEntity).parent = e;
-				EntityManager::Get().AddComponent<SceneComponent>(audioEntity, EntityManager::Get().GetComponent<SceneComponent>(e).scene);
-				EntityManager::Get().AddComponent<DOG::AudioComponent>(audioEntity);
+						atLeastOneWithinAudioRange = (myGroup != agentGroup) && atLeastOneWithinAudioRange;
+					});
 			}
 
-			auto& onStandbyAudio = EntityManager::Get().GetComponent<DOG::AudioComponent>(EntityManager::Get().GetComponent<AgentOnStandbyAudioComponent>(e).agentOnStandbyAudioEntity);
-			if (!onStandbyAudio.playing)
+			//Add audiocomponent if wihtin range or else remove it
+			entity e = agent;
+			if (atLeastOneWithinAudioRange)
 			{
-				onStandbyAudio.assetID = AssetManager::Get().LoadAudio("Assets/Audio/Enemy/OnStandby.wav");
-				onStandbyAudio.shouldPlay = true;
-				onStandbyAudio.volume = 1.0f;
-				onStandbyAudio.is3D = true;
-				onStandbyAudio.loop = true;
+				if (!EntityManager::Get().GetComponent<AgentAggroComponent>(e).active)
+				{
+					const auto startOnStandbyAudio = [](DOG::AudioComponent& onStandbyAudio)
+					{
+						onStandbyAudio.assetID = AssetManager::Get().LoadAudio("Assets/Audio/Enemy/OnStandby.wav");
+						onStandbyAudio.shouldPlay = true;
+						onStandbyAudio.volume = 1.0f;
+						onStandbyAudio.is3D = true;
+						onStandbyAudio.loop = true;
+					};
+
+					if (!EntityManager::Get().HasComponent<AgentOnStandbyAudioComponent>(e))
+					{
+						//The marker on the agent is added right away for the group check, the audio entity is filled in at the next playback
+						entity audioEntity = EntityManager::Get().CreateEntity();
+						EntityManager::Get().AddComponent<AgentOnStandbyAudioComponent>(e).agentOnStandbyAudioEntity = audioEntity;
+
+						ChildComponent child;
+						child.parent = e;
+						DOG::AudioComponent onStandbyAudio;
+						startOnStandbyAudio(onStandbyAudio);
+
+						auto& commands = EntityManager::Get().GetCommandBuffer();
+						commands.AddComponent<TransformComponent>(audioEntity);
+						commands.AddComponent<ChildComponent>(audioEntity, std::move(child));
+						commands.AddComponent<SceneComponent>(audioEntity, EntityManager::Get().GetComponent<SceneComponent>(e).scene);
+						commands.AddComponent<DOG::AudioComponent>(audioEntity, std::move(onStandbyAudio));
+					}
+					else
+					{
+						auto& onStandbyAudio = EntityManager::Get().GetComponent<DOG::AudioComponent>(EntityManager::Get().GetComponent<AgentOnStandbyAudioComponent>(e).agentOnStandbyAudioEntity);
+						if (!onStandbyAudio.playing)
+							startOnStandbyAudio(onStandbyAudio);
+					}
+				}
+				else
+				{
+					if (EntityManager::Get().HasComponent<AgentOnStandbyAudioComponent>(e))
+					{
+						auto& onStandbyAudio = EntityManager::Get().GetComponent<DOG::AudioComponent>(EntityManager::Get().GetComponent<AgentOnStandbyAudioComponent>(e).agentOnStandbyAudioEntity);
+						onStandbyAudio.shouldStop = true;
+					}
+				}
 			}
-		}
-		else
-		{
-			if (EntityManager::Get().HasComponent<AgentOnStandbyAudioComponent>(e))
+			else
 			{
-				auto& onStandbyAudio = EntityManager::Get().GetComponent<DOG::AudioComponent>(EntityManager::Get().GetComponent<AgentOnStandbyAudioComponent>(e).agentOnStandbyAudioEntity);
-				onStandbyAudio.shouldStop = true;
-			}
-		}
-	}
-	else
-	{
-		if (EntityManager::Get().HasComponent<AgentOnStandbyAudioComponent>(e))
-		{
-			auto& agentOnStandbyComponent = EntityManager::Get().GetComponent<AgentOnStandbyAudioComponent>(e);
+				if (EntityManager::Get().HasComponent<AgentOnStandbyAudioComponent>(e))
+				{
+					auto& agentOnStandbyComponent = EntityManager::Get().GetComponent<AgentOnStandbyAudioComponent>(e);
 
-			EntityManager::Get().DeferredEntityDestruction(agentOnStandbyComponent.agentOnStandbyAudioEntity);
+					EntityManager::Get().DeferredEntityDestruction(agentOnStandbyComponent.agentOnStandbyAudioEntity);
 
-			EntityManager::Get().RemoveComponent<AgentOnStandbyAudioComponent>(e);
-		}
-	}
+					EntityManager::Get().RemoveComponent<AgentOnStandbyAudioComponent>(e);
+				}
+			}
 
-	if (atLeastOneWithinRange)
-		LEAF(btc.currentRunningNode)->Succeed(agent);
-	else
-		LEAF(btc.currentRunningNode)->Fail(agent);
+			if (atLeastOneWithinRange)
+				BehaviorTree::Succeed(agent, currentLeaf);
+			else
+				BehaviorTree::Fail(agent, currentLeaf);
+		});
 }
 
-void AgentLineOfSightToPlayerSystem::OnEarlyUpdate(entity agent, BTLineOfSightToPlayerComponent&, AgentTargetMetricsComponent& atmc,
+void AgentLineOfSightToPlayerSystem::OnEarlyUpdate(entity agent, AgentTargetMetricsComponent& atmc,
 	AgentIdComponent& aidc, TransformComponent& tc, BehaviorTreeComponent& btc)
 {
 	const AgentManager::AgentStats stats = AgentManager::Get().GetAgentStats(aidc.type);
@@ -175,12 +207,12 @@ void AgentLineOfSightToPlayerSystem::OnEarlyUpdate(entity agent, BTLineOfSightTo
 	}
 
 	if (atLeastOneHasLineOfSight)
-		LEAF(btc.currentRunningNode)->Succeed(agent);
+		BehaviorTree::Succeed(agent, btc.currentRunningNode);
 	else
-		LEAF(btc.currentRunningNode)->Fail(agent);
+		BehaviorTree::Fail(agent, btc.currentRunningNode);
 }	
 
-void AgentDetectPlayerSystem::OnEarlyUpdate(entity agentID, BTDetectPlayerComponent&, AgentSeekPlayerComponent& seek, 
+void AgentDetectPlayerSystem::OnEarlyUpdate(entity agentID, AgentSeekPlayerComponent& seek, 
 	AgentIdComponent& agent, TransformComponent& transform, AgentTargetMetricsComponent& atmc, BehaviorTreeComponent& btc)
 {
 	/*This system will determine the aggro focus, if any, of the agent.
@@ -209,7 +241,7 @@ void AgentDetectPlayerSystem::OnEarlyUpdate(entity agentID, BTDetectPlayerCompon
 	if (potentialTargets.empty())
 	{
 		seek.entityID = NULL_ENTITY;
-		LEAF(btc.currentRunningNode)->Fail(agentID);
+		BehaviorTree::Fail(agentID, btc.currentRunningNode);
 		return;
 	}
 
@@ -220,7 +252,7 @@ void AgentDetectPlayerSystem::OnEarlyUpdate(entity agentID, BTDetectPlayerCompon
 	seek.distanceToPlayer = finalTarget.distanceFromAgent;
 	seek.direction = transform.GetPosition() - finalTarget.position;
 
-	LEAF(btc.currentRunningNode)->Succeed(agentID);
+	BehaviorTree::Succeed(agentID, btc.currentRunningNode);
 }
 
 const bool AgentDetectPlayerSystem::IsPotentialTarget(const AgentTargetMetricsComponent::PlayerData& playerData, const AgentManager::AgentStats& stats) noexcept
@@ -239,7 +271,7 @@ const bool AgentDetectPlayerSystem::IsPotentialTarget(const AgentTargetMetricsCo
 		return false;
 }
 
-void AgentDetectHitSystem::OnEarlyUpdate(entity agentID, BTHitDetectComponent&, AgentSeekPlayerComponent& seek,
+void AgentDetectHitSystem::OnEarlyUpdate(entity agentID, AgentSeekPlayerComponent& seek,
 	AgentIdComponent& agent, TransformComponent& transform, AgentTargetMetricsComponent& atmc, BehaviorTreeComponent& btc)
 {
 	/*This system will determine the aggro focus, if any, of the agent.
@@ -268,7 +300,7 @@ void AgentDetectHitSystem::OnEarlyUpdate(entity agentID, BTHitDetectComponent&,
 	if (potentialTargets.empty())
 	{
 		seek.entityID = NULL_ENTITY;
-		LEAF(btc.currentRunningNode)->Fail(agentID);
+		BehaviorTree::Fail(agentID, btc.currentRunningNode);
 		return;
 	}
 
@@ -281,35 +313,40 @@ void AgentDetectHitSystem::OnEarlyUpdate(entity agentID, BTHitDetectComponent&,
 
 	EntityManager& em = EntityManager::Get();
 
-	if (!em.HasComponent<AgentAggroComponent>(agentID))
+	if (AgentAggroComponent& aggro = em.GetComponent<AgentAggroComponent>(agentID); !aggro.active)
 	{
-		em.AddComponent<AgentAggroComponent>(agentID);
+		aggro.Trigger();
 		if (!em.HasComponent<PathFindingSync>(agentID))
 		{
 			em.AddComponent<PathFindingSync>(agentID).id = em.GetComponent<AgentIdComponent>(agentID);
 			em.GetComponent<PathFindingSync>(agentID).id.id = em.GetComponent<PathFindingSync>(agentID).id.id | AGGRO_BIT;
 		}
 	}
-	LEAF(btc.currentRunningNode)->Succeed(agentID);
+	BehaviorTree::Succeed(agentID, btc.currentRunningNode);
 }
 
-void AgentGetPathSystem::OnEarlyUpdate(entity e, BTGetPathComponent&, AgentSeekPlayerComponent& seek, BehaviorTreeComponent& btc)
+void AgentGetPathSystem::OnEarlyUpdate(entity e, AgentSeekPlayerComponent& seek, BehaviorTreeComponent& btc)
 {
 	EntityManager& em = EntityManager::Get();
-	em.AddOrGetComponent<PathfinderWalkComponent>(e).goal = em.GetComponent<TransformComponent>(seek.entityID).GetPosition();
+	PathfinderWalkComponent& pfc = em.AddOrGetComponent<PathfinderWalkComponent>(e);
+	pfc.goal = em.GetComponent<TransformComponent>(seek.entityID).GetPosition();
+	AgentManager& am = AgentManager::Get();
+	const AgentIdComponent& agent = em.GetComponent<AgentIdComponent>(e);
+	pfc.flowTarget = am.GetAgentStats(agent.type).flowField && am.IsSwarm(am.GroupID(agent.id)) ? seek.entityID : NULL_ENTITY;
 	
-	LEAF(btc.currentRunningNode)->Succeed(e);
+	BehaviorTree::Succeed(e, btc.currentRunningNode);
 }
 
-void AgentCreatePatrolSystem::OnEarlyUpdate(entity e, BTCreatePatrolComponent&, BehaviorTreeComponent& btc)
+void AgentCreatePatrolSystem::OnEarlyUpdate(entity e, BehaviorTreeComponent& btc)
 {
 	EntityManager& em = EntityManager::Get();
 
-	if (em.HasComponent<AgentPatrolComponent>(e))
-		LEAF(btc.currentRunningNode)->Fail(e);
+	AgentPatrolComponent& patrol = em.GetComponent<AgentPatrolComponent>(e);
+	if (patrol.active)
+		BehaviorTree::Fail(e, btc.currentRunningNode);
 	else
 	{
-		AgentPatrolComponent& patrol = em.AddComponent<AgentPatrolComponent>(e);
+		patrol.active = true;
 		patrol.timer = Time::ElapsedTime();
 		size_t agentID = em.GetComponent<AgentIdComponent>(e).id;
 		i32 dir = 1 - (2 * (agentID % 2));  // 1 or -1
@@ -318,7 +355,7 @@ void AgentCreatePatrolSystem::OnEarlyUpdate(entity e, BTCreatePatrolComponent&,
 		patrol.turnSpeed = patrol.ratio * static_cast<f32>(dir) * 3.1415f;
 		patrol.orientation = patrol.turnSpeed;
 
-		LEAF(btc.currentRunningNode)->Succeed(e);
+		BehaviorTree::Succeed(e, btc.currentRunningNode);
 	}
 }
 
@@ -327,7 +364,7 @@ void AgentCreatePatrolSystem::OnEarlyUpdate(entity e, BTCreatePatrolComponent&,
 *				Regular Systems
 ***************************************************/
 
-void AgentAttackSystem::OnUpdate(entity e, BTAttackComponent&, BehaviorTreeComponent& btc, 
+void AgentAttackSystem::OnUpdate(entity e, BehaviorTreeComponent& btc, 
 	AgentAttackComponent& attack, AgentSeekPlayerComponent& seek)
 {
 	if (seek.HasTarget() && attack.Ready()
@@ -356,13 +393,13 @@ void AgentAttackSystem::OnUpdate(entity e, BTAttackComponent&, BehaviorTreeCompo
 		// Reset cooldown
 		attack.timeOfLast = Time::ElapsedTime();
 
-		LEAF(btc.currentRunningNode)->Succeed(e);
+		BehaviorTree::Succeed(e, btc.currentRunningNode);
 	}
 	else
-		LEAF(btc.currentRunningNode)->Fail(e);
+		BehaviorTree::Fail(e, btc.currentRunningNode);
 }
 
-void AgentJumpAtPlayerSystem::OnUpdate(entity e, BTJumpAtPlayerComponent&, BehaviorTreeComponent& btc,
+void AgentJumpAtPlayerSystem::OnUpdate(entity e, BehaviorTreeComponent& btc,
 	AgentAttackComponent& attack, AgentSeekPlayerComponent& seek)
 {
 	if (seek.HasTarget() && attack.Ready()
@@ -393,13 +430,13 @@ void AgentJumpAtPlayerSystem::OnUpdate(entity e, BTJumpAtPlayerComponent&, Behav
 		movement.forward *= movement.currentSpeed;
 		rb.linearVelocity = movement.forward;
 
-		LEAF(btc.currentRunningNode)->Succeed(e);
+		BehaviorTree::Succeed(e, btc.currentRunningNode);
 	}
 	else
-		LEAF(btc.currentRunningNode)->Fail(e);
+		BehaviorTree::Fail(e, btc.currentRunningNode);
 }
 
-void AgentPullBackSystem::OnUpdate(entity e, BTPullBackComponent&, BehaviorTreeComponent& btc,
+void AgentPullBackSystem::OnUpdate(entity e, BehaviorTreeComponent& btc,
 	AgentAttackComponent& attack, AgentSeekPlayerComponent& seek)
 {
 	if (seek.HasTarget() && !attack.Ready()
@@ -433,13 +470,13 @@ void AgentPullBackSystem::OnUpdate(entity e, BTPullBackComponent&, BehaviorTreeC
 		back.z *= -1;
 		rb.linearVelocity = back;
 
-		LEAF(btc.currentRunningNode)->Succeed(e);
+		BehaviorTree::Succeed(e, btc.currentRunningNode);
 	}
 	else
-		LEAF(btc.currentRunningNode)->Fail(e);
+		BehaviorTree::Fail(e, btc.currentRunningNode);
 }
 
-void AgentDodgeSystem::OnUpdate(entity e, BTDodgeComponent&, BehaviorTreeComponent& btc,
+void AgentDodgeSystem::OnUpdate(entity e, BehaviorTreeComponent& btc,
 	AgentAttackComponent& attack, AgentSeekPlayerComponent& seek)
 {
 	if (seek.HasTarget() && seek.distanceToPlayer <= attack.radius && attack.Ready())
@@ -449,10 +486,10 @@ void AgentDodgeSystem::OnUpdate(entity e, BTDodgeComponent&, BehaviorTreeCompone
 		// Reset cooldown
 		attack.timeOfLast = Time::ElapsedTime();
 
-		LEAF(btc.currentRunningNode)->Succeed(e);
+		BehaviorTree::Succeed(e, btc.currentRunningNode);
 	}
 	else
-		LEAF(btc.currentRunningNode)->Fail(e);
+		BehaviorTree::Fail(e, btc.currentRunningNode);
 }
 
 void AgentHitDetectionSystem::OnUpdate(entity e, HasEnteredCollisionComponent& collision, AgentSeekPlayerComponent& seek)
@@ -669,17 +706,22 @@ void AgentFrostTimerSystem::OnUpdate(entity e, AgentMovementComponent& movement,
 	frostEffect.frostTimer -= (float)Time::DeltaTime();
 	if (frostEffect.frostTimer <= 0.0f)
 	{
+		//Runs next to other systems, so the structural changes go through the command buffer
 		movement.currentSpeed = AgentManager::Get().GetAgentStats(idc.type).baseSpeed;
-		EntityManager::Get().DeferredEntityDestruction(frostEffect.frostAudioEntity);
-		EntityManager::Get().RemoveComponent<FrostEffectComponent>(e);
+		EntityManager::Get().GetCommandBuffer().AddComponent<DeferredDeletionComponent>(frostEffect.frostAudioEntity);
+		EntityManager::Get().GetCommandBuffer().RemoveComponent<FrostEffectComponent>(e);
 	}
 }
 
-void AgentAggroSystem::OnUpdate(entity e, BTAggroComponent&, AgentAggroComponent& aggro, AgentIdComponent& agent)
+void AgentAggroSystem::OnUpdate(entity e, AgentAggroComponent& aggro, AgentIdComponent& agent)
 {
 	constexpr float minutes = 1.3f;
 	constexpr f64 maxAggroTime = minutes * 60.0;
 
+	//Waits like before, when the leaf needed the component to be present
+	if (!aggro.active)
+		return;
+
 	EntityManager& em = EntityManager::Get();
 	AgentManager& am = AgentManager::Get();
 
@@ -691,7 +733,7 @@ void AgentAggroSystem::OnUpdate(entity e, BTAggroComponent&, AgentAggroComponent
 	auto& btc = em.GetComponent<BehaviorTreeComponent>(e);
 	if ((Time::ElapsedTime() - aggro.timeTriggered) > maxAggroTime)
 	{
-		em.RemoveComponent<AgentAggroComponent>(e);
+		aggro.active = false;
 		em.RemoveComponentIfExists<AgentAggroAudioComponent>(e);
 		if (!em.HasComponent<PathFindingSync>(e))
 		{
@@ -699,7 +741,7 @@ void AgentAggroSystem::OnUpdate(entity e, BTAggroComponent&, AgentAggroComponent
 			em.GetComponent<PathFindingSync>(e).id.id = em.GetComponent<PathFindingSync>(e).id.id | AGGRO_BIT;
 		}
 		em.RemoveComponentIfExists<AgentAttackComponent>(e);
-		LEAF(btc.currentRunningNode)->Fail(e);
+		BehaviorTree::Fail(e, btc.currentRunningNode);
 	}
 	else
 	{
@@ -709,15 +751,14 @@ void AgentAggroSystem::OnUpdate(entity e, BTAggroComponent&, AgentAggroComponent
 
 		// Give aggro component to the group
 		bool signaledAnotherAgent = false;
-		em.Collect<AgentIdComponent>().Do(
-			[&](entity o, AgentIdComponent& other)
+		em.Collect<AgentIdComponent, AgentAggroComponent>().Do(
+			[&](entity o, AgentIdComponent& other, AgentAggroComponent& otherAggro)
 			{
 				u32 otherGroup = am.GroupID(other.id);
 				if (myGroup == otherGroup && !em.HasComponent<AgentAlertComponent>(o))
 				{
 					em.AddComponent<AgentAlertComponent>(o);
-					if (!em.HasComponent<AgentAggroComponent>(o))
-						em.AddComponent<AgentAggroComponent>(o);
+					otherAggro.Trigger();
 					if (!em.HasComponent<PathFindingSync>(o))
 					{
 						em.AddComponent<PathFindingSync>(o).id = EntityManager::Get().GetComponent<AgentIdComponent>(o);
@@ -729,10 +770,10 @@ void AgentAggroSystem::OnUpdate(entity e, BTAggroComponent&, AgentAggroComponent
 		);
 		if (signaledAnotherAgent)
 		{
-			LEAF(btc.currentRunningNode)->Succeed(e);
+			BehaviorTree::Succeed(e, btc.currentRunningNode);
 		}
 		else
-			LEAF(btc.currentRunningNode)->Fail(e);
+			BehaviorTree::Fail(e, btc.currentRunningNode);
 
 		if (!EntityManager::Get().HasComponent<AgentAggroAudioComponent>(e))
 		{
@@ -770,12 +811,12 @@ AgentMovementSystem::AgentMovementSystem()
 	m_walkingSounds.push_back(AssetManager::Get().LoadAudio("Assets/Audio/Enemy/Walking_6.wav"));
 }
 
-void AgentMovementSystem::OnLateUpdate(entity e, BTMoveToPlayerComponent&, BehaviorTreeComponent& btc, 
+void AgentMovementSystem::OnLateUpdate(entity e, BehaviorTreeComponent& btc, 
 	AgentMovementComponent& movement, AgentSeekPlayerComponent& seek, PathfinderWalkComponent& pfc, 
 	RigidbodyComponent& rb, TransformComponent& trans)
 {
 	if (pfc.path.size() == 0)
-		LEAF(btc.currentRunningNode)->Fail(e);
+		EntityManager::Get().Defer([e, currentLeaf = btc.currentRunningNode]() { BehaviorTree::Fail(e, currentLeaf); });
 	else if (seek.entityID != NULL_ENTITY && 5.0f < seek.distanceToPlayer)	// TODO: hardcoded 5 for now - change to dynamic value
 	{
 		movement.forward = pfc.path[0] - trans.GetPosition();
@@ -806,21 +847,25 @@ void AgentMovementSystem::OnLateUpdate(entity e, BTMoveToPlayerComponent&, Behav
 		rb.linearVelocity.x = movement.forward.x;
 		rb.linearVelocity.z = movement.forward.z;
 
-		LEAF(btc.currentRunningNode)->Succeed(e);
+		//Behavior tree steps and the walking audio add/remove components, they run once every agent has moved
+		EntityManager::Get().Defer([this, e, currentLeaf = btc.currentRunningNode]()
+			{
+				BehaviorTree::Succeed(e, currentLeaf);
 
-		if (!EntityManager::Get().HasComponent<DOG::AudioComponent>(e))
-		{
-			EntityManager::Get().AddComponent<DOG::AudioComponent>(e).is3D = true;
-		}
-		
-		auto& audio = EntityManager::Get().GetComponent<DOG::AudioComponent>(e);
-		if (!audio.playing)
-		{
-			int walkingSoundIndex = rand() % m_walkingSounds.size();
-			audio.assetID = m_walkingSounds[walkingSoundIndex];
-			audio.shouldPlay = true;
-			audio.volume = 0.5f;
-		}
+				if (!EntityManager::Get().HasComponent<DOG::AudioComponent>(e))
+				{
+					EntityManager::Get().AddComponent<DOG::AudioComponent>(e).is3D = true;
+				}
+
+				auto& audio = EntityManager::Get().GetComponent<DOG::AudioComponent>(e);
+				if (!audio.playing)
+				{
+					int walkingSoundIndex = rand() % m_walkingSounds.size();
+					audio.assetID = m_walkingSounds[walkingSoundIndex];
+					audio.shouldPlay = true;
+					audio.volume = 0.5f;
+				}
+			});
 	}
 	else
 	{
@@ -838,7 +883,7 @@ void AgentMovementSystem::OnLateUpdate(entity e, BTMoveToPlayerComponent&, Behav
 	}
 }
 
-void AgentExecutePatrolSystem::OnLateUpdate(entity agentID, BTExecutePatrolComponent&, 
+void AgentExecutePatrolSystem::OnLateUpdate(entity agentID, 
 	AgentPatrolComponent& patrol, BehaviorTreeComponent& btc, AgentMovementComponent& movement,
 	DOG::RigidbodyComponent& rb, DOG::TransformComponent& trans)
 {
@@ -858,7 +903,7 @@ void AgentExecutePatrolSystem::OnLateUpdate(entity agentID, BTExecutePatrolCompo
 		patrol.timer = Time::ElapsedTime();
 	}
 
-	LEAF(btc.currentRunningNode)->Succeed(agentID);
+	BehaviorTree::Succeed(agentID, btc.currentRunningNode);
 }
 
 
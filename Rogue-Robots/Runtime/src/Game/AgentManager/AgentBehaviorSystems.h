@@ -4,6 +4,38 @@
 #include "BehaviorTree.h"
 #include "AgentManager.h"
 
+// Leaf systems go over the agents whose behavior tree waits on their leaf (see BehaviorTree::ForEachWaiting),
+// the components are passed like for the ON_*_ID systems
+#define ON_EARLY_UPDATE_LEAF(leaf, ...)																							\
+	void EarlyUpdate() noexcept override final																					\
+	{																															\
+		BehaviorTree::ForEachWaiting<__VA_ARGS__>(leaf, [this](DOG::entity e, auto&... components) { OnEarlyUpdate(e, components...); });	\
+	}
+
+#define ON_EARLY_UPDATE_LEAF_PARALLEL(leaf, ...)																				\
+	void EarlyUpdate() noexcept override final																					\
+	{																															\
+		BehaviorTree::ForEachWaitingParallel<__VA_ARGS__>(leaf, [this](DOG::entity e, auto&... components) { OnEarlyUpdate(e, components...); });	\
+	}
+
+#define ON_UPDATE_LEAF(leaf, ...)																								\
+	void Update() noexcept override final																						\
+	{																															\
+		BehaviorTree::ForEachWaiting<__VA_ARGS__>(leaf, [this](DOG::entity e, auto&... components) { OnUpdate(e, components...); });		\
+	}
+
+#define ON_LATE_UPDATE_LEAF(leaf, ...)																							\
+	void LateUpdate() noexcept override final																					\
+	{																															\
+		BehaviorTree::ForEachWaiting<__VA_ARGS__>(leaf, [this](DOG::entity e, auto&... components) { OnLateUpdate(e, components...); });	\
+	}
+
+#define ON_LATE_UPDATE_LEAF_PARALLEL(leaf, ...)																					\
+	void LateUpdate() noexcept override final																					\
+	{																															\
+		BehaviorTree::ForEachWaitingParallel<__VA_ARGS__>(leaf, [this](DOG::entity e, auto&... components) { OnLateUpdate(e, components...); });	\
+	}
+
 /**************************************************
 *			Early Update Systems
 ***************************************************/
@@ -12,24 +44,25 @@ class AgentBehaviorTreeSystem : public DOG::ISystem
 {
 public:
 	SYSTEM_CLASS(AgentIdComponent, BehaviorTreeComponent);
-	ON_EARLY_UPDATE_ID(AgentIdComponent, BehaviorTreeComponent);
-	void OnEarlyUpdate(DOG::entity agent, AgentIdComponent&, BehaviorTreeComponent& btc);
+	// Starts the leaf lists of the frame over, then every tree runs from where it stopped
+	void EarlyUpdate() noexcept override final;
 };
 
 class AgentDistanceToPlayersSystem : public DOG::ISystem
 {
 public:
-	SYSTEM_CLASS(BTDistanceToPlayerComponent, AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
-	ON_EARLY_UPDATE_ID(BTDistanceToPlayerComponent, AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
-	void OnEarlyUpdate(DOG::entity e, BTDistanceToPlayerComponent&, AgentTargetMetricsComponent& atmc, AgentIdComponent& aidc, DOG::TransformComponent& tc, BehaviorTreeComponent& btc);
+	AgentDistanceToPlayersSystem();
+	SYSTEM_CLASS(AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
+	ON_EARLY_UPDATE_LEAF_PARALLEL(LeafType::DistanceToPlayer, AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
+	void OnEarlyUpdate(DOG::entity e, AgentTargetMetricsComponent& atmc, AgentIdComponent& aidc, DOG::TransformComponent& tc, BehaviorTreeComponent& btc);
 };
 
 class AgentLineOfSightToPlayerSystem : public DOG::ISystem
 {
 public:
-	SYSTEM_CLASS(BTLineOfSightToPlayerComponent, AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
-	ON_EARLY_UPDATE_ID(BTLineOfSightToPlayerComponent, AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
-	void OnEarlyUpdate(DOG::entity e, BTLineOfSightToPlayerComponent&, AgentTargetMetricsComponent& atmc, AgentIdComponent& aidc, DOG::TransformComponent& tc, BehaviorTreeComponent& btc);
+	SYSTEM_CLASS(AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
+	ON_EARLY_UPDATE_LEAF(LeafType::LineOfSightToPlayer, AgentTargetMetricsComponent, AgentIdComponent, DOG::TransformComponent, BehaviorTreeComponent);
+	void OnEarlyUpdate(DOG::entity e, AgentTargetMetricsComponent& atmc, AgentIdComponent& aidc, DOG::TransformComponent& tc, BehaviorTreeComponent& btc);
 };
 
 class AgentDetectPlayerSystem: public DOG::ISystem
@@ -37,9 +70,9 @@ class AgentDetectPlayerSystem: public DOG::ISystem
 	using Vector3 = DirectX::SimpleMath::Vector3;
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
-	SYSTEM_CLASS(BTDetectPlayerComponent, AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
-	ON_EARLY_UPDATE_ID(BTDetectPlayerComponent, AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
-	void OnEarlyUpdate(DOG::entity e, BTDetectPlayerComponent&, AgentSeekPlayerComponent& seek, 
+	SYSTEM_CLASS(AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
+	ON_EARLY_UPDATE_LEAF(LeafType::DetectPlayer, AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
+	void OnEarlyUpdate(DOG::entity e, AgentSeekPlayerComponent& seek, 
 		AgentIdComponent& agent, DOG::TransformComponent& transform, AgentTargetMetricsComponent& atmc, BehaviorTreeComponent& btc);
 	[[nodiscard]] const bool IsPotentialTarget(const AgentTargetMetricsComponent::PlayerData& playerData, const AgentManager::AgentStats& stats) noexcept;
 };
@@ -47,26 +80,26 @@ public:
 class AgentDetectHitSystem : public DOG::ISystem
 {
 public:
-	SYSTEM_CLASS(BTHitDetectComponent, AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
-	ON_EARLY_UPDATE_ID(BTHitDetectComponent, AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
-	void OnEarlyUpdate(DOG::entity agentID, BTHitDetectComponent&, AgentSeekPlayerComponent& seek,
+	SYSTEM_CLASS(AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
+	ON_EARLY_UPDATE_LEAF(LeafType::DetectHit, AgentSeekPlayerComponent, AgentIdComponent, DOG::TransformComponent, AgentTargetMetricsComponent, BehaviorTreeComponent);
+	void OnEarlyUpdate(DOG::entity agentID, AgentSeekPlayerComponent& seek,
 		AgentIdComponent& agent, DOG::TransformComponent& transform, AgentTargetMetricsComponent& atmc, BehaviorTreeComponent& btc);
 };
 
 class AgentGetPathSystem : public DOG::ISystem
 {
 public:
-	SYSTEM_CLASS(BTGetPathComponent, AgentSeekPlayerComponent, BehaviorTreeComponent);
-	ON_EARLY_UPDATE_ID(BTGetPathComponent, AgentSeekPlayerComponent, BehaviorTreeComponent);
-	void OnEarlyUpdate(DOG::entity e, BTGetPathComponent&, AgentSeekPlayerComponent& seek, BehaviorTreeComponent& btc);
+	SYSTEM_CLASS(AgentSeekPlayerComponent, BehaviorTreeComponent);
+	ON_EARLY_UPDATE_LEAF(LeafType::GetPath, AgentSeekPlayerComponent, BehaviorTreeComponent);
+	void OnEarlyUpdate(DOG::entity e, AgentSeekPlayerComponent& seek, BehaviorTreeComponent& btc);
 };
 
 class AgentCreatePatrolSystem : public DOG::ISystem
 {
 public:
-	SYSTEM_CLASS(BTCreatePatrolComponent, BehaviorTreeComponent);
-	ON_EARLY_UPDATE_ID(BTCreatePatrolComponent, BehaviorTreeComponent);
-	void OnEarlyUpdate(DOG::entity e, BTCreatePatrolComponent&, BehaviorTreeComponent& btc);
+	SYSTEM_CLASS(BehaviorTreeComponent);
+	ON_EARLY_UPDATE_LEAF(LeafType::CreatePatrol, BehaviorTreeComponent);
+	void OnEarlyUpdate(DOG::entity e, BehaviorTreeComponent& btc);
 };
 
 
@@ -79,9 +112,9 @@ class AgentAttackSystem : public DOG::ISystem
 	using Vector3 = DirectX::SimpleMath::Vector3;
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
-	SYSTEM_CLASS(BTAttackComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	ON_UPDATE_ID(BTAttackComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	void OnUpdate(DOG::entity e, BTAttackComponent&, BehaviorTreeComponent& btc, 
+	SYSTEM_CLASS(BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	ON_UPDATE_LEAF(LeafType::Attack, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	void OnUpdate(DOG::entity e, BehaviorTreeComponent& btc, 
 		AgentAttackComponent& attack, AgentSeekPlayerComponent& seek);
 };
 
@@ -90,9 +123,9 @@ class AgentJumpAtPlayerSystem : public DOG::ISystem
 	using Vector3 = DirectX::SimpleMath::Vector3;
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
-	SYSTEM_CLASS(BTJumpAtPlayerComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	ON_UPDATE_ID(BTJumpAtPlayerComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	void OnUpdate(DOG::entity e, BTJumpAtPlayerComponent&, BehaviorTreeComponent& btc,
+	SYSTEM_CLASS(BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	ON_UPDATE_LEAF(LeafType::JumpAtPlayer, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	void OnUpdate(DOG::entity e, BehaviorTreeComponent& btc,
 		AgentAttackComponent& attack, AgentSeekPlayerComponent& seek);
 };
 
@@ -101,9 +134,9 @@ class AgentPullBackSystem : public DOG::ISystem
 	using Vector3 = DirectX::SimpleMath::Vector3;
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
-	SYSTEM_CLASS(BTPullBackComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	ON_UPDATE_ID(BTPullBackComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	void OnUpdate(DOG::entity e, BTPullBackComponent&, BehaviorTreeComponent& btc,
+	SYSTEM_CLASS(BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	ON_UPDATE_LEAF(LeafType::PullBack, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	void OnUpdate(DOG::entity e, BehaviorTreeComponent& btc,
 		AgentAttackComponent& attack, AgentSeekPlayerComponent& seek);
 };
 
@@ -112,9 +145,9 @@ class AgentDodgeSystem : public DOG::ISystem
 	using Vector3 = DirectX::SimpleMath::Vector3;
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
-	SYSTEM_CLASS(BTDodgeComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	ON_UPDATE_ID(BTDodgeComponent, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
-	void OnUpdate(DOG::entity e, BTDodgeComponent&, BehaviorTreeComponent& btc,
+	SYSTEM_CLASS(BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	ON_UPDATE_LEAF(LeafType::Dodge, BehaviorTreeComponent, AgentAttackComponent, AgentSeekPlayerComponent);
+	void OnUpdate(DOG::entity e, BehaviorTreeComponent& btc,
 		AgentAttackComponent& attack, AgentSeekPlayerComponent& seek);
 };
 
@@ -123,9 +156,9 @@ class AgentAggroSystem : public DOG::ISystem
 	using Vector3 = DirectX::SimpleMath::Vector3;
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
-	SYSTEM_CLASS(BTAggroComponent, AgentAggroComponent, AgentIdComponent);
-	ON_UPDATE_ID(BTAggroComponent, AgentAggroComponent, AgentIdComponent);
-	void OnUpdate(DOG::entity e, BTAggroComponent&, AgentAggroComponent& aggro, AgentIdComponent& agent);
+	SYSTEM_CLASS(AgentAggroComponent, AgentIdComponent);
+	ON_UPDATE_LEAF(LeafType::SignalGroup, AgentAggroComponent, AgentIdComponent);
+	void OnUpdate(DOG::entity e, AgentAggroComponent& aggro, AgentIdComponent& agent);
 };
 
 class AgentHitDetectionSystem : public DOG::ISystem
@@ -168,6 +201,7 @@ class AgentFrostTimerSystem : public DOG::ISystem
 {
 public:
 	SYSTEM_CLASS(AgentMovementComponent, FrostEffectComponent, AgentIdComponent);
+	SYSTEM_ACCESS(DOG::Reads<AgentIdComponent>, DOG::Writes<AgentMovementComponent, FrostEffectComponent>);
 	ON_UPDATE_ID(AgentMovementComponent, FrostEffectComponent, AgentIdComponent);
 	void OnUpdate(DOG::entity e, AgentMovementComponent& movement, FrostEffectComponent& frostEffect, AgentIdComponent& idc);
 };
@@ -187,9 +221,9 @@ public:
 class AgentExecutePatrolSystem : public DOG::ISystem
 {
 public:
-	SYSTEM_CLASS(BTExecutePatrolComponent, AgentPatrolComponent, BehaviorTreeComponent, AgentMovementComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
-	ON_LATE_UPDATE_ID(BTExecutePatrolComponent, AgentPatrolComponent, BehaviorTreeComponent, AgentMovementComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
-	void OnLateUpdate(DOG::entity e, BTExecutePatrolComponent&, AgentPatrolComponent& patrol, 
+	SYSTEM_CLASS(AgentPatrolComponent, BehaviorTreeComponent, AgentMovementComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
+	ON_LATE_UPDATE_LEAF(LeafType::ExecutePatrol, AgentPatrolComponent, BehaviorTreeComponent, AgentMovementComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
+	void OnLateUpdate(DOG::entity e, AgentPatrolComponent& patrol, 
 		BehaviorTreeComponent& btc, AgentMovementComponent& movement,
 		DOG::RigidbodyComponent& rb, DOG::TransformComponent& trans);
 };
@@ -205,9 +239,9 @@ private:
 public:
 	AgentMovementSystem();
 	
-	SYSTEM_CLASS(BTMoveToPlayerComponent, BehaviorTreeComponent, AgentMovementComponent, AgentSeekPlayerComponent, PathfinderWalkComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
-	ON_LATE_UPDATE_ID(BTMoveToPlayerComponent, BehaviorTreeComponent, AgentMovementComponent, AgentSeekPlayerComponent, PathfinderWalkComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
-	void OnLateUpdate(DOG::entity e, BTMoveToPlayerComponent&, BehaviorTreeComponent& btc, 
+	SYSTEM_CLASS(BehaviorTreeComponent, AgentMovementComponent, AgentSeekPlayerComponent, PathfinderWalkComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
+	ON_LATE_UPDATE_LEAF_PARALLEL(LeafType::MoveToPlayer, BehaviorTreeComponent, AgentMovementComponent, AgentSeekPlayerComponent, PathfinderWalkComponent, DOG::RigidbodyComponent, DOG::TransformComponent);
+	void OnLateUpdate(DOG::entity e, BehaviorTreeComponent& btc, 
 		AgentMovementComponent& movement, AgentSeekPlayerComponent& seek, PathfinderWalkComponent& pfc,
 		DOG::RigidbodyComponent& rb, DOG::TransformComponent& trans);
 };
@@ -227,6 +261,7 @@ class ShadowAgentSeekPlayerSystem : public DOG::ISystem
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
 	SYSTEM_CLASS(ShadowAgentSeekPlayerComponent);
+	SYSTEM_ACCESS(DOG::Reads<DOG::NetworkPlayerComponent>, DOG::Writes<ShadowAgentSeekPlayerComponent>);
 	ON_UPDATE(ShadowAgentSeekPlayerComponent);
 	void OnUpdate(ShadowAgentSeekPlayerComponent& seek);
 };
@@ -74,9 +74,12 @@ struct AgentSeekPlayerComponent
 	bool HasTarget() { return entityID != DOG::NULL_ENTITY; }
 };
 
+// On every agent, aggro comes and goes through the flag so the behavior tree never adds or removes components
 struct AgentAggroComponent
 {
-	f64 timeTriggered = DOG::Time::ElapsedTime();
+	f64 timeTriggered = 0.0;
+	bool active = false;
+	void Trigger() { if (!active) { active = true; timeTriggered = DOG::Time::ElapsedTime(); } }
 };
 
 struct AgentHitComponent
@@ -119,8 +122,10 @@ struct AgentOnStandbyAudioComponent
 	DOG::entity agentOnStandbyAudioEntity = DOG::NULL_ENTITY;
 };
 
+// On every agent, CreatePatrol fills it in and activates it, attacking deactivates it
 struct AgentPatrolComponent
 {
+	bool active = false;
 	f64 timer;
 	bool successfullyCreated = true;
 	f32 ratio;
@@ -84,6 +84,12 @@ void AgentManager::CountAgentKilled(u32 agentID)
 		m_agentKillCounter[i] = m_agentIdCounter[i] = 0;	// reset both counters
 }
 
+bool AgentManager::IsSwarm(u32 groupID) const
+{
+	// One flow field per target only pays off when many agents share it, small groups search (cached) paths
+	return m_agentIdCounter[groupID] - m_agentKillCounter[groupID] >= SWARM_SIZE;
+}
+
 u32 AgentManager::GroupID(u32 agentID)
 {
 	if (agentID == NULL_AGENT)
@@ -124,6 +130,7 @@ AgentManager::AgentStats AgentManager::GetAgentStats(EntityTypes type)
 			scorpio.lidarDistance = 5.0f;
 		}
 		scorpio.baseSpeed = 10.0f;
+		scorpio.flowField = true;
 		return scorpio;
 	}
 		break;
@@ -153,6 +160,10 @@ void AgentManager::Initialize()
 	// Load (all) agent model asset(s)
 	s_amInstance.m_models.push_back(AssetManager::Get().LoadModelAsset("Assets/Models/Enemies/enemy1.gltf"));
 
+	// Behavior trees are shared by every agent of a type
+	s_amInstance.m_scorpioBehaviorTree = CreateScorpioBehaviourTree();
+	BehaviorTree::ToGraphViz(s_amInstance.m_scorpioBehaviorTree, "BehaviorTree_Scorpio.dot");
+
 	// Register early agent systems
 	EntityManager& em = EntityManager::Get();
 	em.RegisterSystem(std::make_unique<AgentBehaviorTreeSystem>());
@@ -246,6 +257,8 @@ entity AgentManager::CreateAgentCore(u32 model, u32 groupID, const Vector3& pos,
 	hpComp.hp = hpComp.maxHP;
 
 	em.AddComponent<AgentTargetMetricsComponent>(e);
+	em.AddComponent<AgentAggroComponent>(e);
+	em.AddComponent<AgentPatrolComponent>(e);
 
 	// Add networking components
 	if (GameLayer::GetNetworkStatus() != NetworkStatus::Offline)
@@ -260,7 +273,7 @@ entity AgentManager::CreateAgentCore(u32 model, u32 groupID, const Vector3& pos,
 	switch (type)
 	{
 	case EntityTypes::Scorpio:
-		CreateScorpioBehaviourTree(e);
+		em.AddComponent<BehaviorTreeComponent>(e).tree = &m_scorpioBehaviorTree;
 		break;
 	default:
 		break;
@@ -351,70 +364,52 @@ void AgentManager::DestroyLocalAgent(entity e, bool local)
 	}
 }
 
-void AgentManager::CreateScorpioBehaviourTree(DOG::entity agent) noexcept
+BehaviorTreeDefinition AgentManager::CreateScorpioBehaviourTree() noexcept
 {
-	// BehaviorTree root
-	std::shared_ptr<Selector> rootSelector = std::move(std::make_shared<Selector>("RootSelector"));
-
-	// Attack or move towards player
-	std::shared_ptr<Sequence> seekAndDestroySequence = std::move(std::make_shared<Sequence>("SeekAndDestroySequence"));
-	std::shared_ptr<Selector> attackOrMoveToPlayerSelector = std::move(std::make_shared<Selector>("attackOrMoveToPlayerSelector"));
-
-	// Attack behavior
-	std::shared_ptr<Selector> attackSelector = std::move(std::make_shared<Selector>("AttackSelector"));
-	attackSelector->AddChild(std::make_shared<AttackNode>("AttackNode"));
-	attackSelector->AddChild(std::make_shared<JumpAtPlayerNode>("JumpAtPlayerNode"));
-	attackSelector->AddChild(std::make_shared<PullBackNode>("PullBackNode"));
-	attackOrMoveToPlayerSelector->AddChild(std::move(attackSelector));
-
-	// Move towards player
-	attackOrMoveToPlayerSelector->AddChild(std::make_shared<MoveToPlayerNode>("MoveToPlayerNode"));
+	BehaviorTreeDefinition tree;
+	const u16 root = tree.AddDecorator("ScorpioRootNode", DecoratorType::Root, BehaviorTreeDefinition::NO_NODE);
 
-	// Alert group
-	std::shared_ptr<Succeeder> signalGroupSucceeder = std::move(std::make_shared<Succeeder>("SignalGroupSucceeder"));
-	signalGroupSucceeder->AddChild(std::make_shared<SignalGroupNode>("SignalGroupNode"));
+	// BehaviorTree root
+	const u16 rootSelector = tree.AddComposite("RootSelector", NodeType::Selector, root);
+	const u16 seekAndDestroySequence = tree.AddComposite("SeekAndDestroySequence", NodeType::Sequence, rootSelector);
 
 	// Detection phase (more aggressive if alert)
-	std::shared_ptr<Selector> detectHitOrPlayerSelector = std::move(std::make_shared<Selector>("detectHitOrPlayerSelector"));
-	std::shared_ptr<Sequence> detectPlayerSequence = std::move(std::make_shared<Sequence>("DetectPlayerSequence"));
-	std::shared_ptr<Selector> detectOrAlertSelector = std::move(std::make_shared<Selector>("DetectOrAlertSelector"));
-	std::shared_ptr<Succeeder> lineOfSightToPlayerSucceeder = std::move(std::make_shared<Succeeder>("LineOfSightToPlayerSucceeder"));
+	const u16 detectPlayerSequence = tree.AddComposite("DetectPlayerSequence", NodeType::Sequence, seekAndDestroySequence);
+	const u16 detectOrAlertSelector = tree.AddComposite("DetectOrAlertSelector", NodeType::Selector, detectPlayerSequence);
 	// Check distance to each player
-	detectOrAlertSelector->AddChild(std::make_shared<DistanceToPlayerNode>("DistanceToPlayerNode"));
+	tree.AddLeaf("DistanceToPlayerNode", LeafType::DistanceToPlayer, detectOrAlertSelector);
 	// More aggressive detection if alert
-	detectOrAlertSelector->AddChild(std::make_shared<IsAlertNode>("IsAlertNode"));
+	tree.AddLeaf("IsAlertNode", LeafType::IsAlert, detectOrAlertSelector);
 	// Check line of sight to relevant players
-	lineOfSightToPlayerSucceeder->AddChild(std::make_shared<LineOfSightToPlayerNode>("LineOfSightToPlayerNode"));
-	detectPlayerSequence->AddChild(std::move(detectOrAlertSelector));
-	detectPlayerSequence->AddChild(std::move(lineOfSightToPlayerSucceeder));
-
-	detectHitOrPlayerSelector->AddChild(std::make_shared<DetectHitNode>("DetectHitNode"));
-	detectHitOrPlayerSelector->AddChild(std::make_shared<DetectPlayerNode>("DetectPlayerNode"));
-	detectPlayerSequence->AddChild(std::move(detectHitOrPlayerSelector));
-
-	rootSelector->AddChild(seekAndDestroySequence);
-	seekAndDestroySequence->AddChild(std::move(detectPlayerSequence));
+	const u16 lineOfSightToPlayerSucceeder = tree.AddDecorator("LineOfSightToPlayerSucceeder", DecoratorType::Succeeder, detectPlayerSequence);
+	tree.AddLeaf("LineOfSightToPlayerNode", LeafType::LineOfSightToPlayer, lineOfSightToPlayerSucceeder);
+	const u16 detectHitOrPlayerSelector = tree.AddComposite("detectHitOrPlayerSelector", NodeType::Selector, detectPlayerSequence);
+	tree.AddLeaf("DetectHitNode", LeafType::DetectHit, detectHitOrPlayerSelector);
+	tree.AddLeaf("DetectPlayerNode", LeafType::DetectPlayer, detectHitOrPlayerSelector);
 
 	// Get path from Pathfinder
-	seekAndDestroySequence->AddChild(std::make_shared<GetPathNode>("GetPathNode"));
+	tree.AddLeaf("GetPathNode", LeafType::GetPath, seekAndDestroySequence);
 
-	seekAndDestroySequence->AddChild(std::move(signalGroupSucceeder));
+	// Alert group
+	const u16 signalGroupSucceeder = tree.AddDecorator("SignalGroupSucceeder", DecoratorType::Succeeder, seekAndDestroySequence);
+	tree.AddLeaf("SignalGroupNode", LeafType::SignalGroup, signalGroupSucceeder);
 
-	// Patrol subtree
-	std::shared_ptr<Selector> patrolSelector = std::move(std::make_shared<Selector>("PatrolSelector"));
-	patrolSelector->AddChild(std::make_shared<CreatePatrolNode>("CreatePatrolNode"));
-	patrolSelector->AddChild(std::make_shared<ExecutePatrolNode>("ExecutePatrolNode"));
-	rootSelector->AddChild(patrolSelector);
+	// Attack or move towards player
+	const u16 attackOrMoveToPlayerSelector = tree.AddComposite("attackOrMoveToPlayerSelector", NodeType::Selector, seekAndDestroySequence);
 
+	// Attack behavior
+	const u16 attackSelector = tree.AddComposite("AttackSelector", NodeType::Selector, attackOrMoveToPlayerSelector);
+	tree.AddLeaf("AttackNode", LeafType::Attack, attackSelector);
+	tree.AddLeaf("JumpAtPlayerNode", LeafType::JumpAtPlayer, attackSelector);
+	tree.AddLeaf("PullBackNode", LeafType::PullBack, attackSelector);
 
-	seekAndDestroySequence->AddChild(std::move(attackOrMoveToPlayerSelector));
+	// Move towards player
+	tree.AddLeaf("MoveToPlayerNode", LeafType::MoveToPlayer, attackOrMoveToPlayerSelector);
 
-	// Add tree to component
-	auto& btc = DOG::EntityManager::Get().AddComponent<BehaviorTreeComponent>(agent);
-	btc.rootNode = std::move(std::make_unique<Root>("ScorpioRootNode"));
-	btc.rootNode->AddChild(std::move(rootSelector));
-	btc.currentRunningNode = btc.rootNode.get();
+	// Patrol subtree
+	const u16 patrolSelector = tree.AddComposite("PatrolSelector", NodeType::Selector, rootSelector);
+	tree.AddLeaf("CreatePatrolNode", LeafType::CreatePatrol, patrolSelector);
+	tree.AddLeaf("ExecutePatrolNode", LeafType::ExecutePatrol, patrolSelector);
 
-	// Write tree to file
-	BehaviorTree::ToGraphViz(btc.rootNode.get(), "BehaviorTree_Scorpio.dot");
+	return tree;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <DOGEngine.h>
 #include "../GameComponent.h"
+#include "BehaviorTree.h"
 
 
 class AgentManager
@@ -15,6 +16,7 @@ private:
 public:
 	static constexpr u32 NULL_AGENT = u32(-1);
 	static constexpr u32 GROUP_SIZE = NULL_AGENT >> GROUP_BITS;	// max agents in a group
+	static constexpr u32 SWARM_SIZE = 8;	// agents alive in a group before it chases along flow fields
 
 	struct AgentStats
 	{
@@ -22,6 +24,7 @@ public:
 		float visionConeDotValue;
 		f32 lidarDistance;
 		f32 baseSpeed;
+		bool flowField;		// In a swarm group, chase along the shared flow field of the target instead of searching a path per agent
 	};
 
 	[[nodiscard]] static constexpr AgentManager& Get() noexcept
@@ -35,13 +38,14 @@ public:
 	static Vector3 GenerateRandomVector3(u32 seed, f32 max = 1.0f, f32 min = 0.0f);
 	void DestroyLocalAgent(DOG::entity e, bool local = true);
 	static void CreateVillain(const Vector3& position);
-	static void CreateScorpioBehaviourTree(DOG::entity agent) noexcept;
+	static BehaviorTreeDefinition CreateScorpioBehaviourTree() noexcept;
 
 	void SceneBegins();
 
 	u32 GenAgentID(u32 groupID);
 	void CountAgentKilled(u32 agentID);
 	u32 GroupID(u32 agentID = NULL_AGENT);
+	bool IsSwarm(u32 groupID) const;
 	AgentStats GetAgentStats(EntityTypes type);
 
 private:
@@ -51,6 +55,7 @@ private:
 	f64 m_timer;
 
 	std::vector<u32> m_models;
+	BehaviorTreeDefinition m_scorpioBehaviorTree;
 	std::array<u32, GROUP_RANGE> m_agentIdCounter{ 0 };
 	std::array<u32, GROUP_RANGE> m_agentKillCounter{ 0 };
 
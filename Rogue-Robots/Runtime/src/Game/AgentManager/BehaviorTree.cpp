@@ -1,621 +1,248 @@
 #include "BehaviorTree.h"
 #include "AgentComponents.h"
 
-Node::Node(const std::string& name, NodeType type) noexcept
-	: m_name{ name },
-	m_nodeType{ type },
-	m_parent{ nullptr }
-{}
-
-void Node::SetParent(Node* pNode) noexcept
+u16 BehaviorTreeDefinition::AddComposite(const std::string& name, NodeType type, u16 parent) noexcept
 {
-	m_parent = pNode;
+	ASSERT(type == NodeType::Sequence || type == NodeType::Selector, "Composite must be a sequence or a selector.");
+	return Add(name, type, 0u, parent);
 }
 
-Composite::Composite(const std::string& name, NodeType type) noexcept
-	: Node{ name, type }
-{}
-
-void Composite::AddChild(std::shared_ptr<Node>&& pNode) noexcept
+u16 BehaviorTreeDefinition::AddDecorator(const std::string& name, DecoratorType type, u16 parent) noexcept
 {
-	m_children.push_back(pNode);
-	m_children.back()->SetParent(this);
+	ASSERT(parent == NO_NODE || m_nodes[parent].type != NodeType::Decorator || m_nodes[parent].childCount == 0, "Decorator already has child node assigned.");
+	return Add(name, NodeType::Decorator, static_cast<u8>(type), parent);
 }
 
-void Composite::Reset() noexcept
+u16 BehaviorTreeDefinition::AddLeaf(const std::string& name, LeafType type, u16 parent) noexcept
 {
-	m_currentChildIndex = 0u;
+	return Add(name, NodeType::Leaf, static_cast<u8>(type), parent);
 }
 
-Sequence::Sequence(const std::string& name) noexcept
-	: Composite{ name, NodeType::Sequence }
-{}
-
-void Sequence::Process(DOG::entity agent) noexcept
+u16 BehaviorTreeDefinition::Add(const std::string& name, NodeType type, u8 kind, u16 parent) noexcept
 {
-	//Are we at the very first child?
-	const bool sequenceIsAtTheVeryStart = (m_currentChildIndex == 0u);
-	if (sequenceIsAtTheVeryStart)
-	{
-		auto& pCurrentChild = GetChildren()[m_currentChildIndex];
-		//We are, so we should just process it:
-		m_currentChildIndex++;
-		pCurrentChild->Process(agent);
-	}
-	else
-	{
-		//We are not at the very first child. 
-		//If the previous child failed we should mark the sequence as a failure:
-		auto& pCompletedChild = GetChildren()[m_currentChildIndex - 1];
-		if (!pCompletedChild->Succeeded())
-		{
-			Reset();
-			SetSucceededAs(false);
-			GetParent()->Process(agent);
-			return;
-		}
+	ASSERT(m_nodes.size() < MAX_NODES, "Behavior tree has too many nodes.");
+	ASSERT((parent == NO_NODE) == m_nodes.empty(), "Only the first node can be without parent.");
 
-		//By this point we know the previous child succeeded. Have we processed all children?
-		//If so, we should mark the sequence as succeeded and return:
-		const bool doneProcessing = (m_currentChildIndex == GetChildren().size());
-		if (doneProcessing)
-		{
-			Reset();
-			SetSucceededAs(true);
-			GetParent()->Process(agent);
-			return;
-		}
+	const u16 node = static_cast<u16>(m_nodes.size());
+	m_nodes.push_back({ type, kind, parent, 0, 0 });
+	m_names.push_back(name);
 
-		//At this point we know that we should just continue going:
-		auto& pCurrentChild = GetChildren()[m_currentChildIndex];
-		m_currentChildIndex++;
-		pCurrentChild->Process(agent);
-	}
-}
-
-Selector::Selector(const std::string& name) noexcept
-	: Composite{ name, NodeType::Selector }
-{}
-
-void Selector::Process(DOG::entity agent) noexcept
-{
-	//Are we at the very first child?
-	const bool sequenceIsAtTheVeryStart = (m_currentChildIndex == 0u);
-	if (sequenceIsAtTheVeryStart)
+	if (parent != NO_NODE)
 	{
-		auto& pCurrentChild = GetChildren()[m_currentChildIndex];
-		//We are, so we should just process it:
-		m_currentChildIndex++;
-		pCurrentChild->Process(agent);
-	}
-	else
-	{
-		//We are not at the very first child. 
-		//If the previous child succeeded we should mark the selector as a success:
-		auto& pCompletedChild = GetChildren()[m_currentChildIndex - 1];
-		if (pCompletedChild->Succeeded())
-		{
-			Reset();
-			SetSucceededAs(true);
-			GetParent()->Process(agent);
-			return;
-		}
-
-		//By this point we know the previous child failed. Have we processed all children?
-		//If so, we should mark the selector as a failure and return:
-		const bool doneProcessing = (m_currentChildIndex == GetChildren().size());
-		if (doneProcessing)
+		// Keep the children of a parent next to each other, the ones of later parents move up one slot
+		BTNode& p = m_nodes[parent];
+		if (p.childCount == 0)
+			p.firstChild = static_cast<u16>(m_children.size());
+		const u16 slot = p.firstChild + p.childCount;
+		m_children.insert(m_children.begin() + slot, node);
+		for (BTNode& other : m_nodes)
 		{
-			Reset();
-			SetSucceededAs(false);
-			GetParent()->Process(agent);
-			return;
+			if (&other != &p && other.childCount > 0 && other.firstChild >= slot)
+				++other.firstChild;
 		}
-
-		//At this point we know that we should just continue going:
-		auto& pCurrentChild = GetChildren()[m_currentChildIndex];
-		m_currentChildIndex++;
-		pCurrentChild->Process(agent);
+		++p.childCount;
 	}
+	return node;
 }
 
-Decorator::Decorator(const std::string& name, const DecoratorType type) noexcept
-	: Node{ name, NodeType::Decorator },
-	m_decoratorType{ type },
-	m_child{ nullptr }
-{}
-
-void Decorator::AddChild(std::shared_ptr<Node>&& pNode) noexcept
+namespace
 {
-	ASSERT(!m_child, "Decorator already has child node assigned.");
-	m_child = pNode;
-	m_child->SetParent(this);
-}
+	constexpr u32 LEAF_TYPE_COUNT = static_cast<u32>(LeafType::ExecutePatrol) + 1;
 
-Succeeder::Succeeder(const std::string& name) noexcept
-	: Decorator{ name, DecoratorType::Succeeder }
-{}
+	// Per leaf type, the agents waiting on it and the batch its system is going over
+	std::array<std::vector<DOG::entity>, LEAF_TYPE_COUNT> s_waiting;
+	std::array<std::vector<DOG::entity>, LEAF_TYPE_COUNT> s_batches;
 
-void Succeeder::Process(DOG::entity agent) noexcept
-{
-	if (!processed)
-	{
-		processed = true;
-		GetChild()->Process(agent);
-	}
-	else
+	void ProcessNode(DOG::entity agent, BehaviorTreeComponent& btc, u16 node) noexcept;
+
+	void SetSucceededAs(BehaviorTreeComponent& btc, u16 node, bool result) noexcept
 	{
-		SetSucceededAs(true);
-		processed = false;
-		GetParent()->Process(agent);
+		if (result)
+			btc.succeeded |= 1u << node;
+		else
+			btc.succeeded &= ~(1u << node);
 	}
-}
 
-Failer::Failer(const std::string& name) noexcept
-	: Decorator{ name, DecoratorType::Failer}
-{}
-
-void Failer::Process(DOG::entity agent) noexcept
-{
-	if (!processed)
+	// Hands the result of node to its parent
+	void Resolve(DOG::entity agent, BehaviorTreeComponent& btc, u16 node, bool result) noexcept
 	{
-		processed = true;
-		GetChild()->Process(agent);
+		SetSucceededAs(btc, node, result);
+		ProcessNode(agent, btc, btc.tree->GetNode(node).parent);
 	}
-	else
+
+	void ProcessComposite(DOG::entity agent, BehaviorTreeComponent& btc, u16 node, const BTNode& composite) noexcept
 	{
-		processed = false;
-		SetSucceededAs(false);
-		GetParent()->Process(agent);
-	}
-}
+		u8& childIndex = btc.progress[node];
 
-Inverter::Inverter(const std::string& name) noexcept
-	: Decorator{ name, DecoratorType::Inverter}
-{}
+		//We are not at the very first child, so a child has just completed.
+		//A sequence stops at the first child that fails, a selector at the first one that succeeds.
+		//Either way, if it stopped or all children are processed it reports what the last child reported:
+		if (childIndex != 0u)
+		{
+			const bool childSucceeded = btc.Succeeded(btc.tree->GetChild(node, childIndex - 1u));
+			const bool stop = (composite.type == NodeType::Sequence) ? !childSucceeded : childSucceeded;
+			if (stop || childIndex == composite.childCount)
+			{
+				childIndex = 0u;
+				Resolve(agent, btc, node, childSucceeded);
+				return;
+			}
+		}
 
-void Inverter::Process(DOG::entity agent) noexcept
-{
-	if (!processed)
-	{
-		processed = true;
-		GetChild()->Process(agent);
+		//At this point we know that we should just continue going:
+		const u16 child = btc.tree->GetChild(node, childIndex);
+		childIndex++;
+		ProcessNode(agent, btc, child);
 	}
-	else
+
+	void ProcessDecorator(DOG::entity agent, BehaviorTreeComponent& btc, u16 node, const BTNode& decorator) noexcept
 	{
-		if (GetChild()->Succeeded())
+		u8& processed = btc.progress[node];
+		if (!processed)
 		{
-			SetSucceededAs(false);
+			processed = 1u;
+			ProcessNode(agent, btc, btc.tree->GetChild(node, 0u));
+			return;
 		}
-		else
+
+		processed = 0u;
+		switch (static_cast<DecoratorType>(decorator.kind))
 		{
-			SetSucceededAs(true);
+		case DecoratorType::Inverter:
+			Resolve(agent, btc, node, !btc.Succeeded(btc.tree->GetChild(node, 0u)));
+			break;
+		case DecoratorType::Succeeder:
+			Resolve(agent, btc, node, true);
+			break;
+		case DecoratorType::Failer:
+			Resolve(agent, btc, node, false);
+			break;
+		case DecoratorType::Root:
+			btc.currentRunningNode = node;
+			break;
 		}
-		processed = false;
-		GetParent()->Process(agent);
 	}
-}
 
-Root::Root(const std::string& name) noexcept
-	: Decorator(name, DecoratorType::Root)
-{}
-
-void Root::Process(DOG::entity agent) noexcept
-{
-	if (!processed)
-	{
-		processed = true;
-		GetChild()->Process(agent);
-	}
-	else
+	// The agent waits on the leaf until its system reports a result
+	void Wait(DOG::entity agent, BehaviorTreeComponent& btc, u16 node, LeafType leaf) noexcept
 	{
-		processed = false;
-		DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
+		btc.currentRunningNode = node;
+		s_waiting[static_cast<u32>(leaf)].push_back(agent);
 	}
-}
-
-Leaf::Leaf(const std::string& name) noexcept
-	: Node{ name, NodeType::Leaf }
-{}
 
-void Leaf::ForceSucceed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	GetParent()->Process(agent);
-}
-
-void Leaf::ForceFail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	GetParent()->Process(agent);
-}
-
-DetectPlayerNode::DetectPlayerNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void DetectPlayerNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddComponent<BTDetectPlayerComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void DetectPlayerNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTDetectPlayerComponent>(agent);
-	if (!DOG::EntityManager::Get().HasComponent<AgentAggroComponent>(agent))
-		DOG::EntityManager::Get().AddComponent<AgentAggroComponent>(agent);
-
-	GetParent()->Process(agent);
-}
-
-void DetectPlayerNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTDetectPlayerComponent>(agent);
-	DOG::EntityManager::Get().RemoveComponentIfExists<AgentAggroComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-DetectHitNode::DetectHitNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void DetectHitNode::Process(DOG::entity agent) noexcept
-{
-	if (DOG::EntityManager::Get().HasComponent<AgentAlertComponent>(agent))
+	void ProcessLeaf(DOG::entity agent, BehaviorTreeComponent& btc, u16 node, LeafType leaf) noexcept
 	{
-		DOG::EntityManager::Get().AddComponent<BTHitDetectComponent>(agent);
-		DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-	}
-	else
-	{
-		ForceFail(agent); // Go to next node of SELECTOR, which is DetectPlayer as of now.
+		DOG::EntityManager& em = DOG::EntityManager::Get();
+		switch (leaf)
+		{
+		case LeafType::DetectHit:
+			if (em.HasComponent<AgentAlertComponent>(agent))
+				Wait(agent, btc, node, leaf);
+			else
+				Resolve(agent, btc, node, false); // Go to next node of SELECTOR, which is DetectPlayer as of now.
+			break;
+		case LeafType::Attack:
+			em.GetComponent<AgentPatrolComponent>(agent).active = false;
+			Wait(agent, btc, node, leaf);
+			break;
+		case LeafType::IsAlert:
+			Resolve(agent, btc, node, em.HasComponent<AgentAlertComponent>(agent));
+			break;
+		case LeafType::ExecutePatrol:
+			if (em.GetComponent<AgentPatrolComponent>(agent).active)
+				Wait(agent, btc, node, leaf);
+			else
+				Resolve(agent, btc, node, false);
+			break;
+		default:
+			Wait(agent, btc, node, leaf);
+			break;
+		}
 	}
-}
-
-void DetectHitNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTHitDetectComponent>(agent);
-	if (!DOG::EntityManager::Get().HasComponent<AgentAggroComponent>(agent))
-		DOG::EntityManager::Get().AddComponent<AgentAggroComponent>(agent);
-
-	GetParent()->Process(agent);
-}
-
-void DetectHitNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTHitDetectComponent>(agent);
-	DOG::EntityManager::Get().RemoveComponentIfExists<AgentAggroComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-SignalGroupNode::SignalGroupNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
 
-void SignalGroupNode::Process(DOG::entity agent) noexcept
-{
-	if (!DOG::EntityManager::Get().HasComponent<BTAttackComponent>(agent))
+	void FinishLeaf(DOG::entity agent, BehaviorTreeComponent& btc, u16 node, bool result) noexcept
 	{
-		DOG::EntityManager::Get().AddComponent<BTAggroComponent>(agent);
-		DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
+		// Detecting a player or a hit decides whether the agent is aggro
+		const LeafType leaf = static_cast<LeafType>(btc.tree->GetNode(node).kind);
+		if (leaf == LeafType::DetectPlayer || leaf == LeafType::DetectHit)
+		{
+			AgentAggroComponent& aggro = DOG::EntityManager::Get().GetComponent<AgentAggroComponent>(agent);
+			if (result)
+				aggro.Trigger();
+			else
+				aggro.active = false;
+		}
+
+		Resolve(agent, btc, node, result);
 	}
-	else
+
+	void ProcessNode(DOG::entity agent, BehaviorTreeComponent& btc, u16 node) noexcept
 	{
-		ForceSucceed(agent);
+		const BTNode& n = btc.tree->GetNode(node);
+		switch (n.type)
+		{
+		case NodeType::Sequence:
+		case NodeType::Selector:
+			ProcessComposite(agent, btc, node, n);
+			break;
+		case NodeType::Decorator:
+			ProcessDecorator(agent, btc, node, n);
+			break;
+		case NodeType::Leaf:
+			ProcessLeaf(agent, btc, node, static_cast<LeafType>(n.kind));
+			break;
+		}
 	}
 }
 
-void SignalGroupNode::Succeed(DOG::entity agent) noexcept
+void BehaviorTree::Process(DOG::entity agent, BehaviorTreeComponent& btc) noexcept
 {
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTAggroComponent>(agent);
-	GetParent()->Process(agent);
+	ASSERT(btc.tree, "Agent has no behavior tree!");
+	ProcessNode(agent, btc, btc.currentRunningNode);
 }
 
-void SignalGroupNode::Fail(DOG::entity agent) noexcept
+void BehaviorTree::Succeed(DOG::entity agent, u16 leaf) noexcept
 {
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTAggroComponent>(agent);
-	GetParent()->Process(agent);
+	FinishLeaf(agent, DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent), leaf, true);
 }
 
-AttackNode::AttackNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void AttackNode::Process(DOG::entity agent) noexcept
+void BehaviorTree::Fail(DOG::entity agent, u16 leaf) noexcept
 {
-	DOG::EntityManager::Get().RemoveComponentIfExists<AgentPatrolComponent>(agent);
-
-	DOG::EntityManager::Get().AddOrReplaceComponent<BTAttackComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
+	FinishLeaf(agent, DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent), leaf, false);
 }
 
-void AttackNode::Succeed(DOG::entity agent) noexcept
+void BehaviorTree::BeginFrame() noexcept
 {
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTAttackComponent>(agent);
-	GetParent()->Process(agent);
+	for (auto& waiting : s_waiting)
+		waiting.clear();
 }
 
-void AttackNode::Fail(DOG::entity agent) noexcept
+const std::vector<DOG::entity>& BehaviorTree::TakeWaiting(LeafType leaf) noexcept
 {
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTAttackComponent>(agent);
-	GetParent()->Process(agent);
+	// Swapping keeps the capacity of both lists, steady frames do not allocate
+	auto& batch = s_batches[static_cast<u32>(leaf)];
+	batch.clear();
+	std::swap(batch, s_waiting[static_cast<u32>(leaf)]);
+	return batch;
 }
 
-MoveToPlayerNode::MoveToPlayerNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void MoveToPlayerNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddOrReplaceComponent<BTMoveToPlayerComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void MoveToPlayerNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTMoveToPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void MoveToPlayerNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTMoveToPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-DistanceToPlayerNode::DistanceToPlayerNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void DistanceToPlayerNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddComponent<BTDistanceToPlayerComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void DistanceToPlayerNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTDistanceToPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void DistanceToPlayerNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTDistanceToPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-IsAlertNode::IsAlertNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void IsAlertNode::Process(DOG::entity agent) noexcept
-{
-	if (DOG::EntityManager::Get().HasComponent<AgentAlertComponent>(agent))
-		ForceSucceed(agent);
-	else
-		ForceFail(agent);
-}
-
-void IsAlertNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	GetParent()->Process(agent);
-}
-
-void IsAlertNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	GetParent()->Process(agent);
-}
-
-LineOfSightToPlayerNode::LineOfSightToPlayerNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void LineOfSightToPlayerNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddComponent<BTLineOfSightToPlayerComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void LineOfSightToPlayerNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTLineOfSightToPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void LineOfSightToPlayerNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTLineOfSightToPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-GetPathNode::GetPathNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void GetPathNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddComponent<BTGetPathComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void GetPathNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTGetPathComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void GetPathNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTGetPathComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-JumpAtPlayerNode::JumpAtPlayerNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void JumpAtPlayerNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddComponent<BTJumpAtPlayerComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void JumpAtPlayerNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTJumpAtPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void JumpAtPlayerNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTJumpAtPlayerComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-PullBackNode::PullBackNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void PullBackNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddComponent<BTPullBackComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void PullBackNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTPullBackComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void PullBackNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTPullBackComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-DodgeNode::DodgeNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void DodgeNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddComponent<BTDodgeComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void DodgeNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTDodgeComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void DodgeNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTDodgeComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-CreatePatrolNode::CreatePatrolNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void CreatePatrolNode::Process(DOG::entity agent) noexcept
-{
-	DOG::EntityManager::Get().AddOrReplaceComponent<BTCreatePatrolComponent>(agent);
-	DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-}
-
-void CreatePatrolNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTCreatePatrolComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void CreatePatrolNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTCreatePatrolComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-ExecutePatrolNode::ExecutePatrolNode(const std::string& name) noexcept
-	: Leaf{ name }
-{}
-
-void ExecutePatrolNode::Process(DOG::entity agent) noexcept
-{
-	if (DOG::EntityManager::Get().HasComponent<AgentPatrolComponent>(agent))
-	{
-		DOG::EntityManager::Get().AddOrReplaceComponent<BTExecutePatrolComponent>(agent);
-		DOG::EntityManager::Get().GetComponent<BehaviorTreeComponent>(agent).currentRunningNode = this;
-	}
-	else
-	{
-		DOG::EntityManager::Get().RemoveComponentIfExists<BTExecutePatrolComponent>(agent);
-		ForceFail(agent);
-	}
-}
-
-void ExecutePatrolNode::Succeed(DOG::entity agent) noexcept
-{
-	SetSucceededAs(true);
-	DOG::EntityManager::Get().RemoveComponent<BTExecutePatrolComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-void ExecutePatrolNode::Fail(DOG::entity agent) noexcept
-{
-	SetSucceededAs(false);
-	DOG::EntityManager::Get().RemoveComponent<BTExecutePatrolComponent>(agent);
-	GetParent()->Process(agent);
-}
-
-
-
-void BehaviorTree::ToGraphViz(Node* root, const std::string filename)
+void BehaviorTree::ToGraphViz(const BehaviorTreeDefinition& tree, const std::string filename)
 {
 	std::ofstream outStream;
 	outStream.open(filename);
 
 	outStream << "digraph {" << std::endl;
-	BehaviorTree::ToGraphVizHelper(root, outStream);
+	BehaviorTree::ToGraphVizHelper(tree, 0, outStream);
 	outStream << "}" << std::endl;
 	outStream.close();
 }
 
-void BehaviorTree::ToGraphVizHelper(Node* node, std::ofstream& outstream)
+void BehaviorTree::ToGraphVizHelper(const BehaviorTreeDefinition& tree, u16 node, std::ofstream& outstream)
 {
-	outstream << node->GetName() << " [label=\"" << node->GetName() << "\\n";
+	const BTNode& n = tree.GetNode(node);
+	outstream << tree.GetName(node) << " [label=\"" << tree.GetName(node) << "\\n";
 
-	switch (node->GetNodeType())
+	switch (n.type)
 	{
 	case NodeType::Sequence:
 		outstream << "[Sequence]\" shape=box";
@@ -625,7 +252,7 @@ void BehaviorTree::ToGraphVizHelper(Node* node, std::ofstream& outstream)
 		break;
 	case NodeType::Decorator:
 	{
-		switch (static_cast<Decorator*>(node)->GetDecoratorType())
+		switch (static_cast<DecoratorType>(n.kind))
 		{
 		case DecoratorType::Inverter:
 			outstream << "[Inverter]\" shape=box";
@@ -654,24 +281,10 @@ void BehaviorTree::ToGraphVizHelper(Node* node, std::ofstream& outstream)
 
 	outstream << "];" << std::endl;
 
-	switch (node->GetNodeType())
+	for (u32 i = 0; i < n.childCount; ++i)
 	{
-	case NodeType::Sequence:
-	case NodeType::Selector:
-		for (auto& child : static_cast<Composite*>(node)->GetChildren())
-		{
-			ToGraphVizHelper(child.get(), outstream);
-			outstream << node->GetName() << " -> " << child->GetName() << ";" << std::endl;
-		}
-		break;
-	case NodeType::Decorator:
-		{
-			Node* child = static_cast<Decorator*>(node)->GetChild().get();
-			ToGraphVizHelper(child, outstream);
-			outstream << node->GetName() << " -> " << child->GetName() << ";" << std::endl;
-		}
-		break;
-	default:
-		break;
+		const u16 child = tree.GetChild(node, i);
+		ToGraphVizHelper(tree, child, outstream);
+		outstream << tree.GetName(node) << " -> " << tree.GetName(child) << ";" << std::endl;
 	}
 }
\ No newline at end of file
@@ -1,342 +1,109 @@
 #pragma once
 #include <DOGEngine.h>
 
-struct BTDetectPlayerComponent
-{
-	//ID
-};
-
-struct BTAggroComponent
-{
-	//ID
-};
-
-struct BTAttackComponent
-{
-	//ID
-};
-
-struct BTJumpAtPlayerComponent
-{
-	//ID
-};
-
-struct BTPullBackComponent
-{
-	//ID
-};
-
-struct BTDodgeComponent
-{
-	//ID
-};
-
-struct BTMoveToPlayerComponent
-{
-	//ID
-};
-
-struct BTCreatePatrolComponent
-{
-	//ID
-};
-
-struct BTExecutePatrolComponent
-{
-	//ID
-};
-
-struct BTHitDetectComponent
-{
-	//ID
-};
-
-struct BTDistanceToPlayerComponent
-{
-	//ID
-};
-
-struct BTLineOfSightToPlayerComponent
-{
-	//ID
-};
-
-struct BTGetPathComponent
-{
-	//ID
-};
-
 enum class NodeType : uint8_t { Sequence = 0, Selector, Decorator, Leaf };
 enum class DecoratorType : uint8_t { Inverter = 0, Succeeder, Failer, Root };
-
-class Node
+enum class LeafType : uint8_t
 {
-public:
-	Node(const std::string& name, NodeType type) noexcept;
-	virtual ~Node() noexcept = default;
-	virtual void Process(DOG::entity agent) noexcept = 0;
-	
-	[[nodiscard]] constexpr const std::string& GetName() const noexcept { return m_name; }
-	[[nodiscard]] constexpr const NodeType GetNodeType() const noexcept { return m_nodeType; }
-	[[nodiscard]] Node* GetParent() const noexcept { return m_parent; }
-	[[nodiscard]] constexpr const bool Succeeded() const noexcept { return m_succeeded; }
-	void SetSucceededAs(bool result) noexcept { m_succeeded = result; }
-	void SetParent(Node* pNode) noexcept;
-private:
-	bool m_succeeded = false;
-	std::string m_name;
-	NodeType m_nodeType;
-	Node* m_parent;
+	DetectPlayer = 0, DetectHit, SignalGroup, Attack, MoveToPlayer, DistanceToPlayer, IsAlert,
+	LineOfSightToPlayer, GetPath, JumpAtPlayer, PullBack, Dodge, CreatePatrol, ExecutePatrol
 };
 
-class Composite : public Node
+struct BTNode
 {
-public:
-	Composite(const std::string& name, NodeType type) noexcept;
-	virtual ~Composite() noexcept override = default;
-	virtual void Process(DOG::entity agent) noexcept override = 0;
-	void Reset() noexcept;
-	[[nodiscard]] constexpr const std::vector<std::shared_ptr<Node>>& GetChildren() const noexcept { return m_children; }
-	void AddChild(std::shared_ptr<Node>&& pNode) noexcept;
-	u32 m_currentChildIndex = 0;
-private:
-	std::vector<std::shared_ptr<Node>> m_children;
+	NodeType type;
+	u8 kind;			// DecoratorType or LeafType
+	u16 parent;
+	u16 firstChild;		// Into the child table of the tree
+	u16 childCount;
 };
 
-class Sequence : public Composite 
+// A behavior tree flattened into one node array. It is built once per agent type and shared by every agent of that type,
+// nothing in it changes while agents run it. Node 0 is the root decorator, children are added after their parent.
+class BehaviorTreeDefinition
 {
 public:
-	Sequence(const std::string& name) noexcept;
-	virtual ~Sequence() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-};
+	static constexpr u32 MAX_NODES = 32;
+	static constexpr u16 NO_NODE = UINT16_MAX;
 
-class Selector : public Composite
-{
-public:
-	Selector(const std::string& name) noexcept;
-	virtual ~Selector() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-};
+	u16 AddComposite(const std::string& name, NodeType type, u16 parent) noexcept;
+	u16 AddDecorator(const std::string& name, DecoratorType type, u16 parent) noexcept;
+	u16 AddLeaf(const std::string& name, LeafType type, u16 parent) noexcept;
 
-class Decorator : public Node
-{
-public:
-	Decorator(const std::string& name, const DecoratorType type) noexcept;
-	virtual ~Decorator() noexcept override = default;
-	virtual void Process(DOG::entity agent) noexcept = 0;
-	[[nodiscard]] constexpr const DecoratorType GetDecoratorType() const noexcept { return m_decoratorType; }
-	[[nodiscard]] constexpr const std::shared_ptr<Node>& GetChild() const noexcept { return m_child; }
-	void AddChild(std::shared_ptr<Node>&& pNode) noexcept;
-	bool processed = false;
-protected:
-	DecoratorType m_decoratorType;
+	[[nodiscard]] const BTNode& GetNode(u16 node) const noexcept { return m_nodes[node]; }
+	[[nodiscard]] u16 GetChild(u16 node, u32 index) const noexcept { return m_children[m_nodes[node].firstChild + index]; }
+	[[nodiscard]] const std::string& GetName(u16 node) const noexcept { return m_names[node]; }
+	[[nodiscard]] u16 Size() const noexcept { return static_cast<u16>(m_nodes.size()); }
 private:
-	std::shared_ptr<Node> m_child;
-};
+	u16 Add(const std::string& name, NodeType type, u8 kind, u16 parent) noexcept;
 
-class Succeeder : public Decorator
-{
-public:
-	Succeeder(const std::string& name) noexcept;
-	virtual ~Succeeder() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-};
-
-class Failer : public Decorator
-{
-public:
-	Failer(const std::string& name) noexcept;
-	virtual ~Failer() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-};
-
-class Inverter : public Decorator
-{
-public:
-	Inverter(const std::string& name) noexcept;
-	virtual ~Inverter() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-};
-
-class Root : public Decorator
-{
-public:
-	Root(const std::string& name) noexcept;
-	virtual ~Root() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-};
-
-class Leaf : public Node
-{
-public:
-	Leaf(const std::string& name) noexcept;
-	virtual ~Leaf() noexcept override = default;
-	virtual void Process(DOG::entity agent) noexcept override = 0;
-	virtual void Succeed(DOG::entity agent) noexcept = 0;
-	virtual void Fail(DOG::entity agent) noexcept = 0;
-	void ForceSucceed(DOG::entity agent) noexcept;
-	void ForceFail(DOG::entity agent) noexcept;
-};
-
-class DetectPlayerNode : public Leaf
-{
-public:
-	DetectPlayerNode(const std::string& name) noexcept;
-	virtual ~DetectPlayerNode() noexcept = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class DetectHitNode : public Leaf 
-{
-public:
-	DetectHitNode(const std::string& name) noexcept;
-	virtual ~DetectHitNode() noexcept = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class SignalGroupNode : public Leaf
-{
-public:
-	SignalGroupNode(const std::string& name) noexcept;
-	virtual ~SignalGroupNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class AttackNode : public Leaf
-{
-public:
-	AttackNode(const std::string& name) noexcept;
-	virtual ~AttackNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class MoveToPlayerNode : public Leaf
-{
-public:
-	MoveToPlayerNode(const std::string& name) noexcept;
-	virtual ~MoveToPlayerNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class DistanceToPlayerNode : public Leaf 
-{
-public:
-	DistanceToPlayerNode(const std::string& name) noexcept;
-	virtual ~DistanceToPlayerNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class IsAlertNode : public Leaf 
-{
-public:
-	IsAlertNode(const std::string& name) noexcept;
-	virtual ~IsAlertNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class LineOfSightToPlayerNode : public Leaf
-{
-public:
-	LineOfSightToPlayerNode(const std::string& name) noexcept;
-	virtual ~LineOfSightToPlayerNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class GetPathNode : public Leaf
-{
-public:
-	GetPathNode(const std::string& name) noexcept;
-	virtual ~GetPathNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-
-class JumpAtPlayerNode : public Leaf
-{
-public:
-	JumpAtPlayerNode(const std::string& name) noexcept;
-	virtual ~JumpAtPlayerNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class PullBackNode : public Leaf
-{
-public:
-	PullBackNode(const std::string& name) noexcept;
-	virtual ~PullBackNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class DodgeNode : public Leaf
-{
-public:
-	DodgeNode(const std::string& name) noexcept;
-	virtual ~DodgeNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-
-
-
-
-
-
-
-class CreatePatrolNode : public Leaf
-{
-public:
-	CreatePatrolNode(const std::string& name) noexcept;
-	virtual ~CreatePatrolNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
-};
-
-class ExecutePatrolNode : public Leaf
-{
-public:
-	ExecutePatrolNode(const std::string& name) noexcept;
-	virtual ~ExecutePatrolNode() noexcept override final = default;
-	virtual void Process(DOG::entity agent) noexcept override final;
-	virtual void Succeed(DOG::entity agent) noexcept override final;
-	virtual void Fail(DOG::entity agent) noexcept override final;
+	std::vector<BTNode> m_nodes;
+	std::vector<u16> m_children;		// Grouped by parent, in the order they were added
+	std::vector<std::string> m_names;	// Only read by ToGraphViz
 };
 
+// What one agent needs to run a shared tree. Plain data, adding it to an agent allocates nothing.
 struct BehaviorTreeComponent
 {
-	std::unique_ptr<Root> rootNode{ nullptr };
-	Node* currentRunningNode{ nullptr };
-};
+	const BehaviorTreeDefinition* tree{ nullptr };
+	u16 currentRunningNode{ 0 };
+	u32 succeeded{ 0 };										// One bit per node, the result it last reported to its parent
+	std::array<u8, BehaviorTreeDefinition::MAX_NODES> progress{};	// Composites: next child to run, decorators: whether the child has been run
 
-#define LEAF(x) static_cast<Leaf*>(x)
+	[[nodiscard]] bool Succeeded(u16 node) const noexcept { return succeeded & (1u << node); }
+};
 
 namespace BehaviorTree
 {
-	void ToGraphViz(Node* root, const std::string filename);
-	void ToGraphVizHelper(Node* node, std::ofstream& outstream);
+	// Runs the tree of the agent from its current node until a leaf has to wait for a system
+	void Process(DOG::entity agent, BehaviorTreeComponent& btc) noexcept;
+
+	// Reports the result of a running leaf and continues the tree from its parent
+	void Succeed(DOG::entity agent, u16 leaf) noexcept;
+	void Fail(DOG::entity agent, u16 leaf) noexcept;
+
+	// Agents waiting on a leaf are kept in one list per leaf type, there are no tag components to add and remove.
+	// The lists start over every frame, when AgentBehaviorTreeSystem processes every tree, and grow as trees step on
+	// during the frame. A leaf reached before its system has run is handled the same frame.
+	void BeginFrame() noexcept;
+	// The agents waiting on leaf, agents that reach it from here on are put in the list for the next batch
+	[[nodiscard]] const std::vector<DOG::entity>& TakeWaiting(LeafType leaf) noexcept;
+
+	// The pools are looked up once per batch, every agent then costs one sparse index per component. An agent that was
+	// destroyed or lost a component since it started waiting fails Contains (stale handles included) and is skipped.
+	template<typename... ComponentType, typename Function>
+	void ForEachWaiting(LeafType leaf, Function&& function) noexcept
+	{
+		const std::tuple<DOG::SparseSet<ComponentType>*...> pools{ DOG::EntityManager::Get().ExpandAsTupleArguments<ComponentType>()... };
+		for (DOG::entity agent : TakeWaiting(leaf))
+		{
+			std::apply([&](auto*... pool)
+				{
+					if ((pool->Contains(agent) && ...))
+						function(agent, pool->Get(agent)...);
+				}, pools);
+		}
+	}
+
+	template<typename... ComponentType, typename Function>
+	void ForEachWaitingParallel(LeafType leaf, Function&& function) noexcept
+	{
+		DOG::EntityManager& em = DOG::EntityManager::Get();
+		const std::tuple<DOG::SparseSet<ComponentType>*...> pools{ em.ExpandAsTupleArguments<ComponentType>()... };
+		const std::vector<DOG::entity>& agents = TakeWaiting(leaf);
+		em.ParallelForChunks(static_cast<u32>(agents.size()), [&](u32 begin, u32 end)
+			{
+				for (u32 i = begin; i < end; ++i)
+				{
+					std::apply([&](auto*... pool)
+						{
+							if ((pool->Contains(agents[i]) && ...))
+								function(agents[i], pool->Get(agents[i])...);
+						}, pools);
+				}
+			});
+	}
+
+	void ToGraphViz(const BehaviorTreeDefinition& tree, const std::string filename);
+	void ToGraphVizHelper(const BehaviorTreeDefinition& tree, u16 node, std::ofstream& outstream);
 }
\ No newline at end of file
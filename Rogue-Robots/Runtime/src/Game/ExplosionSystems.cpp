@@ -11,22 +11,23 @@ void ExplosionSystem::OnUpdate(entity e, TransformComponent& explosionTransform,
 	float power = explosionInfo.power;
 	float radius = explosionInfo.radius;
 
-	EntityManager::Get().Collect<TransformComponent, RigidbodyComponent>().Do([&](TransformComponent& transform, RigidbodyComponent& rigidbody)
-		{
-			Vector3 position = transform.GetPosition();
-			float distance = Vector3::Distance(position, explosionPosition);
-			if (distance > radius)
-				return;
-
-			//float squaredDistance = Vector3::DistanceSquared(position, explosionPosition);
-			//if (squaredDistance < 1.0f)
-			//	squaredDistance = 1.0f;
-			//power /= squaredDistance;
-
-			Vector3 direction = (position - explosionPosition);
-			direction.Normalize();
-			rigidbody.centralImpulse = direction * rigidbody.mass * power;
-		});
+	// Only the rigidbodies within the radius are visited
+	m_inRange.clear();
+	SpatialIndex::QueryRadius<RigidbodyComponent>(explosionPosition, radius, m_inRange);
+	for (entity hit : m_inRange)
+	{
+		Vector3 position = EntityManager::Get().GetComponent<TransformComponent>(hit).GetPosition();
+		RigidbodyComponent& rigidbody = EntityManager::Get().GetComponent<RigidbodyComponent>(hit);
+
+		//float squaredDistance = Vector3::DistanceSquared(position, explosionPosition);
+		//if (squaredDistance < 1.0f)
+		//	squaredDistance = 1.0f;
+		//power /= squaredDistance;
+
+		Vector3 direction = (position - explosionPosition);
+		direction.Normalize();
+		rigidbody.centralImpulse = direction * rigidbody.mass * power;
+	}
 
 	EntityManager::Get().RemoveComponent<ExplosionComponent>(e);
 }
@@ -8,6 +8,8 @@ public:
 	SYSTEM_CLASS(DOG::TransformComponent, ExplosionComponent);
 	ON_UPDATE_ID(DOG::TransformComponent, ExplosionComponent);
 	void OnUpdate(DOG::entity e, DOG::TransformComponent& explosionTransform, ExplosionComponent& explosionInfo);
+private:
+	std::vector<DOG::entity> m_inRange;
 };
 
 class ExplosionEffectSystem : public DOG::ISystem
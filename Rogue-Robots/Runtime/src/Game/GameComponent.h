@@ -259,14 +259,12 @@ struct ChildComponent
 {
 	DOG::entity parent = DOG::NULL_ENTITY;
 	DOG::TransformComponent localTransform;
-	bool nodeHasBeenUpdated = false;
 };
 
 struct ChildToBoneComponent
 {
 	DOG::entity boneParent = DOG::NULL_ENTITY;
 	DOG::TransformComponent localTransform;
-	bool nodeHasBeenUpdated = false;
 };
 
 struct WeaponLightComponent
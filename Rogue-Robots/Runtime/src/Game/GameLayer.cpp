@@ -8,6 +8,7 @@
 #include "ExplosionSystems.h"
 #include "TurretSystems.h"
 #include "HomingMissileSystem.h"
+#include "TransformHierarchySystem.h"
 #include "PCG/PcgLevelLoader.h"
 #include "PrefabInstantiatorFunctions.h"
 #include "ItemManager/ItemManager.h"
@@ -28,6 +29,7 @@ NetworkStatus GameLayer::s_networkStatus = NetworkStatus::Offline;
 GameState GameLayer::m_gameState = GameState::Initializing;
 bool GameLayer::s_connectedPlayersLobby[MAX_PLAYER_COUNT] = { false, false, false, false };
 u16 GameLayer::s_levelIndex = 0;
+u64 GameLayer::s_levelSeed = 0;
 std::unique_ptr<WFC> GameLayer::s_WFC = nullptr;
 
 GameLayer::GameLayer() noexcept
@@ -56,9 +58,7 @@ GameLayer::GameLayer() noexcept
 		}
 	);
 
-	m_entityManager.RegisterSystem(std::make_unique<ScuffedSceneGraphSystem>());
-	m_entityManager.RegisterSystem(std::make_unique<SetFlashLightToBoneSystem>());
-	m_entityManager.RegisterSystem(std::make_unique<SetGunToBoneSystem>());
+	m_entityManager.RegisterSystem(std::make_unique<TransformHierarchySystem>());
 	m_entityManager.RegisterSystem(std::make_unique<DoorOpeningSystem>());
 	m_entityManager.RegisterSystem(std::make_unique<LerpAnimationSystem>());
 	m_entityManager.RegisterSystem(std::make_unique<LerpColorSystem>());
@@ -388,8 +388,10 @@ void GameLayer::OnUpdate()
 
 }
 
-void GameLayer::GenerateLevel()
+void GameLayer::GenerateLevel(u64 seed)
 {
+	s_levelSeed = seed;
+
 	//Number of rooms to generate.
 	uint32_t nrOfRooms = 4;
 
@@ -398,9 +400,9 @@ void GameLayer::GenerateLevel()
 	uint32_t minHeight = 5;
 	uint32_t minDepth = 13;
 
-	//The generation has a certain amount of chances to succeed.
+	//The generation has a certain amount of chances to succeed. Each chance uses the next seed derived from the level seed.
 	unsigned chances = 100;
-	while (!s_WFC->GenerateLevel(nrOfRooms, minWidth, minHeight, minDepth) && chances > 0)
+	while (!s_WFC->GenerateLevel(DeriveSeed(seed, 100u - chances), nrOfRooms, minWidth, minHeight, minDepth) && chances > 0)
 	{
 		chances--;
 		std::cout << chances << std::endl;
@@ -408,8 +410,8 @@ void GameLayer::GenerateLevel()
 	if (chances != 0)
 	{
 		//Output the generated level to a textfile.
-		std::vector<std::string> generatedLevel = s_WFC->GetGeneratedLevel();
-		std::vector<Room> generatedRooms = s_WFC->GetGeneratedRoomsData();
+		const std::vector<TileId>& generatedLevel = s_WFC->GetGeneratedLevel();
+		const std::vector<Room>& generatedRooms = s_WFC->GetGeneratedRoomsData();
 
 		std::ofstream output("Assets\\Levels\\Generate.txt");
 
@@ -432,7 +434,7 @@ void GameLayer::GenerateLevel()
 			{
 				for (uint32_t k{ 0u }; k < w; ++k)
 				{
-					output << generatedLevel[i * h * w + j * w + k] << " ";
+					output << TileNames::ToString(generatedLevel[i * h * w + j * w + k]) << " ";
 				}
 				output << "\n";
 			}
@@ -1032,7 +1034,8 @@ void HostButtonFunc(void)
 
 	if (GameLayer::s_levelIndex == 0) //If generate level
 	{
-		GameLayer::GenerateLevel();
+		std::random_device rd;
+		GameLayer::GenerateLevel((u64(rd()) << 32) | rd()); //random_device only gives 32 bits per draw
 	}
 
 	//Reset player list.
@@ -1096,7 +1099,8 @@ void PlayButtonFunc(void)
 
 	if (GameLayer::s_levelIndex == 0) //If generate level
 	{
-		GameLayer::GenerateLevel();
+		std::random_device rd;
+		GameLayer::GenerateLevel((u64(rd()) << 32) | rd()); //random_device only gives 32 bits per draw
 	}
 
 	if(GameLayer::GetGameStatus() != GameState::Playing)
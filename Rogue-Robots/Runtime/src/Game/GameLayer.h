@@ -56,8 +56,9 @@ public:
 	static GameState GetGameStatus() { return m_gameState; };
 	static NetworkStatus GetNetworkStatus() { return s_networkStatus; }
 	static u16 s_levelIndex;
+	static u64 s_levelSeed; //The seed of the latest generated level, the same seed generates the same level.
 
-	static void GenerateLevel();
+	static void GenerateLevel(u64 seed);
 	static std::unique_ptr<WFC> s_WFC;
 private:
 	void UpdateLobby();
@@ -6,48 +6,6 @@ using namespace DOG;
 using namespace DirectX;
 using namespace SimpleMath;
 
-void UpdateParentNode(entity parent)
-{
-	auto& em = EntityManager::Get();
-	assert(em.HasComponent<TransformComponent>(parent));
-	if (auto parentAsChild = em.TryGetComponent<ChildComponent>(parent); parentAsChild && !parentAsChild->get().nodeHasBeenUpdated)
-	{
-		entity grandParent = parentAsChild->get().parent;
-		if (em.Exists(grandParent)) // Grand parent might have been removed. In this case we ignore it.
-		{
-			UpdateParentNode(grandParent);
-			auto& grandParentWorld = em.GetComponent<TransformComponent>(grandParent);
-			auto& parentWorld = em.GetComponent<TransformComponent>(parent);
-			parentWorld.worldMatrix = parentAsChild->get().localTransform * grandParentWorld.worldMatrix;
-			parentAsChild->get().nodeHasBeenUpdated = true;
-		}
-	}
-}
-
-void ScuffedSceneGraphSystem::OnUpdate(entity e, ChildComponent& child, TransformComponent& world)
-{
-	auto& em = EntityManager::Get();
-	if (em.Exists(child.parent) && !em.HasComponent<DOG::DeferredDeletionComponent>(child.parent))
-	{
-		if (!child.nodeHasBeenUpdated)
-		{
-			UpdateParentNode(child.parent);
-			auto& parentWorld = em.GetComponent<TransformComponent>(child.parent);
-			world.worldMatrix = child.localTransform * parentWorld.worldMatrix;
-			child.nodeHasBeenUpdated = true;
-		}
-	}
-	else
-	{
-		em.DeferredEntityDestruction(e);
-	}
-}
-
-
-void ScuffedSceneGraphSystem::OnLateUpdate(ChildComponent& child)
-{
-	child.nodeHasBeenUpdated = false;
-}
 void DespawnSystem::OnUpdate(DOG::entity e, DespawnComponent& despawn)
 {
 	if (despawn.despawnTimer < Time::ElapsedTime())
@@ -1038,7 +996,7 @@ void GlowStickSystem::OnUpdate(entity e, GlowStickComponent&, RigidbodyComponent
 	auto& em = EntityManager::Get();
 	if (rigidBody.linearVelocity.LengthSquared() > 0.1f)
 	{
-		em.AddOrReplaceComponent<DirtyComponent>(e).SetDirty(DirtyComponent::positionChanged);
+		em.MarkChanged<TransformComponent>(e);
 	}
 }
 
@@ -1059,46 +1017,6 @@ void PlayerUseEquipmentSystem::OnUpdate(DOG::entity e, InputController& controll
 }
 
 
-void SetFlashLightToBoneSystem::OnUpdate(DOG::entity e, ChildToBoneComponent& child, DOG::TransformComponent& world)
-{
-	auto& em = EntityManager::Get();
-	if (em.Exists(child.boneParent))
-	{
-		if (!em.HasComponent<ModelComponent>(e))
-		{
-			world.worldMatrix = child.localTransform *
-				em.GetComponent<MixamoHeadJointTF>(child.boneParent).transform *
-				em.GetComponent<TransformComponent>(child.boneParent).worldMatrix;
-
-			world.SetPosition(world.GetPosition() + Vector3(0.f, -0.5f, 0.f)); // Account for capsule offset
-		}
-	}
-	else
-	{
-		em.DeferredEntityDestruction(e);
-	}
-}
-
-void SetGunToBoneSystem::OnUpdate(DOG::entity e, ChildToBoneComponent& child, DOG::TransformComponent& world)
-{
-	auto& em = EntityManager::Get();
-	if (em.Exists(child.boneParent))
-	{
-		if (em.HasComponent<ModelComponent>(e))
-		{
-			world.worldMatrix = child.localTransform *
-				em.GetComponent<MixamoRightHandJointTF>(child.boneParent).transform *
-				em.GetComponent<TransformComponent>(child.boneParent).worldMatrix;
-
-			world.SetPosition(world.GetPosition() + Vector3(0.f, -0.5f, 0.f)); // Account for model capsule offset
-		}
-	}
-	else
-	{
-		em.DeferredEntityDestruction(e);
-	}
-}
-
 void WeaponPointLightSystem::OnUpdate(WeaponLightComponent&, DOG::PointLightComponent& pointLight, ChildComponent&)
 {
 	pointLight.dirty = true;
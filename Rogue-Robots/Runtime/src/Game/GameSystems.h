@@ -2,6 +2,7 @@
 #include <DOGEngine.h>
 #include "GameComponent.h"
 #include "../UI/InGameMenu.h"
+#include "../Pathfinder/Pathfinder.h"
 
 class DoorOpeningSystem : public DOG::ISystem
 {
@@ -18,6 +19,9 @@ public:
 			door.openValue = 1.f;
 			door.isOpening = false;
 			std::cout << "Door opened!" << "\n";
+
+			// Agents can walk through the doorway now
+			Pathfinder::Get().UpdateNavRegion(transform.GetPosition(), transform.GetPosition());
 			return;
 		}
 		else if (door.openValue >= 1.f) return;
@@ -64,6 +68,7 @@ class MVPFlashlightMoveSystem : public DOG::ISystem
 {
 public:
 	SYSTEM_CLASS(DOG::SpotLightComponent, DOG::CameraComponent, DOG::TransformComponent);
+	SYSTEM_ACCESS(DOG::Reads<DOG::TransformComponent, PlayerControllerComponent, DOG::ThisPlayer>, DOG::Writes<DOG::SpotLightComponent, DOG::CameraComponent>);
 	ON_UPDATE(DOG::SpotLightComponent, DOG::CameraComponent, DOG::TransformComponent);
 
 	void OnUpdate(DOG::SpotLightComponent& slc, DOG::CameraComponent& cc, DOG::TransformComponent& stc)
@@ -551,36 +556,6 @@ public:
 	}
 };
 
-class ScuffedSceneGraphSystem : public DOG::ISystem
-{
-public:
-	SYSTEM_CLASS(ChildComponent, DOG::TransformComponent);
-
-	ON_UPDATE_ID(ChildComponent, DOG::TransformComponent);
-	void OnUpdate(DOG::entity e, ChildComponent& child, DOG::TransformComponent& world);
-
-	ON_LATE_UPDATE(ChildComponent);
-	void OnLateUpdate(ChildComponent& child);
-};
-
-class SetFlashLightToBoneSystem : public DOG::ISystem
-{
-public:
-	SYSTEM_CLASS(ChildToBoneComponent, DOG::TransformComponent);
-
-	ON_UPDATE_ID(ChildToBoneComponent, DOG::TransformComponent);
-	void OnUpdate(DOG::entity e, ChildToBoneComponent& child, DOG::TransformComponent& world);
-};
-
-class SetGunToBoneSystem : public DOG::ISystem
-{
-public:
-	SYSTEM_CLASS(ChildToBoneComponent, DOG::TransformComponent);
-
-	ON_UPDATE_ID(ChildToBoneComponent, DOG::TransformComponent);
-	void OnUpdate(DOG::entity e, ChildToBoneComponent& child, DOG::TransformComponent& world);
-};
-
 class PlaceHolderDeathUISystem : public DOG::ISystem
 {
 public:
@@ -175,42 +175,47 @@ void HomingMissileImpacteSystem::OnUpdate(entity e, HomingMissileComponent& miss
 
 		if (missile.armed || missile.hit > 3)
 		{
-			em.Collect<AgentIdComponent, DOG::TransformComponent>().Do([&](entity agent, AgentIdComponent&, DOG::TransformComponent& tr)
+			m_inRange.clear();
+			SpatialIndex::QueryRadius<AgentIdComponent>(transform.GetPosition(), missile.explosionRadius, m_inRange);
+			for (entity agent : m_inRange)
+			{
+				float distSquared = Vector3::DistanceSquared(transform.GetPosition(), em.GetComponent<DOG::TransformComponent>(agent).GetPosition());
+				if (distSquared < missile.explosionRadius * missile.explosionRadius)
 				{
-					float distSquared = Vector3::DistanceSquared(transform.GetPosition(), tr.GetPosition());
-					if (distSquared < missile.explosionRadius * missile.explosionRadius)
-					{
-						AgentHitComponent* hit;
-						if (em.HasComponent<AgentHitComponent>(agent))
-							hit = &em.GetComponent<AgentHitComponent>(agent);
-						else
-							hit = &em.AddComponent<AgentHitComponent>(agent);
-						hit->HitBy({ e, missile.playerEntityID , missile.dmg / (1.0f + distSquared) });
-					}
-				});
+					AgentHitComponent* hit;
+					if (em.HasComponent<AgentHitComponent>(agent))
+						hit = &em.GetComponent<AgentHitComponent>(agent);
+					else
+						hit = &em.AddComponent<AgentHitComponent>(agent);
+					hit->HitBy({ e, missile.playerEntityID , missile.dmg / (1.0f + distSquared) });
+				}
+			}
 
 			// Friendly fire
-			em.Collect<DOG::TransformComponent, PlayerAliveComponent, ThisPlayer>().Do([&](entity player, DOG::TransformComponent& playerTransform, PlayerAliveComponent&, ThisPlayer&)
+			m_inRange.clear();
+			SpatialIndex::QueryRadius<PlayerAliveComponent, ThisPlayer>(transform.GetPosition(), missile.explosionRadius, m_inRange);
+			for (entity player : m_inRange)
+			{
+				DOG::TransformComponent& playerTransform = em.GetComponent<DOG::TransformComponent>(player);
+				float distSquared = Vector3::DistanceSquared(transform.GetPosition(), playerTransform.GetPosition());
+				if (distSquared < missile.explosionRadius * missile.explosionRadius)
 				{
-					float distSquared = Vector3::DistanceSquared(transform.GetPosition(), playerTransform.GetPosition());
-					if (distSquared < missile.explosionRadius * missile.explosionRadius)
+					auto& fakeHit = em.AddOrGetComponent<HasEnteredCollisionComponent>(player);
+					if (fakeHit.entitiesCount < fakeHit.maxCount)
 					{
-						auto& fakeHit = em.AddOrGetComponent<HasEnteredCollisionComponent>(player);
-						if (fakeHit.entitiesCount < fakeHit.maxCount)
-						{
-							fakeHit.entities[fakeHit.entitiesCount] = e;
-							Vector3 n = playerTransform.GetPosition() - transform.GetPosition();
-							n.Normalize();
-							fakeHit.normal[fakeHit.entitiesCount] = n;
-							fakeHit.entitiesCount++;
-
-							assert(!em.HasComponent<TeamDamageDealerComponent>(e));
-							auto& damageDealer = em.AddComponent<TeamDamageDealerComponent>(e);
-							damageDealer.playerEntityID = missile.playerEntityID;
-							damageDealer.damage = missile.dmg / (1.0f + distSquared);
-						}
+						fakeHit.entities[fakeHit.entitiesCount] = e;
+						Vector3 n = playerTransform.GetPosition() - transform.GetPosition();
+						n.Normalize();
+						fakeHit.normal[fakeHit.entitiesCount] = n;
+						fakeHit.entitiesCount++;
+
+						assert(!em.HasComponent<TeamDamageDealerComponent>(e));
+						auto& damageDealer = em.AddComponent<TeamDamageDealerComponent>(e);
+						damageDealer.playerEntityID = missile.playerEntityID;
+						damageDealer.damage = missile.dmg / (1.0f + distSquared);
 					}
-				});
+				}
+			}
 
 			auto& expEffect = em.AddComponent<ExplosionEffectComponent>(e, 0.8f * missile.explosionRadius);
 			expEffect.audioVolume = 100;
@@ -289,25 +294,19 @@ HomingMissileImpacteSystem::HomingMissileImpacteSystem()
 
 void HomingMissileTargetingSystem::OnUpdate(HomingMissileComponent& missile, DOG::TransformComponent& transform)
 {
-	float minDistSquared = 1000000;
-	entity target = NULL_ENTITY;
+	constexpr float MAX_TARGET_DISTANCE = 1000.0f;
 	if (!missile.homing)
 		return;
 
 	if (missile.homingTarget == NULL_ENTITY)
 	{
-		EntityManager::Get().Collect<AgentHPComponent, DOG::TransformComponent>().Do([&](entity e, AgentHPComponent&, DOG::TransformComponent& agentTransform)
+		// The closest agent in line of sight, agents are raycast against closest first and only until one is visible
+		const Vector3 missilePosition = transform.GetPosition();
+		missile.homingTarget = SpatialIndex::FindNearest<AgentHPComponent>(missilePosition, MAX_TARGET_DISTANCE, [&](entity agent)
 			{
-				float distSquared = Vector3::DistanceSquared(agentTransform.GetPosition(), transform.GetPosition());
-				if (distSquared < minDistSquared)
-				{
-					if (auto hit = PhysicsEngine::RayCast(transform.GetPosition(), agentTransform.GetPosition()); hit && hit->entityHit == e)
-					{
-						minDistSquared = distSquared;
-						target = e;
-					}
-				}
+				const Vector3 agentPosition = EntityManager::Get().GetComponent<DOG::TransformComponent>(agent).GetPosition();
+				auto hit = PhysicsEngine::RayCast(missilePosition, agentPosition);
+				return hit && hit->entityHit == agent;
 			});
-		missile.homingTarget = target;
 	}
 }
@@ -30,6 +30,7 @@ public:
 	inline static bool s_useSmokeExplosion = true;
 private:
 	u32 m_smokeTexureAssetID{ 0 };
+	std::vector<DOG::entity> m_inRange;
 };
 
 class HomingMissileTargetingSystem : public DOG::ISystem
@@ -52,7 +52,9 @@ void PlayMusicSystem::OnUpdate(MusicPlayer& musicPlayer)
 	AudioComponent& ambienceAudioComponent = EntityManager::Get().GetComponent<AudioComponent>(m_ambienceMusicEntity);
 
 	bool foundAggro = false;
-	EntityManager::Get().Collect<AgentAggroComponent>().Do([&](AgentAggroComponent) {
+	EntityManager::Get().Collect<AgentAggroComponent>().Do([&](AgentAggroComponent aggro) {
+		if (!aggro.active)
+			return;
 		foundAggro = true;
 		actionAudioComponent.volume = ACTION_MUSIC_VOLUME;
 		ambienceAudioComponent.volume = 0.0f;
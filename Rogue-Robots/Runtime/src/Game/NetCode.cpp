@@ -327,6 +327,7 @@ void NetCode::ReceiveDataUdp()
 	>().Do([&](entity id, TransformComponent& transformC, NetworkPlayerComponent& networkC, InputController& inputC, OnlinePlayer&, PlayerStatsComponent& statsC, PlayerControllerComponent& pC, AnimationComponent& aC)
 		{
 			transformC.worldMatrix = m_outputUdp.m_holdplayersUdp[networkC.playerId].playerTransform;
+			s_entityManager.MarkChanged<TransformComponent>(id);
 			inputC = m_outputUdp.m_holdplayersUdp[networkC.playerId].actions;
 			if (statsC.health > m_outputUdp.m_holdplayersUdp[networkC.playerId].playerStat.health)
 				PlayerManager::Get().HurtOnlinePlayers(id);
@@ -338,6 +339,7 @@ void NetCode::ReceiveDataUdp()
 			}
 			if ((pC.cameraEntity != DOG::NULL_ENTITY) && (m_outputUdp.m_holdplayersUdp[networkC.playerId].cameraTransform.Determinant() != 0)) {
 				s_entityManager.GetComponent<TransformComponent>(pC.cameraEntity).worldMatrix = m_outputUdp.m_holdplayersUdp[networkC.playerId].cameraTransform;
+				s_entityManager.MarkChanged<TransformComponent>(pC.cameraEntity);
 			}
 		});
 }
@@ -353,8 +355,10 @@ void NetCode::UpdateSendTcp()
 			//sync all transforms Host only
 			if (m_inputTcp.playerId == 0 && m_syncCounter % HARD_SYNC_FRAME == 0)
 			{
-				EntityManager::Get().Collect<NetworkTransform, TransformComponent, AgentIdComponent, AgentAggroComponent>().Do([&](NetworkTransform& netC, TransformComponent& transC, AgentIdComponent agentId, AgentAggroComponent&)
+				EntityManager::Get().Collect<NetworkTransform, TransformComponent, AgentIdComponent, AgentAggroComponent>().Do([&](NetworkTransform& netC, TransformComponent& transC, AgentIdComponent agentId, AgentAggroComponent& aggro)
 					{
+						if (!aggro.active)
+							return;
 						netC.objectId = agentId.id;
 						netC.position = transC.GetPosition();
 						//netC.rotation = transC.GetRotation(); might enabel agian 
@@ -438,7 +442,7 @@ void NetCode::ReceiveDataTcp()
 				if (m_inputTcp.playerId > 0)
 				{
 					NetworkTransform* tempTransfrom = new NetworkTransform;
-					EntityManager::Get().Collect<NetworkTransform, TransformComponent, AgentIdComponent, CapsuleColliderComponent>().Do([&](NetworkTransform&, TransformComponent& transC, AgentIdComponent& idC, CapsuleColliderComponent& rC)
+					EntityManager::Get().Collect<NetworkTransform, TransformComponent, AgentIdComponent, CapsuleColliderComponent>().Do([&](entity e, NetworkTransform&, TransformComponent& transC, AgentIdComponent& idC, CapsuleColliderComponent& rC)
 						{
 							for (u32 i = 0; i < header.nrOfNetTransform; ++i)
 							{
@@ -454,6 +458,7 @@ void NetCode::ReceiveDataTcp()
 									if (compare.Length() > (capsuleThreshold))
 									{
 										transC.SetPosition(tempTransfrom->position);
+										EntityManager::Get().MarkChanged<TransformComponent>(e);
 									}
 								}
 
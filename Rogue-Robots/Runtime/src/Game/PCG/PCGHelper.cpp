@@ -105,26 +105,11 @@ std::vector<std::pair<uint32_t, int>> AStarRoom(Room& room, uint32_t* start, uin
 			{
 				continue;
 			}
-			else if (room.generatedRoom[neighborIndex] == "Void")
+			else if (room.generatedRoom[neighborIndex].name == TileName("Void"))
 			{
 				weight = 10'000;
 			}
-			else if (room.generatedRoom[current.index].find("Door") != std::string::npos && room.generatedRoom[neighborIndex] == "Void")
-			{
-				continue;
-			}
-			else if (//All blocks it shouldnt be able to create a door through.
-				room.generatedRoom[neighborIndex].find("Roof") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("Wall1") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("Shelf") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("WallToRoofCorner") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("InnerCorner") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("Riverbed") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("Spawn") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("Exit") != std::string::npos ||
-				room.generatedRoom[neighborIndex].find("Cliff") != std::string::npos ||
-				(room.generatedRoom[neighborIndex].find("Floor1") != std::string::npos && room.generatedRoom[neighborIndex].find("WallFloor1") == std::string::npos && room.generatedRoom[neighborIndex].find("CornerFloor1") == std::string::npos)
-				)
+			else if (TileNames::Has(room.generatedRoom[neighborIndex], TILE_SOLID)) //All blocks it shouldnt be able to create a door through.
 			{
 				continue;
 			}
@@ -164,7 +149,7 @@ std::vector<std::pair<uint32_t, int>> AStarRoom(Room& room, uint32_t* start, uin
 	return v;
 }
 
-std::vector<std::pair<uint32_t, int>> AStarLevel(uint32_t& width, uint32_t& height, uint32_t& depth, std::vector<std::string>& level, uint32_t* start, uint32_t* goal)
+std::vector<std::pair<uint32_t, int>> AStarLevel(uint32_t& width, uint32_t& height, uint32_t& depth, std::vector<TileId>& level, uint32_t* start, uint32_t* goal)
 {
 	uint32_t startIndex = start[0] + start[1] * width + start[2] * width * height;
 	uint32_t goalIndex = goal[0] + goal[1] * width + goal[2] * width * height;
@@ -250,19 +235,19 @@ std::vector<std::pair<uint32_t, int>> AStarLevel(uint32_t& width, uint32_t& heig
 			{
 				continue;
 			}
-			else if ((level[neighborIndex].find("Door") != std::string::npos || level[current.index].find("Door") != std::string::npos) && (i == 2 || i == 3))
+			else if ((TileNames::Has(level[neighborIndex], TILE_DOOR) || TileNames::Has(level[current.index], TILE_DOOR)) && (i == 2 || i == 3))
 			{
 				continue; //Do not allow the A* to go into a door from a vertical angle.
 			}
-			else if (level[neighborIndex].find("Connector") != std::string::npos)
+			else if (TileNames::Has(level[neighborIndex], TILE_CONNECTOR))
 			{
 				weight = 1;
 			}
-			else if (level[neighborIndex].find("Door") != std::string::npos)
+			else if (TileNames::Has(level[neighborIndex], TILE_DOOR))
 			{
 				weight = 1;
 			}
-			else if (level[neighborIndex] != "Void")
+			else if (level[neighborIndex].name != TileName("Void"))
 			{
 				continue; //Do not allow the A* to go inside rooms.
 			}
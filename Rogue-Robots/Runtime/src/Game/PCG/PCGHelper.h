@@ -14,6 +14,7 @@
 #include <limits>
 #include <thread>
 */
+#include "TileId.h"
 
 //Used to save data read from the input.
 struct Block
@@ -23,21 +24,6 @@ struct Block
 	std::vector<unsigned int> dirPossibilities[6];
 };
 
-//Id is the index in the 1D-array and possibilities is the possibilities that are left for this cell.
-struct EntropyBlock
-{
-	uint32_t id = (uint32_t)-1;
-	std::vector<unsigned int> possibilities;
-};
-
-//Used in the PriorityQueue. Points to an entryblock and has a calculated Shannon Entropy.
-struct QueueBlock
-{
-	EntropyBlock* m_block = nullptr;
-	float m_entropy = 0.0f;
-	std::shared_ptr<QueueBlock> m_next;
-};
-
 struct Box
 {
 	Box(std::vector<uint32_t>& minIn, std::vector<uint32_t>& maxIn)
@@ -164,10 +150,21 @@ struct Room
 	uint32_t depth = 0;
 
 	Door doors[4]; //+x, +z, -x, -z
-	std::vector<std::string> generatedRoom;
+	std::vector<TileId> generatedRoom;
 	bool generationSuccess = false;
+	uint64_t seed = 0u; //Derived from the level seed.
 };
 
+//SplitMix64 of the seed and the stream. Used to give every room and every attempt of a room its own seed,
+//so what a room generates does not depend on which thread it runs on or when.
+inline uint64_t DeriveSeed(uint64_t seed, uint64_t stream)
+{
+	uint64_t z = seed + (stream + 1u) * 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31u);
+}
+
 struct AStarData
 {
 	AStarData(uint32_t i, uint32_t f, uint32_t g) : index{ i }, fScore{ f }, gScore{ g } {
@@ -189,4 +186,4 @@ public:
 std::vector<uint32_t> ReconstructPath(std::unordered_map<uint32_t, uint32_t>& cameFrom, uint32_t current);
 uint32_t Heuristic(uint32_t* start, uint32_t* goal);
 std::vector<std::pair<uint32_t, int>> AStarRoom(Room& room, uint32_t* start, uint32_t* goal);
-std::vector<std::pair<uint32_t, int>> AStarLevel(uint32_t& width, uint32_t& height, uint32_t& depth, std::vector<std::string>& level, uint32_t* start, uint32_t* goal);
\ No newline at end of file
+std::vector<std::pair<uint32_t, int>> AStarLevel(uint32_t& width, uint32_t& height, uint32_t& depth, std::vector<TileId>& level, uint32_t* start, uint32_t* goal);
\ No newline at end of file
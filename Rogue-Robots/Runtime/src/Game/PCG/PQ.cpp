@@ -1,168 +1,129 @@
 #include "PQ.h"
 
-int PriorityQueue::Pop()
+void PriorityQueue::Reset(const WFCSolver& solver, unsigned int seed)
 {
-	if (!m_first)
+	const uint32_t cellCount = solver.GetCellCount();
+	std::default_random_engine gen;
+	gen.seed(seed);
+
+	m_heap.resize(cellCount);
+	m_positions.resize(cellCount);
+	m_entropy.resize(cellCount);
+	m_keys.resize(cellCount);
+	for (uint32_t cell{ 0u }; cell < cellCount; ++cell)
 	{
-		return -1; //When all blocks have been handled.
+		m_heap[cell] = cell;
+		m_positions[cell] = cell;
+		m_entropy[cell] = solver.GetEntropy(cell);
+		m_keys[cell] = static_cast<uint32_t>(gen());
 	}
-	else
-	{
-		//Go through the first few elements and see how many there are that share lowest entropy.
-		uint32_t count = 1;
-		float lowestVal = m_first->m_entropy;
-		std::shared_ptr<QueueBlock> current = m_first->m_next;
-		while (current && current->m_entropy == lowestVal)
-		{
-			++count;
-			current = current->m_next;
-		}
 
-		//If only the first element have the lowest entropy.
-		//Set 2nd element as first and return the removed element's index.
-		if (count == 1)
-		{
-			current = m_first;
-			m_first = m_first->m_next;
-
-			uint32_t returnIndex = current->m_block->id;
-			current->m_block = nullptr;
-			current->m_next = nullptr;
+	//Heapify bottom up.
+	for (uint32_t position = cellCount / 2u; position-- > 0u;)
+	{
+		SiftDown(position);
+	}
+}
 
-			return returnIndex;
-		}
-		//Otherwise we randomize one of the elements with the lowest entropy and remove it from the PQ.
-		else
-		{
-			std::default_random_engine gen;
-			gen.seed(static_cast<unsigned int>(time(NULL)));
-			std::uniform_int_distribution<uint32_t> dist(1, count);
-			uint32_t val = dist(gen);
+int PriorityQueue::Pop()
+{
+	if (m_heap.empty())
+	{
+		return -1; //When all cells have been handled.
+	}
 
-			//Go to the randomized element.
-			count = 1;
-			current = m_first;
-			std::shared_ptr<QueueBlock> prev = nullptr;
-			while (count != val)
-			{
-				prev = current;
-				current = current->m_next;
-				++count;
-			}
-			if (current)
-			{
-				//If it's the first element.
-				if (!prev)
-				{
-					m_first = m_first->m_next;
-				}
-				else
-				{
-					//If it's the last element.
-					if (!current->m_next)
-					{
-						prev->m_next = nullptr;
-					}
-					else
-					{
-						prev->m_next = current->m_next;
-					}
-				}
-				uint32_t returnIndex = current->m_block->id;
-				current->m_block = nullptr;
-				current->m_next = nullptr;
+	const uint32_t cell = m_heap[0];
+	m_positions[cell] = POPPED;
 
-				return returnIndex;
-			}
-			else
-			{
-				return -1; //Should never happen.
-			}
-		}
+	const uint32_t last = m_heap.back();
+	m_heap.pop_back();
+	if (!m_heap.empty())
+	{
+		Place(0u, last);
+		SiftDown(0u);
 	}
+	return static_cast<int>(cell);
 }
 
-bool PriorityQueue::Rearrange(uint32_t index, std::unordered_map<unsigned int, Block>& blockPossibilities)
+void PriorityQueue::Rearrange(uint32_t cell, const WFCSolver& solver)
 {
-	std::shared_ptr<QueueBlock> current = m_first;
-	std::shared_ptr<QueueBlock> prev = nullptr;
-	//Go to the element in question.
-	while (current && current->m_block->id != index)
+	const uint32_t position = m_positions[cell];
+	if (position == POPPED)
 	{
-		prev = current;
-		current = current->m_next;
+		return; //The cell has already been popped.
 	}
 
-	if (!current)
+	//The entropy usually drops, but removing a heavy tile can raise it.
+	const float entropy = solver.GetEntropy(cell);
+	const bool lower = entropy < m_entropy[cell];
+	m_entropy[cell] = entropy;
+	if (lower)
 	{
-		return true; //If the index has already been popped. (Could occur because of recursiveness)
+		SiftUp(position);
 	}
 	else
 	{
-		if (current->m_block->possibilities.size() == 0)
-		{
-			return false; //This means the generation failed, because a block ended up not having any valid block.
-		}
-
-		//Recalculate the entropy of the element.
-		current->m_entropy = CalculateEntropy(current->m_block->possibilities, blockPossibilities);
-
-		//If it's not the first element it might have to be moved.
-		if (prev)
-		{
-			//Remove it from the PQ.
-			prev->m_next = current->m_next;
-			current->m_next = nullptr;
+		SiftDown(position);
+	}
+}
 
-			//Find the spot where it is supposed to go.
-			std::shared_ptr<QueueBlock> stepper = m_first;
-			prev = nullptr;
-			while (stepper && stepper->m_entropy < current->m_entropy)
-			{
-				prev = stepper;
-				stepper = stepper->m_next;
-			}
+void PriorityQueue::Push(uint32_t cell, const WFCSolver& solver)
+{
+	if (m_positions[cell] != POPPED)
+	{
+		Rearrange(cell, solver);
+		return;
+	}
 
-			//If the spot where it is supposed to go is the front of the queue.
-			if (!prev)
-			{
-				current->m_next = m_first;
-				m_first = current;
-			}
-			else
-			{
-				//If it is not the last spot.
-				if (stepper)
-				{
-					current->m_next = prev->m_next;
-				}
+	m_entropy[cell] = solver.GetEntropy(cell);
+	m_heap.push_back(cell);
+	Place(static_cast<uint32_t>(m_heap.size() - 1u), cell);
+	SiftUp(static_cast<uint32_t>(m_heap.size() - 1u));
+}
 
-				prev->m_next = current;
-			}
+void PriorityQueue::SiftUp(uint32_t position)
+{
+	const uint32_t cell = m_heap[position];
+	while (position > 0u)
+	{
+		const uint32_t parent = (position - 1u) / 2u;
+		if (!Less(cell, m_heap[parent]))
+		{
+			break;
 		}
-		return true;
+		Place(position, m_heap[parent]);
+		position = parent;
 	}
+	Place(position, cell);
 }
 
-float PriorityQueue::CalculateEntropy(std::vector<unsigned int>& currentPossibilities, std::unordered_map<unsigned int, Block>& blockPossibilities)
+void PriorityQueue::SiftDown(uint32_t position)
 {
-	//Shannon entropy.
-
-	float sumWeights = 0.0f;
-	float sumWeightxLogWeight = 0.0f;
-
-	//Go through each possibility of the block and sum up the frequencies.
-	for (auto c : currentPossibilities)
+	const uint32_t cell = m_heap[position];
+	const uint32_t size = static_cast<uint32_t>(m_heap.size());
+	while (true)
 	{
-		float f = blockPossibilities[c].frequency * 100.0f; //Make the frequency into percentage, since log will be used.
-		sumWeights += f;
-		sumWeightxLogWeight += (f * log(f));
+		uint32_t child = 2u * position + 1u;
+		if (child >= size)
+		{
+			break;
+		}
+		if (child + 1u < size && Less(m_heap[child + 1u], m_heap[child]))
+		{
+			++child;
+		}
+		if (!Less(m_heap[child], cell))
+		{
+			break;
+		}
+		Place(position, m_heap[child]);
+		position = child;
 	}
+	Place(position, cell);
+}
 
-	return log(sumWeights) - (sumWeightxLogWeight / sumWeights);
-
-	//Normal entropy
-	/*
-	return currentPossibilities.size();
-	*/
+void PriorityQueue::Place(uint32_t position, uint32_t cell)
+{
+	m_heap[position] = cell;
+	m_positions[cell] = position;
 }
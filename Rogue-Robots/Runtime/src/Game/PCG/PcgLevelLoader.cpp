@@ -1,6 +1,7 @@
 #include "PcgLevelLoader.h"
 #include <DOGEngine.h>
 #include "../GameComponent.h"
+#include "TileId.h"
 using namespace DOG;
 using namespace DirectX::SimpleMath;
 
@@ -20,6 +21,15 @@ std::vector<DOG::entity> LoadLevel(std::string file)
 
 	std::vector<entity> levelBlocks;
 
+	//The models of a block name are only looked up the first time the name is seen.
+	struct BlockAssets
+	{
+		bool loaded = false;
+		u32 model = 0u;
+		u32 collider = 0u;
+	};
+	std::vector<BlockAssets> blockAssets;
+
 	unsigned x = 0;
 	unsigned y = 0;
 	unsigned z = 0;
@@ -37,12 +47,13 @@ std::vector<DOG::entity> LoadLevel(std::string file)
 		{
 			if (line[0] != '-')
 			{
-				while (line.find(' ') != std::string::npos)
+				std::string_view blocks = line;
+				while (blocks.find(' ') != std::string_view::npos)
 				{
-					size_t delimPos = line.find(' ');
-					std::string block = line.substr(0, delimPos);
-					line.erase(0, delimPos + 1);
-					if (block == "Empty")
+					size_t delimPos = blocks.find(' ');
+					const TileId block = TileNames::Parse(blocks.substr(0, delimPos));
+					blocks.remove_prefix(delimPos + 1);
+					if (block.name == TileName("Empty"))
 					{
 						entity blockEntity = levelBlocks.emplace_back(em.CreateEntity());
 						em.AddComponent<EmptySpaceComponent>(blockEntity, Vector3(x * blockDim, y * blockDim, z * blockDim));
@@ -50,19 +61,27 @@ std::vector<DOG::entity> LoadLevel(std::string file)
 						em.AddComponent<BoundingBoxComponent>(blockEntity,
 							Vector3{ x * blockDim, y * blockDim + blockDim / 2, z * blockDim }, extents);
 					}
-					else if (block != "Void")
+					else if (block.name != TileName("Void"))
 					{
-						size_t firstUnderscore = block.find('_');
-						size_t secondUnderscore = block.find('_', firstUnderscore + 1);
-						std::string blockName = block.substr(0, firstUnderscore);
-						int blockRot = std::stoi(block.substr(firstUnderscore + 2, secondUnderscore - firstUnderscore - 2));
+						if (block.name >= blockAssets.size())
+						{
+							blockAssets.resize(block.name + 1u);
+						}
+						BlockAssets& assets = blockAssets[block.name];
+						if (!assets.loaded)
+						{
+							const std::string& blockName = TileNames::Get(block.name);
+							assets.model = aManager.LoadModelAsset("Assets/Models/ModularBlocks/" + blockName + ".gltf");
+							assets.collider = aManager.LoadModelAsset("Assets/Models/ModularBlocks/" + blockName + "_Col.gltf", (DOG::AssetLoadFlag)((DOG::AssetLoadFlag)(DOG::AssetLoadFlag::CPUMemory | DOG::AssetLoadFlag::GPUMemory)));
+							assets.loaded = true;
+						}
 						Vector3 scale = Vector3(1.0f, 1.0f, 1.0f);
 
 						entity blockEntity = levelBlocks.emplace_back(em.CreateEntity());
-						em.AddComponent<ModelComponent>(blockEntity, aManager.LoadModelAsset("Assets/Models/ModularBlocks/" + blockName + ".gltf"));
+						em.AddComponent<ModelComponent>(blockEntity, assets.model);
 						em.AddComponent<TransformComponent>(blockEntity,
 							Vector3(x * blockDim, y * blockDim, z * blockDim),
-							Vector3(0.0f, -blockRot * piDiv2, 0.0f),
+							Vector3(0.0f, -block.rotation * piDiv2, 0.0f),
 							scale);
 						em.AddComponent<CheckForLightsComponent>(blockEntity);
 
@@ -74,21 +93,21 @@ std::vector<DOG::entity> LoadLevel(std::string file)
 
 						em.AddComponent<MeshColliderComponent>(blockEntity,
 							blockEntity,
-							aManager.LoadModelAsset("Assets/Models/ModularBlocks/" + blockName + "_Col.gltf", (DOG::AssetLoadFlag)((DOG::AssetLoadFlag)(DOG::AssetLoadFlag::CPUMemory | DOG::AssetLoadFlag::GPUMemory))),
+							assets.collider,
 							scale,
 							false);		// Set this to true if you want to see colliders only in wireframe
 						
 						em.AddComponent<ShadowReceiverComponent>(blockEntity);
 
-						if (blockName.find("Spawn") != std::string::npos)
+						if (TileNames::Has(block, TILE_SPAWN))
 						{
 							em.AddComponent<SpawnBlockComponent>(blockEntity);
 						}
-						else if (blockName.find("Exit") != std::string::npos)
+						else if (TileNames::Has(block, TILE_EXIT))
 						{
 							em.AddComponent<ExitBlockComponent>(blockEntity);
 						}
-						else if (blockName == "Floor1" || blockName == "Riverbed1" || blockName.find("Connector") != std::string::npos)
+						else if (TileNames::Has(block, TILE_FLOOR))
 						{
 							em.AddComponent<FloorBlockComponent>(blockEntity);
 						}
@@ -0,0 +1,151 @@
+#include "TileId.h"
+
+namespace
+{
+	struct NameTable
+	{
+		NameTable()
+		{
+			for (std::string_view name : BUILTIN_TILE_NAMES)
+			{
+				Add(name);
+			}
+		}
+
+		uint16_t Add(std::string_view name)
+		{
+			assert(names.size() < std::numeric_limits<uint16_t>::max());
+			const uint16_t id = static_cast<uint16_t>(names.size());
+			const std::string& stored = names.emplace_back(name);
+			ids[stored] = id;
+			flags.push_back(FindFlags(stored));
+			return id;
+		}
+
+		static uint32_t FindFlags(const std::string& name)
+		{
+			auto contains = [&](const char* part)
+			{
+				return name.find(part) != std::string::npos;
+			};
+
+			uint32_t found = 0u;
+			found |= contains("Door") ? TILE_DOOR : 0u;
+			found |= contains("Spawn") ? TILE_SPAWN : 0u;
+			found |= contains("Exit") ? TILE_EXIT : 0u;
+			found |= contains("Connector") ? TILE_CONNECTOR : 0u;
+			found |= contains("Replacer") ? TILE_REPLACER : 0u;
+			found |= contains("CornerFloor") ? TILE_CORNER_FLOOR : 0u;
+			found |= contains("CornerFloor1") ? TILE_CORNER_FLOOR1 : 0u;
+			found |= contains("CornerRoof1") ? TILE_CORNER_ROOF1 : 0u;
+
+			//All blocks a door should not be able to be created through.
+			if (contains("Roof") || contains("Wall1") || contains("Shelf") || contains("WallToRoofCorner") || contains("InnerCorner") ||
+				contains("Riverbed") || contains("Spawn") || contains("Exit") || contains("Cliff") ||
+				(contains("Floor1") && !contains("WallFloor1") && !contains("CornerFloor1")))
+			{
+				found |= TILE_SOLID;
+			}
+
+			if (name == "Floor1" || name == "Riverbed1" || contains("Connector"))
+			{
+				found |= TILE_FLOOR;
+			}
+			return found;
+		}
+
+		std::deque<std::string> names; //A deque so the views in ids stay valid.
+		std::vector<uint32_t> flags;
+		std::unordered_map<std::string_view, uint16_t> ids;
+	};
+
+	NameTable& GetTable()
+	{
+		static NameTable table;
+		return table;
+	}
+}
+
+uint16_t TileNames::Intern(std::string_view name)
+{
+	NameTable& table = GetTable();
+	auto it = table.ids.find(name);
+	if (it != table.ids.end())
+	{
+		return it->second;
+	}
+	return table.Add(name);
+}
+
+const std::string& TileNames::Get(uint16_t name)
+{
+	return GetTable().names[name];
+}
+
+uint32_t TileNames::GetFlags(uint16_t name)
+{
+	return GetTable().flags[name];
+}
+
+TileId TileNames::Parse(std::string_view block)
+{
+	TileId tile;
+	const size_t firstUnderscore = block.find('_');
+	tile.name = Intern(block.substr(0u, firstUnderscore));
+	if (firstUnderscore == std::string_view::npos)
+	{
+		return tile;
+	}
+
+	//The rotation is written as "_r<digit>" and the flip as "_f", "_fx" or "_fy".
+	if (firstUnderscore + 2u < block.size())
+	{
+		tile.rotation = static_cast<uint8_t>(block[firstUnderscore + 2u] - '0');
+	}
+	const size_t secondUnderscore = block.find('_', firstUnderscore + 1u);
+	const std::string_view flip = secondUnderscore == std::string_view::npos ? std::string_view{} : block.substr(secondUnderscore + 1u);
+	if (flip == "fx")
+	{
+		tile.flip = TileFlip::FX;
+	}
+	else if (flip == "fy")
+	{
+		tile.flip = TileFlip::FY;
+	}
+	else
+	{
+		tile.flip = TileFlip::F;
+	}
+	return tile;
+}
+
+std::string TileNames::ToString(TileId tile)
+{
+	std::string block = Get(tile.name);
+	if (tile.flip == TileFlip::None)
+	{
+		return block;
+	}
+
+	block += "_r";
+	block += static_cast<char>('0' + tile.rotation);
+	switch (tile.flip)
+	{
+	case TileFlip::FX:
+	{
+		block += "_fx";
+		break;
+	}
+	case TileFlip::FY:
+	{
+		block += "_fy";
+		break;
+	}
+	default:
+	{
+		block += "_f";
+		break;
+	}
+	}
+	return block;
+}
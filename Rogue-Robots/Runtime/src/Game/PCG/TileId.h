@@ -0,0 +1,103 @@
+#pragma once
+
+//How a block is mirrored. This is the part after the rotation in the block names, e.g. "Floor1_r2_fx".
+enum class TileFlip : uint8_t
+{
+	None = 0u, //The name has no rotation or flip, e.g. "Void".
+	F, //_f
+	FX, //_fx
+	FY, //_fy
+};
+
+//A block of the level. The name is an index in TileNames, so copying and comparing blocks never touches a string.
+struct TileId
+{
+	uint16_t name = 0u; //Void.
+	uint8_t rotation = 0u; //In quarter turns, 0-3.
+	TileFlip flip = TileFlip::None;
+
+	bool operator==(const TileId&) const = default;
+
+	//Same rotation and flip with another name.
+	TileId WithName(uint16_t newName) const
+	{
+		return { newName, rotation, flip };
+	}
+
+	//Every field packed into one integer, used as a key in maps.
+	uint32_t Key() const
+	{
+		return (static_cast<uint32_t>(name) << 16u) | (static_cast<uint32_t>(rotation) << 8u) | static_cast<uint32_t>(flip);
+	}
+};
+
+//Properties of a name. They used to be found by searching the name strings, now they are found once when the name is interned.
+enum TileFlag : uint32_t
+{
+	TILE_DOOR = 1u << 0u, //"Door"
+	TILE_SPAWN = 1u << 1u, //"Spawn"
+	TILE_EXIT = 1u << 2u, //"Exit"
+	TILE_CONNECTOR = 1u << 3u, //"Connector", the tunnels made by the post processing.
+	TILE_REPLACER = 1u << 4u, //"Replacer"
+	TILE_CORNER_FLOOR = 1u << 5u, //"CornerFloor"
+	TILE_CORNER_FLOOR1 = 1u << 6u, //"CornerFloor1"
+	TILE_CORNER_ROOF1 = 1u << 7u, //"CornerRoof1"
+	TILE_SOLID = 1u << 8u, //The blocks a tunnel can not be made through inside a room.
+	TILE_FLOOR = 1u << 9u, //The blocks that get a FloorBlockComponent when the level is loaded.
+};
+
+//The names the generator places or checks for itself. They are interned first and in this order,
+//so their ids are known at compile time through TileName.
+constexpr std::string_view BUILTIN_TILE_NAMES[] =
+{
+	"Void", "Empty", "Edge", "None", "Cube", "Exit1",
+	"Wall1", "WallFloor1", "WallRoof1", "CornerWall1", "CornerFloor1", "CornerRoof1",
+	"WallTunnelEntrance1", "WallFloorTunnelEntrance1", "WallFloorTunnelEntrance2", "WallFloorTunnelEntrance3",
+	"WallRoof1Replacer1", "WallRoof1Replacer2", "WallRoof1Replacer3",
+	"CornerWall1Replacer1", "CornerWall1Replacer2", "CornerWall1Replacer3",
+	"CornerFloor1Replacer1", "CornerFloor1Replacer2", "CornerFloor1Replacer3", "CornerFloor1Replacer4",
+	"CornerFloor1Replacer5", "CornerFloor1Replacer6", "CornerFloor1Replacer7",
+	"CornerRoof1Replacer1", "CornerRoof1Replacer2", "CornerRoof1Replacer3", "CornerRoof1Replacer4",
+	"CornerRoof1Replacer5", "CornerRoof1Replacer6", "CornerRoof1Replacer7",
+	"TunnelStraight1", "TunnelT1", "TunnelT2", "TunnelCross1",
+	"SideTwoConnector", "DownUpConnector", "LHorizontalConnector", "LVertical1Connector", "LVertical2Connector",
+	"LUpConnector", "LDownConnector", "THorizontal1Connector", "TVertical1Connector", "TVertical2Connector", "TVertical3Connector",
+	"PlusHorizontalConnector", "PlusVerticalConnector", "4UpConnector", "4DownConnector", "4UpDownConnector",
+	"5NoSideConnector", "5NoUpConnector", "5NoDownConnector", "3DCrossConnector",
+};
+
+//The id of a builtin name. Does not compile if the name is not in BUILTIN_TILE_NAMES.
+consteval uint16_t TileName(std::string_view name)
+{
+	for (uint16_t i{ 0u }; i < static_cast<uint16_t>(std::size(BUILTIN_TILE_NAMES)); ++i)
+	{
+		if (BUILTIN_TILE_NAMES[i] == name)
+		{
+			return i;
+		}
+	}
+	throw "Not a builtin tile name.";
+}
+
+//Every block name that has been read. Interning is not thread safe, it happens when the input or a level
+//is read, while the names and flags can be read from any thread.
+class TileNames
+{
+public:
+	//Returns the id of the name, the name is added if it has not been seen before.
+	static uint16_t Intern(std::string_view name);
+
+	static const std::string& Get(uint16_t name);
+	static uint32_t GetFlags(uint16_t name);
+
+	static bool Has(TileId tile, TileFlag flag)
+	{
+		return (GetFlags(tile.name) & flag) != 0u;
+	}
+
+	//Parses a block as it is written in the input and level files, e.g. "Floor1_r2_f" or "Void".
+	static TileId Parse(std::string_view block);
+
+	//The block as it is written in the level files. Only used when a level is exported.
+	static std::string ToString(TileId tile);
+};
@@ -1,76 +1,23 @@
+#include <DOGEngine.h>
 #include "WFC.h"
 
 bool WFC::EdgeConstrain(uint32_t cellIndex, uint32_t dir, Room& room)
 {
-	bool removed = false;
-	for (uint32_t j{ 0u }; j < m_entropy[room.i][cellIndex].possibilities.size(); ++j) //Go through all the current possibilities in the cell
-	{
-		unsigned int possibility = m_entropy[room.i][cellIndex].possibilities[j];
-		if (m_idToStringMap[possibility].find("Door") != std::string::npos)
-		{
-			continue;
-		}
-		//Check if the possibility cannot have a boundary in the direction.
-		if (!std::count(m_blockPossibilities[possibility].dirPossibilities[dir].begin(), m_blockPossibilities[possibility].dirPossibilities[dir].end(), m_stringToIdMap["Edge"]) &&
-			!std::count(m_blockPossibilities[possibility].dirPossibilities[dir].begin(), m_blockPossibilities[possibility].dirPossibilities[dir].end(), m_stringToIdMap["Void"])) //This has to be tested. Might fuck everything
-		{
-			if (m_entropy[room.i][cellIndex].possibilities.size() == 1)
-			{
-				m_failed[room.i] = true;
-				break;
-			}
-
-			//If it can not we remove the possibility.
-			m_entropy[room.i][cellIndex].possibilities.erase(m_entropy[room.i][cellIndex].possibilities.begin() + j);
-			j--;
-			removed = true;
-		}
-	}
-	if (m_failed[room.i])
+	//Only the possibilities that can have a boundary in the direction (and doors) are kept.
+	//The removals are propagated once the whole boundary is constrained.
+	if (!m_solvers[room.i].Restrict(cellIndex, &m_edgeTiles[dir * m_rules.GetWordCount()], false))
 	{
+		m_failed[room.i] = true;
 		return false;
 	}
-
-	//If we removed a possibility the information has to be propagated.
-	if (removed)
-	{
-		//Push the index onto the stack and then loop through the stack until it is empty.
-		//(A call to Propogate can put more information on the stack.)
-		m_recursiveStack[room.i].push(cellIndex);
-		while (!m_recursiveStack[room.i].empty())
-		{
-			uint32_t data = m_recursiveStack[room.i].front();
-			PropogateConstrain(data, room);
-			m_recursiveStack[room.i].pop();
-		}
-	}
-
 	return true;
 }
 
 bool WFC::IntroduceConstraints(Room& room)
 {
-	//First we set up the entropy.
-	//A vector with all unique id's.
-	std::vector<unsigned int> allBlocks;
-	for (auto& possibility : m_blockPossibilities)
-	{
-		if (m_idToStringMap[possibility.first].find("Door") == std::string::npos && m_idToStringMap[possibility.first].find("Spawn") == std::string::npos) //Dont add special blocks.
-		{
-			allBlocks.push_back(possibility.first);
-		}
-	}
-
-	m_entropy[room.i].clear();
-	//Create an entropy block for each cell.
-	//Set the id to be the index, and the possibilities as all blocks for now.
-	for (uint32_t i{ 0u }; i < room.width * room.height * room.depth; ++i)
-	{
-		EntropyBlock temp;
-		temp.id = i;
-		temp.possibilities = allBlocks;
-		m_entropy[room.i].push_back(temp);
-	}
+	//First we set up the domains. Every cell can be any block except the special ones for now.
+	WFCSolver& solver = m_solvers[room.i];
+	solver.Reset(m_rules, room.width, room.height, room.depth, m_roomTiles.data());
 
 	//ADD A NICE WAY TO INTRODUCE MULTIPLE CONSTRAINTS HERE!
 	{
@@ -80,7 +27,7 @@ bool WFC::IntroduceConstraints(Room& room)
 			if (room.i == 0)
 			{
 				std::default_random_engine gen;
-				gen.seed(static_cast<unsigned int>(time(NULL)));
+				gen.seed(static_cast<unsigned int>(DeriveSeed(room.seed, 0u)));
 				std::uniform_int_distribution<uint32_t> distWidth(2u, room.width - 3u);
 				std::uniform_int_distribution<uint32_t> distDepth(2u, room.depth - 3u);
 
@@ -95,18 +42,10 @@ bool WFC::IntroduceConstraints(Room& room)
 				m_spawnCoords[2] = z;
 
 				uint32_t index = x + y * room.width + z * room.width * room.height;
-				m_entropy[room.i][index].possibilities.clear();
-				std::string spawnBlock = m_spawnBlocks[distSpawn(gen)];
-				m_entropy[room.i][index].possibilities.push_back(m_stringToIdMap[spawnBlock]);
-
-				//Push the index onto the stack and then loop through the stack until it is empty.
-				//(A call to Propogate can put more information on the stack.)
-				m_recursiveStack[room.i].push(index);
-				while (!m_recursiveStack[room.i].empty())
+				auto spawn = m_tileIndices.find(m_spawnBlocks[distSpawn(gen)].Key());
+				if (spawn == m_tileIndices.end() || !solver.Set(index, spawn->second))
 				{
-					uint32_t data = m_recursiveStack[room.i].front();
-					PropogateConstrain(data, room);
-					m_recursiveStack[room.i].pop();
+					m_failed[room.i] = true;
 				}
 			}
 		}
@@ -114,7 +53,7 @@ bool WFC::IntroduceConstraints(Room& room)
 		//Doors
 		{
 			std::default_random_engine gen;
-			gen.seed(static_cast<unsigned int>(time(NULL)) * (room.i + 1u));
+			gen.seed(static_cast<unsigned int>(DeriveSeed(room.seed, 1u)));
 			std::uniform_int_distribution<uint32_t> dist(0u, 3u);
 
 			std::uniform_int_distribution<uint32_t> widthDist(1u, room.width - 2u);
@@ -165,24 +104,14 @@ bool WFC::IntroduceConstraints(Room& room)
 			room.doors[chosenDoor].pos[2] = z;
 
 			uint32_t index = x + y * room.width + z * room.width * room.height;
-			m_entropy[room.i][index].possibilities.clear();
-			//Randomize a door block to use.
+			//Randomize a door block to use and turn it the way the door faces.
 			std::uniform_int_distribution<size_t> distDoorBlocks(0u, m_doorBlocks.size() - 1u);
-			std::string doorBlock = m_doorBlocks[distDoorBlocks(gen)];
-			std::string name = doorBlock.substr(0u, doorBlock.find("_"));
-			size_t startFlip = doorBlock.find("_", doorBlock.find("_") + 1);
-			std::string doorFlip = doorBlock.substr(startFlip + 1u, doorBlock.size() - startFlip);
-			std::string doorCorrectRotation = name + "_r" + std::to_string(room.doors[chosenDoor].rot) + "_" + doorFlip;
-			m_entropy[room.i][index].possibilities.push_back(m_stringToIdMap[doorCorrectRotation]);
-
-			//Push the index onto the stack and then loop through the stack until it is empty.
-			//(A call to Propogate can put more information on the stack.)
-			m_recursiveStack[room.i].push(index);
-			while (!m_recursiveStack[room.i].empty())
+			TileId doorBlock = m_doorBlocks[distDoorBlocks(gen)];
+			doorBlock.rotation = static_cast<uint8_t>(room.doors[chosenDoor].rot);
+			auto door = m_tileIndices.find(doorBlock.Key());
+			if (door == m_tileIndices.end() || !solver.Set(index, door->second))
 			{
-				uint32_t data = m_recursiveStack[room.i].front();
-				PropogateConstrain(data, room);
-				m_recursiveStack[room.i].pop();
+				m_failed[room.i] = true;
 			}
 
 
@@ -247,24 +176,14 @@ bool WFC::IntroduceConstraints(Room& room)
 						room.doors[chosenDoor].pos[2] = z;
 
 						uint32_t index2 = x + y * room.width + z * room.width * room.height;
-						m_entropy[room.i][index2].possibilities.clear();
-						//Randomize a door block to use.
+						//Randomize a door block to use and turn it the way the door faces.
 						std::uniform_int_distribution<size_t> distDoorBlocks2(0u, m_doorBlocks.size() - 1u);
-						std::string doorBlock2 = m_doorBlocks[distDoorBlocks2(gen)];
-						std::string name2 = doorBlock2.substr(0u, doorBlock2.find("_"));
-						size_t startFlip2 = doorBlock2.find("_", doorBlock2.find("_") + 1);
-						std::string doorFlip2 = doorBlock2.substr(startFlip2 + 1u, doorBlock2.size() - startFlip2);
-						std::string doorCorrectRotation2 = name2 + "_r" + std::to_string(room.doors[chosenDoor].rot) + "_" + doorFlip2;
-						m_entropy[room.i][index2].possibilities.push_back(m_stringToIdMap[doorCorrectRotation2]);
-
-						//Push the index onto the stack and then loop through the stack until it is empty.
-						//(A call to Propogate can put more information on the stack.)
-						m_recursiveStack[room.i].push(index2);
-						while (!m_recursiveStack[room.i].empty())
+						TileId doorBlock2 = m_doorBlocks[distDoorBlocks2(gen)];
+						doorBlock2.rotation = static_cast<uint8_t>(room.doors[chosenDoor].rot);
+						auto door2 = m_tileIndices.find(doorBlock2.Key());
+						if (door2 == m_tileIndices.end() || !solver.Set(index2, door2->second))
 						{
-							uint32_t data = m_recursiveStack[room.i].front();
-							PropogateConstrain(data, room);
-							m_recursiveStack[room.i].pop();
+							m_failed[room.i] = true;
 						}
 					}
 				}
@@ -322,26 +241,33 @@ bool WFC::IntroduceConstraints(Room& room)
 					}
 				}
 			}
+
+			if (!m_failed[room.i] && !solver.Propagate())
+			{
+				m_failed[room.i] = true;
+			}
 		}
 	}
 
 	if (m_failed[room.i]) //If we fail here it means that the contraints imposed can not generate any output.
 	{
 		m_failed[room.i] = false;
-		m_entropy[room.i].clear();
 		return false;
 	}
 
+	//Every attempt at the room starts from here.
+	solver.SaveStart();
 	return true;
 }
 
-void WFC::t_GenerateRoom(unsigned int i, std::shared_ptr<Box> chosenBox)
+void WFC::t_GenerateRoom(unsigned int i, std::shared_ptr<Box> chosenBox, uint64_t seed)
 {
 	std::default_random_engine gen;
-	gen.seed(static_cast<unsigned int>(time(NULL)) * (i + 1u));
+	gen.seed(static_cast<unsigned int>(DeriveSeed(seed, 2u)));
 
 	Room newRoom;
 	newRoom.i = i;
+	newRoom.seed = seed;
 	newRoom.globalPos[0] = chosenBox->min[0];
 	newRoom.globalPos[1] = chosenBox->min[1];
 	newRoom.globalPos[2] = chosenBox->min[2];
@@ -368,7 +294,8 @@ void WFC::t_GenerateRoom(unsigned int i, std::shared_ptr<Box> chosenBox)
 
 		uint32_t chances = 100;
 
-		while ((!GenerateRoom(newRoom) && chances != 0) || !newRoom.generationSuccess)
+		//Every attempt gets its own seed, otherwise the attempts made within the same second are the same.
+		while ((!GenerateRoom(newRoom, static_cast<unsigned int>(gen())) && chances != 0) || !newRoom.generationSuccess)
 		{
 			std::cout << "FAILED!" << std::endl;
 			--chances;
@@ -377,7 +304,7 @@ void WFC::t_GenerateRoom(unsigned int i, std::shared_ptr<Box> chosenBox)
 		if (chances != 0)
 		{
 			std::cout << "Done with 1 room, id: " << i << std::endl;
-			std::cout << "Count of voids:" << std::count(newRoom.generatedRoom.begin(), newRoom.generatedRoom.end(), "Void") << std::endl;
+			std::cout << "Count of voids:" << std::count_if(newRoom.generatedRoom.begin(), newRoom.generatedRoom.end(), [](TileId block) { return block.name == TileName("Void"); }) << std::endl;
 
 			m_generatedRooms[i] = newRoom;
 		}
@@ -392,17 +319,18 @@ void WFC::t_GenerateRoom(unsigned int i, std::shared_ptr<Box> chosenBox)
 	}
 }
 
-bool WFC::GenerateLevel(uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeight, uint32_t maxDepth)
+bool WFC::GenerateLevel(uint64_t seed, uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeight, uint32_t maxDepth)
 {
-	m_generatedLevel.assign(m_width * m_height * m_depth, "Void");
+	m_generatedLevel.assign(m_width * m_height * m_depth, TileId{ TileName("Void") });
 
 	//First we construct a virtual space containing blocks that represents the rooms.
 	std::vector<uint32_t> min = { 1u, 1u, 1u };
 	std::vector<uint32_t> max = { m_width - 2, m_height - 2, m_depth - 2 };
 	std::shared_ptr<Box> base = std::make_shared<Box>(min, max);
 
+	//Stream 0 divides the level and chooses the rooms, room i gets stream i + 1.
 	std::default_random_engine gen;
-	gen.seed(static_cast<unsigned int>(time(NULL)));
+	gen.seed(static_cast<unsigned int>(DeriveSeed(seed, 0u)));
 
 	std::vector<std::shared_ptr<Box>> viableOptions;
 	if (base->Divide(maxWidth, maxHeight, maxDepth, gen))
@@ -426,34 +354,30 @@ bool WFC::GenerateLevel(uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeigh
 
 	m_generatedRooms.reserve(nrOfRooms);
 	m_generatedRooms.assign(nrOfRooms, Room());
-	m_entropy.reserve(nrOfRooms);
-	m_entropy.assign(nrOfRooms, std::vector<EntropyBlock>());
-	m_currentEntropy.reserve(nrOfRooms);
-	m_currentEntropy.assign(nrOfRooms, std::vector<EntropyBlock>());
-	m_recursiveStack.reserve(nrOfRooms);
-	m_recursiveStack.assign(nrOfRooms, std::queue<uint32_t>());
-	m_priorityQueue.reserve(nrOfRooms);
-	m_priorityQueue.assign(nrOfRooms, nullptr);
+	m_solvers.resize(nrOfRooms);
+	m_priorityQueue.resize(nrOfRooms);
 	m_failed.reserve(nrOfRooms);
 	m_failed.assign(nrOfRooms, false);
 	//For each room to generate.
-	std::vector<std::thread> threads;
+	std::vector<std::shared_ptr<Box>> chosenBoxes;
 	for (uint32_t i{ 0u }; i < nrOfRooms; i++)
 	{
 		//Now we need to choose nrOfRooms from the viable rooms.
 		std::uniform_int_distribution<size_t> roomID(0u, viableOptions.size() - 1u);
 		uint32_t index = static_cast<uint32_t>(roomID(gen));
-		std::shared_ptr<Box> chosenBox = viableOptions[index];
+		chosenBoxes.push_back(viableOptions[index]);
 		//Remove the option from the vector.
 		viableOptions.erase(viableOptions.begin() + index);
-
-		threads.push_back(std::thread(&WFC::t_GenerateRoom, this, i, chosenBox));
 	}
 
-	for (uint32_t i{ 0u }; i < nrOfRooms; i++)
-	{
-		threads[i].join();
-	}
+	//The rooms only write to their own slots, so they can be generated in any order.
+	DOG::JobSystem::Dispatch(nrOfRooms, 1u, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i{ begin }; i < end; ++i)
+			{
+				t_GenerateRoom(i, chosenBoxes[i], DeriveSeed(seed, i + 1u));
+			}
+		});
 
 	for (Room& room : m_generatedRooms) //For each generated room.
 	{
@@ -508,7 +432,7 @@ bool WFC::GenerateLevel(uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeigh
 			Door& doorToUse = roomToUse.doors[doorIndex];
 			doorToUse.placed = false; //Mark as not placed so that it does not get connected later on.
 			uint32_t idStart = (roomToUse.globalPos[0]) + (roomToUse.globalPos[1] * m_width) + (roomToUse.globalPos[2] * m_width * m_height);
-			m_generatedLevel[idStart + doorToUse.pos[0] + (doorToUse.pos[1] * m_width) + (doorToUse.pos[2] * m_width * m_height)] = "Exit1_r" + std::to_string(doorToUse.rot) + "_f";
+			m_generatedLevel[idStart + doorToUse.pos[0] + (doorToUse.pos[1] * m_width) + (doorToUse.pos[2] * m_width * m_height)] = { TileName("Exit1"), static_cast<uint8_t>(doorToUse.rot), TileFlip::F };
 		}
 
 		//Connect all the doors.
@@ -575,8 +499,8 @@ bool WFC::GenerateLevel(uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeigh
 					bool prevWasVoid = false;
 					for (uint32_t k{ 0u }; k < path.size(); ++k)
 					{
-						std::string current = m_generatedLevel[path[k].first];
-						std::string next = "None";
+						TileId current = m_generatedLevel[path[k].first];
+						TileId next = { TileName("None") };
 
 						nextDir = path[k].second;
 
@@ -589,8 +513,8 @@ bool WFC::GenerateLevel(uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeigh
 
 
 
-						std::string replacer = ReplaceBlock(current, next, prevDir, nextDir, prevWasVoid, doorConnected);
-						if (m_generatedLevel[path[k].first] == "Void")
+						TileId replacer = ReplaceBlock(current, next, prevDir, nextDir, prevWasVoid, doorConnected);
+						if (m_generatedLevel[path[k].first].name == TileName("Void"))
 						{
 							prevWasVoid = true;
 						}
@@ -611,161 +535,110 @@ bool WFC::GenerateLevel(uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeigh
 	return true;
 }
 
-bool WFC::GenerateRoom(Room& room)
+bool WFC::GenerateRoom(Room& room, unsigned int seed)
 {
-	m_currentEntropy[room.i].clear();
-	m_currentEntropy[room.i] = m_entropy[room.i];
-
-	while (!m_recursiveStack[room.i].empty())
-	{
-		m_recursiveStack[room.i].pop();
-	}
+	WFCSolver& solver = m_solvers[room.i];
+	solver.Restart();
 
 	//The priority queue is not needed for the constraints. As they do not use a priority.
-	//All the entropy blocks should now be placed in a priority queue based on their Shannon entropy.
-	m_priorityQueue[room.i] = new PriorityQueue(m_currentEntropy[room.i], m_blockPossibilities, room.width, room.height, room.depth);
+	//All the cells should now be placed in a priority queue based on their Shannon entropy.
+	PriorityQueue& queue = m_priorityQueue[room.i];
+	queue.Reset(solver, seed);
 
-	room.generatedRoom.assign(room.width * room.height * room.depth, "Void");
+	room.generatedRoom.assign(room.width * room.height * room.depth, TileId{ TileName("Void") });
 	room.generationSuccess = false;
-	//Here the WFC starts.
-	//Pop the index with the lowest entropy.
-	uint32_t index = m_priorityQueue[room.i]->Pop();
 
-#ifdef _DEBUG
-	if (index == -1)
-	{
-		std::cout << "MEGA FAIL! SHOULD NEVER HAPPEN!!!" << std::endl;
-		delete m_priorityQueue[room.i];
-		m_priorityQueue[room.i] = nullptr;
-		m_currentEntropy[room.i].clear();
-		return false;
-	}
-#endif
+	std::default_random_engine gen;
+	gen.seed(seed);
 
-	//Firstly we go through all the blocks with just 1 possibility.
-	while (m_currentEntropy[room.i][index].possibilities.size() == 1)
+	//Here the WFC starts.
+	//Pop the index with the lowest entropy until every cell has been handled.
+	uint32_t backtracks{ 0u };
+	for (int index = queue.Pop(); index != -1; index = queue.Pop())
 	{
-		unsigned int possibility = m_currentEntropy[room.i][index].possibilities[0]; //It only has 1 possibility.
-		room.generatedRoom[index] = m_idToStringMap[possibility]; //Put the block in the generated room.
+		const uint32_t count = solver.Count(index);
+		if (count == 0u)
+		{
+			return false;
+		}
 		room.generationSuccess = true;
 
-		index = m_priorityQueue[room.i]->Pop();
-
-		//If we are done with the whole generation.
-		if (index == -1)
+		//Blocks with just 1 possibility are already decided.
+		if (count == 1u)
 		{
-			delete m_priorityQueue[room.i];
-			m_priorityQueue[room.i] = nullptr;
-
-			//If the generation failed.
-			if (m_failed[room.i])
-			{
-				m_failed[room.i] = false;
-				m_currentEntropy[room.i].clear();
-				return false;
-			}
-			return true;
+			continue;
 		}
-	}
 
-	//Here we only have blocks with a possibility count of 2 or higher left.
-	std::default_random_engine gen;
-	gen.seed(static_cast<unsigned int>(time(NULL)) * (room.i + 1u));
-
-	//While blocks exist within the PQ and the count of possibilities is not 0.
-	while (index != -1 && m_currentEntropy[room.i][index].possibilities.size() != 0)
-	{
 		//calculate the total frequency of the possibilities of the current cell.
 		float total = 0.0f;
-		for (auto& c : m_currentEntropy[room.i][index].possibilities)
-		{
-			total += m_blockPossibilities[c].frequency;
-		}
+		solver.ForEachTile(index, [&](uint32_t c)
+			{
+				total += m_rules.GetWeight(c);
+			});
 
 		//We then randomize a value between 0 and that total value.
 		std::uniform_real_distribution<float> dist(0.0f, total);
 		float val = dist(gen);
 
-		unsigned int chosenBlock = 0u;
-		float count = 0.0f;
 		//Go through all possibilities and if the generated value is less than the frequency counter that possibility is chosen.
-		for (auto& current : m_currentEntropy[room.i][index].possibilities)
-		{
-			count += m_blockPossibilities[current].frequency;
-			if (val < count)
+		unsigned int chosenBlock = static_cast<unsigned int>(-1);
+		float counter = 0.0f;
+		solver.ForEachTile(index, [&](uint32_t current)
 			{
-				chosenBlock = current;
-				break;
-			}
-		}
-
-		//Now that a single possibility is chosen the rest of the possibilities have to be removed.
-		bool removed = false;
-		for (uint32_t i{ 0u }; i < m_currentEntropy[room.i][index].possibilities.size(); ++i)
-		{
-			unsigned int current = m_currentEntropy[room.i][index].possibilities[i];
-			if (current != chosenBlock)
-			{
-				if (m_currentEntropy[room.i][index].possibilities.size() == 1)
+				counter += m_rules.GetWeight(current);
+				if (val < counter && chosenBlock == static_cast<unsigned int>(-1))
 				{
-					m_failed[room.i] = true;
-					break;
+					chosenBlock = current;
 				}
+			});
+		if (chosenBlock == static_cast<unsigned int>(-1))
+		{
+			chosenBlock = solver.FirstTile(index);
+		}
 
-				m_currentEntropy[room.i][index].possibilities.erase(m_currentEntropy[room.i][index].possibilities.begin() + i);
-				i--;
-				removed = true;
-			}
+		//Now that a single possibility is chosen the rest of the possibilities are removed,
+		//which is propogated out to the neighboring cells.
+		bool consistent = solver.Decide(index, chosenBlock);
+		const bool backtracked = !consistent;
+
+		//On a contradiction the latest decisions are taken back until the room is consistent again.
+		//When the budget runs out the whole room is tried again with a new seed instead.
+		while (!consistent && solver.GetDecisionCount() != 0u && backtracks < MAX_BACKTRACKS)
+		{
+			consistent = solver.Backtrack();
+			++backtracks;
 		}
-		if (m_failed[room.i])
+		if (!consistent)
 		{
-			break;
+			solver.ClearChanged();
+			return false;
 		}
 
-		//The information that possibilities have been removed is then propogated out to the neighboring cells.
-		if (removed)
+		//The PQ is rearranged for every cell that lost possibilities, the cells that got possibilities back are put back in it.
+		for (uint32_t changed : solver.GetChanged())
 		{
-			//We now have to rearrange the PQ since possibilities were removed.
-			if (!m_priorityQueue[room.i]->Rearrange(index, m_blockPossibilities))
+			if (backtracked)
 			{
-				m_failed[room.i] = false;
-				m_currentEntropy[room.i].clear();
-				delete m_priorityQueue[room.i];
-				m_priorityQueue[room.i] = nullptr;
-				return false;
+				queue.Push(changed, solver);
 			}
-
-			m_recursiveStack[room.i].push(index);
-			while (!m_recursiveStack[room.i].empty())
+			else
 			{
-				uint32_t data = m_recursiveStack[room.i].front();
-				Propogate(data, room);
-				m_recursiveStack[room.i].pop();
-
-				if (m_failed[room.i])
-				{
-					m_failed[room.i] = false;
-					m_currentEntropy[room.i].clear();
-					return false;
-				}
+				queue.Rearrange(changed, solver);
 			}
 		}
-		//We then set the chosen value in the generated level.
-		room.generatedRoom[index] = m_idToStringMap[chosenBlock];
-		room.generationSuccess = true;
-
-		index = m_priorityQueue[room.i]->Pop();
+		solver.ClearChanged();
 	}
 
-	//We are now done and can delete our priorityqueue.
-	delete m_priorityQueue[room.i];
-	m_priorityQueue[room.i] = nullptr;
+	//Decisions can be taken back, so the blocks are put in the generated room when every cell is decided.
+	for (uint32_t i{ 0u }; i < room.generatedRoom.size(); ++i)
+	{
+		room.generatedRoom[i] = m_tiles[solver.FirstTile(i)];
+	}
 
 	//If the generation failed we return false.
 	if (m_failed[room.i])
 	{
 		m_failed[room.i] = false;
-		m_currentEntropy[room.i].clear();
 		return false;
 	}
 
@@ -776,38 +649,38 @@ bool WFC::GenerateRoom(Room& room)
 		{
 			for (uint32_t i{ 0u }; i < room.generatedRoom.size(); ++i)
 			{
-				if (room.generatedRoom[i] == "Void" || room.generatedRoom[i] == "Empty")
+				if (room.generatedRoom[i].name == TileName("Void") || room.generatedRoom[i].name == TileName("Empty"))
 				{
 					continue;
 				}
-				else if (room.generatedRoom[i].find("CornerFloor") != std::string::npos)
+				else if (TileNames::Has(room.generatedRoom[i], TILE_CORNER_FLOOR))
 				{
-					uint32_t rot = std::stoi(room.generatedRoom[i].substr(room.generatedRoom[i].find("_") + 2, 1));
+					uint32_t rot = room.generatedRoom[i].rotation;
 					//Check if a corner is adjacent to this corner.
-					std::string replacement1 = "";
-					std::string replacement2 = "";
+					TileId replacement1;
+					TileId replacement2;
 					//If the x-index is not = width.
-					if ((i % room.width) != room.width - 1 && i != room.generatedRoom.size() - 1 && room.generatedRoom[i + 1u].find("CornerFloor") != std::string::npos && room.generatedRoom[i + 1u].find("Replacer") == std::string::npos)
+					if ((i % room.width) != room.width - 1 && i != room.generatedRoom.size() - 1 && TileNames::Has(room.generatedRoom[i + 1u], TILE_CORNER_FLOOR) && !TileNames::Has(room.generatedRoom[i + 1u], TILE_REPLACER))
 					{
 						switch (rot)
 						{
 						case 0:
 						{
-							if (room.generatedRoom[i].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i], TILE_REPLACER))
 							{
-								replacement1 = "CornerFloor1Replacer1_r0_f";
+								replacement1 = { TileName("CornerFloor1Replacer1"), 0u, TileFlip::F };
 							}
 							else
 							{
-								replacement1 = "CornerFloor1Replacer6_r0_f";
+								replacement1 = { TileName("CornerFloor1Replacer6"), 0u, TileFlip::F };
 							}
-							if (room.generatedRoom[i + 1u].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i + 1u], TILE_REPLACER))
 							{
-								replacement2 = "CornerFloor1Replacer2_r1_f";
+								replacement2 = { TileName("CornerFloor1Replacer2"), 1u, TileFlip::F };
 							}
 							else
 							{
-								replacement2 = "CornerFloor1Replacer6_r1_f";
+								replacement2 = { TileName("CornerFloor1Replacer6"), 1u, TileFlip::F };
 							}
 							room.generatedRoom[i] = replacement1;
 							room.generatedRoom[i + 1u] = replacement2;
@@ -815,21 +688,21 @@ bool WFC::GenerateRoom(Room& room)
 						}
 						case 3:
 						{
-							if (room.generatedRoom[i].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i], TILE_REPLACER))
 							{
-								replacement1 = "CornerFloor1Replacer2_r3_f";
+								replacement1 = { TileName("CornerFloor1Replacer2"), 3u, TileFlip::F };
 							}
 							else
 							{
-								replacement1 = "CornerFloor1Replacer6_r3_f";
+								replacement1 = { TileName("CornerFloor1Replacer6"), 3u, TileFlip::F };
 							}
-							if (room.generatedRoom[i + 1u].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i + 1u], TILE_REPLACER))
 							{
-								replacement2 = "CornerFloor1Replacer1_r2_f";
+								replacement2 = { TileName("CornerFloor1Replacer1"), 2u, TileFlip::F };
 							}
 							else
 							{
-								replacement2 = "CornerFloor1Replacer6_r2_f";
+								replacement2 = { TileName("CornerFloor1Replacer6"), 2u, TileFlip::F };
 							}
 							room.generatedRoom[i] = replacement1;
 							room.generatedRoom[i + 1u] = replacement2;
@@ -843,27 +716,27 @@ bool WFC::GenerateRoom(Room& room)
 						}
 					}
 					//If the z-index is not = depth
-					if ((i < room.width * room.height * (room.depth - 1)) && room.generatedRoom[i + (room.width * room.height)].find("CornerFloor") != std::string::npos && room.generatedRoom[i + (room.width * room.height)].find("Replacer") == std::string::npos)
+					if ((i < room.width * room.height * (room.depth - 1)) && TileNames::Has(room.generatedRoom[i + (room.width * room.height)], TILE_CORNER_FLOOR) && !TileNames::Has(room.generatedRoom[i + (room.width * room.height)], TILE_REPLACER))
 					{
 						switch (rot)
 						{
 						case 3:
 						{
-							if (room.generatedRoom[i].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i], TILE_REPLACER))
 							{
-								replacement1 = "CornerFloor1Replacer1_r3_f";
+								replacement1 = { TileName("CornerFloor1Replacer1"), 3u, TileFlip::F };
 							}
 							else
 							{
-								replacement1 = "CornerFloor1Replacer6_r3_f";
+								replacement1 = { TileName("CornerFloor1Replacer6"), 3u, TileFlip::F };
 							}
-							if (room.generatedRoom[i + (room.width * room.height)].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i + (room.width * room.height)], TILE_REPLACER))
 							{
-								replacement2 = "CornerFloor1Replacer2_r0_f";
+								replacement2 = { TileName("CornerFloor1Replacer2"), 0u, TileFlip::F };
 							}
 							else
 							{
-								replacement2 = "CornerFloor1Replacer6_r0_f";
+								replacement2 = { TileName("CornerFloor1Replacer6"), 0u, TileFlip::F };
 							}
 							room.generatedRoom[i] = replacement1;
 							room.generatedRoom[i + (room.width * room.height)] = replacement2;
@@ -871,21 +744,21 @@ bool WFC::GenerateRoom(Room& room)
 						}
 						case 2:
 						{
-							if (room.generatedRoom[i].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i], TILE_REPLACER))
 							{
-								replacement1 = "CornerFloor1Replacer2_r2_f";
+								replacement1 = { TileName("CornerFloor1Replacer2"), 2u, TileFlip::F };
 							}
 							else
 							{
-								replacement1 = "CornerFloor1Replacer6_r2_f";
+								replacement1 = { TileName("CornerFloor1Replacer6"), 2u, TileFlip::F };
 							}
-							if (room.generatedRoom[i + (room.width * room.height)].find("Replacer") == std::string::npos)
+							if (!TileNames::Has(room.generatedRoom[i + (room.width * room.height)], TILE_REPLACER))
 							{
-								replacement2 = "CornerFloor1Replacer1_r1_f";
+								replacement2 = { TileName("CornerFloor1Replacer1"), 1u, TileFlip::F };
 							}
 							else
 							{
-								replacement2 = "CornerFloor1Replacer6_r1_f";
+								replacement2 = { TileName("CornerFloor1Replacer6"), 1u, TileFlip::F };
 							}
 							room.generatedRoom[i] = replacement1;
 							room.generatedRoom[i + (room.width * room.height)] = replacement2;
@@ -907,7 +780,7 @@ bool WFC::GenerateRoom(Room& room)
 			uint32_t cellIndex = 0u;
 			for (cellIndex; cellIndex < room.generatedRoom.size(); cellIndex++)
 			{
-				if (room.generatedRoom[cellIndex] != "Void")
+				if (room.generatedRoom[cellIndex].name != TileName("Void"))
 				{
 					break;
 				}
@@ -930,14 +803,14 @@ bool WFC::GenerateRoom(Room& room)
 				{
 					for (uint32_t x{ 0u }; x < room.width; ++x)
 					{
-						if (room.generatedRoom[x + y * room.width + z * room.width * room.height] != "Void")
+						if (room.generatedRoom[x + y * room.width + z * room.width * room.height].name != TileName("Void"))
 						{
 							uint32_t goal[3] = { x, y, z };
 							std::vector<std::pair<uint32_t, int>> path = AStarRoom(room, start, goal);
 							bool goOn = false;
 							for (auto& p : path)
 							{
-								if (room.generatedRoom[p.first] == "Void")
+								if (room.generatedRoom[p.first].name == TileName("Void"))
 								{
 									goOn = true;
 									break;
@@ -955,8 +828,8 @@ bool WFC::GenerateRoom(Room& room)
 							bool prevWasVoid = false;
 							for (uint32_t i{ 0u }; i < path.size(); ++i)
 							{
-								std::string current = room.generatedRoom[path[i].first];
-								std::string next = "None";
+								TileId current = room.generatedRoom[path[i].first];
+								TileId next = { TileName("None") };
 
 								nextDir = path[i].second;
 
@@ -967,8 +840,8 @@ bool WFC::GenerateRoom(Room& room)
 									next = room.generatedRoom[path[i + 1].first];
 								}
 
-								std::string replacer = ReplaceBlock(current, next, prevDir, nextDir, prevWasVoid, true);
-								if (room.generatedRoom[path[i].first] == "Void")
+								TileId replacer = ReplaceBlock(current, next, prevDir, nextDir, prevWasVoid, true);
+								if (room.generatedRoom[path[i].first].name == TileName("Void"))
 								{
 									prevWasVoid = true;
 								}
@@ -990,34 +863,33 @@ bool WFC::GenerateRoom(Room& room)
 }
 
 //Here be hardcoded dragons and madness
-std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock, int prevDir, int nextDir, bool prevWasVoid, bool doorConnected)
+TileId WFC::ReplaceBlock(TileId currentBlock, TileId nextBlock, int prevDir, int nextDir, bool prevWasVoid, bool doorConnected)
 {
-	std::string replacer = currentBlock;
+	TileId replacer = currentBlock;
 
-	if (currentBlock != "Void" && prevWasVoid)
+	if (currentBlock.name != TileName("Void") && prevWasVoid)
 	{
-		std::string none = "None";
 		currentBlock = ReplaceBlock(currentBlock, nextBlock, prevDir, nextDir, false, doorConnected);
 	}
 
-	if (currentBlock == "Void" || nextBlock == "Void" || prevWasVoid || (nextBlock.find("Door") != std::string::npos && !doorConnected))
+	if (currentBlock.name == TileName("Void") || nextBlock.name == TileName("Void") || prevWasVoid || (TileNames::Has(nextBlock, TILE_DOOR) && !doorConnected))
 	{
-		if (currentBlock == "Void")
+		if (currentBlock.name == TileName("Void"))
 		{
 			//Straight tunnels.
 			if (prevDir == nextDir)
 			{
 				if (prevDir == 0 || prevDir == 1) //Across, side to side
 				{
-					replacer = "SideTwoConnector_r0_f";
+					replacer = { TileName("SideTwoConnector"), 0u, TileFlip::F };
 				}
 				else if (prevDir == 2 || prevDir == 3) //Up to down
 				{
-					replacer = "DownUpConnector_r0_f";
+					replacer = { TileName("DownUpConnector"), 0u, TileFlip::F };
 				}
 				else if (prevDir == 4 || prevDir == 5) //Across, side to side.
 				{
-					replacer = "SideTwoConnector_r1_f";
+					replacer = { TileName("SideTwoConnector"), 1u, TileFlip::F };
 				}
 			}
 			//L-tunnels
@@ -1026,19 +898,19 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				//Horizontal
 				if ((prevDir == 1 && nextDir == 5) || (prevDir == 4 && nextDir == 0))
 				{
-					replacer = "LHorizontalConnector_r3_f";
+					replacer = { TileName("LHorizontalConnector"), 3u, TileFlip::F };
 				}
 				else if ((prevDir == 0 && nextDir == 4) || (prevDir == 5 && nextDir == 1))
 				{
-					replacer = "LHorizontalConnector_r1_f";
+					replacer = { TileName("LHorizontalConnector"), 1u, TileFlip::F };
 				}
 				else if ((prevDir == 1 && nextDir == 4) || (prevDir == 5 && nextDir == 0))
 				{
-					replacer = "LHorizontalConnector_r2_f";
+					replacer = { TileName("LHorizontalConnector"), 2u, TileFlip::F };
 				}
 				else if ((prevDir == 4 && nextDir == 1) || (prevDir == 0 && nextDir == 5))
 				{
-					replacer = "LHorizontalConnector_r0_f";
+					replacer = { TileName("LHorizontalConnector"), 0u, TileFlip::F };
 				}
 				//Vertical
 				else if (prevDir == 3) //Upwards L
@@ -1047,22 +919,22 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 					case 0:
 					{
-						replacer = "LVertical1Connector_r0_f";
+						replacer = { TileName("LVertical1Connector"), 0u, TileFlip::F };
 						break;
 					}
 					case 1:
 					{
-						replacer = "LVertical1Connector_r2_f";
+						replacer = { TileName("LVertical1Connector"), 2u, TileFlip::F };
 						break;
 					}
 					case 4:
 					{
-						replacer = "LVertical1Connector_r3_f";
+						replacer = { TileName("LVertical1Connector"), 3u, TileFlip::F };
 						break;
 					}
 					case 5:
 					{
-						replacer = "LVertical1Connector_r1_f";
+						replacer = { TileName("LVertical1Connector"), 1u, TileFlip::F };
 						break;
 					}
 					}
@@ -1073,22 +945,22 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 					case 0:
 					{
-						replacer = "LVertical1Connector_r2_f";
+						replacer = { TileName("LVertical1Connector"), 2u, TileFlip::F };
 						break;
 					}
 					case 1:
 					{
-						replacer = "LVertical1Connector_r0_f";
+						replacer = { TileName("LVertical1Connector"), 0u, TileFlip::F };
 						break;
 					}
 					case 4:
 					{
-						replacer = "LVertical1Connector_r1_f";
+						replacer = { TileName("LVertical1Connector"), 1u, TileFlip::F };
 						break;
 					}
 					case 5:
 					{
-						replacer = "LVertical1Connector_r3_f";
+						replacer = { TileName("LVertical1Connector"), 3u, TileFlip::F };
 						break;
 					}
 					}
@@ -1099,22 +971,22 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 					case 0:
 					{
-						replacer = "LVertical2Connector_r2_f";
+						replacer = { TileName("LVertical2Connector"), 2u, TileFlip::F };
 						break;
 					}
 					case 1:
 					{
-						replacer = "LVertical2Connector_r0_f";
+						replacer = { TileName("LVertical2Connector"), 0u, TileFlip::F };
 						break;
 					}
 					case 4:
 					{
-						replacer = "LVertical2Connector_r1_f";
+						replacer = { TileName("LVertical2Connector"), 1u, TileFlip::F };
 						break;
 					}
 					case 5:
 					{
-						replacer = "LVertical2Connector_r3_f";
+						replacer = { TileName("LVertical2Connector"), 3u, TileFlip::F };
 						break;
 					}
 					}
@@ -1125,22 +997,22 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 					case 0:
 					{
-						replacer = "LVertical2Connector_r0_f";
+						replacer = { TileName("LVertical2Connector"), 0u, TileFlip::F };
 						break;
 					}
 					case 1:
 					{
-						replacer = "LVertical2Connector_r2_f";
+						replacer = { TileName("LVertical2Connector"), 2u, TileFlip::F };
 						break;
 					}
 					case 4:
 					{
-						replacer = "LVertical2Connector_r3_f";
+						replacer = { TileName("LVertical2Connector"), 3u, TileFlip::F };
 						break;
 					}
 					case 5:
 					{
-						replacer = "LVertical2Connector_r1_f";
+						replacer = { TileName("LVertical2Connector"), 1u, TileFlip::F };
 						break;
 					}
 					}
@@ -1149,7 +1021,6 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 		}
 		else //This is the block before or after the void.
 		{
-			std::string oldReplacer = replacer;
 			int dirToUse;
 			if (prevWasVoid)
 			{
@@ -1168,353 +1039,340 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 			{
 				dirToUse = nextDir;
 			}
-			size_t firstUnderscore = currentBlock.find('_');
-			size_t secondUnderscore = currentBlock.find('_', firstUnderscore + 1);
-			std::string name = currentBlock.substr(0, firstUnderscore);
-			std::string rotation = currentBlock.substr(firstUnderscore + 1, 2);
-			std::string flip = currentBlock.substr(secondUnderscore + 1, currentBlock.size() - secondUnderscore);
+			uint16_t name = currentBlock.name;
 			//Replacement of blocks that make up the room, before it goes out to void.
-			if (name == "Wall1")
+			if (name == TileName("Wall1"))
 			{
-				replacer = "WallTunnelEntrance1";
-				replacer += "_" + rotation + "_" + flip;
+				replacer = currentBlock.WithName(TileName("WallTunnelEntrance1"));
 			}
-			else if (name == "WallFloor1")
+			else if (name == TileName("WallFloor1"))
 			{
 				if (dirToUse == 3) //If the next block is downwards.
 				{
-					replacer = "WallFloorTunnelEntrance2";
+					replacer = currentBlock.WithName(TileName("WallFloorTunnelEntrance2"));
 				}
 				else
 				{
-					replacer = "WallFloorTunnelEntrance1";
+					replacer = currentBlock.WithName(TileName("WallFloorTunnelEntrance1"));
 				}
-				replacer += "_" + rotation + "_" + flip;
 			}
-			else if (name == "WallFloorTunnelEntrance1" || name == "WallFloorTunnelEntrance2")
+			else if (name == TileName("WallFloorTunnelEntrance1") || name == TileName("WallFloorTunnelEntrance2"))
 			{
-				name = "WallFloorTunnelEntrance3";
-				replacer += "_" + rotation + "_" + flip;
+				replacer = currentBlock.WithName(TileName("WallFloorTunnelEntrance3"));
 			}
-			else if (name == "WallRoof1")
+			else if (name == TileName("WallRoof1"))
 			{
 				if (dirToUse == 2) //If the next block is upwards.
 				{
-					replacer = "WallRoof1Replacer1";
+					replacer = currentBlock.WithName(TileName("WallRoof1Replacer1"));
 				}
 				else
 				{
-					replacer = "WallRoof1Replacer2";
+					replacer = currentBlock.WithName(TileName("WallRoof1Replacer2"));
 				}
-				replacer += "_" + rotation + "_" + flip;
 			}
-			else if (name == "WallRoof1Replacer1" || name == "WallRoof1Replacer2")
+			else if (name == TileName("WallRoof1Replacer1") || name == TileName("WallRoof1Replacer2"))
 			{
-				replacer = "WallRoof1Replacer3";
-				replacer += "_" + rotation + "_" + flip;
+				replacer = currentBlock.WithName(TileName("WallRoof1Replacer3"));
 			}
-			else if (name == "CornerWall1")
+			else if (name == TileName("CornerWall1"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (rot == 0 && dirToUse == 0)
 				{
-					replacer = "CornerWall1Replacer1";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer1"));
 				}
 				else if (rot == 0 && dirToUse == 5)
 				{
-					replacer = "CornerWall1Replacer2";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer2"));
 				}
 				else if (rot == 1 && dirToUse == 5)
 				{
-					replacer = "CornerWall1Replacer1";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer1"));
 				}
 				else if (rot == 1 && dirToUse == 1)
 				{
-					replacer = "CornerWall1Replacer2";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer2"));
 				}
 				else if (rot == 2 && dirToUse == 1)
 				{
-					replacer = "CornerWall1Replacer1";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer1"));
 				}
 				else if (rot == 2 && dirToUse == 4)
 				{
-					replacer = "CornerWall1Replacer2";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer2"));
 				}
 				else if (rot == 3 && dirToUse == 4)
 				{
-					replacer = "CornerWall1Replacer1";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer1"));
 				}
 				else if (rot == 3 && dirToUse == 0)
 				{
-					replacer = "CornerWall1Replacer2";
+					replacer = currentBlock.WithName(TileName("CornerWall1Replacer2"));
 				}
-				replacer += "_" + rotation + "_" + flip;
 			}
-			else if (name == "CornerWall1Replacer1" || name == "CornerWall1Replacer2")
+			else if (name == TileName("CornerWall1Replacer1") || name == TileName("CornerWall1Replacer2"))
 			{
-				replacer = "CornerWall1Replacer3";
-				replacer += "_" + rotation + "_" + flip;
+				replacer = currentBlock.WithName(TileName("CornerWall1Replacer3"));
 			}
-			else if (name.find("CornerFloor1") != std::string::npos)
+			else if (TileNames::Has(currentBlock, TILE_CORNER_FLOOR1))
 			{
-				if (name == "CornerFloor1")
+				if (name == TileName("CornerFloor1"))
 				{
-					int rot = std::stoi(rotation.substr(1, 1));
+					int rot = currentBlock.rotation;
 					if (dirToUse == 3)
 					{
-						replacer = "CornerFloor1Replacer3"; //Only tunnel down
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer3")); //Only tunnel down
 					}
 					else if (rot == 0 && dirToUse == 0)
 					{
-						replacer = "CornerFloor1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer1"));
 					}
 					else if (rot == 0 && dirToUse == 5)
 					{
-						replacer = "CornerFloor1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer2"));
 					}
 					else if (rot == 1 && dirToUse == 5)
 					{
-						replacer = "CornerFloor1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer1"));
 					}
 					else if (rot == 1 && dirToUse == 1)
 					{
-						replacer = "CornerFloor1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer2"));
 					}
 					else if (rot == 2 && dirToUse == 1)
 					{
-						replacer = "CornerFloor1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer1"));
 					}
 					else if (rot == 2 && dirToUse == 4)
 					{
-						replacer = "CornerFloor1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer2"));
 					}
 					else if (rot == 3 && dirToUse == 4)
 					{
-						replacer = "CornerFloor1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer1"));
 					}
 					else if (rot == 3 && dirToUse == 0)
 					{
-						replacer = "CornerFloor1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer2"));
 					}
 				}
-				else if (name == "CornerFloor1Replacer1") //If only left or right, replace with connection to both or connection to down.
+				else if (name == TileName("CornerFloor1Replacer1")) //If only left or right, replace with connection to both or connection to down.
 				{
 					if (dirToUse == 3)
 					{
-						replacer = "CornerFloor1Replacer4"; //Only tunnel left/right and down
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer4")); //Only tunnel left/right and down
 					}
 					else
 					{
-						replacer = "CornerFloor1Replacer6"; //Only tunnel to the sides
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer6")); //Only tunnel to the sides
 
 					}
 				}
-				else if (name == "CornerFloor1Replacer2") //If only left or right, replace with connection to both or connection to down.
+				else if (name == TileName("CornerFloor1Replacer2")) //If only left or right, replace with connection to both or connection to down.
 				{
 					if (dirToUse == 3)
 					{
-						replacer = "CornerFloor1Replacer5"; //Only tunnel left/right and down.
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer5")); //Only tunnel left/right and down.
 					}
 					else
 					{
-						replacer = "CornerFloor1Replacer6"; //Only tunnel to the sides.
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer6")); //Only tunnel to the sides.
 					}
 				}
-				else if (name == "CornerFloor1Replacer3") // If only tunnel down, replace with tunnel down and left or right.
+				else if (name == TileName("CornerFloor1Replacer3")) // If only tunnel down, replace with tunnel down and left or right.
 				{
-					int rot = static_cast<int>(rotation[1]);
+					int rot = currentBlock.rotation;
 
 					if (rot == 0 && dirToUse == 0)
 					{
-						replacer = "CornerFloor1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer4"));
 					}
 					else if (rot == 0 && dirToUse == 5)
 					{
-						replacer = "CornerFloor1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer5"));
 					}
 					else if (rot == 1 && dirToUse == 5)
 					{
-						replacer = "CornerFloor1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer4"));
 					}
 					else if (rot == 1 && dirToUse == 1)
 					{
-						replacer = "CornerFloor1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer5"));
 					}
 					else if (rot == 2 && dirToUse == 1)
 					{
-						replacer = "CornerFloor1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer4"));
 					}
 					else if (rot == 2 && dirToUse == 4)
 					{
-						replacer = "CornerFloor1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer5"));
 					}
 					else if (rot == 3 && dirToUse == 4)
 					{
-						replacer = "CornerFloor1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer4"));
 					}
 					else if (rot == 3 && dirToUse == 0)
 					{
-						replacer = "CornerFloor1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerFloor1Replacer5"));
 					}
 				}
-				else if (name == "CornerFloor1Replacer4" || name == "CornerFloor1Replacer5" || name == "CornerFloor1Replacer6") //If tunnels left and right or left and down or right and down, change to all directions.
+				else if (name == TileName("CornerFloor1Replacer4") || name == TileName("CornerFloor1Replacer5") || name == TileName("CornerFloor1Replacer6")) //If tunnels left and right or left and down or right and down, change to all directions.
 				{
-					replacer = "CornerFloor1Replacer7"; //All directions.
+					replacer = currentBlock.WithName(TileName("CornerFloor1Replacer7")); //All directions.
 				}
 
-				replacer += "_" + rotation + "_" + flip;
 			}
-			else if (name.find("CornerRoof1") != std::string::npos)
+			else if (TileNames::Has(currentBlock, TILE_CORNER_ROOF1))
 			{
-				if (name == "CornerRoof1")
+				if (name == TileName("CornerRoof1"))
 				{
-					int rot = std::stoi(rotation.substr(1, 1));
+					int rot = currentBlock.rotation;
 					if (dirToUse == 2)
 					{
-						replacer = "CornerRoof1Replacer3"; //Only tunnel up
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer3")); //Only tunnel up
 					}
 					else if (rot == 0 && dirToUse == 0)
 					{
-						replacer = "CornerRoof1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer1"));
 					}
 					else if (rot == 0 && dirToUse == 5)
 					{
-						replacer = "CornerRoof1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer2"));
 					}
 					else if (rot == 1 && dirToUse == 5)
 					{
-						replacer = "CornerRoof1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer1"));
 					}
 					else if (rot == 1 && dirToUse == 1)
 					{
-						replacer = "CornerRoof1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer2"));
 					}
 					else if (rot == 2 && dirToUse == 1)
 					{
-						replacer = "CornerRoof1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer1"));
 					}
 					else if (rot == 2 && dirToUse == 4)
 					{
-						replacer = "CornerRoof1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer2"));
 					}
 					else if (rot == 3 && dirToUse == 4)
 					{
-						replacer = "CornerRoof1Replacer1";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer1"));
 					}
 					else if (rot == 3 && dirToUse == 0)
 					{
-						replacer = "CornerRoof1Replacer2";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer2"));
 					}
 				}
-				else if (name == "CornerRoof1Replacer1") //If only left or right, replace with connection to both or connection to up.
+				else if (name == TileName("CornerRoof1Replacer1")) //If only left or right, replace with connection to both or connection to up.
 				{
 					if (dirToUse == 2)
 					{
-						replacer = "CornerRoof1Replacer4"; //Only tunnel left/right and up
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer4")); //Only tunnel left/right and up
 					}
 					else
 					{
-						replacer = "CornerRoof1Replacer6"; //Only tunnel to the sides
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer6")); //Only tunnel to the sides
 
 					}
 				}
-				else if (name == "CornerRoof1Replacer2") //If only left or right, replace with connection to both or connection to up.
+				else if (name == TileName("CornerRoof1Replacer2")) //If only left or right, replace with connection to both or connection to up.
 				{
 					if (dirToUse == 2)
 					{
-						replacer = "CornerRoof1Replacer5"; //Only tunnel left/right and up
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer5")); //Only tunnel left/right and up
 					}
 					else
 					{
-						replacer = "CornerRoof1Replacer6"; //Only tunnel to the sides.
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer6")); //Only tunnel to the sides.
 					}
 				}
-				else if (name == "CornerRoof1Replacer3") // If only tunnel up, replace with tunnel down and left or right.
+				else if (name == TileName("CornerRoof1Replacer3")) // If only tunnel up, replace with tunnel down and left or right.
 				{
-					int rot = static_cast<int>(rotation[1]);
+					int rot = currentBlock.rotation;
 
 					if (rot == 0 && dirToUse == 0)
 					{
-						replacer = "CornerRoof1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer4"));
 					}
 					else if (rot == 0 && dirToUse == 5)
 					{
-						replacer = "CornerRoof1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer5"));
 					}
 					else if (rot == 1 && dirToUse == 5)
 					{
-						replacer = "CornerRoof1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer4"));
 					}
 					else if (rot == 1 && dirToUse == 1)
 					{
-						replacer = "CornerRoof1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer5"));
 					}
 					else if (rot == 2 && dirToUse == 1)
 					{
-						replacer = "CornerRoof1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer4"));
 					}
 					else if (rot == 2 && dirToUse == 4)
 					{
-						replacer = "CornerRoof1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer5"));
 					}
 					else if (rot == 3 && dirToUse == 4)
 					{
-						replacer = "CornerRoof1Replacer4";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer4"));
 					}
 					else if (rot == 3 && dirToUse == 0)
 					{
-						replacer = "CornerRoof1Replacer5";
+						replacer = currentBlock.WithName(TileName("CornerRoof1Replacer5"));
 					}
 				}
-				else if (name == "CornerRoof1Replacer4" || name == "CornerRoof1Replacer5" || name == "CornerRoof1Replacer6") //If tunnels left and right or left and down or right and down, change to all directions.
+				else if (name == TileName("CornerRoof1Replacer4") || name == TileName("CornerRoof1Replacer5") || name == TileName("CornerRoof1Replacer6")) //If tunnels left and right or left and down or right and down, change to all directions.
 				{
-					replacer = "CornerRoof1Replacer7"; //All directions.
+					replacer = currentBlock.WithName(TileName("CornerRoof1Replacer7")); //All directions.
 				}
 
-				replacer += "_" + rotation + "_" + flip;
 			}
 			//Replacement of blocks that used to be voids but have been replaced with connectors.
 			//add T-tunnel, if straight tunnel
-			else if (name == "TunnelStraight1" || name == "SideTwoConnector")
+			else if (name == TileName("TunnelStraight1") || name == TileName("SideTwoConnector"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (dirToUse == 3) //Tunnel downwards
 				{
-					replacer = "TVertical2Connector_" + rotation + "_f";
+					replacer = { TileName("TVertical2Connector"), currentBlock.rotation, TileFlip::F };
 				}
 				else if (dirToUse == 2) //Tunnel upwards
 				{
-					replacer = "TVertical1Connector_" + rotation + "_f";
+					replacer = { TileName("TVertical1Connector"), currentBlock.rotation, TileFlip::F };
 				}
 				//Horizontal connections.
 				else if (dirToUse == 5 && (rot == 0 || rot == 2))
 				{
-					replacer = "THorizontal1Connector_r0_f";
+					replacer = { TileName("THorizontal1Connector"), 0u, TileFlip::F };
 				}
 				else if (dirToUse == 4 && (rot == 0 || rot == 2))
 				{
-					replacer = "THorizontal1Connector_r2_f";
+					replacer = { TileName("THorizontal1Connector"), 2u, TileFlip::F };
 				}
 				else if (dirToUse == 1 && (rot == 1 || rot == 3))
 				{
-					replacer = "THorizontal1Connector_r1_f";
+					replacer = { TileName("THorizontal1Connector"), 1u, TileFlip::F };
 				}
 				else if (dirToUse == 0 && (rot == 1 || rot == 3))
 				{
-					replacer = "THorizontal1Connector_r3_f";
+					replacer = { TileName("THorizontal1Connector"), 3u, TileFlip::F };
 				}
 			}
 			//Add T-tunnel, if horizontal L tunnel
-			else if (name == "LHorizontalConnector")
+			else if (name == TileName("LHorizontalConnector"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (dirToUse == 2)
 				{
-					replacer = "LUpConnector_" + rotation + "_f";
+					replacer = { TileName("LUpConnector"), currentBlock.rotation, TileFlip::F };
 				}
 				else if (dirToUse == 3)
 				{
-					replacer = "LDownConnector_" + rotation + "_f";
+					replacer = { TileName("LDownConnector"), currentBlock.rotation, TileFlip::F };
 				}
 				else
 				{
@@ -1524,11 +1382,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "THorizontal1Connector_r0_f";
+							replacer = { TileName("THorizontal1Connector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "THorizontal1Connector_r1_f";
+							replacer = { TileName("THorizontal1Connector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -1536,11 +1394,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "THorizontal1Connector_r2_f";
+							replacer = { TileName("THorizontal1Connector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "THorizontal1Connector_r1_f";
+							replacer = { TileName("THorizontal1Connector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -1548,11 +1406,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "THorizontal1Connector_r2_f";
+							replacer = { TileName("THorizontal1Connector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "THorizontal1Connector_r3_f";
+							replacer = { TileName("THorizontal1Connector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -1560,11 +1418,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "THorizontal1Connector_r0_f";
+							replacer = { TileName("THorizontal1Connector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "THorizontal1Connector_r3_f";
+							replacer = { TileName("THorizontal1Connector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -1573,12 +1431,12 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 
 			}
 			//Add T-tunnel, if vertical L tunnel
-			else if (name == "LVertical1Connector") //Up
+			else if (name == TileName("LVertical1Connector")) //Up
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (dirToUse == 3)
 				{
-					replacer = "TVertical3Connector_" + rotation + "_f";
+					replacer = { TileName("TVertical3Connector"), currentBlock.rotation, TileFlip::F };
 				}
 				else
 				{
@@ -1588,15 +1446,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "TVertical1Connector_r0_f";
+							replacer = { TileName("TVertical1Connector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "LUpConnector_r2_f";
+							replacer = { TileName("LUpConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "LUpConnector_r3_f";
+							replacer = { TileName("LUpConnector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -1604,15 +1462,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "LUpConnector_r3_f";
+							replacer = { TileName("LUpConnector"), 3u, TileFlip::F };
 						}
 						else if (dirToUse == 1)
 						{
-							replacer = "LUpConnector_r0_f";
+							replacer = { TileName("LUpConnector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "TVertical1Connector_r1_f";
+							replacer = { TileName("TVertical1Connector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -1620,15 +1478,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "TVertical1Connector_r2_f";
+							replacer = { TileName("TVertical1Connector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "LUpConnector_r1_f";
+							replacer = { TileName("LUpConnector"), 1u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "LUpConnector_r0_f";
+							replacer = { TileName("LUpConnector"), 0u, TileFlip::F };
 						}
 						break;
 					}
@@ -1636,29 +1494,29 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 5)
 						{
-							replacer = "TVertical1Connector_r3_f";
+							replacer = { TileName("TVertical1Connector"), 3u, TileFlip::F };
 						}
 						else if (dirToUse == 0)
 						{
-							replacer = "LUpConnector_r2_f";
+							replacer = { TileName("LUpConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 1)
 						{
-							replacer = "LUpConnector_r1_f";
+							replacer = { TileName("LUpConnector"), 1u, TileFlip::F };
 						}
 						break;
 					}
 					}
 				}
 			}
-			else if (name == "LVertical2Connector") //Down
+			else if (name == TileName("LVertical2Connector")) //Down
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (dirToUse == 2)
 				{
 					rot = (rot + 2) % 4;
 
-					replacer = "TVertical3Connector_r" + std::to_string(rot) + "_f";
+					replacer = { TileName("TVertical3Connector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 				else
 				{
@@ -1668,15 +1526,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "TVertical2Connector_r0_f";
+							replacer = { TileName("TVertical2Connector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "LDownConnector_r0_f";
+							replacer = { TileName("LDownConnector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "LDownConnector_r1_f";
+							replacer = { TileName("LDownConnector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -1684,15 +1542,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 5)
 						{
-							replacer = "TVertical2Connector_r1_f";
+							replacer = { TileName("TVertical2Connector"), 1u, TileFlip::F };
 						}
 						else if (dirToUse == 0)
 						{
-							replacer = "LDownConnector_r2_f";
+							replacer = { TileName("LDownConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 1)
 						{
-							replacer = "LDownConnector_r1_f";
+							replacer = { TileName("LDownConnector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -1700,15 +1558,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "TVertical2Connector_r2_f";
+							replacer = { TileName("TVertical2Connector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "LDownConnector_r2_f";
+							replacer = { TileName("LDownConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "LDownConnector_r3_f";
+							replacer = { TileName("LDownConnector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -1716,15 +1574,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 4)
 						{
-							replacer = "TVertical2Connector_r3_f";
+							replacer = { TileName("TVertical2Connector"), 3u, TileFlip::F };
 						}
 						else if (dirToUse == 0)
 						{
-							replacer = "LDownConnector_r3_f";
+							replacer = { TileName("LDownConnector"), 3u, TileFlip::F };
 						}
 						else if (dirToUse == 1)
 						{
-							replacer = "LDownConnector_r0_f";
+							replacer = { TileName("LDownConnector"), 0u, TileFlip::F };
 						}
 						break;
 					}
@@ -1732,117 +1590,117 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				}
 			}
 			//Add T-tunnel, if vertical tunnel
-			else if (name == "DownUpConnector")
+			else if (name == TileName("DownUpConnector"))
 			{
 				switch (dirToUse)
 				{
 				case 0:
 				{
-					replacer = "TVertical3Connector_r0_f";
+					replacer = { TileName("TVertical3Connector"), 0u, TileFlip::F };
 					break;
 				}
 				case 1:
 				{
-					replacer = "TVertical3Connector_r2_f";
+					replacer = { TileName("TVertical3Connector"), 2u, TileFlip::F };
 					break;
 				}
 				case 4:
 				{
-					replacer = "TVertical3Connector_r3_f";
+					replacer = { TileName("TVertical3Connector"), 3u, TileFlip::F };
 					break;
 				}
 				case 5:
 				{
-					replacer = "TVertical3Connector_r1_f";
+					replacer = { TileName("TVertical3Connector"), 1u, TileFlip::F };
 					break;
 				}
 				}
 			}
 			//add 4-connection-tunnel, if T-tunnel
-			else if (name == "TVertical1Connector")
+			else if (name == TileName("TVertical1Connector"))
 			{
 				if (dirToUse == 3)
 				{
-					replacer = "PlusVerticalConnector_" + rotation + "_f";
+					replacer = { TileName("PlusVerticalConnector"), currentBlock.rotation, TileFlip::F };
 				}
 				else
 				{
-					int rot = std::stoi(rotation.substr(1, 1));
+					int rot = currentBlock.rotation;
 					if (rot == 0 || rot == 2)
 					{
 						if (dirToUse == 4)
 						{
-							replacer = "4UpConnector_r0_f";
+							replacer = { TileName("4UpConnector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "4UpConnector_r2_f";
+							replacer = { TileName("4UpConnector"), 2u, TileFlip::F };
 						}
 					}
 					else if (rot == 1 || rot == 3)
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "4UpConnector_r1_f";
+							replacer = { TileName("4UpConnector"), 1u, TileFlip::F };
 						}
 						else if (dirToUse == 1)
 						{
-							replacer = "4UpConnector_r3_f";
+							replacer = { TileName("4UpConnector"), 3u, TileFlip::F };
 						}
 					}
 				}
 			}
-			else if (name == "TVertical2Connector")
+			else if (name == TileName("TVertical2Connector"))
 			{
 				if (dirToUse == 2)
 				{
-					replacer = "PlusVerticalConnector_" + rotation + "_f";
+					replacer = { TileName("PlusVerticalConnector"), currentBlock.rotation, TileFlip::F };
 				}
 				else
 				{
-					int rot = std::stoi(rotation.substr(1, 1));
+					int rot = currentBlock.rotation;
 					if (rot == 0 || rot == 2)
 					{
 						if (dirToUse == 4)
 						{
-							replacer = "4DownConnector_r2_f";
+							replacer = { TileName("4DownConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "4DownConnector_r0_f";
+							replacer = { TileName("4DownConnector"), 0u, TileFlip::F };
 						}
 					}
 					else if (rot == 1 || rot == 3)
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "4DownConnector_r3_f";
+							replacer = { TileName("4DownConnector"), 3u, TileFlip::F };
 						}
 						else if (dirToUse == 1)
 						{
-							replacer = "4DownConnector_r1_f";
+							replacer = { TileName("4DownConnector"), 1u, TileFlip::F };
 						}
 					}
 				}
 			}
-			else if (name == "TVertical3Connector")
+			else if (name == TileName("TVertical3Connector"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				switch (rot)
 				{
 				case 0:
 				{
 					if (dirToUse == 1)
 					{
-						replacer = "PlusVerticalConnector_r0_f";
+						replacer = { TileName("PlusVerticalConnector"), 0u, TileFlip::F };
 					}
 					else if (dirToUse == 4)
 					{
-						replacer = "4UpDownConnector_r3_f";
+						replacer = { TileName("4UpDownConnector"), 3u, TileFlip::F };
 					}
 					else if (dirToUse == 5)
 					{
-						replacer = "4UpDownConnector_r0_f";
+						replacer = { TileName("4UpDownConnector"), 0u, TileFlip::F };
 					}
 					break;
 				}
@@ -1850,15 +1708,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				{
 					if (dirToUse == 4)
 					{
-						replacer = "PlusVerticalConnector_r1_f";
+						replacer = { TileName("PlusVerticalConnector"), 1u, TileFlip::F };
 					}
 					else if (dirToUse == 0)
 					{
-						replacer = "4UpDownConnector_r0_f";
+						replacer = { TileName("4UpDownConnector"), 0u, TileFlip::F };
 					}
 					else if (dirToUse == 1)
 					{
-						replacer = "4UpDownConnector_r1_f";
+						replacer = { TileName("4UpDownConnector"), 1u, TileFlip::F };
 					}
 					break;
 				}
@@ -1866,15 +1724,15 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				{
 					if (dirToUse == 0)
 					{
-						replacer = "PlusVerticalConnector_r2_f";
+						replacer = { TileName("PlusVerticalConnector"), 2u, TileFlip::F };
 					}
 					else if (dirToUse == 4)
 					{
-						replacer = "4UpDownConnector_r2_f";
+						replacer = { TileName("4UpDownConnector"), 2u, TileFlip::F };
 					}
 					else if (dirToUse == 5)
 					{
-						replacer = "4UpDownConnector_r1_f";
+						replacer = { TileName("4UpDownConnector"), 1u, TileFlip::F };
 					}
 					break;
 				}
@@ -1882,64 +1740,64 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				{
 					if (dirToUse == 5)
 					{
-						replacer = "PlusVerticalConnector_r3_f";
+						replacer = { TileName("PlusVerticalConnector"), 3u, TileFlip::F };
 					}
 					else if (dirToUse == 0)
 					{
-						replacer = "4UpDownConnector_r3_f";
+						replacer = { TileName("4UpDownConnector"), 3u, TileFlip::F };
 					}
 					else if (dirToUse == 1)
 					{
-						replacer = "4UpDownConnector_r2_f";
+						replacer = { TileName("4UpDownConnector"), 2u, TileFlip::F };
 					}
 					break;
 				}
 				}
 			}
-			else if (name == "THorizontal1Connector" || name == "TunnelT1")
+			else if (name == TileName("THorizontal1Connector") || name == TileName("TunnelT1"))
 			{
 				if (dirToUse != 2 && dirToUse != 3)
 				{
-					replacer = "PlusHorizontalConnector_" + rotation + "_f";
+					replacer = { TileName("PlusHorizontalConnector"), currentBlock.rotation, TileFlip::F };
 				}
 				else if (dirToUse == 2)
 				{
-					int rot = std::stoi(rotation.substr(1, 1));
+					int rot = currentBlock.rotation;
 					rot = (rot + 2) % 4;
 
-					replacer = "4UpConnector_r" + std::to_string(rot) + "_f";
+					replacer = { TileName("4UpConnector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 				else if (dirToUse == 3)
 				{
-					replacer = "4DownConnector_" + rotation + "_f";
+					replacer = { TileName("4DownConnector"), currentBlock.rotation, TileFlip::F };
 				}
 			}
-			else if (name == "TunnelT2")
+			else if (name == TileName("TunnelT2"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				rot = (rot + 2) % 4;
 
 				if (dirToUse != 2 && dirToUse != 3)
 				{
-					replacer = "PlusHorizontalConnector_r" + std::to_string(rot) + "_f";
+					replacer = { TileName("PlusHorizontalConnector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 				else if (dirToUse == 2)
 				{
 					rot = (rot + 2) % 4;
-					replacer = "4UpConnector_r" + std::to_string(rot) + "_f";
+					replacer = { TileName("4UpConnector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 				else if (dirToUse == 3)
 				{
-					replacer = "4DownConnector_" + rotation + "_f";
+					replacer = { TileName("4DownConnector"), currentBlock.rotation, TileFlip::F };
 				}
 			}
-			else if (name == "LUpConnector")
+			else if (name == TileName("LUpConnector"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (dirToUse == 3)
 				{
 					rot = rot + 1;
-					replacer = "4UpDownConnector_r" + std::to_string(rot) + "_f";
+					replacer = { TileName("4UpDownConnector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 				else
 				{
@@ -1949,11 +1807,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "4UpConnector_r2_f";
+							replacer = { TileName("4UpConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "4UpConnector_r3_f";
+							replacer = { TileName("4UpConnector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -1961,11 +1819,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "4UpConnector_r0_f";
+							replacer = { TileName("4UpConnector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "4UpConnector_r3_f";
+							replacer = { TileName("4UpConnector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -1973,11 +1831,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "4UpConnector_r0_f";
+							replacer = { TileName("4UpConnector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "4UpConnector_r1_f";
+							replacer = { TileName("4UpConnector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -1985,24 +1843,24 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "4UpConnector_r2_f";
+							replacer = { TileName("4UpConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "4UpConnector_r1_f";
+							replacer = { TileName("4UpConnector"), 1u, TileFlip::F };
 						}
 						break;
 					}
 					}
 				}
 			}
-			else if (name == "LDownConnector")
+			else if (name == TileName("LDownConnector"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (dirToUse == 2)
 				{
 					rot = rot + 1;
-					replacer = "4UpDownConnector_r" + std::to_string(rot) + "_f";
+					replacer = { TileName("4UpDownConnector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 				else
 				{
@@ -2012,11 +1870,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "4DownConnector_r0_f";
+							replacer = { TileName("4DownConnector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "4DownConnector_r1_f";
+							replacer = { TileName("4DownConnector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -2024,11 +1882,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 0)
 						{
-							replacer = "4DownConnector_r2_f";
+							replacer = { TileName("4DownConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "4DownConnector_r1_f";
+							replacer = { TileName("4DownConnector"), 1u, TileFlip::F };
 						}
 						break;
 					}
@@ -2036,11 +1894,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "4DownConnector_r2_f";
+							replacer = { TileName("4DownConnector"), 2u, TileFlip::F };
 						}
 						else if (dirToUse == 5)
 						{
-							replacer = "4DownConnector_r3_f";
+							replacer = { TileName("4DownConnector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -2048,11 +1906,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 					{
 						if (dirToUse == 1)
 						{
-							replacer = "4DownConnector_r0_f";
+							replacer = { TileName("4DownConnector"), 0u, TileFlip::F };
 						}
 						else if (dirToUse == 4)
 						{
-							replacer = "4DownConnector_r3_f";
+							replacer = { TileName("4DownConnector"), 3u, TileFlip::F };
 						}
 						break;
 					}
@@ -2060,71 +1918,71 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				}
 			}
 			//add 5-connection tunnel, if 4-connection tunnel.
-			else if (name == "PlusVerticalConnector")
+			else if (name == TileName("PlusVerticalConnector"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				if (rot == 0 || rot == 2)
 				{
 					if (dirToUse == 4)
 					{
-						replacer = "5NoSideConnector_r2_f";
+						replacer = { TileName("5NoSideConnector"), 2u, TileFlip::F };
 					}
 					else if (dirToUse == 5)
 					{
-						replacer = "5NoSideConnector_r0_f";
+						replacer = { TileName("5NoSideConnector"), 0u, TileFlip::F };
 					}
 				}
 				else if (rot == 1 || rot == 3)
 				{
 					if (dirToUse == 0)
 					{
-						replacer = "5NoSideConnector_r3_f";
+						replacer = { TileName("5NoSideConnector"), 3u, TileFlip::F };
 					}
 					else if (dirToUse == 1)
 					{
-						replacer = "5NoSideConnector_r1_f";
+						replacer = { TileName("5NoSideConnector"), 1u, TileFlip::F };
 					}
 				}
 			}
-			else if (name == "4UpConnector")
+			else if (name == TileName("4UpConnector"))
 			{
 				if (dirToUse != 3)
 				{
-					replacer = "5NoDownConnector_r0_f";
+					replacer = { TileName("5NoDownConnector"), 0u, TileFlip::F };
 				}
 				else if (dirToUse == 3)
 				{
-					int rot = std::stoi(rotation.substr(1, 1));
+					int rot = currentBlock.rotation;
 					rot = (rot + 2) % 4;
-					replacer = "5NoSideConnector_r" + std::to_string(rot) + "_f";
+					replacer = { TileName("5NoSideConnector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 			}
-			else if (name == "4DownConnector")
+			else if (name == TileName("4DownConnector"))
 			{
 				if (dirToUse != 2)
 				{
-					replacer = "5NoUpConnector_r0_f";
+					replacer = { TileName("5NoUpConnector"), 0u, TileFlip::F };
 				}
 				else if (dirToUse == 2)
 				{
-					int rot = std::stoi(rotation.substr(1, 1));
-					replacer = "5NoSideConnector_r" + std::to_string(rot) + "_f";
+					int rot = currentBlock.rotation;
+					replacer = { TileName("5NoSideConnector"), static_cast<uint8_t>(rot), TileFlip::F };
 				}
 			}
-			else if (name == "4UpDownConnector")
+			else if (name == TileName("4UpDownConnector"))
 			{
-				int rot = std::stoi(rotation.substr(1, 1));
+				int rot = currentBlock.rotation;
 				switch (rot)
 				{
 				case 0:
 				{
 					if (dirToUse == 1)
 					{
-						replacer = "5NoSideConnector_r0_f";
+						replacer = { TileName("5NoSideConnector"), 0u, TileFlip::F };
 					}
 					else if (dirToUse == 4)
 					{
-						replacer = "5NoSideConnector_r3_f";
+						replacer = { TileName("5NoSideConnector"), 3u, TileFlip::F };
 					}
 					break;
 				}
@@ -2132,11 +1990,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				{
 					if (dirToUse == 0)
 					{
-						replacer = "5NoSideConnector_r0_f";
+						replacer = { TileName("5NoSideConnector"), 0u, TileFlip::F };
 					}
 					else if (dirToUse == 4)
 					{
-						replacer = "5NoSideConnector_r1_f";
+						replacer = { TileName("5NoSideConnector"), 1u, TileFlip::F };
 					}
 					break;
 				}
@@ -2144,11 +2002,11 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				{
 					if (dirToUse == 0)
 					{
-						replacer = "5NoSideConnector_r2_f";
+						replacer = { TileName("5NoSideConnector"), 2u, TileFlip::F };
 					}
 					else if (dirToUse == 5)
 					{
-						replacer = "5NoSideConnector_r1_f";
+						replacer = { TileName("5NoSideConnector"), 1u, TileFlip::F };
 					}
 					break;
 				}
@@ -2156,37 +2014,37 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 				{
 					if (dirToUse == 1)
 					{
-						replacer = "5NoSideConnector_r2_f";
+						replacer = { TileName("5NoSideConnector"), 2u, TileFlip::F };
 					}
 					else if (dirToUse == 5)
 					{
-						replacer = "5NoSideConnector_r3_f";
+						replacer = { TileName("5NoSideConnector"), 3u, TileFlip::F };
 					}
 					break;
 				}
 				}
 			}
-			else if (name == "PlusHorizontalConnector" || name == "TunnelCross1")
+			else if (name == TileName("PlusHorizontalConnector") || name == TileName("TunnelCross1"))
 			{
 				if (dirToUse == 2)
 				{
-					replacer = "5NoDownConnector_" + rotation + "_f";
+					replacer = { TileName("5NoDownConnector"), currentBlock.rotation, TileFlip::F };
 				}
 				else if (dirToUse == 3)
 				{
-					replacer = "5NoUpConnector_" + rotation + "_f";
+					replacer = { TileName("5NoUpConnector"), currentBlock.rotation, TileFlip::F };
 				}
 			}
 			//add 6-connection tunnel, if 5-connection tunnel.
-			else if (name == "5NoSideConnector" || name == "5NoDownConnector" || name == "5NoUpConnector")
+			else if (name == TileName("5NoSideConnector") || name == TileName("5NoDownConnector") || name == TileName("5NoUpConnector"))
 			{
-				replacer = "3DCrossConnector_" + rotation + "_f";
+				replacer = { TileName("3DCrossConnector"), currentBlock.rotation, TileFlip::F };
 			}
 		}
 	}
-	if (replacer == "Void") //Should never happen. Is here so we see cubes where something went very wrong.
+	if (replacer.name == TileName("Void")) //Should never happen. Is here so we see cubes where something went very wrong.
 	{
-		replacer = "Cube_r0_f";
+		replacer = { TileName("Cube"), 0u, TileFlip::F };
 	}
 
 	return replacer;
@@ -2195,9 +2053,10 @@ std::string WFC::ReplaceBlock(std::string& currentBlock, std::string& nextBlock,
 bool WFC::SetInput(std::string input)
 {
 	//Make sure everything is reset.
-	m_entropy.clear();
-	m_currentEntropy.clear();
+	m_solvers.clear();
 	m_blockPossibilities.clear();
+	m_tiles.clear();
+	m_tileIndices.clear();
 
 	//If the read fails it means the constraints can not generate a level.
 	if (!ReadInput(input))
@@ -2221,34 +2080,24 @@ bool WFC::ReadInput(std::string input)
 
 	if (inputFile.is_open())
 	{
-		m_uniqueIdCounter = 0u;
 		//For each unique block.
 		while (std::getline(inputFile, line))
 		{
 			size_t delim = line.find(' ');
-			std::string id = line.substr(0, delim);
+			const TileId block = TileNames::Parse(std::string_view(line).substr(0, delim));
 
-			if (id.find("Door") != std::string::npos)
+			if (TileNames::Has(block, TILE_DOOR))
 			{
-				m_doorBlocks.push_back(id);
+				m_doorBlocks.push_back(block);
 			}
-			else if (id.find("Spawn") != std::string::npos)
+			else if (TileNames::Has(block, TILE_SPAWN))
 			{
-				m_spawnBlocks.push_back(id);
+				m_spawnBlocks.push_back(block);
 				++m_spawnBlocksSize;
 			}
 
-			//Check if the block is already in the map.
-			if (m_stringToIdMap.find(id) == m_stringToIdMap.end())
-			{
-				m_stringToIdMap[id] = m_uniqueIdCounter;
-				m_idToStringMap[m_uniqueIdCounter] = id;
-
-				++m_uniqueIdCounter;
-			}
-
 			//Put the count in the frequency and increment the totalcount.
-			unsigned int uid = m_stringToIdMap[id];
+			unsigned int uid = GetTileIndex(block);
 			m_blockPossibilities[uid].count = std::stoi(line.substr(delim + 1, line.size()));
 			m_totalCount += m_blockPossibilities[uid].count;
 
@@ -2257,24 +2106,14 @@ bool WFC::ReadInput(std::string input)
 			{
 				//Go through each possibility in that direction.
 				std::getline(inputFile, line);
-				while (line.find(',') != std::string::npos)
+				std::string_view possibilities = line;
+				while (possibilities.find(',') != std::string_view::npos)
 				{
-					delim = line.find(',');
-					std::string possibility = line.substr(0, delim);
-
-					//Check if the block is already in the map.
-					if (m_stringToIdMap.find(possibility) == m_stringToIdMap.end())
-					{
-						m_stringToIdMap[possibility] = m_uniqueIdCounter;
-						m_idToStringMap[m_uniqueIdCounter] = possibility;
-
-						++m_uniqueIdCounter;
-					}
-
-					unsigned int uidDir = m_stringToIdMap[possibility];
+					delim = possibilities.find(',');
+					unsigned int uidDir = GetTileIndex(TileNames::Parse(possibilities.substr(0, delim)));
 
 					m_blockPossibilities[uid].dirPossibilities[i].push_back(uidDir);
-					line.erase(line.begin(), line.begin() + delim + 1);
+					possibilities.remove_prefix(delim + 1);
 				}
 			}
 
@@ -2292,172 +2131,52 @@ bool WFC::ReadInput(std::string input)
 		block.second.frequency = 1.0f;
 	}
 
-	return true;
-}
-
-void WFC::Propogate(uint32_t index, Room& room)
-{
-	//If the index is not z = 0 we can propogate in the negative z direction.
-	if (index % room.width != 0)
-	{
-		CheckForPropogation(index, index - 1, 2, room.i);
-	}
-
-	//If the index is not z = width we can propogate in the positive z direction.
-	if (index % room.width != room.width - 1)
-	{
-		CheckForPropogation(index, index + 1, 3, room.i);
-	}
-
-	//If the index is not y = 0 we can propogate in the negative y direction.
-	uint32_t remainder = index % (room.width * room.height);
-	if (remainder >= room.width)
-	{
-		CheckForPropogation(index, index - room.width, 4, room.i);
-	}
-
-	//If the index is not y = height we can propogate in the positive y direction.
-	if (remainder < room.width * (room.height - 1))
-	{
-		CheckForPropogation(index, index + room.width, 5, room.i);
-	}
-
-	//If the index is not x = 0 we can propogate in the negative x direction.
-	if (index >= room.width * room.height)
-	{
-		CheckForPropogation(index, index - (room.width * room.height), 0, room.i);
-	}
-
-	//If the index is not x = depth we can propogate in the positive x direction.
-	if (index < room.width * room.height * (room.depth - 1))
-	{
-		CheckForPropogation(index, index + (room.width * room.height), 1, room.i);
-	}
-}
+	//Bake the rules into bitmasks for the solver.
+	m_rules.Build(m_blockPossibilities, static_cast<uint32_t>(m_tiles.size()));
+	const uint32_t words = m_rules.GetWordCount();
+	m_roomTiles.assign(words, 0u);
+	m_edgeTiles.assign(6u * words, 0u);
 
-//Dir is the direction from the neighborIndex TO the currentIndex.
-void WFC::CheckForPropogation(uint32_t currentIndex, uint32_t neighborIndex, unsigned dir, unsigned int roomi)
-{
-	bool removed = false;
-	for (uint32_t i{ 0u }; i < m_currentEntropy[roomi][neighborIndex].possibilities.size(); ++i) //For every possibility in the neighbor cell
+	const auto edge = m_tileIndices.find(TileId{ TileName("Edge") }.Key());
+	const auto empty = m_tileIndices.find(TileId{ TileName("Void") }.Key());
+	for (auto& [tile, block] : m_blockPossibilities)
 	{
-		unsigned int& neighborPossibility = m_currentEntropy[roomi][neighborIndex].possibilities[i];
-		bool matched = false;
-
-		for (auto& possibility : m_currentEntropy[roomi][currentIndex].possibilities) //Check every possibility still left in the current cell and make sure "r" matches with atleast one of them.
+		const bool door = TileNames::Has(m_tiles[tile], TILE_DOOR);
+		if (!door && !TileNames::Has(m_tiles[tile], TILE_SPAWN)) //Dont add special blocks.
 		{
-			if (std::count(m_blockPossibilities[neighborPossibility].dirPossibilities[dir].begin(), m_blockPossibilities[neighborPossibility].dirPossibilities[dir].end(), possibility))
-			{
-				matched = true;
-				break;
-			}
+			m_roomTiles[tile >> 6u] |= 1ull << (tile & 63u);
 		}
-		if (!matched) //If it didnt match with any possibility in the current cell we remove the possibility from the neighbor cell.
-		{
-			if (m_currentEntropy[roomi][neighborIndex].possibilities.size() == 1)
-			{
-				m_failed[roomi] = true;
-				break;
-			}
 
-			m_currentEntropy[roomi][neighborIndex].possibilities.erase(m_currentEntropy[roomi][neighborIndex].possibilities.begin() + i);
-			i--;
-			removed = true;
-		}
-	}
-	//If something got removed we have to propagate that information.
-	if (removed)
-	{
-		//We now have to rearrange the PQ since possibilities were removed. (Is not done during contraints.)
-		if (m_priorityQueue[roomi])
+		//Doors and the blocks that can have a boundary in a direction can be placed at the boundary.
+		for (uint32_t dir{ 0u }; dir < 6u; ++dir)
 		{
-			if (!m_priorityQueue[roomi]->Rearrange(neighborIndex, m_blockPossibilities))
+			const uint64_t* allowed = m_rules.Allowed(dir, tile);
+			const bool boundary = (edge != m_tileIndices.end() && ((allowed[edge->second >> 6u] >> (edge->second & 63u)) & 1u)) ||
+				(empty != m_tileIndices.end() && ((allowed[empty->second >> 6u] >> (empty->second & 63u)) & 1u));
+			if (door || boundary)
 			{
-				m_failed[roomi] = true; //Mark generation as failed if it fails to rearrange.
+				m_edgeTiles[dir * words + (tile >> 6u)] |= 1ull << (tile & 63u);
 			}
 		}
-
-		m_recursiveStack[roomi].push(neighborIndex);
-	}
-}
-
-void WFC::PropogateConstrain(uint32_t index, Room& room)
-{
-	//If the index is not z = 0 we can propogate in the negative z direction.
-	if (index % room.width != 0)
-	{
-		CheckForPropogationConstrain(index, index - 1, 2, room.i);
-	}
-
-	//If the index is not z = width we can propogate in the positive z direction.
-	if (index % room.width != room.width - 1)
-	{
-		CheckForPropogationConstrain(index, index + 1, 3, room.i);
-	}
-
-	//If the index is not y = 0 we can propogate in the negative y direction.
-	uint32_t remainder = index % (room.width * room.height);
-	if (remainder >= room.width)
-	{
-		CheckForPropogationConstrain(index, index - room.width, 4, room.i);
-	}
-
-	//If the index is not y = height we can propogate in the positive y direction.
-	if (remainder < room.width * (room.height - 1))
-	{
-		CheckForPropogationConstrain(index, index + room.width, 5, room.i);
 	}
 
-	//If the index is not x = 0 we can propogate in the negative x direction.
-	if (index >= room.width * room.height)
-	{
-		CheckForPropogationConstrain(index, index - (room.width * room.height), 0, room.i);
-	}
-
-	//If the index is not x = depth we can propogate in the positive x direction.
-	if (index < room.width * room.height * (room.depth - 1))
-	{
-		CheckForPropogationConstrain(index, index + (room.width * room.height), 1, room.i);
-	}
+	return true;
 }
 
-//Dir is the direction from the neighborIndex TO the currentIndex.
-void WFC::CheckForPropogationConstrain(uint32_t currentIndex, uint32_t neighborIndex, unsigned dir, unsigned int roomi)
+unsigned int WFC::GetTileIndex(TileId block)
 {
-	bool removed = false;
-	for (uint32_t i{ 0u }; i < m_entropy[roomi][neighborIndex].possibilities.size(); ++i) //For every possibility in the neighbor cell
+	//Check if the block is already in the map.
+	auto it = m_tileIndices.find(block.Key());
+	if (it != m_tileIndices.end())
 	{
-		unsigned int& neighborPossibility = m_entropy[roomi][neighborIndex].possibilities[i];
-		bool matched = false;
-
-		for (auto& possibility : m_entropy[roomi][currentIndex].possibilities) //Check every possibility still left in the current cell and make sure "r" matches with atleast one of them.
-		{
-			if (std::count(m_blockPossibilities[neighborPossibility].dirPossibilities[dir].begin(), m_blockPossibilities[neighborPossibility].dirPossibilities[dir].end(), possibility))
-			{
-				matched = true;
-				break;
-			}
-		}
-		if (!matched) //If it didnt match with any possibility in the current cell we remove the possibility from the neighbor cell.
-		{
-			if (m_entropy[roomi][neighborIndex].possibilities.size() == 1)
-			{
-				m_failed[roomi] = true;
-				break;
-			}
-
-			m_entropy[roomi][neighborIndex].possibilities.erase(m_entropy[roomi][neighborIndex].possibilities.begin() + i);
-			i--;
-			removed = true;
-		}
-	}
-	//If something got removed we have to propagate that information.
-	if (removed)
-	{
-		m_recursiveStack[roomi].push(neighborIndex);
+		return it->second;
 	}
-}
 
+	const unsigned int uid = static_cast<unsigned int>(m_tiles.size());
+	m_tileIndices[block.Key()] = uid;
+	m_tiles.push_back(block);
+	return uid;
+}
 
 void WFC::PrintLevel()
 {
@@ -2477,13 +2196,6 @@ void WFC::PrintLevel()
 		{
 			std::cout << std::endl;
 		}
-		if (m_generatedLevel[i] == "")
-		{
-			std::cout << i << ": x\t\t";
-		}
-		else
-		{
-			std::cout << i << ": " << m_generatedLevel[i] << "\t\t";
-		}
+		std::cout << i << ": " << TileNames::ToString(m_generatedLevel[i]) << "\t\t";
 	}
 }
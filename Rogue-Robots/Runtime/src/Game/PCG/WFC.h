@@ -13,10 +13,10 @@ public:
 
 	~WFC() noexcept = default;
 
-	//Generates a level from the read input in the constructor or SetInput.
-	//Can be called multiple times for different results each time.
-	bool GenerateLevel(uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeight, uint32_t maxDepth);
-	const std::vector<std::string>& GetGeneratedLevel() const
+	//Generates a level from the read input in the constructor or SetInput. The rooms are generated on the job system.
+	//The same seed gives the same level, no matter how many workers there are.
+	bool GenerateLevel(uint64_t seed, uint32_t nrOfRooms, uint32_t maxWidth, uint32_t maxHeight, uint32_t maxDepth);
+	const std::vector<TileId>& GetGeneratedLevel() const
 	{
 		return m_generatedLevel;
 	}
@@ -56,34 +56,31 @@ private:
 	bool EdgeConstrain(uint32_t i, uint32_t dir, Room& room);
 	bool IntroduceConstraints(Room& room);
 
-	bool GenerateRoom(Room& room);
+	//Collapses the room from the domains saved after the constraints. Returns false if it contradicts
+	//after MAX_BACKTRACKS decisions have been taken back, the room is then tried again with another seed.
+	bool GenerateRoom(Room& room, unsigned int seed);
 
 	//Reads input from a file and adds it to the block possibilities.
 	bool ReadInput(std::string input);
-
-	//The constrain functions are only used on startup for constraints, same code but uses m_entropy or m_currentEntropy.
-	//Propogates information to neighboring cells after a possibility is removed.
-	void Propogate(uint32_t index, Room& room);
-	void PropogateConstrain(uint32_t index, Room& room);
-
-	//Helper function
-	void CheckForPropogation(uint32_t currentIndex, uint32_t neighborIndex, unsigned dir, unsigned int roomi);
-	void CheckForPropogationConstrain(uint32_t currentIndex, uint32_t neighborIndex, unsigned dir, unsigned int roomi);
+	//Returns the solver tile of the block, a new tile is added if the block has not been read before.
+	unsigned int GetTileIndex(TileId block);
 
 	//Post processing functions.
-	std::string ReplaceBlock(std::string& currentBlock, std::string& nextBlock, int prevDir, int nextDir, bool prevWasVoid, bool doorConnected);
+	TileId ReplaceBlock(TileId currentBlock, TileId nextBlock, int prevDir, int nextDir, bool prevWasVoid, bool doorConnected);
 
 private:
-	void t_GenerateRoom(unsigned int i, std::shared_ptr<Box> chosenBox);
+	void t_GenerateRoom(unsigned int i, std::shared_ptr<Box> chosenBox, uint64_t seed);
+
+	static constexpr uint32_t MAX_BACKTRACKS = 16u; //Per attempt of a room, see the WFC benchmark.
 
 	uint32_t m_totalCount = 0u; //Total number of blocks read during input.
 	std::unordered_map<unsigned int, Block> m_blockPossibilities; //The possibilities for each block-id.
-	std::vector<std::string> m_spawnBlocks;
+	std::vector<TileId> m_spawnBlocks;
 	unsigned int m_spawnBlocksSize = 0u;
-	std::vector<std::string> m_doorBlocks;
-	std::vector<std::string> m_connectorBlocks;
+	std::vector<TileId> m_doorBlocks;
+	std::vector<TileId> m_connectorBlocks;
 
-	std::vector<bool> m_failed; //If the generation fails.
+	std::vector<uint8_t> m_failed; //If the generation fails. Not a vector<bool>, the rooms write to it from different threads.
 
 	//Dimensions of the output level.
 	uint32_t m_width = 0;
@@ -92,15 +89,14 @@ private:
 
 	uint32_t m_spawnCoords[3] = { 0u, 0u, 0u };
 	std::vector<Room> m_generatedRooms; //The generated rooms. Rooms are placed here before the level is generated 
-	std::vector<std::string> m_generatedLevel; //The final level that is being generated.
-	std::vector<std::vector<EntropyBlock>> m_entropy; //The initial entropy. After the constraints.
-	std::vector<std::vector<EntropyBlock>> m_currentEntropy; //The current entropy of the generation.
-
-	std::vector<PriorityQueue*> m_priorityQueue; //Used for prioritizing entropy.
+	std::vector<TileId> m_generatedLevel; //The final level that is being generated.
+	WFCRules m_rules; //The block possibilities as bitmasks.
+	std::vector<uint64_t> m_roomTiles; //Every block that can be placed in a room (no doors or spawns).
+	std::vector<uint64_t> m_edgeTiles; //Per direction, the blocks that can be placed at the boundary of a room.
+	std::vector<WFCSolver> m_solvers; //The domains of every room. Saved after the constraints.
 
-	std::vector<std::queue<uint32_t>> m_recursiveStack; //Used to circumvent recursiveness. Saves us from stack overflows.
+	std::vector<PriorityQueue> m_priorityQueue; //Used for prioritizing entropy.
 
-	unsigned int m_uniqueIdCounter = 0u;
-	std::unordered_map<unsigned int, std::string> m_idToStringMap;
-	std::unordered_map<std::string, unsigned int> m_stringToIdMap;
+	std::vector<TileId> m_tiles; //The block of every solver tile.
+	std::unordered_map<uint32_t, unsigned int> m_tileIndices; //TileId::Key to solver tile.
 };
\ No newline at end of file
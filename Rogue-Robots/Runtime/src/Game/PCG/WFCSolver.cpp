@@ -0,0 +1,597 @@
+#include "WFCSolver.h"
+
+void WFCRules::Build(std::unordered_map<unsigned int, Block>& blockPossibilities, uint32_t tileCount)
+{
+	m_tileCount = tileCount;
+	m_wordCount = (tileCount + 63u) / 64u;
+	m_support.assign(6u * m_tileCount * m_wordCount, 0u);
+	m_allowed.assign(6u * m_tileCount * m_wordCount, 0u);
+	m_weights.assign(m_tileCount, 0.0f);
+	m_weightLogWeights.assign(m_tileCount, 0.0f);
+
+	for (auto& [tile, block] : blockPossibilities)
+	{
+		m_weights[tile] = block.frequency;
+		m_weightLogWeights[tile] = block.frequency > 0.0f ? block.frequency * std::log(block.frequency) : 0.0f;
+		for (uint32_t dir{ 0u }; dir < 6u; ++dir)
+		{
+			for (unsigned int neighbor : block.dirPossibilities[dir])
+			{
+				//The tile accepts the neighbor, so the neighbor supports the tile.
+				m_allowed[(dir * m_tileCount + tile) * m_wordCount + (neighbor >> 6u)] |= 1ull << (neighbor & 63u);
+				m_support[(dir * m_tileCount + neighbor) * m_wordCount + (tile >> 6u)] |= 1ull << (tile & 63u);
+			}
+		}
+	}
+}
+
+void WFCSolver::Reset(const WFCRules& rules, uint32_t width, uint32_t height, uint32_t depth, const uint64_t* initial, Propagation propagation)
+{
+	m_rules = &rules;
+	m_propagation = propagation;
+	m_width = width;
+	m_height = height;
+	m_depth = depth;
+	m_cellCount = width * height * depth;
+	m_tiles = rules.GetTileCount();
+	m_words = rules.GetWordCount();
+
+	m_domains.resize(m_cellCount * m_words);
+	for (uint32_t cell{ 0u }; cell < m_cellCount; ++cell)
+	{
+		std::copy(initial, initial + m_words, m_domains.begin() + cell * m_words);
+	}
+	double sumWeights = 0.0;
+	double sumWeightLogWeights = 0.0;
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		for (uint64_t bits = initial[word]; bits; bits &= bits - 1u)
+		{
+			const uint32_t tile = word * 64u + static_cast<uint32_t>(std::countr_zero(bits));
+			sumWeights += rules.GetWeight(tile);
+			sumWeightLogWeights += rules.GetWeightLogWeight(tile);
+		}
+	}
+	m_sumWeights.assign(m_cellCount, sumWeights);
+	m_sumWeightLogWeights.assign(m_cellCount, sumWeightLogWeights);
+	m_scratch.assign(2u * m_words, 0u);
+	m_queue.clear();
+	m_queued.assign(m_cellCount, 0u);
+	m_removals.clear();
+	m_changed.clear();
+	m_isChanged.assign(m_cellCount, 0u);
+	ClearDecisions();
+
+	if (m_propagation == Propagation::SupportCount)
+	{
+		m_supportCounts.assign(m_cellCount * 6u * m_tiles, 0u);
+		m_stale.assign(m_cellCount * 6u, 0u);
+		for (uint32_t cell{ 0u }; cell < m_cellCount; ++cell)
+		{
+			for (uint32_t dir{ 0u }; dir < 6u; ++dir)
+			{
+				ForEachTile(cell, [&](uint32_t tile)
+					{
+						SupportCount(cell, dir, tile) = CountSupport(cell, dir, tile);
+						if (SupportCount(cell, dir, tile) == 0u)
+						{
+							m_stale[cell * 6u + dir] = 1u;
+						}
+					});
+			}
+		}
+	}
+}
+
+bool WFCSolver::Restrict(uint32_t cell, const uint64_t* mask, bool propagate)
+{
+	uint64_t* domain = &m_domains[cell * m_words];
+	if (m_propagation == Propagation::SupportCount)
+	{
+		uint64_t* removed = &m_scratch[m_words];
+		for (uint32_t word{ 0u }; word < m_words; ++word)
+		{
+			removed[word] = domain[word] & ~mask[word];
+		}
+		return Remove(cell, removed) && (!propagate || PropagateSupportCount());
+	}
+
+	bool changed = false;
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		changed |= (domain[word] & ~mask[word]) != 0u;
+	}
+	if (!changed)
+	{
+		return true;
+	}
+
+	Save(cell);
+	bool empty = true;
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		SubtractWeights(cell, word, domain[word] & ~mask[word]);
+		domain[word] &= mask[word];
+		empty &= domain[word] == 0u;
+	}
+	if (empty)
+	{
+		return false;
+	}
+
+	MarkChanged(cell);
+	if (!m_queued[cell])
+	{
+		m_queued[cell] = 1u;
+		m_queue.push_back(cell);
+	}
+	return !propagate || PropagateBitset();
+}
+
+bool WFCSolver::Propagate()
+{
+	return m_propagation == Propagation::SupportCount ? PropagateSupportCount() : PropagateBitset();
+}
+
+bool WFCSolver::Collapse(uint32_t cell, uint32_t tile)
+{
+	//The mask lives in the upper half of the scratch, Restrict only uses it to compute what is removed.
+	uint64_t* mask = &m_scratch[m_words];
+	std::fill(mask, mask + m_words, 0u);
+	mask[tile >> 6u] |= 1ull << (tile & 63u);
+	if (m_propagation == Propagation::SupportCount)
+	{
+		const uint64_t* domain = Domain(cell);
+		for (uint32_t word{ 0u }; word < m_words; ++word)
+		{
+			mask[word] = domain[word] & ~mask[word];
+		}
+		return Remove(cell, mask) && PropagateSupportCount();
+	}
+	return Restrict(cell, mask);
+}
+
+bool WFCSolver::Set(uint32_t cell, uint32_t tile)
+{
+	uint64_t* domain = &m_domains[cell * m_words];
+	const bool added = !Has(cell, tile);
+
+	if (m_propagation == Propagation::SupportCount)
+	{
+		//A tile that was not possible before adds to the support of the neighbors.
+		if (added)
+		{
+			for (uint32_t dir{ 0u }; dir < 6u; ++dir)
+			{
+				const int neighbor = Neighbor(cell, dir);
+				if (neighbor < 0)
+				{
+					continue;
+				}
+				const uint64_t* support = m_rules->Support(dir, tile);
+				const uint64_t* neighborDomain = Domain(neighbor);
+				for (uint32_t word{ 0u }; word < m_words; ++word)
+				{
+					for (uint64_t bits = support[word] & neighborDomain[word]; bits; bits &= bits - 1u)
+					{
+						++SupportCount(neighbor, dir, word * 64u + static_cast<uint32_t>(std::countr_zero(bits)));
+					}
+				}
+			}
+		}
+
+		//Every other tile is removed as usual.
+		uint64_t* removed = &m_scratch[m_words];
+		for (uint32_t word{ 0u }; word < m_words; ++word)
+		{
+			removed[word] = domain[word];
+		}
+		removed[tile >> 6u] &= ~(1ull << (tile & 63u));
+		domain[tile >> 6u] |= 1ull << (tile & 63u);
+		if (!Remove(cell, removed))
+		{
+			return false;
+		}
+		SetWeights(cell, tile);
+
+		//The tile did not have its support counted while it was impossible.
+		for (uint32_t dir{ 0u }; dir < 6u; ++dir)
+		{
+			SupportCount(cell, dir, tile) = CountSupport(cell, dir, tile);
+			if (SupportCount(cell, dir, tile) == 0u)
+			{
+				m_stale[cell * 6u + dir] = 1u;
+			}
+		}
+
+		//The neighbors are revised against the cell even when nothing was removed.
+		for (uint32_t dir{ 0u }; dir < 6u; ++dir)
+		{
+			const int neighbor = Neighbor(cell, dir);
+			if (neighbor >= 0 && !Revise(neighbor, dir))
+			{
+				return false;
+			}
+		}
+		return PropagateSupportCount();
+	}
+
+	Save(cell);
+	bool changed = added;
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		const uint64_t only = (word == (tile >> 6u)) ? (1ull << (tile & 63u)) : 0u;
+		changed |= domain[word] != only;
+		domain[word] = only;
+	}
+	SetWeights(cell, tile);
+	if (changed)
+	{
+		MarkChanged(cell);
+	}
+	if (!m_queued[cell])
+	{
+		m_queued[cell] = 1u;
+		m_queue.push_back(cell);
+	}
+	return PropagateBitset();
+}
+
+bool WFCSolver::Decide(uint32_t cell, uint32_t tile)
+{
+	assert(m_propagation == Propagation::Bitset);
+	m_decisions.push_back({ cell, tile, static_cast<uint32_t>(m_undo.size()) });
+	return Collapse(cell, tile);
+}
+
+bool WFCSolver::Backtrack()
+{
+	assert(!m_decisions.empty());
+	const Decision decision = m_decisions.back();
+	m_decisions.pop_back();
+
+	//The latest changes are put back first, so every cell ends up as it was before the decision.
+	for (size_t i = m_undo.size(); i-- > decision.undoSize;)
+	{
+		const Undo& undo = m_undo[i];
+		std::copy(m_undoDomains.begin() + i * m_words, m_undoDomains.begin() + (i + 1u) * m_words, m_domains.begin() + undo.cell * m_words);
+		m_sumWeights[undo.cell] = undo.sumWeights;
+		m_sumWeightLogWeights[undo.cell] = undo.sumWeightLogWeights;
+		m_savedAt[undo.cell] = undo.savedAt;
+		MarkChanged(undo.cell);
+	}
+	m_undo.resize(decision.undoSize);
+	m_undoDomains.resize(static_cast<size_t>(decision.undoSize) * m_words);
+
+	//The tile led to a contradiction, so the cell can not be it.
+	uint64_t* mask = &m_scratch[m_words];
+	std::copy(m_domains.begin() + decision.cell * m_words, m_domains.begin() + (decision.cell + 1u) * m_words, mask);
+	mask[decision.tile >> 6u] &= ~(1ull << (decision.tile & 63u));
+	return Restrict(decision.cell, mask);
+}
+
+void WFCSolver::SaveStart()
+{
+	m_startDomains = m_domains;
+	m_startSumWeights = m_sumWeights;
+	m_startSumWeightLogWeights = m_sumWeightLogWeights;
+	m_startSupportCounts = m_supportCounts;
+	m_startStale = m_stale;
+}
+
+void WFCSolver::Restart()
+{
+	m_domains = m_startDomains;
+	m_sumWeights = m_startSumWeights;
+	m_sumWeightLogWeights = m_startSumWeightLogWeights;
+	m_supportCounts = m_startSupportCounts;
+	m_stale = m_startStale;
+	m_queue.clear();
+	m_queued.assign(m_cellCount, 0u);
+	m_removals.clear();
+	ClearChanged();
+	ClearDecisions();
+}
+
+uint32_t WFCSolver::Count(uint32_t cell) const
+{
+	const uint64_t* domain = Domain(cell);
+	uint32_t count{ 0u };
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		count += static_cast<uint32_t>(std::popcount(domain[word]));
+	}
+	return count;
+}
+
+uint32_t WFCSolver::FirstTile(uint32_t cell) const
+{
+	const uint64_t* domain = Domain(cell);
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		if (domain[word])
+		{
+			return word * 64u + static_cast<uint32_t>(std::countr_zero(domain[word]));
+		}
+	}
+	return static_cast<uint32_t>(-1);
+}
+
+float WFCSolver::GetEntropy(uint32_t cell) const
+{
+	//Shannon entropy of the weights left in the cell, log(sum w) - sum(w * log w) / sum w.
+	const double sumWeights = m_sumWeights[cell];
+	if (sumWeights <= 0.0)
+	{
+		return 0.0f;
+	}
+	return static_cast<float>(std::max(0.0, std::log(sumWeights) - m_sumWeightLogWeights[cell] / sumWeights));
+}
+
+void WFCSolver::ClearChanged()
+{
+	for (uint32_t cell : m_changed)
+	{
+		m_isChanged[cell] = 0u;
+	}
+	m_changed.clear();
+}
+
+int WFCSolver::Neighbor(uint32_t cell, uint32_t dir) const
+{
+	const uint32_t layer = m_width * m_height;
+	const uint32_t remainder = cell % layer;
+	switch (dir)
+	{
+	case 0:
+		return cell >= layer ? static_cast<int>(cell - layer) : -1;
+	case 1:
+		return cell < layer * (m_depth - 1u) ? static_cast<int>(cell + layer) : -1;
+	case 2:
+		return cell % m_width != 0u ? static_cast<int>(cell - 1u) : -1;
+	case 3:
+		return cell % m_width != m_width - 1u ? static_cast<int>(cell + 1u) : -1;
+	case 4:
+		return remainder >= m_width ? static_cast<int>(cell - m_width) : -1;
+	case 5:
+		return remainder < m_width * (m_height - 1u) ? static_cast<int>(cell + m_width) : -1;
+	default:
+		return -1;
+	}
+}
+
+bool WFCSolver::PropagateBitset()
+{
+	uint64_t* allowed = m_scratch.data();
+	for (uint32_t head{ 0u }; head < m_queue.size(); ++head)
+	{
+		const uint32_t cell = m_queue[head];
+		m_queued[cell] = 0u;
+
+		for (uint32_t dir{ 0u }; dir < 6u; ++dir)
+		{
+			const int neighbor = Neighbor(cell, dir);
+			if (neighbor < 0)
+			{
+				continue;
+			}
+
+			//Everything the tiles left in the cell support in this direction.
+			std::fill(allowed, allowed + m_words, 0u);
+			ForEachTile(cell, [&](uint32_t tile)
+				{
+					const uint64_t* support = m_rules->Support(dir, tile);
+					for (uint32_t word{ 0u }; word < m_words; ++word)
+					{
+						allowed[word] |= support[word];
+					}
+				});
+
+			uint64_t* domain = &m_domains[neighbor * m_words];
+			bool changed = false;
+			for (uint32_t word{ 0u }; word < m_words; ++word)
+			{
+				changed |= (domain[word] & ~allowed[word]) != 0u;
+			}
+			if (!changed)
+			{
+				continue;
+			}
+
+			Save(neighbor);
+			bool empty = true;
+			for (uint32_t word{ 0u }; word < m_words; ++word)
+			{
+				SubtractWeights(neighbor, word, domain[word] & ~allowed[word]);
+				domain[word] &= allowed[word];
+				empty &= domain[word] == 0u;
+			}
+			if (empty)
+			{
+				for (uint32_t queued : m_queue)
+				{
+					m_queued[queued] = 0u;
+				}
+				m_queue.clear();
+				return false;
+			}
+			MarkChanged(neighbor);
+			if (!m_queued[neighbor])
+			{
+				m_queued[neighbor] = 1u;
+				m_queue.push_back(neighbor);
+			}
+		}
+	}
+	m_queue.clear();
+	return true;
+}
+
+bool WFCSolver::PropagateSupportCount()
+{
+	while (!m_removals.empty())
+	{
+		const auto [cell, tile] = m_removals.back();
+		m_removals.pop_back();
+
+		for (uint32_t dir{ 0u }; dir < 6u; ++dir)
+		{
+			const int neighbor = Neighbor(cell, dir);
+			if (neighbor < 0)
+			{
+				continue;
+			}
+
+			//The tile no longer supports the tiles of the neighbor, the ones left without support are removed.
+			const uint64_t* support = m_rules->Support(dir, tile);
+			uint64_t* domain = &m_domains[neighbor * m_words];
+			uint64_t* removed = &m_scratch[m_words];
+			bool any = false;
+			for (uint32_t word{ 0u }; word < m_words; ++word)
+			{
+				removed[word] = 0u;
+				for (uint64_t bits = support[word] & domain[word]; bits; bits &= bits - 1u)
+				{
+					const uint32_t supported = word * 64u + static_cast<uint32_t>(std::countr_zero(bits));
+					if (--SupportCount(neighbor, dir, supported) == 0u)
+					{
+						removed[word] |= bits & (~bits + 1u);
+						any = true;
+					}
+				}
+			}
+			if (any && !Remove(neighbor, removed))
+			{
+				m_removals.clear();
+				return false;
+			}
+
+			if (m_stale[neighbor * 6u + dir])
+			{
+				m_stale[neighbor * 6u + dir] = 0u;
+				if (!Revise(neighbor, dir))
+				{
+					m_removals.clear();
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool WFCSolver::Remove(uint32_t cell, const uint64_t* removed)
+{
+	uint64_t* domain = &m_domains[cell * m_words];
+	bool changed = false;
+	bool empty = true;
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		const uint64_t gone = domain[word] & removed[word];
+		for (uint64_t bits = gone; bits; bits &= bits - 1u)
+		{
+			m_removals.emplace_back(cell, word * 64u + static_cast<uint32_t>(std::countr_zero(bits)));
+		}
+		SubtractWeights(cell, word, gone);
+		changed |= gone != 0u;
+		domain[word] &= ~gone;
+		empty &= domain[word] == 0u;
+	}
+	if (changed)
+	{
+		MarkChanged(cell);
+	}
+	return !empty;
+}
+
+bool WFCSolver::Revise(uint32_t cell, uint32_t dir)
+{
+	const int neighbor = Neighbor(cell, dir ^ 1u);
+	if (neighbor < 0)
+	{
+		return true;
+	}
+
+	uint64_t* allowed = m_scratch.data();
+	std::fill(allowed, allowed + m_words, 0u);
+	ForEachTile(neighbor, [&](uint32_t tile)
+		{
+			const uint64_t* support = m_rules->Support(dir, tile);
+			for (uint32_t word{ 0u }; word < m_words; ++word)
+			{
+				allowed[word] |= support[word];
+			}
+		});
+
+	const uint64_t* domain = Domain(cell);
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		allowed[word] = domain[word] & ~allowed[word];
+	}
+	return Remove(cell, allowed);
+}
+
+uint16_t WFCSolver::CountSupport(uint32_t cell, uint32_t dir, uint32_t tile) const
+{
+	//Cells at the border have nothing to lose support from in that direction.
+	const int neighbor = Neighbor(cell, dir ^ 1u);
+	if (neighbor < 0)
+	{
+		return std::numeric_limits<uint16_t>::max();
+	}
+
+	const uint64_t* allowed = m_rules->Allowed(dir, tile);
+	const uint64_t* domain = Domain(neighbor);
+	uint32_t count{ 0u };
+	for (uint32_t word{ 0u }; word < m_words; ++word)
+	{
+		count += static_cast<uint32_t>(std::popcount(allowed[word] & domain[word]));
+	}
+	return static_cast<uint16_t>(count);
+}
+
+void WFCSolver::SubtractWeights(uint32_t cell, uint32_t word, uint64_t removed)
+{
+	for (; removed; removed &= removed - 1u)
+	{
+		const uint32_t tile = word * 64u + static_cast<uint32_t>(std::countr_zero(removed));
+		m_sumWeights[cell] -= m_rules->GetWeight(tile);
+		m_sumWeightLogWeights[cell] -= m_rules->GetWeightLogWeight(tile);
+	}
+}
+
+void WFCSolver::SetWeights(uint32_t cell, uint32_t tile)
+{
+	m_sumWeights[cell] = m_rules->GetWeight(tile);
+	m_sumWeightLogWeights[cell] = m_rules->GetWeightLogWeight(tile);
+}
+
+void WFCSolver::MarkChanged(uint32_t cell)
+{
+	if (!m_isChanged[cell])
+	{
+		m_isChanged[cell] = 1u;
+		m_changed.push_back(cell);
+	}
+}
+
+void WFCSolver::Save(uint32_t cell)
+{
+	const uint32_t decisions = static_cast<uint32_t>(m_decisions.size());
+	if (decisions == 0u || m_savedAt[cell] == decisions)
+	{
+		return;
+	}
+
+	m_undo.push_back({ cell, m_savedAt[cell], m_sumWeights[cell], m_sumWeightLogWeights[cell] });
+	m_undoDomains.insert(m_undoDomains.end(), m_domains.begin() + cell * m_words, m_domains.begin() + (cell + 1u) * m_words);
+	m_savedAt[cell] = decisions;
+}
+
+void WFCSolver::ClearDecisions()
+{
+	m_decisions.clear();
+	m_undo.clear();
+	m_undoDomains.clear();
+	m_savedAt.assign(m_cellCount, 0u);
+}
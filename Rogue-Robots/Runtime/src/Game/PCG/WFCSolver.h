@@ -0,0 +1,175 @@
+#pragma once
+#include "PCGHelper.h"
+
+//The adjacency rules read from the input, baked into one bitmask (one bit per tile id) per tile and direction.
+//dir is the direction from the neighbor that changed to the cell that shrinks, dir ^ 1 is the way back.
+class WFCRules
+{
+public:
+	void Build(std::unordered_map<unsigned int, Block>& blockPossibilities, uint32_t tileCount);
+
+	uint32_t GetTileCount() const { return m_tileCount; }
+	uint32_t GetWordCount() const { return m_wordCount; }
+
+	//The tiles a cell can keep while its neighbor in direction dir ^ 1 can still be tile.
+	const uint64_t* Support(uint32_t dir, uint32_t tile) const { return &m_support[(dir * m_tileCount + tile) * m_wordCount]; }
+
+	//The tiles that tile accepts as its neighbor in direction dir ^ 1 (Block::dirPossibilities as a mask).
+	const uint64_t* Allowed(uint32_t dir, uint32_t tile) const { return &m_allowed[(dir * m_tileCount + tile) * m_wordCount]; }
+
+	float GetWeight(uint32_t tile) const { return m_weights[tile]; }
+	float GetWeightLogWeight(uint32_t tile) const { return m_weightLogWeights[tile]; }
+
+private:
+	uint32_t m_tileCount = 0u;
+	uint32_t m_wordCount = 0u;
+	std::vector<uint64_t> m_support;
+	std::vector<uint64_t> m_allowed;
+	std::vector<float> m_weights;
+	std::vector<float> m_weightLogWeights;
+};
+
+//The domains of one room, every cell holds the tiles it can still become as a fixed width bitset.
+//Removing tiles propagates to the neighbors until nothing changes. A tile stays in a cell as long as some tile of the
+//neighbor allows it, checked a word at a time instead of tile by tile:
+//	Bitset: a changed cell ORs the support masks of its tiles together and ANDs that into each neighbor.
+//	SupportCount: AC-4, every (cell, direction, tile) counts the tiles that support it in the neighbor. Removing a tile
+//	only decrements the counts it contributed to instead of rebuilding the OR of a cell with many tiles.
+//Both end up with the same domains. Collapsing a cell removes most of its tiles at once, which the OR handles better
+//(see the WFC benchmark), the counts only pay off when large domains shrink a few tiles at a time.
+//Collapses made through Decide can be taken back. The first time a cell changes after a decision its domain is saved
+//in an undo log, Backtrack puts the saved domains back and rules out the tile that led to the contradiction.
+class WFCSolver
+{
+public:
+	enum class Propagation { Bitset, SupportCount };
+
+	//Sizes the solver for a room and gives every cell the tiles in initial. Nothing is propagated yet.
+	void Reset(const WFCRules& rules, uint32_t width, uint32_t height, uint32_t depth, const uint64_t* initial, Propagation propagation = Propagation::Bitset);
+
+	//Keeps only the tiles of mask in the cell and propagates. Returns false on a contradiction (a cell without tiles).
+	//Many restrictions at once are cheaper with propagate false and a single Propagate afterwards.
+	bool Restrict(uint32_t cell, const uint64_t* mask, bool propagate = true);
+	bool Propagate();
+
+	//Removes every other tile from the cell and propagates.
+	bool Collapse(uint32_t cell, uint32_t tile);
+
+	//Makes tile the only tile of the cell, also when the cell could not be tile, and propagates. Used for doors and spawns.
+	bool Set(uint32_t cell, uint32_t tile);
+
+	//Collapses the cell like Collapse, but the decision can be taken back by Backtrack. Bitset propagation only.
+	bool Decide(uint32_t cell, uint32_t tile);
+
+	//Undoes the latest decision and removes its tile from the cell, which is propagated as part of the decision before.
+	//Returns false if that contradicts as well, then the decision before has to be taken back too.
+	//Every cell that got its domain back is in GetChanged.
+	bool Backtrack();
+	uint32_t GetDecisionCount() const { return static_cast<uint32_t>(m_decisions.size()); }
+
+	//Remembers the current domains, Restart goes back to them and forgets every decision.
+	void SaveStart();
+	void Restart();
+
+	uint32_t Count(uint32_t cell) const;
+	bool Has(uint32_t cell, uint32_t tile) const { return (Domain(cell)[tile >> 6u] >> (tile & 63u)) & 1u; }
+	uint32_t FirstTile(uint32_t cell) const;
+	const uint64_t* Domain(uint32_t cell) const { return &m_domains[cell * m_words]; }
+	uint32_t GetCellCount() const { return m_cellCount; }
+
+	//The Shannon entropy of the cell, kept up to date from running sums of the weights left in it.
+	float GetEntropy(uint32_t cell) const;
+
+	template<typename Function>
+	void ForEachTile(uint32_t cell, Function&& function) const
+	{
+		const uint64_t* domain = Domain(cell);
+		for (uint32_t word{ 0u }; word < m_words; ++word)
+		{
+			for (uint64_t bits = domain[word]; bits; bits &= bits - 1u)
+			{
+				function(word * 64u + static_cast<uint32_t>(std::countr_zero(bits)));
+			}
+		}
+	}
+
+	//The cells whose domain shrank since the last ClearChanged, each one once.
+	const std::vector<uint32_t>& GetChanged() const { return m_changed; }
+	void ClearChanged();
+
+private:
+	//The cell next to cell in direction dir, or -1 at the border of the room.
+	int Neighbor(uint32_t cell, uint32_t dir) const;
+
+	bool PropagateBitset();
+	bool PropagateSupportCount();
+	//Removes tiles from a cell during propagation, false if the cell ran out of tiles.
+	bool Remove(uint32_t cell, const uint64_t* removed);
+	//Revises cell against all the tiles of the neighbor it has in direction dir ^ 1.
+	bool Revise(uint32_t cell, uint32_t dir);
+	//Counts the support tile has in cell from the neighbor in direction dir ^ 1.
+	uint16_t CountSupport(uint32_t cell, uint32_t dir, uint32_t tile) const;
+	void MarkChanged(uint32_t cell);
+	//Puts the domain of the cell in the undo log, if it has not been saved since the latest decision.
+	void Save(uint32_t cell);
+	void ClearDecisions();
+	//Takes the removed tiles of one word of the domain out of the entropy sums.
+	void SubtractWeights(uint32_t cell, uint32_t word, uint64_t removed);
+	void SetWeights(uint32_t cell, uint32_t tile);
+
+	uint16_t& SupportCount(uint32_t cell, uint32_t dir, uint32_t tile) { return m_supportCounts[(cell * 6u + dir) * m_tiles + tile]; }
+
+private:
+	const WFCRules* m_rules = nullptr;
+	Propagation m_propagation = Propagation::Bitset;
+	uint32_t m_width = 0u;
+	uint32_t m_height = 0u;
+	uint32_t m_depth = 0u;
+	uint32_t m_cellCount = 0u;
+	uint32_t m_tiles = 0u;
+	uint32_t m_words = 0u;
+
+	std::vector<uint64_t> m_domains;
+	std::vector<uint64_t> m_startDomains;
+	std::vector<uint64_t> m_scratch;
+
+	//Per cell, the sum of the weights and of weight * log(weight) of the tiles left.
+	std::vector<double> m_sumWeights;
+	std::vector<double> m_sumWeightLogWeights;
+	std::vector<double> m_startSumWeights;
+	std::vector<double> m_startSumWeightLogWeights;
+
+	//Bitset: cells whose neighbors have to be revised.
+	std::vector<uint32_t> m_queue;
+	std::vector<uint8_t> m_queued;
+
+	//SupportCount: per cell, direction and tile. Removed (cell, tile) pairs wait in m_removals.
+	//A direction is stale when the cell may hold tiles without any support from it (after Reset and Set),
+	//the next change of that neighbor revises the whole cell instead of relying on the counts.
+	std::vector<uint16_t> m_supportCounts;
+	std::vector<uint16_t> m_startSupportCounts;
+	std::vector<uint8_t> m_stale;
+	std::vector<uint8_t> m_startStale;
+	std::vector<std::pair<uint32_t, uint32_t>> m_removals;
+
+	std::vector<uint32_t> m_changed;
+	std::vector<uint8_t> m_isChanged;
+
+	struct Decision
+	{
+		uint32_t cell = 0u;
+		uint32_t tile = 0u;
+		uint32_t undoSize = 0u; //Where the changes made after the decision start in the undo log.
+	};
+	struct Undo
+	{
+		uint32_t cell = 0u;
+		uint32_t savedAt = 0u; //The savedAt the cell had before.
+		double sumWeights = 0.0;
+		double sumWeightLogWeights = 0.0;
+	};
+	std::vector<Decision> m_decisions;
+	std::vector<Undo> m_undo;
+	std::vector<uint64_t> m_undoDomains; //m_words per entry in m_undo.
+	std::vector<uint32_t> m_savedAt; //Per cell, the number of decisions when it was last saved, 0 if never.
+};
@@ -6,6 +6,7 @@ class LerpAnimationSystem : public DOG::ISystem
 	using Vector3 = DirectX::SimpleMath::Vector3;
 public:
 	SYSTEM_CLASS(DOG::LerpAnimateComponent, DOG::TransformComponent);
+	SYSTEM_ACCESS(DOG::Writes<DOG::LerpAnimateComponent, DOG::TransformComponent>);
 	ON_UPDATE_ID(DOG::LerpAnimateComponent, DOG::TransformComponent);
 	void OnUpdate(DOG::entity entityID, DOG::LerpAnimateComponent& animator, DOG::TransformComponent& transform)
 	{
@@ -16,10 +17,7 @@ public:
 			f64 t01 = std::clamp(animator.t, 0.0, 1.0);
 			Vector3 pos = Vector3::Lerp(animator.origin, animator.target, static_cast<float>(t01));
 			transform.SetPosition(pos);
-			if (DOG::EntityManager::Get().HasComponent<DOG::DirtyComponent>(entityID))
-				DOG::EntityManager::Get().GetComponent<DOG::DirtyComponent>(entityID).dirtyBitSet[DOG::DirtyComponent::positionChanged] = true;
-			else
-				DOG::EntityManager::Get().AddComponent<DOG::DirtyComponent>(entityID).dirtyBitSet[DOG::DirtyComponent::positionChanged] = true;
+			DOG::EntityManager::Get().MarkChanged<DOG::TransformComponent>(entityID);
 			if (animator.t < t01)
 			{
 				animator.scale = abs(animator.scale);
@@ -35,7 +33,7 @@ public:
 		}
 		if (animator.loops == 0)
 		{
-			DOG::EntityManager::Get().RemoveComponent<DOG::LerpAnimateComponent>(entityID);
+			DOG::EntityManager::Get().GetCommandBuffer().RemoveComponent<DOG::LerpAnimateComponent>(entityID);
 		}
 	}
 };
@@ -47,6 +45,7 @@ class PickupLerpAnimationSystem : public DOG::ISystem
 	#define DISTANCE_THRESHOLD 0.60f
 public:
 	SYSTEM_CLASS(DOG::PickupLerpAnimateComponent, DOG::TransformComponent);
+	SYSTEM_ACCESS(DOG::Writes<DOG::PickupLerpAnimateComponent, DOG::TransformComponent>);
 	ON_UPDATE(DOG::PickupLerpAnimateComponent, DOG::TransformComponent);
 	void OnUpdate(DOG::PickupLerpAnimateComponent& animator, DOG::TransformComponent& transform)
 	{
@@ -137,6 +136,7 @@ class LerpColorSystem : public DOG::ISystem
 	using Vector4 = DirectX::SimpleMath::Vector4;
 public:
 	SYSTEM_CLASS(DOG::LerpColorComponent, DOG::SubmeshRenderer);
+	SYSTEM_ACCESS(DOG::Writes<DOG::LerpColorComponent, DOG::SubmeshRenderer>);
 	ON_UPDATE_ID(DOG::LerpColorComponent, DOG::SubmeshRenderer);
 	void OnUpdate(DOG::entity entityID, DOG::LerpColorComponent& animator, DOG::SubmeshRenderer& mat)
 	{
@@ -163,7 +163,7 @@ public:
 		}
 		if (animator.loops == 0)
 		{
-			DOG::EntityManager::Get().RemoveComponent<DOG::LerpColorComponent>(entityID);
+			DOG::EntityManager::Get().GetCommandBuffer().RemoveComponent<DOG::LerpColorComponent>(entityID);
 		}
 	}
 };
\ No newline at end of file
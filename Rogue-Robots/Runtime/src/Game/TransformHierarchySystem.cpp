@@ -0,0 +1,210 @@
+#include "TransformHierarchySystem.h"
+
+using namespace DOG;
+using namespace DirectX::SimpleMath;
+
+void TransformHierarchy::Update() noexcept
+{
+	Gather();
+	const bool rebuilt = StructureChanged();
+	if (rebuilt)
+		Rebuild();
+	Propagate(rebuilt);
+}
+
+void TransformHierarchy::Gather() noexcept
+{
+	auto& em = EntityManager::Get();
+	m_gathered.clear();
+
+	em.CachedQuery<Include<ChildComponent, TransformComponent>>().Do([&](entity e, ChildComponent& child, TransformComponent& world)
+		{
+			if (!em.Exists(child.parent) || em.HasComponent<DeferredDeletionComponent>(child.parent))
+				em.DeferredEntityDestruction(e);
+			// An entity that is also a bone attachment follows the bone, like when the bone systems ran last and overwrote it
+			else if (!em.HasComponent<ChildToBoneComponent>(e))
+				m_gathered.push_back({ e, child.parent, child.localTransform.worldMatrix, &world, false });
+		});
+
+	// Bone attachments follow a joint of the parent's rig, guns the right hand and the flashlight the head
+	em.CachedQuery<Include<ChildToBoneComponent, TransformComponent>, Optional<ModelComponent>>().Do(
+		[&](entity e, ChildToBoneComponent& child, TransformComponent& world, ModelComponent* model)
+		{
+			if (!em.Exists(child.boneParent))
+			{
+				em.DeferredEntityDestruction(e);
+				return;
+			}
+
+			const Matrix& joint = model ?
+				em.GetComponent<MixamoRightHandJointTF>(child.boneParent).transform :
+				em.GetComponent<MixamoHeadJointTF>(child.boneParent).transform;
+			m_gathered.push_back({ e, child.boneParent, child.localTransform.worldMatrix * joint, &world, true });
+		});
+}
+
+bool TransformHierarchy::StructureChanged() const noexcept
+{
+	// Gather adds every entity at most once, so its size is the number of unique entities
+	if (m_gathered.size() != m_entities.size())
+		return true;
+
+	for (const auto& node : m_gathered)
+	{
+		const u32 index = EntityIndex(node.entity);
+		if (index >= m_slots.size() || m_slots[index] == NO_NODE)
+			return true;
+
+		const u32 slot = m_slots[index];
+		if (m_entities[slot] != node.entity || m_parentEntities[slot] != node.parent || m_boneOffsets[slot] != (u8)node.boneOffset)
+			return true;
+	}
+	return false;
+}
+
+void TransformHierarchy::Rebuild() noexcept
+{
+	constexpr u32 IN_PROGRESS = NO_NODE - 1u;
+	const u32 gatheredCount = (u32)m_gathered.size();
+
+	for (entity e : m_entities)
+		m_slots[EntityIndex(e)] = NO_NODE;
+
+	// While rebuilding, the slots point into m_gathered. Gather adds every entity once.
+	for (u32 i = 0; i < gatheredCount; ++i)
+	{
+		const u32 index = EntityIndex(m_gathered[i].entity);
+		if (index >= m_slots.size())
+			m_slots.resize(std::max<size_t>(index + 1u, m_slots.size() * 2u), NO_NODE);
+		m_slots[index] = i;
+	}
+
+	const auto findNode = [&](entity e)
+	{
+		const u32 index = EntityIndex(e);
+		if (index >= m_slots.size() || m_slots[index] == NO_NODE || m_gathered[m_slots[index]].entity != e)
+			return NO_NODE;
+		return m_slots[index];
+	};
+
+	// Depth of every node, walking up each chain once. A cycle is cut by treating the parent that closes it as a root.
+	std::vector<u32> depths(gatheredCount, NO_NODE);
+	std::vector<u32> parentNodes(gatheredCount, NO_NODE);
+	std::vector<u32> chain;
+	u32 maxDepth = 0u;
+	for (u32 i = 0; i < gatheredCount; ++i)
+	{
+		chain.clear();
+		u32 current = i;
+		while (depths[current] == NO_NODE)
+		{
+			depths[current] = IN_PROGRESS;
+			chain.push_back(current);
+
+			const u32 parent = findNode(m_gathered[current].parent);
+			if (parent == NO_NODE || depths[parent] == IN_PROGRESS)
+				break;
+			parentNodes[current] = parent;
+			current = parent;
+		}
+
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+		{
+			depths[*it] = parentNodes[*it] == NO_NODE ? 0u : depths[parentNodes[*it]] + 1u;
+			maxDepth = std::max(maxDepth, depths[*it]);
+		}
+	}
+
+	// Counting sort by depth, parents always end up before their children
+	std::vector<u32> depthStart(maxDepth + 2u, 0u);
+	for (u32 i = 0; i < gatheredCount; ++i)
+		depthStart[depths[i] + 1u]++;
+	for (u32 depth = 1; depth < depthStart.size(); ++depth)
+		depthStart[depth] += depthStart[depth - 1u];
+
+	const u32 nodeCount = gatheredCount;
+	std::vector<u32> order(nodeCount);
+	for (u32 i = 0; i < gatheredCount; ++i)
+		order[depthStart[depths[i]]++] = i;
+
+	m_entities.resize(nodeCount);
+	m_parentEntities.resize(nodeCount);
+	m_parents.resize(nodeCount);
+	m_locals.resize(nodeCount);
+	m_worlds.resize(nodeCount);
+	m_transforms.resize(nodeCount);
+	m_boneOffsets.resize(nodeCount);
+	m_dirty.resize(nodeCount);
+	m_roots.clear();
+
+	std::unordered_map<entity, u32> rootIndices;
+	std::vector<u32> nodeIndices(gatheredCount, NO_NODE);
+	for (u32 node = 0; node < nodeCount; ++node)
+	{
+		const GatheredNode& gathered = m_gathered[order[node]];
+		nodeIndices[order[node]] = node;
+
+		m_entities[node] = gathered.entity;
+		m_parentEntities[node] = gathered.parent;
+		m_boneOffsets[node] = (u8)gathered.boneOffset;
+
+		if (parentNodes[order[node]] != NO_NODE)
+		{
+			m_parents[node] = nodeIndices[parentNodes[order[node]]];
+		}
+		else
+		{
+			auto [it, inserted] = rootIndices.try_emplace(gathered.parent, (u32)m_roots.size());
+			if (inserted)
+				m_roots.push_back(gathered.parent);
+			m_parents[node] = ROOT_BIT | it->second;
+		}
+	}
+	m_rootWorlds.resize(m_roots.size());
+	m_rootDirty.resize(m_roots.size());
+
+	for (u32 i = 0; i < gatheredCount; ++i)
+		m_slots[EntityIndex(m_gathered[i].entity)] = nodeIndices[i];
+}
+
+void TransformHierarchy::Propagate(bool rebuilt) noexcept
+{
+	auto& em = EntityManager::Get();
+
+	for (u32 root = 0; root < m_roots.size(); ++root)
+	{
+		const Matrix& world = em.GetComponent<TransformComponent>(m_roots[root]).worldMatrix;
+		m_rootDirty[root] = rebuilt || world != m_rootWorlds[root];
+		m_rootWorlds[root] = world;
+	}
+
+	// Scatter this frame's local matrices into depth order
+	for (const auto& node : m_gathered)
+	{
+		const u32 slot = m_slots[EntityIndex(node.entity)];
+		m_dirty[slot] = rebuilt || node.local != m_locals[slot];
+		m_locals[slot] = node.local;
+		m_transforms[slot] = node.transform;
+	}
+
+	m_recomputed = 0u;
+	for (u32 node = 0; node < m_entities.size(); ++node)
+	{
+		const u32 parent = m_parents[node];
+		const bool parentIsRoot = parent & ROOT_BIT;
+		if (parentIsRoot ? m_rootDirty[parent & ~ROOT_BIT] : m_dirty[parent])
+			m_dirty[node] = true;
+
+		if (m_dirty[node])
+		{
+			m_worlds[node] = m_locals[node] * (parentIsRoot ? m_rootWorlds[parent & ~ROOT_BIT] : m_worlds[parent]);
+			if (m_boneOffsets[node])
+				m_worlds[node]._42 -= 0.5f; // Account for capsule offset
+			em.MarkChanged<TransformComponent>(m_entities[node]);
+			m_recomputed++;
+		}
+
+		// Always written back, anything else touching a child's world matrix is overridden like before
+		m_transforms[node]->worldMatrix = m_worlds[node];
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <DOGEngine.h>
+#include "GameComponent.h"
+
+// Resolves ChildComponent and ChildToBoneComponent world matrices. Nodes are kept in parent-before-child (depth) order
+// in flat arrays, so one linear pass propagates local -> world for whole chains like player -> weapon -> light.
+// A node is only recomputed when its local matrix, its root parent's world matrix or one of its ancestors changed.
+class TransformHierarchy
+{
+	using Matrix = DirectX::SimpleMath::Matrix;
+public:
+	void Update() noexcept;
+
+	[[nodiscard]] u32 GetNodeCount() const noexcept { return (u32)m_entities.size(); }
+	[[nodiscard]] u32 GetRecomputedCount() const noexcept { return m_recomputed; }
+
+private:
+	struct GatheredNode
+	{
+		DOG::entity entity;
+		DOG::entity parent;
+		Matrix local;
+		DOG::TransformComponent* transform;
+		bool boneOffset;
+	};
+
+	static constexpr u32 NO_NODE = UINT32_MAX;
+	static constexpr u32 ROOT_BIT = 0x8000'0000u;
+
+	void Gather() noexcept;
+	[[nodiscard]] bool StructureChanged() const noexcept;
+	void Rebuild() noexcept;
+	void Propagate(bool rebuilt) noexcept;
+
+	// Gathered this frame in query order, the pointers are only valid during Update
+	std::vector<GatheredNode> m_gathered;
+
+	// Nodes in depth order
+	std::vector<DOG::entity> m_entities;
+	std::vector<DOG::entity> m_parentEntities;
+	std::vector<u32> m_parents; //Node index of the parent, or ROOT_BIT | index into m_roots
+	std::vector<Matrix> m_locals;
+	std::vector<Matrix> m_worlds;
+	std::vector<DOG::TransformComponent*> m_transforms;
+	std::vector<u8> m_boneOffsets;
+	std::vector<u8> m_dirty;
+
+	// Parents that are not nodes themselves
+	std::vector<DOG::entity> m_roots;
+	std::vector<Matrix> m_rootWorlds;
+	std::vector<u8> m_rootDirty;
+
+	std::vector<u32> m_slots; //Node index per entity slot
+	u32 m_recomputed = 0;
+};
+
+class TransformHierarchySystem : public DOG::ISystem
+{
+public:
+	SYSTEM_CLASS(ChildComponent, DOG::TransformComponent);
+	void Update() noexcept override final { m_hierarchy.Update(); }
+
+private:
+	TransformHierarchy m_hierarchy;
+};
@@ -41,7 +41,8 @@ void TurretTargetingSystem::OnUpdate(TurretTargetingComponent& targeter, ChildCo
 				{
 					if (SimpleMath::Vector3::DistanceSquared(turretPosW, hit->hitPosition) < d2)
 					{
-						if (!em.HasComponent<AgentAggroComponent>(hit->entityHit)) return;
+						auto aggro = em.TryGetComponent<AgentAggroComponent>(hit->entityHit);
+						if (!aggro || !aggro->get().active) return;
 					}
 				}
 
@@ -53,11 +54,14 @@ void TurretTargetingSystem::OnUpdate(TurretTargetingComponent& targeter, ChildCo
 	};
 
 
-	// Finds closest agent
-	em.Collect<AgentAggroComponent, TransformComponent>().Do([&](entity agent, AgentAggroComponent&, TransformComponent& agentTransform)
-		{
-			findBetterTarget(agent, agentTransform.GetPosition());
-		});
+	// Finds closest aggro agent, only the ones within range are looked at
+	m_inRange.clear();
+	SpatialIndex::QueryRadius<AgentAggroComponent>(turretPosW, targeter.maxRange, m_inRange);
+	for (entity agent : m_inRange)
+	{
+		if (em.GetComponent<AgentAggroComponent>(agent).active)
+			findBetterTarget(agent, em.GetComponent<TransformComponent>(agent).GetPosition());
+	}
 
 	// Turn turret against the target 
 	if (targeter.trackedTarget != NULL_ENTITY)
@@ -130,7 +134,8 @@ void TurretProjectileSystem::OnUpdate(DOG::entity e, TurretProjectileComponent&
 	}
 	else
 	{
-		EntityManager::Get().DeferredEntityDestruction(e);
+		//Runs next to other systems, the deletion flag is added at the next sync point
+		EntityManager::Get().GetCommandBuffer().AddComponent<DeferredDeletionComponent>(e);
 	}
 }
 
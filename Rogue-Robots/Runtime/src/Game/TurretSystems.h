@@ -11,6 +11,7 @@ public:
 	ON_UPDATE(TurretTargetingComponent, ChildComponent, DOG::TransformComponent);
 	void OnUpdate(TurretTargetingComponent& targeter, ChildComponent& localTransform, DOG::TransformComponent& globalTransform);
 private:
+	std::vector<DOG::entity> m_inRange;
 };
 
 class TurretShootingSystem : public DOG::ISystem
@@ -28,6 +29,7 @@ class TurretProjectileSystem : public DOG::ISystem
 {
 public:
 	SYSTEM_CLASS(TurretProjectileComponent, DOG::PointLightComponent);
+	SYSTEM_ACCESS(DOG::Writes<TurretProjectileComponent, DOG::PointLightComponent>);
 	ON_UPDATE_ID(TurretProjectileComponent, DOG::PointLightComponent);
 	void OnUpdate(DOG::entity e, TurretProjectileComponent& projectile, DOG::PointLightComponent& pointLight);
 private:
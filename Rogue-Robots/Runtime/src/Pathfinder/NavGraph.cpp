@@ -0,0 +1,656 @@
+#include "NavGraph.h"
+#include "PathfinderComponents.h"
+#include <limits>
+#include <numeric>
+
+using namespace DOG;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+	constexpr u32 NOT_IN_HEAP = UINT32_MAX;
+	constexpr u32 CLOSED = UINT32_MAX - 1;
+
+	// Maps entity slots to dense indices, the stored entity catches stale handles
+	u32 DenseIndex(const std::vector<u32>& indices, const std::vector<entity>& entities, entity e)
+	{
+		const u32 slot = EntityIndex(e);
+		if (slot < indices.size() && indices[slot] != NavGraph::NO_NODE && entities[indices[slot]] == e)
+			return indices[slot];
+		return NavGraph::NO_NODE;
+	}
+}
+
+// Search state, one set per thread so queries can run concurrently on a shared graph.
+// A node's entries are only valid if its stamp matches the current search, so nothing is cleared between queries.
+struct NavGraph::SearchScratch
+{
+	std::vector<float> g;
+	std::vector<float> f;
+	std::vector<u32> parent;
+	std::vector<u32> stamp;
+	std::vector<u32> heapPos;
+	std::vector<u32> heap;
+	u32 search = 0;
+
+	void Begin(u32 nodeCount)
+	{
+		if (stamp.size() < nodeCount)
+		{
+			g.resize(nodeCount);
+			f.resize(nodeCount);
+			parent.resize(nodeCount);
+			stamp.resize(nodeCount, 0);
+			heapPos.resize(nodeCount);
+		}
+		if (++search == 0)
+		{
+			std::fill(stamp.begin(), stamp.end(), 0);
+			search = 1;
+		}
+		heap.clear();
+	}
+
+	void Touch(u32 node)
+	{
+		if (stamp[node] != search)
+		{
+			stamp[node] = search;
+			g[node] = std::numeric_limits<float>::infinity();
+			parent[node] = NavGraph::NO_NODE;
+			heapPos[node] = NOT_IN_HEAP;
+		}
+	}
+
+	// Indexed binary min-heap on f, heapPos lets a node move up in place when its score decreases
+	void SiftUp(u32 i)
+	{
+		const u32 node = heap[i];
+		while (i > 0)
+		{
+			const u32 p = (i - 1) / 2;
+			if (f[heap[p]] <= f[node])
+				break;
+			heap[i] = heap[p];
+			heapPos[heap[i]] = i;
+			i = p;
+		}
+		heap[i] = node;
+		heapPos[node] = i;
+	}
+
+	void SiftDown(u32 i)
+	{
+		const u32 node = heap[i];
+		const u32 size = static_cast<u32>(heap.size());
+		while (true)
+		{
+			u32 child = i * 2 + 1;
+			if (child >= size)
+				break;
+			if (child + 1 < size && f[heap[child + 1]] < f[heap[child]])
+				++child;
+			if (f[node] <= f[heap[child]])
+				break;
+			heap[i] = heap[child];
+			heapPos[heap[i]] = i;
+			i = child;
+		}
+		heap[i] = node;
+		heapPos[node] = i;
+	}
+
+	void PushOrDecrease(u32 node)
+	{
+		if (heapPos[node] == NOT_IN_HEAP)
+		{
+			heap.push_back(node);
+			SiftUp(static_cast<u32>(heap.size() - 1));
+		}
+		else
+			SiftUp(heapPos[node]);
+	}
+
+	u32 Pop()
+	{
+		const u32 top = heap[0];
+		heapPos[top] = CLOSED;
+		const u32 last = heap.back();
+		heap.pop_back();
+		if (!heap.empty())
+		{
+			heap[0] = last;
+			SiftDown(0);
+		}
+		return top;
+	}
+};
+
+thread_local NavGraph::SearchScratch NavGraph::s_scratch;
+thread_local NavGraph::SearchScratch NavGraph::s_startScratch;
+thread_local NavGraph::SearchScratch NavGraph::s_goalScratch;
+
+void NavGraph::Build(float clusterSize)
+{
+	EntityManager& em = EntityManager::Get();
+
+	m_portals.clear();
+	m_positions.clear();
+	m_nodeMeshes.clear();
+	m_edgeOffsets.clear();
+	m_edgeTargets.clear();
+	m_edgeCosts.clear();
+	m_edgeMeshes.clear();
+	m_meshPortalOffsets.clear();
+	m_meshPortals.clear();
+	m_meshIndices.clear();
+	m_portalIndices.clear();
+
+	// Dense NavMesh indices
+	std::vector<NavMeshID> meshes;
+	em.Collect<NavMeshComponent>().Do([&](entity e, NavMeshComponent&)
+		{
+			if (EntityIndex(e) >= m_meshIndices.size())
+				m_meshIndices.resize(EntityIndex(e) + 1, NO_NODE);
+			m_meshIndices[EntityIndex(e)] = static_cast<u32>(meshes.size());
+			meshes.push_back(e);
+		});
+
+	// Dense portal indices
+	em.Collect<PortalComponent>().Do([&](entity e, PortalComponent& portal)
+		{
+			const u32 mesh1 = DenseIndex(m_meshIndices, meshes, portal.navMesh1);
+			const u32 mesh2 = DenseIndex(m_meshIndices, meshes, portal.navMesh2);
+			if (mesh1 == NO_NODE || mesh2 == NO_NODE)
+				return;
+
+			if (EntityIndex(e) >= m_portalIndices.size())
+				m_portalIndices.resize(EntityIndex(e) + 1, NO_NODE);
+			m_portalIndices[EntityIndex(e)] = static_cast<u32>(m_portals.size());
+			m_portals.push_back(e);
+			m_positions.push_back(portal.portal);
+			m_nodeMeshes.push_back(mesh1);
+			m_nodeMeshes.push_back(mesh2);
+		});
+	m_meshes = std::move(meshes);
+
+	// Portals per mesh
+	const u32 nodeCount = NodeCount();
+	m_meshPortalOffsets.assign(m_meshes.size() + 1, 0);
+	for (u32 node = 0; node < nodeCount; ++node)
+	{
+		m_meshPortalOffsets[m_nodeMeshes[node * 2] + 1]++;
+		if (m_nodeMeshes[node * 2 + 1] != m_nodeMeshes[node * 2])
+			m_meshPortalOffsets[m_nodeMeshes[node * 2 + 1] + 1]++;
+	}
+	for (size_t mesh = 1; mesh < m_meshPortalOffsets.size(); ++mesh)
+		m_meshPortalOffsets[mesh] += m_meshPortalOffsets[mesh - 1];
+
+	m_meshPortals.resize(m_meshPortalOffsets.back());
+	std::vector<u32> fill(m_meshPortalOffsets.begin(), m_meshPortalOffsets.end() - 1);
+	for (u32 node = 0; node < nodeCount; ++node)
+	{
+		m_meshPortals[fill[m_nodeMeshes[node * 2]]++] = node;
+		if (m_nodeMeshes[node * 2 + 1] != m_nodeMeshes[node * 2])
+			m_meshPortals[fill[m_nodeMeshes[node * 2 + 1]]++] = node;
+	}
+
+	// Edges: every other portal of the two meshes a portal connects
+	m_edgeOffsets.reserve(nodeCount + 1);
+	m_edgeOffsets.push_back(0);
+	for (u32 node = 0; node < nodeCount; ++node)
+	{
+		for (u32 side = 0; side < 2; ++side)
+		{
+			const u32 mesh = m_nodeMeshes[node * 2 + side];
+			if (side == 1 && mesh == m_nodeMeshes[node * 2])
+				break;
+			for (u32 i = m_meshPortalOffsets[mesh]; i < m_meshPortalOffsets[mesh + 1]; ++i)
+			{
+				const u32 neighbor = m_meshPortals[i];
+				if (neighbor == node)
+					continue;
+				m_edgeTargets.push_back(neighbor);
+				m_edgeCosts.push_back(Vector3::Distance(m_positions[node], m_positions[neighbor]));
+				m_edgeMeshes.push_back(mesh);
+			}
+		}
+		m_edgeOffsets.push_back(static_cast<u32>(m_edgeTargets.size()));
+	}
+
+	BuildClusters(clusterSize);
+}
+
+void NavGraph::BuildClusters(float clusterSize)
+{
+	const u32 nodeCount = NodeCount();
+
+	// A mesh is placed by the average of its portals, the cluster is the grid cell that point falls in
+	std::vector<Vector3> centers(m_meshes.size(), Vector3::Zero);
+	for (u32 mesh = 0; mesh < m_meshes.size(); ++mesh)
+	{
+		for (u32 i = m_meshPortalOffsets[mesh]; i < m_meshPortalOffsets[mesh + 1]; ++i)
+			centers[mesh] += m_positions[m_meshPortals[i]];
+		if (m_meshPortalOffsets[mesh + 1] > m_meshPortalOffsets[mesh])
+			centers[mesh] /= static_cast<float>(m_meshPortalOffsets[mesh + 1] - m_meshPortalOffsets[mesh]);
+	}
+
+	std::unordered_map<u64, u32> cells;
+	m_meshClusters.resize(m_meshes.size());
+	for (u32 mesh = 0; mesh < m_meshes.size(); ++mesh)
+	{
+		const u64 x = static_cast<u64>(static_cast<u32>(std::floor(centers[mesh].x / clusterSize)) & 0x1F'FFFF);
+		const u64 y = static_cast<u64>(static_cast<u32>(std::floor(centers[mesh].y / clusterSize)) & 0x1F'FFFF);
+		const u64 z = static_cast<u64>(static_cast<u32>(std::floor(centers[mesh].z / clusterSize)) & 0x1F'FFFF);
+		m_meshClusters[mesh] = cells.try_emplace(x | (y << 21) | (z << 42), static_cast<u32>(cells.size())).first->second;
+	}
+	m_clusterCount = static_cast<u32>(cells.size());
+
+	// Portals crossing between the same two clusters form runs along the border where their meshes touch on both sides.
+	// Every run gets one entrance, the portal closest to its middle, so a cluster has a handful of entrances instead of
+	// one per crossing portal. Paths between clusters are forced through the entrances, which makes them slightly longer.
+	std::unordered_map<u64, std::vector<u32>> borders;
+	for (u32 node = 0; node < nodeCount; ++node)
+	{
+		const u32 cluster1 = m_meshClusters[m_nodeMeshes[node * 2]];
+		const u32 cluster2 = m_meshClusters[m_nodeMeshes[node * 2 + 1]];
+		if (cluster1 != cluster2)
+			borders[(static_cast<u64>(std::min(cluster1, cluster2)) << 32) | std::max(cluster1, cluster2)].push_back(node);
+	}
+
+	const auto meshesTouch = [&](u32 mesh1, u32 mesh2)
+	{
+		if (mesh1 == mesh2)
+			return true;
+		for (u32 i = m_meshPortalOffsets[mesh1]; i < m_meshPortalOffsets[mesh1 + 1]; ++i)
+		{
+			const u32 node = m_meshPortals[i];
+			if (m_nodeMeshes[node * 2] == mesh2 || m_nodeMeshes[node * 2 + 1] == mesh2)
+				return true;
+		}
+		return false;
+	};
+
+	std::vector<std::vector<u32>> clusterEntrances(m_clusterCount);
+	std::vector<u32> runs;
+	for (auto& [key, border] : borders)
+	{
+		// Union-find over the crossing portals of this border, meshes are sorted by cluster so side 0 is the same cluster for all of them
+		const u32 low = static_cast<u32>(key >> 32);
+		const auto side = [&](u32 node, u32 s) { return m_nodeMeshes[node * 2 + ((m_meshClusters[m_nodeMeshes[node * 2]] == low) ? s : 1 - s)]; };
+		runs.resize(border.size());
+		std::iota(runs.begin(), runs.end(), 0u);
+		const auto find = [&](u32 i) { while (runs[i] != i) i = runs[i] = runs[runs[i]]; return i; };
+		for (u32 i = 0; i < border.size(); ++i)
+		{
+			for (u32 j = i + 1; j < border.size(); ++j)
+			{
+				if (meshesTouch(side(border[i], 0), side(border[j], 0)) && meshesTouch(side(border[i], 1), side(border[j], 1)))
+					runs[find(i)] = find(j);
+			}
+		}
+
+		for (u32 i = 0; i < border.size(); ++i)
+		{
+			if (find(i) != i)
+				continue;
+
+			Vector3 middle = Vector3::Zero;
+			u32 count = 0;
+			for (u32 j = 0; j < border.size(); ++j)
+			{
+				if (find(j) == i)
+				{
+					middle += m_positions[border[j]];
+					count++;
+				}
+			}
+			middle /= static_cast<float>(count);
+
+			u32 entrance = NO_NODE;
+			float closest = std::numeric_limits<float>::infinity();
+			for (u32 j = 0; j < border.size(); ++j)
+			{
+				if (find(j) == i && Vector3::DistanceSquared(m_positions[border[j]], middle) < closest)
+				{
+					closest = Vector3::DistanceSquared(m_positions[border[j]], middle);
+					entrance = border[j];
+				}
+			}
+			clusterEntrances[m_meshClusters[m_nodeMeshes[entrance * 2]]].push_back(entrance);
+			clusterEntrances[m_meshClusters[m_nodeMeshes[entrance * 2 + 1]]].push_back(entrance);
+		}
+	}
+
+	m_clusterEntranceOffsets.assign(1, 0u);
+	m_clusterEntrances.clear();
+	for (auto& entrances : clusterEntrances)
+	{
+		std::sort(entrances.begin(), entrances.end());
+		m_clusterEntrances.insert(m_clusterEntrances.end(), entrances.begin(), entrances.end());
+		m_clusterEntranceOffsets.push_back(static_cast<u32>(m_clusterEntrances.size()));
+	}
+
+	// Shortest path from every entrance to the other entrances of the same cluster, without leaving it
+	struct EntranceEdge
+	{
+		u32 from, to;
+		float cost;
+		u32 pathBegin, pathEnd;
+	};
+	std::vector<EntranceEdge> edges;
+	std::vector<u32> paths;
+	SearchScratch& s = s_startScratch;
+	for (u32 cluster = 0; cluster < m_clusterCount; ++cluster)
+	{
+		for (u32 from : clusterEntrances[cluster])
+		{
+			s.Begin(nodeCount);
+			s.Touch(from);
+			s.g[from] = s.f[from] = 0.f;
+			s.PushOrDecrease(from);
+			SearchCluster(s, cluster);
+
+			for (u32 to : clusterEntrances[cluster])
+			{
+				if (to == from || s.stamp[to] != s.search || s.g[to] == std::numeric_limits<float>::infinity())
+					continue;
+
+				const u32 pathBegin = static_cast<u32>(paths.size());
+				for (u32 node = s.parent[to]; node != from; node = s.parent[node])
+					paths.push_back(node);
+				std::reverse(paths.begin() + pathBegin, paths.end());
+				edges.push_back({ from, to, s.g[to], pathBegin, static_cast<u32>(paths.size()) });
+			}
+		}
+	}
+
+	std::stable_sort(edges.begin(), edges.end(), [](const EntranceEdge& a, const EntranceEdge& b) { return a.from < b.from; });
+	m_entranceOffsets.assign(nodeCount + 1, 0);
+	m_entranceTargets.clear();
+	m_entranceCosts.clear();
+	m_entrancePathOffsets.clear();
+	m_entrancePaths.clear();
+	m_entrancePathOffsets.push_back(0);
+	for (const EntranceEdge& edge : edges)
+	{
+		m_entranceOffsets[edge.from + 1]++;
+		m_entranceTargets.push_back(edge.to);
+		m_entranceCosts.push_back(edge.cost);
+		m_entrancePaths.insert(m_entrancePaths.end(), paths.begin() + edge.pathBegin, paths.begin() + edge.pathEnd);
+		m_entrancePathOffsets.push_back(static_cast<u32>(m_entrancePaths.size()));
+	}
+	for (u32 node = 1; node <= nodeCount; ++node)
+		m_entranceOffsets[node] += m_entranceOffsets[node - 1];
+}
+
+void NavGraph::SearchCluster(SearchScratch& s, u32 cluster) const
+{
+	while (!s.heap.empty())
+	{
+		const u32 current = s.Pop();
+		for (u32 edge = m_edgeOffsets[current]; edge < m_edgeOffsets[current + 1]; ++edge)
+		{
+			if (m_meshClusters[m_edgeMeshes[edge]] != cluster)
+				continue;
+
+			const u32 neighbor = m_edgeTargets[edge];
+			s.Touch(neighbor);
+			if (s.heapPos[neighbor] == CLOSED)
+				continue;
+
+			const float distance = s.g[current] + m_edgeCosts[edge];
+			if (distance < s.g[neighbor])
+			{
+				s.g[neighbor] = s.f[neighbor] = distance;
+				s.parent[neighbor] = current;
+				s.PushOrDecrease(neighbor);
+			}
+		}
+	}
+}
+
+u32 NavGraph::MeshIndex(NavMeshID mesh) const
+{
+	return DenseIndex(m_meshIndices, m_meshes, mesh);
+}
+
+u32 NavGraph::PortalIndex(PortalID portal) const
+{
+	return DenseIndex(m_portalIndices, m_portals, portal);
+}
+
+bool NavGraph::FindPath(NavMeshID startMesh, const Vector3 start, NavMeshID goalMesh, const Vector3 goal, std::vector<PortalID>& path) const
+{
+	path.clear();
+	if (startMesh == goalMesh)
+		return true;
+
+	const u32 startIndex = MeshIndex(startMesh);
+	const u32 goalIndex = MeshIndex(goalMesh);
+	if (startIndex == NO_NODE || goalIndex == NO_NODE)
+		return false;
+
+	if (m_meshClusters[startIndex] == m_meshClusters[goalIndex])
+		return FindPathFlat(startMesh, start, goalMesh, goal, path);
+	return FindPathHierarchical(startIndex, start, goalIndex, goal, path);
+}
+
+bool NavGraph::FindPathHierarchical(u32 startIndex, const Vector3 start, u32 goalIndex, const Vector3 goal, std::vector<PortalID>& path) const
+{
+	const u32 nodeCount = NodeCount();
+	const u32 startCluster = m_meshClusters[startIndex];
+	const u32 goalCluster = m_meshClusters[goalIndex];
+
+	// Cost from start to every entrance of the start cluster
+	SearchScratch& toStart = s_startScratch;
+	toStart.Begin(nodeCount);
+	for (u32 i = m_meshPortalOffsets[startIndex]; i < m_meshPortalOffsets[startIndex + 1]; ++i)
+	{
+		const u32 node = m_meshPortals[i];
+		toStart.Touch(node);
+		toStart.g[node] = toStart.f[node] = Vector3::Distance(start, m_positions[node]);
+		toStart.PushOrDecrease(node);
+	}
+	SearchCluster(toStart, startCluster);
+
+	// Cost from every entrance of the goal cluster to the goal, ending at a portal of the goal mesh like the flat search
+	SearchScratch& toGoal = s_goalScratch;
+	toGoal.Begin(nodeCount);
+	for (u32 i = m_meshPortalOffsets[goalIndex]; i < m_meshPortalOffsets[goalIndex + 1]; ++i)
+	{
+		const u32 node = m_meshPortals[i];
+		toGoal.Touch(node);
+		toGoal.g[node] = toGoal.f[node] = Vector3::Distance(m_positions[node], goal);
+		toGoal.PushOrDecrease(node);
+	}
+	SearchCluster(toGoal, goalCluster);
+
+	const auto goalCost = [&](u32 node)
+	{
+		return toGoal.stamp[node] == toGoal.search ? toGoal.g[node] : std::numeric_limits<float>::infinity();
+	};
+
+	// A* over the entrances
+	SearchScratch& s = s_scratch;
+	s.Begin(nodeCount);
+	for (u32 i = m_clusterEntranceOffsets[startCluster]; i < m_clusterEntranceOffsets[startCluster + 1]; ++i)
+	{
+		const u32 node = m_clusterEntrances[i];
+		if (toStart.stamp[node] != toStart.search || toStart.g[node] == std::numeric_limits<float>::infinity())
+			continue;
+		s.Touch(node);
+		s.g[node] = toStart.g[node];
+		s.f[node] = s.g[node] + Vector3::Distance(m_positions[node], goal);
+		s.PushOrDecrease(node);
+	}
+
+	float best = std::numeric_limits<float>::infinity();
+	u32 last = NO_NODE;
+	while (!s.heap.empty())
+	{
+		const u32 current = s.Pop();
+		if (s.f[current] >= best)
+			break;
+
+		if (const float total = s.g[current] + goalCost(current); total < best)
+		{
+			best = total;
+			last = current;
+		}
+
+		for (u32 edge = m_entranceOffsets[current]; edge < m_entranceOffsets[current + 1]; ++edge)
+		{
+			const u32 neighbor = m_entranceTargets[edge];
+			s.Touch(neighbor);
+			if (s.heapPos[neighbor] == CLOSED)
+				continue;
+
+			const float tentativeG = s.g[current] + m_entranceCosts[edge];
+			if (tentativeG < s.g[neighbor])
+			{
+				s.g[neighbor] = tentativeG;
+				s.f[neighbor] = tentativeG + Vector3::Distance(m_positions[neighbor], goal);
+				s.parent[neighbor] = edge;	// The entrance edge, so its path can be expanded
+				s.PushOrDecrease(neighbor);
+			}
+		}
+	}
+	if (last == NO_NODE)
+		return false;
+
+	// Expand back to front: goal cluster, entrance edges, start cluster
+	for (u32 node = toGoal.parent[last]; node != NO_NODE; node = toGoal.parent[node])
+		path.push_back(m_portals[node]);
+	std::reverse(path.begin(), path.end());
+
+	u32 node = last;
+	while (s.parent[node] != NO_NODE)
+	{
+		const u32 edge = s.parent[node];
+		path.push_back(m_portals[node]);
+		for (u32 i = m_entrancePathOffsets[edge + 1]; i > m_entrancePathOffsets[edge]; --i)
+			path.push_back(m_portals[m_entrancePaths[i - 1]]);
+		node = EntranceSource(edge);
+	}
+	for (; node != NO_NODE; node = toStart.parent[node])
+		path.push_back(m_portals[node]);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+bool NavGraph::FindPathFlat(NavMeshID startMesh, const Vector3 start, NavMeshID goalMesh, const Vector3 goal, std::vector<PortalID>& path) const
+{
+	path.clear();
+
+	// Trivial navigation within the NavMesh
+	if (startMesh == goalMesh)
+		return true;
+
+	const u32 startIndex = MeshIndex(startMesh);
+	const u32 goalIndex = MeshIndex(goalMesh);
+	if (startIndex == NO_NODE || goalIndex == NO_NODE)
+		return false;
+
+	SearchScratch& s = s_scratch;
+	s.Begin(NodeCount());
+
+	// The start point is not a node, its edges are the portals out of the start mesh
+	for (u32 i = m_meshPortalOffsets[startIndex]; i < m_meshPortalOffsets[startIndex + 1]; ++i)
+	{
+		const u32 node = m_meshPortals[i];
+		s.Touch(node);
+		s.g[node] = Vector3::Distance(start, m_positions[node]);
+		s.f[node] = s.g[node] + Vector3::Distance(m_positions[node], goal);
+		s.PushOrDecrease(node);
+	}
+
+	while (!s.heap.empty())
+	{
+		const u32 current = s.Pop();
+		if (m_nodeMeshes[current * 2] == goalIndex || m_nodeMeshes[current * 2 + 1] == goalIndex)
+		{
+			for (u32 node = current; node != NO_NODE; node = s.parent[node])
+				path.push_back(m_portals[node]);
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		for (u32 edge = m_edgeOffsets[current]; edge < m_edgeOffsets[current + 1]; ++edge)
+		{
+			const u32 neighbor = m_edgeTargets[edge];
+			s.Touch(neighbor);
+			if (s.heapPos[neighbor] == CLOSED)
+				continue;
+
+			const float tentativeG = s.g[current] + m_edgeCosts[edge];
+			if (tentativeG < s.g[neighbor])
+			{
+				s.g[neighbor] = tentativeG;
+				s.f[neighbor] = tentativeG + Vector3::Distance(m_positions[neighbor], goal);
+				s.parent[neighbor] = current;
+				s.PushOrDecrease(neighbor);
+			}
+		}
+	}
+	return false;
+}
+
+void NavGraph::BuildFlowField(NavMeshID goalMesh, const Vector3 goal, FlowField& field) const
+{
+	field.goalMesh = goalMesh;
+	field.exits.assign(m_meshes.size(), NO_NODE);
+
+	const u32 goalIndex = MeshIndex(goalMesh);
+	if (goalIndex == NO_NODE)
+		return;
+
+	SearchScratch& s = s_scratch;
+	s.Begin(NodeCount());
+
+	// Integrate the walking distance to the goal outwards from the portals of the goal mesh, f is the distance itself
+	for (u32 i = m_meshPortalOffsets[goalIndex]; i < m_meshPortalOffsets[goalIndex + 1]; ++i)
+	{
+		const u32 node = m_meshPortals[i];
+		s.Touch(node);
+		s.g[node] = s.f[node] = Vector3::Distance(m_positions[node], goal);
+		s.PushOrDecrease(node);
+	}
+
+	while (!s.heap.empty())
+	{
+		const u32 current = s.Pop();
+		for (u32 edge = m_edgeOffsets[current]; edge < m_edgeOffsets[current + 1]; ++edge)
+		{
+			const u32 neighbor = m_edgeTargets[edge];
+			s.Touch(neighbor);
+			if (s.heapPos[neighbor] == CLOSED)
+				continue;
+
+			const float distance = s.g[current] + m_edgeCosts[edge];
+			if (distance < s.g[neighbor])
+			{
+				s.g[neighbor] = s.f[neighbor] = distance;
+				s.PushOrDecrease(neighbor);
+			}
+		}
+	}
+
+	// Every mesh heads for its portal closest to the goal
+	for (u32 mesh = 0; mesh < m_meshes.size(); ++mesh)
+	{
+		if (mesh == goalIndex)
+			continue;
+
+		float best = std::numeric_limits<float>::infinity();
+		for (u32 i = m_meshPortalOffsets[mesh]; i < m_meshPortalOffsets[mesh + 1]; ++i)
+		{
+			const u32 node = m_meshPortals[i];
+			if (s.stamp[node] == s.search && s.g[node] < best)
+			{
+				best = s.g[node];
+				field.exits[mesh] = node;
+			}
+		}
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <DOGEngine.h>
+
+// The portal graph baked into flat arrays. Portals are the nodes (dense indices in build order),
+// two portals are neighbors when they share a NavMesh. Edges are stored as CSR: the neighbors of
+// node n are m_edgeTargets[m_edgeOffsets[n] .. m_edgeOffsets[n + 1]] with their walk costs next to them.
+//
+// On top of it sits a second, much smaller level (HPA*): NavMeshes are grouped into cubic clusters of the level grid,
+// each run of portals along a cluster border gets one entrance and the entrances of a cluster are connected by their
+// precomputed shortest path through it. Queries between clusters search that level and only walk the flat graph
+// inside the start and goal clusters.
+class NavGraph
+{
+	using Vector3 = DirectX::SimpleMath::Vector3;
+public:
+	using NavMeshID = DOG::entity;
+	using PortalID = DOG::entity;
+	static constexpr u32 NO_NODE = UINT32_MAX;
+
+	// Where to go next from every NavMesh to reach one goal, see BuildFlowField
+	struct FlowField
+	{
+		NavMeshID goalMesh = DOG::NULL_ENTITY;
+		std::vector<u32> exits;		// Per mesh index, the portal node to walk to. NO_NODE in the goal mesh and meshes that can not reach it.
+	};
+
+	// Bakes every NavMeshComponent/PortalComponent currently in the EntityManager, clusterSize is the edge of a cluster in world units
+	void Build(float clusterSize);
+
+	// A* from start (inside startMesh) to the first portal that touches goalMesh. Writes the portals to pass through
+	// into path, returns false if goalMesh can not be reached. Does not allocate once the scratch arrays have grown.
+	// Goals in another cluster are searched for on the cluster level, the path is near optimal.
+	bool FindPath(NavMeshID startMesh, const Vector3 start, NavMeshID goalMesh, const Vector3 goal, std::vector<PortalID>& path) const;
+
+	// FindPath on the flat portal graph only
+	bool FindPathFlat(NavMeshID startMesh, const Vector3 start, NavMeshID goalMesh, const Vector3 goal, std::vector<PortalID>& path) const;
+
+	// Reverse Dijkstra from goal over every portal, O(portals) no matter how many agents follow the field
+	void BuildFlowField(NavMeshID goalMesh, const Vector3 goal, FlowField& field) const;
+
+	u32 NodeCount() const { return static_cast<u32>(m_portals.size()); }
+	u32 MeshIndex(NavMeshID mesh) const;
+	u32 PortalIndex(PortalID portal) const;
+	const Vector3& PortalPosition(u32 node) const { return m_positions[node]; }
+	PortalID Portal(u32 node) const { return m_portals[node]; }
+	u32 ClusterCount() const { return m_clusterCount; }
+	u32 EntranceEdgeCount() const { return static_cast<u32>(m_entranceTargets.size()); }
+
+private:
+	struct SearchScratch;
+
+	bool FindPathHierarchical(u32 startIndex, const Vector3 start, u32 goalIndex, const Vector3 goal, std::vector<PortalID>& path) const;
+	void BuildClusters(float clusterSize);
+	// Dijkstra from the seeded nodes of s that only walks through NavMeshes of the cluster
+	void SearchCluster(SearchScratch& s, u32 cluster) const;
+	u32 EntranceSource(u32 edge) const { return static_cast<u32>(std::upper_bound(m_entranceOffsets.begin(), m_entranceOffsets.end(), edge) - m_entranceOffsets.begin()) - 1; }
+
+	// Scratch per thread: flat searches, the start and goal cluster searches and the cluster level search
+	static thread_local SearchScratch s_scratch;
+	static thread_local SearchScratch s_startScratch;
+	static thread_local SearchScratch s_goalScratch;
+
+	// Per node
+	std::vector<PortalID> m_portals;
+	std::vector<Vector3> m_positions;
+	std::vector<u32> m_nodeMeshes;			// Two mesh indices per node
+	std::vector<u32> m_edgeOffsets;			// NodeCount() + 1 entries
+	std::vector<u32> m_edgeTargets;
+	std::vector<float> m_edgeCosts;
+	std::vector<u32> m_edgeMeshes;			// The mesh an edge walks through
+
+	// Per mesh, the portals leading out of it (CSR as well)
+	std::vector<NavMeshID> m_meshes;
+	std::vector<u32> m_meshPortalOffsets;
+	std::vector<u32> m_meshPortals;
+
+	// Cluster level, entrance edges are CSR per node (empty for nodes that are not entrances)
+	std::vector<u32> m_meshClusters;
+	std::vector<u32> m_clusterEntranceOffsets;
+	std::vector<u32> m_clusterEntrances;
+	std::vector<u32> m_entranceOffsets;
+	std::vector<u32> m_entranceTargets;
+	std::vector<float> m_entranceCosts;
+	std::vector<u32> m_entrancePathOffsets;	// Per entrance edge + 1, the nodes walked between its two entrances
+	std::vector<u32> m_entrancePaths;
+	u32 m_clusterCount = 0;
+
+	// Entity slot -> dense index
+	std::vector<u32> m_meshIndices;
+	std::vector<u32> m_portalIndices;
+};
@@ -0,0 +1,80 @@
+#include "PathCache.h"
+
+using namespace DOG;
+
+const std::vector<PathCache::PortalID>* PathCache::Find(u64 key) noexcept
+{
+	auto it = m_slots.find(key);
+	if (it == m_slots.end())
+		return nullptr;
+
+	Entry& entry = m_entries[it->second];
+	entry.used = true;
+	return &entry.portals;
+}
+
+std::vector<PathCache::PortalID>& PathCache::Insert(u64 key) noexcept
+{
+	ASSERT(!m_slots.contains(key), "Path is already cached");
+
+	u32 slot;
+	if (!m_free.empty())
+	{
+		slot = m_free.back();
+		m_free.pop_back();
+	}
+	else if (m_entries.size() < m_capacity)
+	{
+		slot = static_cast<u32>(m_entries.size());
+		m_entries.emplace_back();
+	}
+	else
+	{
+		// Every used path gets a second chance, the sweep ends after one lap at the latest
+		while (m_entries[m_hand].used)
+		{
+			m_entries[m_hand].used = false;
+			m_hand = (m_hand + 1) % m_capacity;
+		}
+		slot = m_hand;
+		m_hand = (m_hand + 1) % m_capacity;
+		m_slots.erase(m_entries[slot].key);
+		++m_evictions;
+	}
+
+	Entry& entry = m_entries[slot];
+	entry.key = key;
+	entry.used = false;
+	entry.occupied = true;
+	entry.portals.clear();
+	m_slots.emplace(key, slot);
+	return entry.portals;
+}
+
+void PathCache::EraseIf(const std::function<bool(const std::vector<PortalID>&)>& predicate) noexcept
+{
+	for (u32 slot = 0; slot < m_entries.size(); ++slot)
+	{
+		Entry& entry = m_entries[slot];
+		if (entry.occupied && predicate(entry.portals))
+		{
+			m_slots.erase(entry.key);
+			entry.occupied = false;
+			entry.used = false;
+			m_free.push_back(slot);
+		}
+	}
+}
+
+void PathCache::Clear() noexcept
+{
+	for (Entry& entry : m_entries)
+	{
+		entry.occupied = false;
+		entry.used = false;
+	}
+	m_free.clear();
+	for (u32 slot = static_cast<u32>(m_entries.size()); slot > 0; --slot)
+		m_free.push_back(slot - 1);
+	m_slots.clear();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <DOGEngine.h>
+
+// Portal paths keyed by (start NavMesh, goal NavMesh) in a fixed number of slots. When every slot is taken the
+// clock hand sweeps the slots and evicts the first path that has not been found since the hand last passed it,
+// so the paths agents keep asking for stay while one-off queries are recycled. Slots keep their vectors, a warm
+// cache does not allocate.
+class PathCache
+{
+public:
+	using PortalID = DOG::entity;
+
+	explicit PathCache(u32 capacity) noexcept : m_capacity{ capacity } {}
+
+	// Marks the path as used, nullptr if it is not cached
+	const std::vector<PortalID>* Find(u64 key) noexcept;
+	bool Contains(u64 key) const noexcept { return m_slots.contains(key); }
+
+	// Empty path for a key that is not cached yet, the reference is valid until the next Insert, Erase or Clear
+	std::vector<PortalID>& Insert(u64 key) noexcept;
+
+	void EraseIf(const std::function<bool(const std::vector<PortalID>&)>& predicate) noexcept;
+	void Clear() noexcept;
+
+	u32 Size() const noexcept { return static_cast<u32>(m_slots.size()); }
+	u32 Capacity() const noexcept { return m_capacity; }
+	u32 Evictions() const noexcept { return m_evictions; }
+
+private:
+	struct Entry
+	{
+		u64 key = 0;
+		std::vector<PortalID> portals;
+		bool used = false;
+		bool occupied = false;
+	};
+
+	u32 m_capacity;
+	std::vector<Entry> m_entries;
+	std::vector<u32> m_free;					// Slots emptied by EraseIf
+	std::unordered_map<u64, u32> m_slots;		// Key -> index into m_entries
+	u32 m_hand = 0;
+	u32 m_evictions = 0;
+};
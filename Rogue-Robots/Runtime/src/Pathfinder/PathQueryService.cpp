@@ -0,0 +1,113 @@
+#include "PathQueryService.h"
+
+using namespace DOG;
+using namespace DirectX::SimpleMath;
+
+PathQueryService::~PathQueryService()
+{
+	JobSystem::Wait(m_counter);
+}
+
+void PathQueryService::Request(entity e, NavMeshID startMesh, const Vector3 start, NavMeshID goalMesh, const Vector3 goal, Callback&& callback)
+{
+	const u64 key = Key(startMesh, goalMesh);
+	if (auto it = m_keys.find(key); it != m_keys.end())
+	{
+		// Workers never touch the waiters, so joining a query in flight is fine
+		Query& query = (it->second & IN_FLIGHT) ? m_inFlight[it->second & ~IN_FLIGHT] : m_queued[it->second];
+		query.waiters.push_back({ e, std::move(callback) });
+		return;
+	}
+
+	m_keys.emplace(key, static_cast<u32>(m_queued.size()));
+	Query& query = m_queued.emplace_back(Query{ startMesh, goalMesh, start, goal });
+	query.waiters.push_back({ e, std::move(callback) });
+}
+
+void PathQueryService::Dispatch(const NavGraph& graph, f64 budgetMs)
+{
+	if (!m_inFlight.empty() || m_queued.empty())
+		return;
+
+	std::swap(m_inFlight, m_queued);
+	for (auto& [key, index] : m_keys)
+		index |= IN_FLIGHT;
+	m_solved.assign(m_inFlight.size(), 0u);
+	m_next.store(0u, std::memory_order_relaxed);
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<f64, std::milli>(budgetMs);
+	const u32 jobCount = std::min(std::max(JobSystem::GetWorkerCount(), 1u), static_cast<u32>(m_inFlight.size()));
+	for (u32 job = 0; job < jobCount; ++job)
+	{
+		JobSystem::Execute([this, &graph, deadline]()
+			{
+				// The budget is checked before each search, only the first query of the batch is solved no matter what.
+				// A query claimed after the deadline stays unsolved and is requeued by Deliver.
+				for (u32 i = m_next.fetch_add(1u, std::memory_order_relaxed); i < m_inFlight.size(); i = m_next.fetch_add(1u, std::memory_order_relaxed))
+				{
+					if (i > 0u && std::chrono::steady_clock::now() >= deadline)
+						break;
+					Query& query = m_inFlight[i];
+					query.found = graph.FindPath(query.startMesh, query.start, query.goalMesh, query.goal, query.portals);
+					m_solved[i] = 1u;
+				}
+			}, &m_counter);
+	}
+}
+
+void PathQueryService::Deliver()
+{
+	JobSystem::Wait(m_counter);
+
+	// Callbacks may request new paths, so the batch is taken out of the members before any of them runs
+	std::vector<Query> solved;
+	for (u32 i = 0; i < m_inFlight.size(); ++i)
+	{
+		if (m_solved[i])
+		{
+			m_keys.erase(Key(m_inFlight[i].startMesh, m_inFlight[i].goalMesh));
+			solved.push_back(std::move(m_inFlight[i]));
+		}
+	}
+	Requeue();
+
+	for (Query& query : solved)
+	{
+		for (Waiter& waiter : query.waiters)
+			waiter.callback(waiter.e, query.portals, query.found);
+	}
+	m_solvedCount += static_cast<u32>(solved.size());
+}
+
+void PathQueryService::Cancel()
+{
+	JobSystem::Wait(m_counter);
+	m_inFlight.clear();
+	m_solved.clear();
+	m_queued.clear();
+	m_keys.clear();
+}
+
+void PathQueryService::Requeue()
+{
+	std::vector<Query> queue;
+	queue.reserve(m_inFlight.size() + m_queued.size());
+	for (u32 i = 0; i < m_inFlight.size(); ++i)
+	{
+		if (!m_solved[i])
+		{
+			m_inFlight[i].portals.clear();
+			queue.push_back(std::move(m_inFlight[i]));
+		}
+	}
+	for (Query& query : m_queued)
+		queue.push_back(std::move(query));
+
+	m_inFlight.clear();
+	m_solved.clear();
+	m_queued = std::move(queue);
+
+	m_keys.clear();
+	for (u32 i = 0; i < m_queued.size(); ++i)
+		m_keys.emplace(Key(m_queued[i].startMesh, m_queued[i].goalMesh), i);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <DOGEngine.h>
+#include "NavGraph.h"
+
+// Solves portal path queries on the job system instead of inside the systems asking for them.
+// Requests are queued during the frame, Dispatch hands the queue to the workers and Deliver is the sync point
+// where the callbacks run (on the calling thread). Queries between the same pair of NavMeshes are solved once,
+// every requester gets the result. Queries that did not fit in a frame's time budget stay queued for the next one.
+class PathQueryService
+{
+	using Vector3 = DirectX::SimpleMath::Vector3;
+public:
+	using NavMeshID = DOG::entity;
+	using PortalID = DOG::entity;
+	using Callback = std::function<void(DOG::entity e, const std::vector<PortalID>& portals, bool found)>;
+
+	PathQueryService() noexcept = default;
+	~PathQueryService();
+	DELETE_COPY_MOVE_CONSTRUCTOR(PathQueryService);
+
+	void Request(DOG::entity e, NavMeshID startMesh, const Vector3 start, NavMeshID goalMesh, const Vector3 goal, Callback&& callback);
+
+	// Starts solving the queued queries on the workers and returns. Workers stop picking up new queries once budgetMs has passed,
+	// the first query of a batch is always solved so the queue drains even when the workers start late.
+	// The graph must not change until Deliver or Cancel has been called.
+	void Dispatch(const NavGraph& graph, f64 budgetMs);
+
+	// Waits for the dispatched batch and runs the callbacks of every solved query
+	void Deliver();
+
+	// Waits for the dispatched batch and drops every query without running its callbacks. Call before the graph changes,
+	// the queued NavMeshes may not exist afterwards and results would be stale. Requesters have to ask again.
+	void Cancel();
+
+	bool IsPending(NavMeshID startMesh, NavMeshID goalMesh) const { return m_keys.contains(Key(startMesh, goalMesh)); }
+	u32 QueuedCount() const { return static_cast<u32>(m_queued.size() + m_inFlight.size()); }
+	u32 SolvedCount() const { return m_solvedCount; }
+
+private:
+	struct Waiter
+	{
+		DOG::entity e;
+		Callback callback;
+	};
+
+	struct Query
+	{
+		NavMeshID startMesh;
+		NavMeshID goalMesh;
+		Vector3 start;
+		Vector3 goal;
+		std::vector<Waiter> waiters;
+
+		// Written by the worker that solves it
+		std::vector<PortalID> portals;
+		bool found = false;
+	};
+
+	static u64 Key(NavMeshID startMesh, NavMeshID goalMesh) { return (static_cast<u64>(startMesh) << 32) | goalMesh; }
+
+	// Puts the unsolved part of the batch back in front of the queue
+	void Requeue();
+
+	std::vector<Query> m_queued;
+	std::vector<Query> m_inFlight;
+	std::vector<u8> m_solved;					// Per query in flight
+	std::unordered_map<u64, u32> m_keys;		// Key -> index, into m_inFlight if the top bit is set, else into m_queued
+	std::atomic<u32> m_next{ 0 };
+	DOG::JobCounter m_counter;
+	u32 m_solvedCount = 0;
+
+	static constexpr u32 IN_FLIGHT = 0x8000'0000u;
+};
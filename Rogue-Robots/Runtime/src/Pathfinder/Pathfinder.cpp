@@ -1,6 +1,7 @@
 #include "Pathfinder.h"
 #include <limits>
 #include <unordered_map>
+#include <unordered_set>
 #include "Game/PCG/PcgLevelLoader.h"
 #include "PathfinderSystems.h"
 #include "Game/AgentManager/AgentManager.h"
@@ -37,6 +38,7 @@ void Pathfinder::Init()
 	EntityManager& em = EntityManager::Get();
 	em.RegisterSystem(std::make_unique<VisualizePathCleanUpSystem>());
 	em.RegisterSystem(std::make_unique<PathfinderWalkSystem>());
+	em.RegisterSystem(std::make_unique<PathQuerySystem>());
 
 	m_initialized = true;
 
@@ -62,6 +64,8 @@ void Pathfinder::VisualizePathsMenu(bool& open)
 		if (ImGui::Begin("Pathfinder", &open, ImGuiWindowFlags_NoFocusOnAppearing))
 		{
 			ImGui::Checkbox("Visualize paths", &m_visualizePaths);
+			ImGui::Checkbox("Asynchronous path queries", &m_asyncPaths);
+			ImGui::Text("Queued path queries: %u", m_queries.QueuedCount());
 
 			if (ImGui::Checkbox("Visualize NavMeshes", &m_vizNavMeshes))
 			{
@@ -221,7 +225,7 @@ void Pathfinder::BuildNavScene(SceneComponent::Type sceneType)
 			// create NavMesh and add to navScene
 			entity newMesh = em.CreateEntity();
 			navScene.AddIdAt(x, y, z, newMesh);
-			em.AddComponent<NavMeshComponent>(newMesh);
+			em.AddComponent<NavMeshComponent>(newMesh).source = e;
 			em.AddComponent<SceneComponent>(newMesh, sceneType);
 			BoundingBoxComponent& bb = em.AddComponent<BoundingBoxComponent>(newMesh, em.GetComponent<BoundingBoxComponent>(e));
 			if (m_vizNavMeshes)
@@ -250,7 +254,7 @@ void Pathfinder::BuildNavScene(SceneComponent::Type sceneType)
 			// create NavMesh and add to navScene
 			entity newMesh = em.CreateEntity();
 			navScene.AddIdAt(x, y, z, newMesh);
-			em.AddComponent<NavMeshComponent>(newMesh);
+			em.AddComponent<NavMeshComponent>(newMesh).source = e;
 			em.AddComponent<SceneComponent>(newMesh, sceneType);
 			BoundingBoxComponent& bb = em.AddComponent<BoundingBoxComponent>(newMesh, em.GetComponent<BoundingBoxComponent>(e));
 			if (m_vizNavMeshes)
@@ -269,71 +273,173 @@ void Pathfinder::BuildNavScene(SceneComponent::Type sceneType)
 
 
 	// Connect the NavMeshes
-	for (size_t y = 0; y < navScene.map.size(); ++y)
-	{
-		for (size_t z = 0; z < navScene.map[y].size(); ++z)
+	for (size_t y = 0; y < navScene.height; ++y)
+		for (size_t z = 0; z < navScene.depth; ++z)
+			for (size_t x = 0; x < navScene.width; ++x)
+				ConnectNavMesh(navScene, x, y, z, sceneType);
+
+	InvalidatePaths();
+}
+
+
+void Pathfinder::UpdateNavRegion(const Vector3 low, const Vector3 high)
+{
+	constexpr float blockDim = pcgBlock::DIMENSION;
+
+	EntityManager& em = EntityManager::Get();
+
+	std::unordered_set<PortalID> removed;
+	std::unordered_set<u64> wereConnected;
+	bool newConnection = false;
+	const auto pair = [](NavMeshID mesh1, NavMeshID mesh2) { return (static_cast<u64>(std::min(mesh1, mesh2)) << 32) | std::max(mesh1, mesh2); };
+
+	em.Collect<NavSceneComponent>().Do(
+		[&](entity navSceneID, NavSceneComponent& navScene)
 		{
-			for (size_t x = 0; x < navScene.map[y][z].size(); ++x)
-			{
-				if (navScene.HasNavMesh(x, y, z))
-				{
-					// connect mesh to neighbors
-					entity me = navScene.At(x, y, z);
-					NavMeshComponent& myMesh = em.GetComponent<NavMeshComponent>(me);
-					BoundingBoxComponent& bb = em.GetComponent<BoundingBoxComponent>(me);
+			if (navScene.cells.empty())
+				return;
+
+			const SceneComponent::Type sceneType = em.HasComponent<SceneComponent>(navSceneID) ?
+				em.GetComponent<SceneComponent>(navSceneID).scene : SceneComponent::Type::Global;
 
-					for (Step dir : {Dir::down, Dir::north, Dir::east, Dir::south, Dir::west, Dir::up})
+			// One cell of padding, the NavMeshes next to the region were shrunk towards it and have portals into it
+			const auto cell = [](float position, size_t size, int padding)
+			{
+				return static_cast<size_t>(std::clamp(static_cast<int>(std::floor(position / blockDim)) + padding, 0, static_cast<int>(size) - 1));
+			};
+			const size_t x0 = cell(low.x, navScene.width, -1), x1 = cell(high.x, navScene.width, 1);
+			const size_t y0 = cell(low.y, navScene.height, -1), y1 = cell(high.y, navScene.height, 1);
+			const size_t z0 = cell(low.z, navScene.depth, -1), z1 = cell(high.z, navScene.depth, 1);
+
+			// Tear the region down: its portals are destroyed and its NavMeshes get their unshrunk boxes back
+			for (size_t y = y0; y <= y1; ++y)
+				for (size_t z = z0; z <= z1; ++z)
+					for (size_t x = x0; x <= x1; ++x)
 					{
-						Vector3 extDir = dir.Vec3() * bb.Extents();
-						// shrink NavMesh if hit detected else connect if neighbor exists
-						if (auto hit = PhysicsEngine::RayCast(bb.Center(), bb.Center() + extDir); hit)
+						NavMeshID mesh = navScene.At(x, y, z);
+						if (mesh == NULL_ENTITY)
+							continue;
+
+						NavMeshComponent& navMesh = em.GetComponent<NavMeshComponent>(mesh);
+						for (PortalID id : navMesh.portals)
 						{
-							Vector3 juxtaPoint = bb.Center() - extDir;
-							bb.Center((hit->hitPosition + juxtaPoint) / 2);
-							Vector3 masked = dir.InversePositive().Vec3() * bb.Extents();
-							f32 halfDist = Vector3::Distance(hit->hitPosition, juxtaPoint) / 2;
-							Vector3 newExt = dir.Positive().Vec3() * halfDist;
-							bb.Extents(masked + newExt);
+							if (!removed.insert(id).second)
+								continue;
+
+							PortalComponent& portal = em.GetComponent<PortalComponent>(id);
+							NavMeshID other = portal.navMesh1 == mesh ? portal.navMesh2 : portal.navMesh1;
+							wereConnected.insert(pair(mesh, other));
+							if (other != mesh)
+								std::erase(em.GetComponent<NavMeshComponent>(other).portals, id);
+							em.DestroyEntity(id);
 						}
-						else if (navScene.HasNavMesh(x + dir.x, y + dir.y, z + dir.z))
+						navMesh.portals.clear();
+
+						if (em.Exists(navMesh.source) && em.HasComponent<BoundingBoxComponent>(navMesh.source))
+							em.GetComponent<BoundingBoxComponent>(mesh) = em.GetComponent<BoundingBoxComponent>(navMesh.source);
+					}
+
+			// And derive it again, against whatever the physics world looks like now
+			for (size_t y = y0; y <= y1; ++y)
+				for (size_t z = z0; z <= z1; ++z)
+					for (size_t x = x0; x <= x1; ++x)
+						ConnectNavMesh(navScene, x, y, z, sceneType);
+
+			for (size_t y = y0; y <= y1; ++y)
+				for (size_t z = z0; z <= z1; ++z)
+					for (size_t x = x0; x <= x1; ++x)
+					{
+						if (NavMeshID mesh = navScene.At(x, y, z); mesh != NULL_ENTITY)
 						{
-							entity other = navScene.At(x + dir.x, y + dir.y, z + dir.z);
-							BoundingBoxComponent& obb = em.GetComponent<BoundingBoxComponent>(other);
-							extDir = (-dir).Vec3() * obb.Extents();
-							if (auto ohit = PhysicsEngine::RayCast(obb.Center(), obb.Center() + extDir); ohit)
+							for (PortalID id : em.GetComponent<NavMeshComponent>(mesh).portals)
 							{
-								Vector3 juxtaPoint = obb.Center() - extDir;
-								obb.Center((ohit->hitPosition + juxtaPoint) / 2);
-								Vector3 masked = dir.InversePositive().Vec3() * obb.Extents();
-								f32 halfDist = Vector3::Distance(ohit->hitPosition, juxtaPoint) / 2;
-								Vector3 newExt = dir.Positive().Vec3() * halfDist;
-								obb.Extents(masked + newExt);
+								PortalComponent& portal = em.GetComponent<PortalComponent>(id);
+								newConnection |= !wereConnected.contains(pair(portal.navMesh1, portal.navMesh2));
 							}
-							// if meshes not connected, create portal
-							else if (!myMesh.Connected(me, other))
-							{
-								// add new portal to me and other
-								PortalID id = myMesh.portals.emplace_back(em.CreateEntity());
-								em.GetComponent<NavMeshComponent>(other).portals.push_back(id);
+						}
+					}
+		});
 
-								// add necessary components to portal
-								Vector3 pos = em.AddComponent<PortalComponent>(id, me, other).portal;
-								em.AddComponent<SceneComponent>(id, sceneType);
+	if (removed.empty() && !newConnection)
+		return;
 
-								if (m_vizPortals)
-								{
-									// visualize Portals
-									em.AddComponent<TransformComponent>(id).SetPosition(pos).SetScale(PORTAL_SCALE);
-									em.AddComponent<ModelComponent>(id, AssetManager::Get().LoadShapeAsset(PORTAL_SHAPE, PORTAL_TESS));
-									if (m_vizOutlines)
-									{
-										auto& comp = em.AddComponent<OutlineComponent>(id);
-										comp.color = PORTAL_COLOR;
-										comp.onlyOutline = true;
-									}
-								}
-							}
-						}
+	CancelPathQueries();
+	m_navGraph.Build(NAV_CLUSTER_BLOCKS * pcgBlock::DIMENSION);
+	m_flowFields.clear();
+	++m_navVersion;
+
+	// A new connection can shorten any path or make an unreachable goal reachable, a removed one only breaks the paths through it
+	if (newConnection)
+		m_pathCache.Clear();
+	else
+	{
+		m_pathCache.EraseIf([&](const std::vector<PortalID>& portals)
+			{
+				return std::any_of(portals.begin(), portals.end(), [&](PortalID id) { return removed.contains(id); });
+			});
+	}
+}
+
+void Pathfinder::ConnectNavMesh(NavSceneComponent& navScene, size_t x, size_t y, size_t z, SceneComponent::Type sceneType)
+{
+	if (!navScene.HasNavMesh(x, y, z))
+		return;
+
+	EntityManager& em = EntityManager::Get();
+
+	// connect mesh to neighbors
+	entity me = navScene.At(x, y, z);
+	NavMeshComponent& myMesh = em.GetComponent<NavMeshComponent>(me);
+	BoundingBoxComponent& bb = em.GetComponent<BoundingBoxComponent>(me);
+
+	for (Step dir : {Dir::down, Dir::north, Dir::east, Dir::south, Dir::west, Dir::up})
+	{
+		Vector3 extDir = dir.Vec3() * bb.Extents();
+		// shrink NavMesh if hit detected else connect if neighbor exists
+		if (auto hit = PhysicsEngine::RayCast(bb.Center(), bb.Center() + extDir); hit)
+		{
+			Vector3 juxtaPoint = bb.Center() - extDir;
+			bb.Center((hit->hitPosition + juxtaPoint) / 2);
+			Vector3 masked = dir.InversePositive().Vec3() * bb.Extents();
+			f32 halfDist = Vector3::Distance(hit->hitPosition, juxtaPoint) / 2;
+			Vector3 newExt = dir.Positive().Vec3() * halfDist;
+			bb.Extents(masked + newExt);
+		}
+		else if (navScene.HasNavMesh(x + dir.x, y + dir.y, z + dir.z))
+		{
+			entity other = navScene.At(x + dir.x, y + dir.y, z + dir.z);
+			BoundingBoxComponent& obb = em.GetComponent<BoundingBoxComponent>(other);
+			extDir = (-dir).Vec3() * obb.Extents();
+			if (auto ohit = PhysicsEngine::RayCast(obb.Center(), obb.Center() + extDir); ohit)
+			{
+				Vector3 juxtaPoint = obb.Center() - extDir;
+				obb.Center((ohit->hitPosition + juxtaPoint) / 2);
+				Vector3 masked = dir.InversePositive().Vec3() * obb.Extents();
+				f32 halfDist = Vector3::Distance(ohit->hitPosition, juxtaPoint) / 2;
+				Vector3 newExt = dir.Positive().Vec3() * halfDist;
+				obb.Extents(masked + newExt);
+			}
+			// if meshes not connected, create portal
+			else if (!myMesh.Connected(me, other))
+			{
+				// add new portal to me and other
+				PortalID id = myMesh.portals.emplace_back(em.CreateEntity());
+				em.GetComponent<NavMeshComponent>(other).portals.push_back(id);
+
+				// add necessary components to portal
+				Vector3 pos = em.AddComponent<PortalComponent>(id, me, other).portal;
+				em.AddComponent<SceneComponent>(id, sceneType);
+
+				if (m_vizPortals)
+				{
+					// visualize Portals
+					em.AddComponent<TransformComponent>(id).SetPosition(pos).SetScale(PORTAL_SCALE);
+					em.AddComponent<ModelComponent>(id, AssetManager::Get().LoadShapeAsset(PORTAL_SHAPE, PORTAL_TESS));
+					if (m_vizOutlines)
+					{
+						auto& comp = em.AddComponent<OutlineComponent>(id);
+						comp.color = PORTAL_COLOR;
+						comp.onlyOutline = true;
 					}
 				}
 			}
@@ -341,22 +447,15 @@ void Pathfinder::BuildNavScene(SceneComponent::Type sceneType)
 	}
 }
 
-
 std::vector<Vector3> Pathfinder::Checkpoints(Vector3 start, Vector3 goal)
 {
-	EntityManager& em = EntityManager::Get();
-
 	std::vector<Vector3> checkpoints;
-
-	for (PortalID id : Astar(start, goal, heuristicStraightLine))
-		checkpoints.push_back(em.GetComponent<PortalComponent>(id).portal);
-
-	checkpoints.push_back(goal);
+	Funnel(start, Astar(start, goal), goal, checkpoints);
 
 	return checkpoints;
 }
 
-void Pathfinder::Checkpoints(Vector3 start, PathfinderWalkComponent& pfc)
+void Pathfinder::Checkpoints(Vector3 start, PathfinderWalkComponent& pfc, entity e)
 {
 	EntityManager::Get().Collect<NavSceneComponent>().Do(
 		[&](NavSceneComponent& navScene)
@@ -365,20 +464,74 @@ void Pathfinder::Checkpoints(Vector3 start, PathfinderWalkComponent& pfc)
 			{
 				if (NavMeshID terminalMesh = navScene.At(pfc.goal); terminalMesh != NULL_ENTITY)
 				{
-					// Recalculate each frame...
 					EntityManager& em = EntityManager::Get();
-					pfc.path.clear();
-					for (PortalID id : Astar(start, pfc.goal, heuristicStraightLine))
-						pfc.path.push_back(em.GetComponent<PortalComponent>(id).portal);
 
-					if (!pfc.path.empty() || startMesh == terminalMesh)
-						pfc.path.push_back(pfc.goal);
+					// Swarm agents sample the flow field of their target, the next waypoint is the exit portal of their mesh
+					if (pfc.flowTarget != NULL_ENTITY)
+					{
+						const NavGraph::FlowField& field = FlowFieldTo(pfc.flowTarget, terminalMesh, pfc.goal);
+						pfc.path.clear();
+						if (startMesh == terminalMesh)
+							pfc.path.push_back(pfc.goal);
+						else if (u32 mesh = m_navGraph.MeshIndex(startMesh); mesh != NavGraph::NO_NODE && field.exits[mesh] != NavGraph::NO_NODE)
+						{
+							m_exitPortal.assign(1, m_navGraph.Portal(field.exits[mesh]));
+							Funnel(start, m_exitPortal, pfc.goal, pfc.path);
+						}
+						return;
+					}
+
+					// Keep following the corridor while the agent is still in it
+					auto inCorridor = std::find(pfc.corridor.begin(), pfc.corridor.end(), startMesh);
+					bool replan = pfc.navVersion != m_navVersion || pfc.goalMesh != terminalMesh || inCorridor == pfc.corridor.end();
+					if (!replan)
+					{
+						size_t passed = inCorridor - pfc.corridor.begin();
+						pfc.corridor.erase(pfc.corridor.begin(), inCorridor);
+						pfc.portals.erase(pfc.portals.begin(), pfc.portals.begin() + passed);
+					}
+					else if (const u64 key = (static_cast<u64>(startMesh) << 32) | terminalMesh;
+						e != NULL_ENTITY && m_asyncPaths && !m_pathCache.Contains(key))
+					{
+						// Keep walking the old path, or straight at the goal if there is none yet, until the search is done
+						if (!pfc.pending)
+						{
+							pfc.pending = true;
+							m_queries.Request(e, startMesh, start, terminalMesh, pfc.goal,
+								[this, key](entity agent, const std::vector<PortalID>& portals, bool)
+								{
+									if (!m_pathCache.Contains(key))
+									{
+										m_pathCache.Insert(key) = portals;
+										++m_cacheMisses;
+									}
+									if (EntityManager::Get().Exists(agent) && EntityManager::Get().HasComponent<PathfinderWalkComponent>(agent))
+										EntityManager::Get().GetComponent<PathfinderWalkComponent>(agent).pending = false;
+								});
+						}
+						if (pfc.path.empty())
+							pfc.path.push_back(pfc.goal);
+						return;
+					}
+					else
+					{
+						pfc.portals = CachedPortals(startMesh, terminalMesh, start, pfc.goal);
+						pfc.goalMesh = terminalMesh;
+						pfc.navVersion = m_navVersion;
 
-					// remove the first checkpoint if entity is close enough
-					constexpr float THRESHOLD = .05f;
-					constexpr float THRESHOLD_SQ = THRESHOLD * THRESHOLD;
-					if (pfc.path.size() > 1 && Vector3::DistanceSquared(start, pfc.path[0]) > THRESHOLD_SQ)
-						pfc.path.erase(pfc.path.begin());
+						pfc.corridor.clear();
+						pfc.corridor.push_back(startMesh);
+						for (PortalID id : pfc.portals)
+						{
+							PortalComponent& portal = em.GetComponent<PortalComponent>(id);
+							pfc.corridor.push_back(portal.navMesh1 == pfc.corridor.back() ? portal.navMesh2 : portal.navMesh1);
+						}
+					}
+
+					// Only the corners of the corridor are walked to, the first one is always in sight
+					pfc.path.clear();
+					if (!pfc.portals.empty() || startMesh == terminalMesh)
+						Funnel(start, pfc.portals, pfc.goal, pfc.path);
 				}
 			}
 		});
@@ -386,191 +539,156 @@ void Pathfinder::Checkpoints(Vector3 start, PathfinderWalkComponent& pfc)
 
 
 
-std::vector<PortalID> Pathfinder::Astar(const Vector3 start, const Vector3 goal, float(*h)(Vector3, Vector3))
+void Pathfinder::InvalidatePaths()
 {
-	struct MaxFloat
-	{	// float wrapper that has default value infinity
-		float score;
-		MaxFloat() : score(std::numeric_limits<float>::infinity()) {}
-		void	operator=(const float other)		{ score = other; }
-		float	operator=(const MaxFloat& other)	{ return other.score; }
-		float	operator+(const float other)		{ return this->score + other; }
-		bool	operator<(const float other)		{ return this->score < other; }
-		bool	operator<(const MaxFloat& other)	{ return this->score < other.score; }
-		bool	operator>(const MaxFloat& other)	{ return this->score > other.score; }
-		bool	operator>(const float other)		{ return this->score > other; }
-	};
+	CancelPathQueries();
+	m_navGraph.Build(NAV_CLUSTER_BLOCKS * pcgBlock::DIMENSION);
+	m_pathCache.Clear();
+	m_flowFields.clear();
+	++m_navVersion;
+}
 
+void Pathfinder::Funnel(const Vector3 start, const std::vector<PortalID>& portals, const Vector3 goal, std::vector<Vector3>& path)
+{
 	EntityManager& em = EntityManager::Get();
 
+	// Seen from above, positive if v is to the left of u
+	const auto cross = [](const Vector3 u, const Vector3 v) { return u.x * v.z - u.z * v.x; };
+	const auto same = [](const Vector3 a, const Vector3 b) { return Vector3::DistanceSquared(a, b) < 1e-6f; };
+
+	// The ends of every portal as they are seen walking through it, start and goal are portals of zero width
+	m_funnelLefts.assign(1, start);
+	m_funnelRights.assign(1, start);
+	Vector3 from = start;
+	for (PortalID id : portals)
+	{
+		const PortalComponent& portal = em.GetComponent<PortalComponent>(id);
+		const bool end1Left = cross(portal.portal - from, portal.end1 - portal.portal) > 0.f;
+		m_funnelLefts.push_back(end1Left ? portal.end1 : portal.end2);
+		m_funnelRights.push_back(end1Left ? portal.end2 : portal.end1);
+		from = portal.portal;
+	}
+	m_funnelLefts.push_back(goal);
+	m_funnelRights.push_back(goal);
+
+	// Simple stupid funnel: narrow the funnel portal by portal, when one side crosses over the other its end is a corner
+	Vector3 apex = start, left = start, right = start;
+	u32 apexIndex = 0, leftIndex = 0, rightIndex = 0;
+	for (u32 i = 1; i < m_funnelLefts.size(); ++i)
+	{
+		const Vector3 newLeft = m_funnelLefts[i];
+		const Vector3 newRight = m_funnelRights[i];
+
+		if (cross(right - apex, newRight - apex) >= 0.f)
+		{
+			if (same(apex, right) || cross(left - apex, newRight - apex) < 0.f)
+			{
+				right = newRight;
+				rightIndex = i;
+			}
+			else
+			{
+				path.push_back(left);
+				apex = right = left;
+				apexIndex = rightIndex = leftIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+
+		if (cross(left - apex, newLeft - apex) <= 0.f)
+		{
+			if (same(apex, left) || cross(right - apex, newLeft - apex) > 0.f)
+			{
+				left = newLeft;
+				leftIndex = i;
+			}
+			else
+			{
+				path.push_back(right);
+				apex = left = right;
+				apexIndex = leftIndex = rightIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+	}
+	path.push_back(goal);
+}
+
+void Pathfinder::CancelPathQueries()
+{
+	// Queued queries name NavMeshes of the old graph, they are dropped and the agents waiting for them ask again
+	m_queries.Cancel();
+	EntityManager::Get().Collect<PathfinderWalkComponent>().Do([](PathfinderWalkComponent& pfc) { pfc.pending = false; });
+}
+
+void Pathfinder::DeliverPaths()
+{
+	m_queries.Deliver();
+}
+
+void Pathfinder::DispatchPaths()
+{
+	PruneFlowFields();
+	m_queries.Dispatch(m_navGraph, PATH_QUERY_BUDGET_MS);
+}
+
+const NavGraph::FlowField& Pathfinder::FlowFieldTo(entity target, NavMeshID goalMesh, const Vector3 goal)
+{
+	ChaseField& chase = m_flowFields[target];
+	chase.chased = true;
+	if (chase.field.goalMesh != goalMesh)
+	{
+		++m_flowFieldBuilds;
+		m_navGraph.BuildFlowField(goalMesh, goal, chase.field);
+	}
+	return chase.field;
+}
+
+void Pathfinder::PruneFlowFields()
+{
+	std::erase_if(m_flowFields, [](auto& entry)
+		{
+			const bool keep = entry.second.chased && EntityManager::Get().Exists(entry.first);
+			entry.second.chased = false;
+			return !keep;
+		});
+}
+
+const std::vector<PortalID>& Pathfinder::CachedPortals(NavMeshID startMesh, NavMeshID goalMesh, const Vector3 start, const Vector3 goal)
+{
+	const u64 key = (static_cast<u64>(startMesh) << 32) | goalMesh;
+	if (const std::vector<PortalID>* cached = m_pathCache.Find(key))
+	{
+		++m_cacheHits;
+		return *cached;
+	}
+
+	// Unreachable goals are cached as well (empty path), the graph has to change before they can become reachable
+	++m_cacheMisses;
+	std::vector<PortalID>& path = m_pathCache.Insert(key);
+	m_navGraph.FindPath(startMesh, start, goalMesh, goal, path);
+	return path;
+}
+
+std::vector<PortalID> Pathfinder::Astar(const Vector3 start, const Vector3 goal)
+{
 	std::vector<PortalID> result;
 
-	em.Collect<NavSceneComponent>().Do(
+	EntityManager::Get().Collect<NavSceneComponent>().Do(
 		[&](NavSceneComponent& navScene)
 		{
 			if (NavMeshID startMesh = navScene.At(start); startMesh != NULL_ENTITY)
 			{
 				if (NavMeshID terminalNavMesh = navScene.At(goal); terminalNavMesh != NULL_ENTITY)
 				{
-					// Define the entry and terminal nodes
-					// Opportunity to optimize:
-					// if FindNavMeshContaining(start) == FindNavMeshContaining(goal) return empty path
-
-					PortalComponent entry = PortalComponent(startMesh, start);
-					constexpr PortalID startPoint = NULL_ENTITY;
-
-					std::vector<PortalID> openSet = { startPoint };
-					std::unordered_map<PortalID, PortalID> cameFrom;
-					std::unordered_map<PortalID, MaxFloat> fScore;
-					fScore[startPoint] = h(start, goal);
-					std::unordered_map<PortalID, MaxFloat> gScore;
-					gScore[startPoint] = 0;
-
-					// Lamdas used in A*
-					// ------------------------------------------------------------------------
-					// lambda: pop element with lowest fScore from minheap
-					auto popOpenSet = [&]()
-					{
-						PortalID get = openSet[0];
-						openSet[0] = openSet.back();
-						openSet.pop_back();
-						// percolate down
-						size_t i = 0;
-						size_t comp = i * 2 + 1;		// left child
-						while (comp < openSet.size())
-						{
-							size_t right = i * 2 + 2;	// right child
-							if (right < openSet.size())
-								if (fScore[openSet[right]] < fScore[openSet[comp]])
-									comp = right;
-							if (fScore[openSet[comp]] < fScore[openSet[i]])
-							{
-								std::swap(openSet[i], openSet[comp]);
-								i = comp;
-								comp = i * 2 + 1;
-							}
-							else
-								comp = openSet.size();
-						}
-						return get;
-					};
-					// lambda: push new element onto minheap
-					auto pushOpenSet = [&](PortalID id)
-					{
-						openSet.push_back(id);
-						// percolate up
-						size_t i = openSet.size() - 1;
-						size_t p = (i + (i % 2)) / 2 - 1;
-						while (i > 0 && p >= 0 && fScore[openSet[p]] > fScore[openSet[i]])
-						{
-							std::swap(openSet[p], openSet[i]);
-							i = p;
-							p = (i + (i % 2)) / 2 - 1;
-						}
-					};
-					// lambda: returns true if current node is connected to the NavMesh containing the goal
-					auto leadsToGoal = [&](PortalID current)
-					{
-						PortalComponent* currentPortal = nullptr;
-						if (current == startPoint)
-							currentPortal = &entry;
-						else
-							currentPortal = &em.GetComponent<PortalComponent>(current);
-						
-						return currentPortal->navMesh1 == terminalNavMesh || currentPortal->navMesh2 == terminalNavMesh;
-					};
-					// lambda: returns true if openSet does not contain neighbor
-					auto notInOpenSet = [&](PortalID neighbor)
-					{
-						for (PortalID node : openSet)
-							if (node == neighbor)
-								return false;
-						return true;
-					};
-					auto getNeighbors = [&](PortalID current)
-					{
-						if (current == startPoint)
-							return em.GetComponent<NavMeshComponent>(entry.navMesh1).portals;
-						std::vector<PortalID> neighbors;
-						PortalComponent& currentPortal = em.GetComponent<PortalComponent>(current);
-						for (NavMeshID id : { currentPortal.navMesh1, currentPortal.navMesh2 })
-							for (PortalID portalID : em.GetComponent<NavMeshComponent>(id).portals)
-								if (portalID != current)
-									neighbors.push_back(portalID);
-						return neighbors;
-					};
-					// lambda: d - distance between nodes
-					auto d = [&](PortalID current, PortalID neighbor)
-					{
-						// get the portals
-						PortalComponent* currentPortal = nullptr;
-						if (current == startPoint)
-							currentPortal = &entry;
-						else
-							currentPortal = &em.GetComponent<PortalComponent>(current);
-						PortalComponent* neighborPortal = nullptr;
-						if (neighbor == startPoint)
-							neighborPortal = &entry;
-						else
-							neighborPortal = &em.GetComponent<PortalComponent>(neighbor);
-						// find the common NavMesh
-						NavMeshID meshID;
-						meshID = currentPortal->navMesh1;
-						if (neighborPortal->navMesh1 != meshID || neighborPortal->navMesh2 != meshID)
-							meshID = currentPortal->navMesh2;
-						// meshID must now hold the common NavMesh
-						return em.GetComponent<NavMeshComponent>(meshID).CostWalk(currentPortal->portal, neighborPortal->portal);
-					};
-					// lambda: creates the shortest path found
-					auto reconstructPath = [&](PortalID portalID)
-					{
-						//std::vector<PortalID> path;
-						while (cameFrom.contains(portalID))
-						{
-							if (portalID != startPoint)
-								// exclude starting point from path
-								result.push_back(portalID);
-							portalID = cameFrom[portalID];
-						}
-						// reverse path
-						std::reverse(result.begin(), result.end());
-						//return path;
-					};
-
-					// ---------------------------------------------------------------------
-					// A* implementation
-					while (!openSet.empty())
-					{
-						PortalID current = popOpenSet();
-						if (leadsToGoal(current))
-						{
-							reconstructPath(current);	// fills result with PortalIDs
-							break;
-						}
-
-						for (PortalID neighbor : getNeighbors(current))
-						{
-							float tentativeGScore = gScore[current] + d(current, neighbor);
-							if (gScore[neighbor] > tentativeGScore)
-							{
-								cameFrom[neighbor] = current;
-								gScore[neighbor] = tentativeGScore;
-								fScore[neighbor] = tentativeGScore + h(em.GetComponent<PortalComponent>(neighbor).portal, goal);
-								if (notInOpenSet(neighbor))
-									pushOpenSet(neighbor);
-							}
-						}
-					}
+					m_navGraph.FindPath(startMesh, start, terminalNavMesh, goal, result);
 				}
-				// else trivial navigation within NavMesh
+				// else invalid goal position
 			}
 			// else invalid starting position
 		});
 
 	return result;
 }
-
-float Pathfinder::heuristicStraightLine(Vector3 start, Vector3 goal)
-{
-	return (goal - start).Length();
-}
@@ -2,6 +2,9 @@
 #include <DOGEngine.h>
 #include "../Game/GameComponent.h"
 #include "PathfinderComponents.h"
+#include "NavGraph.h"
+#include "PathQueryService.h"
+#include "PathCache.h"
 
 class Pathfinder
 {
@@ -39,8 +42,28 @@ public:
 
 	void BuildNavScene(SceneComponent::Type sceneType);
 
+	// Re-derives the NavMeshes and portals of the cells overlapping [low, high] and the cells around them, e.g. when a door
+	// opens. Only cached paths through the region are dropped, unless the change connects NavMeshes that were not connected.
+	void UpdateNavRegion(const Vector3 low, const Vector3 high);
+
 	std::vector<Vector3> Checkpoints(Vector3 start, Vector3 goal);
-	void Checkpoints(Vector3 start, PathfinderWalkComponent& pfc);
+	// With an entity, paths that are not cached are searched for asynchronously and pfc.pending is set until they arrive
+	void Checkpoints(Vector3 start, PathfinderWalkComponent& pfc, DOG::entity e = DOG::NULL_ENTITY);
+
+	// Path query sync points, called once per frame by PathQuerySystem. Dispatching also drops the flow fields of targets
+	// that are gone or that no agent chased since the previous dispatch.
+	void DeliverPaths();
+	void DispatchPaths();
+
+	// Rebakes the nav graph, drops every cached path and makes walking agents replan. Call whenever portals or nav meshes change.
+	void InvalidatePaths();
+	u32 NavVersion() const { return m_navVersion; }
+	u32 CacheHits() const { return m_cacheHits; }
+	u32 CacheMisses() const { return m_cacheMisses; }
+	u32 CacheEvictions() const { return m_pathCache.Evictions(); }
+	static constexpr u32 PathCacheCapacity() { return PATH_CACHE_CAPACITY; }
+	u32 FlowFieldBuilds() const { return m_flowFieldBuilds; }
+	u32 QueuedPaths() const { return m_queries.QueuedCount(); }
 
 	bool Visualize(Viz type);
 
@@ -66,9 +89,37 @@ private:
 		static inline const Step start{ 0, 0, 0 };
 	};
 
+	static constexpr f64 PATH_QUERY_BUDGET_MS = 2.0;
+	static constexpr u32 NAV_CLUSTER_BLOCKS = 8;			// Edge of a NavGraph cluster in level blocks
+	static constexpr u32 PATH_CACHE_CAPACITY = 2048;		// (start NavMesh, goal NavMesh) pairs
+
 	static Pathfinder s_instance;
 	static bool m_initialized;
 
+	// Portal paths keyed by (start NavMesh, goal NavMesh), valid until the nav graph changes
+	PathCache m_pathCache{ PATH_CACHE_CAPACITY };
+	u32 m_navVersion = 1;
+	u32 m_cacheHits = 0;
+	u32 m_cacheMisses = 0;
+
+	NavGraph m_navGraph;
+	PathQueryService m_queries;
+	bool m_asyncPaths = true;
+
+	// Flow field per chased entity, only rebuilt when the target enters another NavMesh or the nav graph changes
+	struct ChaseField
+	{
+		NavGraph::FlowField field;
+		bool chased = false;	// Sampled since the last PruneFlowFields
+	};
+	std::unordered_map<DOG::entity, ChaseField> m_flowFields;
+	u32 m_flowFieldBuilds = 0;
+
+	// Funnel scratch
+	std::vector<Vector3> m_funnelLefts;
+	std::vector<Vector3> m_funnelRights;
+	std::vector<PortalID> m_exitPortal;
+
 	Pathfinder() noexcept;
 	~Pathfinder();
 	DELETE_COPY_MOVE_CONSTRUCTOR(Pathfinder);
@@ -76,6 +127,12 @@ private:
 	void VisualizePathsMenu(bool& open);
 
 	// Methods
-	std::vector<PortalID> Astar(const Vector3 start, const Vector3 goal, float (*h)(Vector3, Vector3));
-	static float heuristicStraightLine(Vector3 start, Vector3 goal);
+	void ConnectNavMesh(NavSceneComponent& navScene, size_t x, size_t y, size_t z, SceneComponent::Type sceneType);
+	const NavGraph::FlowField& FlowFieldTo(DOG::entity target, NavMeshID goalMesh, const Vector3 goal);
+	void PruneFlowFields();
+	void CancelPathQueries();
+	// String-pulls start -> portals -> goal through the portal segments, appends the corners and the goal to path
+	void Funnel(const Vector3 start, const std::vector<PortalID>& portals, const Vector3 goal, std::vector<Vector3>& path);
+	const std::vector<PortalID>& CachedPortals(NavMeshID startMesh, NavMeshID goalMesh, const Vector3 start, const Vector3 goal);
+	std::vector<PortalID> Astar(const Vector3 start, const Vector3 goal);
 };
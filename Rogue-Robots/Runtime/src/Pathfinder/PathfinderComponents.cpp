@@ -7,26 +7,31 @@ using Vector3 = DirectX::SimpleMath::Vector3;
 
 void NavSceneComponent::AddIdAt(size_t x, size_t y, size_t z, entity e)
 {
-	// expand map if necessary
-	while (!(y < map.size()))
-		map.emplace_back(std::vector<std::vector<entity>>());
-	while (!(z < map[y].size()))
-		map[y].emplace_back(std::vector<entity>());
-	while (!(x < map[y][z].size()))
-		map[y][z].emplace_back(NULL_ENTITY);
+	// expand grid if necessary, growing geometrically so a level fills it with few re-layouts
+	if (x >= width || y >= height || z >= depth)
+	{
+		const size_t newWidth = x < width ? width : std::max(x + 1, width * 2);
+		const size_t newDepth = z < depth ? depth : std::max(z + 1, depth * 2);
+		const size_t newHeight = y < height ? height : std::max(y + 1, height * 2);
+
+		std::vector<entity> grown(newWidth * newDepth * newHeight, NULL_ENTITY);
+		for (size_t oy = 0; oy < height; ++oy)
+			for (size_t oz = 0; oz < depth; ++oz)
+				std::copy_n(cells.begin() + (oy * depth + oz) * width, width, grown.begin() + (oy * newDepth + oz) * newWidth);
+
+		cells = std::move(grown);
+		width = newWidth;
+		depth = newDepth;
+		height = newHeight;
+	}
 
 	// save block entity id
-	map[y][z][x] = e;
+	cells[(y * depth + z) * width + x] = e;
 }
 
 bool NavSceneComponent::HasNavMesh(size_t x, size_t y, size_t z)
 {
-	if (y < map.size())
-		if (z < map[y].size())
-			if (x < map[y][z].size())
-				return map[y][z][x] != NULL_ENTITY;
-
-	return false;
+	return At(x, y, z) != NULL_ENTITY;
 }
 
 bool NavSceneComponent::HasNavMesh(int x, int y, int z)
@@ -39,10 +44,8 @@ bool NavSceneComponent::HasNavMesh(int x, int y, int z)
 
 DOG::entity NavSceneComponent::At(size_t x, size_t y, size_t z)
 {
-	if (y < map.size())
-		if (z < map[y].size())
-			if (x < map[y][z].size())
-				return map[y][z][x];
+	if (x < width && y < height && z < depth)
+		return cells[(y * depth + z) * width + x];
 
 	return NULL_ENTITY;
 }
@@ -91,9 +94,29 @@ PortalComponent::PortalComponent(NavMeshID mesh1, NavMeshID mesh2) : navMesh1(me
 
 	// find the point on the border between bb1 and bb2
 	portal = (bb2.Center() + bb1.Center()) / 2;
+	end1 = end2 = portal;
+
+	// The surface is where the boxes overlap, its thinnest axis is the one the meshes are neighbors along
+	const Vector3 low = Vector3::Max(bb1.Center() - bb1.Extents(), bb2.Center() - bb2.Extents());
+	const Vector3 high = Vector3::Min(bb1.Center() + bb1.Extents(), bb2.Center() + bb2.Extents());
+	const Vector3 overlap = high - low;
+	if (overlap.y <= overlap.x && overlap.y <= overlap.z)
+		return;
+
+	// Walls along z span x and the other way around
+	if (overlap.z < overlap.x && overlap.x > 2 * PORTAL_MARGIN)
+	{
+		end1.x = low.x + PORTAL_MARGIN;
+		end2.x = high.x - PORTAL_MARGIN;
+	}
+	else if (overlap.x <= overlap.z && overlap.z > 2 * PORTAL_MARGIN)
+	{
+		end1.z = low.z + PORTAL_MARGIN;
+		end2.z = high.z - PORTAL_MARGIN;
+	}
 }
 
-PortalComponent::PortalComponent(NavMeshID mesh, Vector3 pos) : navMesh1(mesh), navMesh2(mesh), portal(pos)
+PortalComponent::PortalComponent(NavMeshID mesh, Vector3 pos) : navMesh1(mesh), navMesh2(mesh), portal(pos), end1(pos), end2(pos)
 {
 }
 
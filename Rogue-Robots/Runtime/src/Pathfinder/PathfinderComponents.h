@@ -6,7 +6,11 @@ struct NavSceneComponent
 	using Vector3 = DirectX::SimpleMath::Vector3;
 	using NavMeshID = DOG::entity;
 
-	std::vector<std::vector<std::vector<DOG::entity>>> map;
+	// Dense grid of NavMeshes, x varies fastest, then z, then y. NULL_ENTITY where there is no NavMesh.
+	std::vector<DOG::entity> cells;
+	size_t width = 0;		// x
+	size_t depth = 0;		// z
+	size_t height = 0;		// y
 
 	void AddIdAt(size_t x, size_t y, size_t z, DOG::entity e);
 	bool HasNavMesh(size_t x, size_t y, size_t z);
@@ -26,6 +30,9 @@ struct NavMeshComponent
 	// Portals to other NavMeshes
 	std::vector<PortalID> portals;
 
+	// The block (or empty space) the NavMesh was derived from, its bounding box is the NavMesh before it is shrunk to the walls
+	DOG::entity source = DOG::NULL_ENTITY;
+
 	// Methods
 	bool Connected(NavMeshID mesh1, NavMeshID mesh2);
 	//bool Contains(const Vector3 pos) const;
@@ -41,9 +48,15 @@ struct PortalComponent
 	using NavMeshID = DOG::entity;
 	using PortalID = DOG::entity;
 
-	// Portal - for now a single point in the middle of the intersecting surface
+	// Portal - a single point in the middle of the intersecting surface
 	Vector3 portal;
 
+	// The walkable width of the portal as a segment across the intersecting surface at the height of portal, kept
+	// clear of the walls by PORTAL_MARGIN. Both ends equal portal if the surface is too narrow or not a wall.
+	Vector3 end1;
+	Vector3 end2;
+	static constexpr float PORTAL_MARGIN = 1.0f;
+
 	// Portal connects
 	NavMeshID navMesh1;
 	NavMeshID navMesh2;
@@ -69,6 +82,19 @@ struct PathfinderWalkComponent
 
 	Vector3 goal;
 	std::vector<Vector3> path;
+
+	// Portal corridor the path is built from. It is kept between frames and only searched for again
+	// when the agent leaves it, the goal moves to another NavMesh or the nav graph changes.
+	std::vector<DOG::entity> portals;
+	std::vector<DOG::entity> corridor;		// NavMeshes along the portals, corridor[i + 1] is entered through portals[i]
+	DOG::entity goalMesh = DOG::NULL_ENTITY;
+	u32 navVersion = 0;
+
+	// Waiting for the PathQueryService, the agent keeps following its last path meanwhile
+	bool pending = false;
+
+	// Set to the entity being chased to follow its shared flow field instead of searching a path of its own
+	DOG::entity flowTarget = DOG::NULL_ENTITY;
 };
 
 struct VisualizePathComponent
@@ -3,13 +3,13 @@
 
 using namespace DOG;
 
-void PathfinderWalkSystem::OnUpdate(PathfinderWalkComponent& pfc, DOG::TransformComponent& trans)
+void PathfinderWalkSystem::OnUpdate(DOG::entity e, PathfinderWalkComponent& pfc, DOG::TransformComponent& trans)
 {
 	constexpr Vector3 LASER_COLOR = Vector3(0.1f, 2.f, 0.1f);
 
 	Pathfinder& pf = Pathfinder::Get();
 
-	pf.Checkpoints(trans.GetPosition(), pfc);
+	pf.Checkpoints(trans.GetPosition(), pfc, e);
 
 	if (pf.Visualize(Pathfinder::Viz::Paths))
 	{
@@ -35,6 +35,16 @@ void PathfinderWalkSystem::OnUpdate(PathfinderWalkComponent& pfc, DOG::Transform
 	}
 }
 
+void PathQuerySystem::EarlyUpdate() noexcept
+{
+	Pathfinder::Get().DeliverPaths();
+}
+
+void PathQuerySystem::LateUpdate() noexcept
+{
+	Pathfinder::Get().DispatchPaths();
+}
+
 void VisualizePathCleanUpSystem::OnUpdate(DOG::entity e, LaserBeamVFXComponent&, VisualizePathComponent&)
 {
 	EntityManager::Get().DestroyEntity(e);
@@ -8,8 +8,18 @@ class PathfinderWalkSystem : public DOG::ISystem
 	using Matrix = DirectX::SimpleMath::Matrix;
 public:
 	SYSTEM_CLASS(PathfinderWalkComponent, DOG::TransformComponent);
-	ON_UPDATE(PathfinderWalkComponent, DOG::TransformComponent);
-	void OnUpdate(PathfinderWalkComponent& pfc, DOG::TransformComponent& trans);
+	ON_UPDATE_ID(PathfinderWalkComponent, DOG::TransformComponent);
+	void OnUpdate(DOG::entity e, PathfinderWalkComponent& pfc, DOG::TransformComponent& trans);
+};
+
+// Sync point of the path queries: results are delivered before the agents walk, and the searches they
+// requested run on the workers from the end of one frame to the start of the next
+class PathQuerySystem : public DOG::ISystem
+{
+public:
+	SYSTEM_CLASS(PathfinderWalkComponent);
+	void EarlyUpdate() noexcept override final;
+	void LateUpdate() noexcept override final;
 };
 
 class VisualizePathCleanUpSystem : public DOG::ISystem